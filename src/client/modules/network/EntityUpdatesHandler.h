@@ -0,0 +1,32 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "IClientProtocolHandler.h"
+#include "animation/Animation.h"
+#include "shared/Quantize.h"
+
+/**
+ * Applies the delta compressed state of all the changed @c frontend::ClientEntity instances of one server tick
+ */
+CLIENTPROTOHANDLERIMPL(EntityUpdates) {
+	const auto* entities = message->entities();
+	for (const network::EntityDelta* delta : *entities) {
+		const frontend::ClientEntityPtr& entity = client->getEntity(delta->id());
+		if (!entity) {
+			continue;
+		}
+		const network::EntityDeltaField fields = delta->fields();
+		if ((fields & network::EntityDeltaField::Position) != network::EntityDeltaField::NONE) {
+			entity->setPosition(shared::dequantizePosition(glm::ivec3(delta->x(), delta->y(), delta->z())));
+		}
+		if ((fields & network::EntityDeltaField::Rotation) != network::EntityDeltaField::NONE) {
+			entity->setOrientation(shared::dequantizeOrientation(delta->rotation()));
+		}
+		if ((fields & network::EntityDeltaField::Animation) != network::EntityDeltaField::NONE) {
+			entity->setAnimation(delta->animation(), true);
+		}
+	}
+}
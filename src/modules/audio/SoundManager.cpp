@@ -82,7 +82,7 @@ void SoundManager::shutdown() {
 	_music = nullptr;
 	Mix_AllocateChannels(0);
 	for (auto i : _map) {
-		Mix_FreeChunk(i->second);
+		Mix_FreeChunk(i->value);
 	}
 	_state = SoundState::CLOSED;
 	_map.clear();
@@ -216,7 +216,7 @@ Mix_Chunk* SoundManager::getChunk(const core::String& filename) {
 	}
 	auto i = _map.find(filename);
 	if (i != _map.end()) {
-		return i->second;
+		return i->value;
 	}
 
 	io::FilePtr file;
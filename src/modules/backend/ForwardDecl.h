@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include "entity/EntityId.h"
 #include "core/SharedPtr.h"
 
@@ -96,6 +97,7 @@ typedef std::shared_ptr<AILoader> AILoaderPtr;
 
 class Entity;
 typedef std::shared_ptr<Entity> EntityPtr;
+typedef std::vector<EntityPtr> EntityList;
 
 class User;
 typedef std::shared_ptr<User> UserPtr;
@@ -0,0 +1,136 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "math/QuadTree.h"
+#include "math/SpatialHashGrid.h"
+#include <unordered_set>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Simulates the visibility updates of the @c backend::Map tick for a lot of moving npcs
+ */
+class MapVisibilityBenchmark : public app::AbstractBenchmark {
+public:
+	static constexpr float WorldSize = 2000.0f;
+	static constexpr float ViewDistance = 50.0f;
+	static constexpr float Speed = 2.0f;
+
+	struct Npc {
+		glm::vec2 pos;
+		int id;
+
+		inline math::RectFloat getRect() const {
+			return math::RectFloat(pos.x - 0.5f, pos.y - 0.5f, pos.x + 0.5f, pos.y + 0.5f);
+		}
+
+		inline math::RectFloat viewRect() const {
+			return math::RectFloat(pos.x - ViewDistance, pos.y - ViewDistance, pos.x + ViewDistance, pos.y + ViewDistance);
+		}
+	};
+
+	struct Node {
+		Npc* npc;
+
+		inline math::RectFloat getRect() const {
+			return npc->getRect();
+		}
+
+		inline bool operator==(const Node& rhs) const {
+			return npc == rhs.npc;
+		}
+	};
+
+	struct NodeHash {
+		inline size_t operator()(const Node& node) const {
+			return std::hash<Npc*>()(node.npc);
+		}
+	};
+
+	static std::vector<Npc> createNpcs(int amount) {
+		std::mt19937 rng(amount);
+		std::uniform_real_distribution<float> dist(0.0f, WorldSize);
+		std::vector<Npc> npcs(amount);
+		for (int i = 0; i < amount; ++i) {
+			npcs[i].pos = glm::vec2(dist(rng), dist(rng));
+			npcs[i].id = i;
+		}
+		return npcs;
+	}
+
+	static void move(Npc& npc, std::mt19937& rng) {
+		std::uniform_real_distribution<float> dist(-Speed, Speed);
+		npc.pos = glm::clamp(npc.pos + glm::vec2(dist(rng), dist(rng)), glm::vec2(0.0f), glm::vec2(WorldSize));
+	}
+};
+
+/**
+ * @brief The old map tick: the moved npc is removed and inserted again, the query fills a list that is copied into a set
+ */
+BENCHMARK_DEFINE_F(MapVisibilityBenchmark, QuadTree)(benchmark::State &state) {
+	std::vector<Npc> npcs = createNpcs((int)state.range(0));
+	math::QuadTree<Node, float> quadTree(math::RectFloat(0.0f, 0.0f, WorldSize, WorldSize), 10);
+	for (Npc& npc : npcs) {
+		quadTree.insert(Node { &npc });
+	}
+	std::mt19937 rng(0);
+	size_t visible = 0;
+	for (auto _ : state) {
+		for (Npc& npc : npcs) {
+			quadTree.remove(Node { &npc });
+			move(npc, rng);
+			quadTree.insert(Node { &npc });
+			math::QuadTree<Node, float>::Contents contents;
+			quadTree.query(npc.viewRect(), contents);
+			std::unordered_set<Npc*> set;
+			set.reserve(contents.size());
+			for (const Node& node : contents) {
+				if (node.npc != &npc) {
+					set.insert(node.npc);
+				}
+			}
+			visible += set.size();
+		}
+	}
+	benchmark::DoNotOptimize(visible);
+	state.SetItemsProcessed(state.iterations() * npcs.size());
+}
+
+/**
+ * @brief The current map tick: the grid is only touched if the npc crosses a cell border, the query
+ * result is collected into a reused buffer
+ */
+BENCHMARK_DEFINE_F(MapVisibilityBenchmark, SpatialHashGrid)(benchmark::State &state) {
+	std::vector<Npc> npcs = createNpcs((int)state.range(0));
+	math::SpatialHashGrid<Node, float, NodeHash> grid(64.0f);
+	for (Npc& npc : npcs) {
+		grid.insert(Node { &npc });
+	}
+	std::mt19937 rng(0);
+	std::vector<Npc*> buffer;
+	size_t visible = 0;
+	for (auto _ : state) {
+		for (Npc& npc : npcs) {
+			move(npc, rng);
+			grid.update(Node { &npc });
+			buffer.clear();
+			grid.visit(npc.viewRect(), [&] (const Node& node) {
+				if (node.npc != &npc) {
+					buffer.push_back(node.npc);
+				}
+			});
+			std::sort(buffer.begin(), buffer.end());
+			visible += buffer.size();
+		}
+	}
+	benchmark::DoNotOptimize(visible);
+	state.SetItemsProcessed(state.iterations() * npcs.size());
+}
+
+BENCHMARK_REGISTER_F(MapVisibilityBenchmark, QuadTree)->Arg(1000)->Arg(5000)->Arg(10000);
+BENCHMARK_REGISTER_F(MapVisibilityBenchmark, SpatialHashGrid)->Arg(1000)->Arg(5000)->Arg(10000);
+
+BENCHMARK_MAIN();
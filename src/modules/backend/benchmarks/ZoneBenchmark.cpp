@@ -0,0 +1,111 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "backend/entity/ai/AI.h"
+#include "backend/entity/ai/ICharacter.h"
+#include "backend/entity/ai/tree/ITask.h"
+#include "backend/entity/ai/condition/True.h"
+#include "backend/entity/ai/zone/Zone.h"
+#include "backend/entity/ai/zone/AIScheduler.h"
+#include "core/concurrent/ThreadPool.h"
+#include <future>
+#include <vector>
+
+namespace backend {
+
+/**
+ * @brief Burns some cycles - every 16th character is a lot more expensive to tick to get
+ * an uneven distribution of the work
+ */
+struct BenchmarkWork: public ITask {
+	BenchmarkWork() :
+			ITask("BenchmarkWork", "", True::get()) {
+	}
+
+	ai::TreeNodeStatus doAction(const AIPtr& entity, int64_t deltaMillis) override {
+		const int iterations = entity->getId() % 16 == 0 ? 2000 : 100;
+		float value = (float)deltaMillis;
+		for (int i = 0; i < iterations; ++i) {
+			value = value * 0.999f + 1.0f;
+		}
+		benchmark::DoNotOptimize(value);
+		return ai::TreeNodeStatus::FINISHED;
+	}
+};
+
+class BenchmarkCharacter : public ICharacter {
+public:
+	BenchmarkCharacter(ai::CharacterId id) :
+			ICharacter(id) {
+	}
+};
+
+/**
+ * @brief Ticks the behaviour trees of a lot of npcs like @c Zone::update does
+ */
+class ZoneBenchmark : public app::AbstractBenchmark {
+public:
+	static void tick(const AIPtr& ai) {
+		ai->update(10, false);
+		ai->getBehaviour()->execute(ai, 10);
+	}
+
+	static std::vector<AIPtr> createAIs(int amount) {
+		const TreeNodePtr root = std::make_shared<BenchmarkWork>();
+		std::vector<AIPtr> ais;
+		ais.reserve(amount);
+		for (int i = 0; i < amount; ++i) {
+			const AIPtr& ai = std::make_shared<AI>(root);
+			ai->setCharacter(core::make_shared<BenchmarkCharacter>(i));
+			ais.push_back(ai);
+		}
+		return ais;
+	}
+};
+
+/**
+ * @brief The old @c Zone::executeParallel: the map is copied and every ai is a task with its own future
+ */
+BENCHMARK_DEFINE_F(ZoneBenchmark, ThreadPool)(benchmark::State &state) {
+	Zone::AIMap ais;
+	for (const AIPtr& ai : createAIs((int)state.range(0))) {
+		ais.insert(std::make_pair(ai->getId(), ai));
+	}
+	core::ThreadPool threadPool((size_t)state.range(1), "ZoneBenchmark");
+	threadPool.init();
+	for (auto _ : state) {
+		Zone::AIMap copy(ais);
+		std::vector<std::future<void> > results;
+		for (auto i = copy.begin(); i != copy.end(); ++i) {
+			results.emplace_back(threadPool.enqueue(tick, i->second));
+		}
+		for (auto& result : results) {
+			result.wait();
+		}
+	}
+	threadPool.shutdown(true);
+	state.counters["ai_updates"] = benchmark::Counter((double)(state.iterations() * ais.size()), benchmark::Counter::kIsRate);
+}
+
+/**
+ * @brief The current @c Zone::executeParallel: chunks of the flat ai list are distributed to the threads
+ */
+BENCHMARK_DEFINE_F(ZoneBenchmark, AIScheduler)(benchmark::State &state) {
+	const std::vector<AIPtr>& ais = createAIs((int)state.range(0));
+	AIScheduler scheduler((int)state.range(1));
+	scheduler.init();
+	for (auto _ : state) {
+		scheduler.parallelFor((int)ais.size(), [&] (int i) {
+			tick(ais[i]);
+		});
+	}
+	scheduler.shutdown();
+	state.counters["ai_updates"] = benchmark::Counter((double)(state.iterations() * ais.size()), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK_REGISTER_F(ZoneBenchmark, ThreadPool)->Args({1000, 1})->Args({1000, 4})->Args({2000, 1})->Args({2000, 4})->UseRealTime();
+BENCHMARK_REGISTER_F(ZoneBenchmark, AIScheduler)->Args({1000, 1})->Args({1000, 4})->Args({2000, 1})->Args({2000, 4})->UseRealTime();
+
+}
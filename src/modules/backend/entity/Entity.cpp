@@ -3,7 +3,6 @@
  */
 
 #include "Entity.h"
-#include "core/collection/SetUtil.h"
 #include "core/ArrayLength.h"
 #include "core/Assert.h"
 #include "core/Log.h"
@@ -17,6 +16,7 @@
 #include "shared/ProtocolEnum.h"
 #include "attrib/ContainerProvider.h"
 #include <glm/trigonometric.hpp>
+#include <algorithm>
 
 namespace backend {
 
@@ -33,14 +33,14 @@ Entity::Entity(EntityId id,
 Entity::~Entity() {
 }
 
-void Entity::visibleAdd(const EntitySet& entities) {
+void Entity::visibleAdd(const EntityList& entities) {
 	for (const EntityPtr& e : entities) {
 		Log::trace("entity %i is visible for %i", (int)e->id(), (int)id());
 		sendEntitySpawn(e);
 	}
 }
 
-void Entity::visibleRemove(const EntitySet& entities) {
+void Entity::visibleRemove(const EntityList& entities) {
 	for (const EntityPtr& e : entities) {
 		Log::trace("entity %i is no longer visible for %i", (int)e->id(), (int)id());
 		sendEntityRemove(e);
@@ -66,7 +66,7 @@ bool Entity::attack(EntityId victimId) {
 
 void Entity::sendToVisible(flatbuffers::FlatBufferBuilder& fbb, network::ServerMsgType type,
 		flatbuffers::Offset<void> data, bool sendToSelf, uint32_t flags) const {
-	const EntitySet& visible = visibleCopy();
+	const EntityList& visible = visibleCopy();
 	std::vector<ENetPeer*> peers;
 	peers.reserve(visible.size() + 1);
 	if (sendToSelf) {
@@ -119,6 +119,9 @@ void Entity::init() {
 
 void Entity::shutdown() {
 	_visible.clear();
+	_visibleAdded.clear();
+	_visibleRemoved.clear();
+	_replication.clear();
 }
 
 void Entity::onAttribChange(const attrib::DirtyValue& v) {
@@ -188,42 +191,69 @@ bool Entity::update(long dt) {
 }
 
 void Entity::updateVisible(const EntitySet& set) {
+	EntityList entities(set.begin(), set.end());
+	updateVisible(entities);
+}
+
+void Entity::updateVisible(EntityList& entities) {
 	core_trace_scoped(UpdateVisible);
+	std::sort(entities.begin(), entities.end());
 	_visibleLock.lockWrite();
-	const auto& stillVisible = core::setIntersection(set, _visible);
-	const EntitySet& remove = core::setDifference(stillVisible, _visible);
-	const EntitySet& add = core::setDifference(set, stillVisible);
-	_visible = core::setUnion(stillVisible, add);
+	// both lists are sorted - walk them in parallel to find the added and removed entities
+	auto oldIter = _visible.begin();
+	auto newIter = entities.begin();
+	while (oldIter != _visible.end() || newIter != entities.end()) {
+		if (newIter == entities.end() || (oldIter != _visible.end() && *oldIter < *newIter)) {
+			_visibleRemoved.push_back(*oldIter++);
+		} else if (oldIter == _visible.end() || *newIter < *oldIter) {
+			_visibleAdded.push_back(*newIter++);
+		} else {
+			++oldIter;
+			++newIter;
+		}
+	}
+	_visible.swap(entities);
 	_visibleLock.unlockWrite();
+	// only the capacity is reused - don't keep the entities alive
+	entities.clear();
 
-	for (const auto& e : _visible) {
-		sendEntityUpdate(e);
-	}
+	// the entities that just got visible are not yet known by the replication - they get a spawn message
+	sendEntityUpdates(_visible);
 
-	if (!add.empty()) {
-		visibleAdd(add);
+	if (!_visibleAdded.empty()) {
+		visibleAdd(_visibleAdded);
 	}
-	if (!remove.empty()) {
-		visibleRemove(remove);
+	if (!_visibleRemoved.empty()) {
+		visibleRemove(_visibleRemoved);
 	}
+	_visibleAdded.clear();
+	_visibleRemoved.clear();
 }
 
-void Entity::sendEntityUpdate(const EntityPtr& entity) const {
+void Entity::sendEntityUpdates(const EntityList& entities) {
+	_replicationBytes = 0u;
 	if (_peer == nullptr) {
 		return;
 	}
-	const glm::vec3& _pos = entity->pos();
-	const network::Vec3 pos { _pos.x, _pos.y, _pos.z };
-	_entityUpdateFBB.Clear();
-	_messageSender->sendServerMessage(_peer, _entityUpdateFBB, network::ServerMsgType::EntityUpdate,
-			network::CreateEntityUpdate(_entityUpdateFBB, entity->id(), &pos, entity->orientation(), entity->animation()).Union());
+	core_trace_scoped(SendEntityUpdates);
+	_entityUpdatesFBB.Clear();
+	for (const EntityPtr& e : entities) {
+		_replication.update(_entityUpdatesFBB, e->id(), e->pos(), e->orientation(), e->animation());
+	}
+	const flatbuffers::Offset<network::EntityUpdates>& updates = _replication.finish(_entityUpdatesFBB);
+	if (updates.IsNull()) {
+		return;
+	}
+	_replicationBytes = _entityUpdatesFBB.GetSize();
+	_messageSender->sendServerMessage(_peer, _entityUpdatesFBB, network::ServerMsgType::EntityUpdates, updates.Union());
 }
 
-void Entity::sendEntitySpawn(const EntityPtr& entity) const {
+void Entity::sendEntitySpawn(const EntityPtr& entity) {
 	if (_peer == nullptr) {
 		return;
 	}
 	const glm::vec3& pos = entity->pos();
+	_replication.add(entity->id(), pos, entity->orientation(), entity->animation());
 	const network::Vec3 vec3 { pos.x, pos.y, pos.z };
 	const EntityId entityId = id();
 	_entitySpawnFBB.Clear();
@@ -232,10 +262,11 @@ void Entity::sendEntitySpawn(const EntityPtr& entity) const {
 			network::CreateEntitySpawn(_entitySpawnFBB, entity->id(), entity->entityType(), &vec3, entityId, entity->animation()).Union());
 }
 
-void Entity::sendEntityRemove(const EntityPtr& entity) const {
+void Entity::sendEntityRemove(const EntityPtr& entity) {
 	if (_peer == nullptr) {
 		return;
 	}
+	_replication.remove(entity->id());
 	_entityRemoveFBB.Clear();
 	_messageSender->sendServerMessage(_peer, _entityRemoveFBB, network::ServerMsgType::EntityRemove,
 			network::CreateEntityRemove(_entityRemoveFBB, entity->id()).Union());
@@ -11,11 +11,13 @@
 #include "attrib/Attributes.h"
 #include "poi/Type.h"
 #include "backend/ForwardDecl.h"
+#include "EntityReplication.h"
 #include "ServerMessages_generated.h"
 #include "network/IProtocolHandler.h"
 #include "core/Trace.h"
 
 #include <unordered_set>
+#include <vector>
 #include <memory>
 
 namespace backend {
@@ -25,18 +27,26 @@ typedef std::unordered_set<EntityPtr> EntitySet;
 /**
  * @brief Every actor in the world is an entity
  *
- * Entities are updated via @c network::ServerMsgType::EntityUpdate
- * message for the clients that are seeing the entity
+ * Entities are updated via one batched and delta compressed @c network::ServerMsgType::EntityUpdates
+ * message per tick for the clients that are seeing the entity
  *
- * @sa EntityUpdateHandler
+ * @sa EntityUpdatesHandler
+ * @sa EntityReplication
  */
 class Entity {
 private:
 	core::ReadWriteLock _visibleLock {"Entity"};
-	EntitySet _visible;
+	// sorted by the entity pointer to compute the visibility changes without any lookups
+	EntityList _visible;
+	// they are stored as members to reduce memory allocations
+	EntityList _visibleAdded;
+	EntityList _visibleRemoved;
+	// the state of the visible entities that was sent to our peer
+	EntityReplication _replication;
+	uint32_t _replicationBytes = 0u;
 	// they are stored as members to reduce memory allocations
 	mutable flatbuffers::FlatBufferBuilder _attribUpdateFBB;
-	mutable flatbuffers::FlatBufferBuilder _entityUpdateFBB;
+	mutable flatbuffers::FlatBufferBuilder _entityUpdatesFBB;
 	mutable flatbuffers::FlatBufferBuilder _entitySpawnFBB;
 	mutable flatbuffers::FlatBufferBuilder _entityRemoveFBB;
 
@@ -64,16 +74,19 @@ protected:
 	/**
 	 * @brief Called with the set of entities that just get visible for this entity
 	 */
-	void visibleAdd(const EntitySet& entities);
+	void visibleAdd(const EntityList& entities);
 	/**
 	 * @brief Called with the set of entities that just get invisible for this entity
 	 */
-	void visibleRemove(const EntitySet& entities);
+	void visibleRemove(const EntityList& entities);
 
 	void broadcastAttribUpdate();
-	void sendEntityUpdate(const EntityPtr& entity) const;
-	void sendEntitySpawn(const EntityPtr& entity) const;
-	void sendEntityRemove(const EntityPtr& entity) const;
+	/**
+	 * @brief Sends the changed state of all the given entities in one message to our peer
+	 */
+	void sendEntityUpdates(const EntityList& entities);
+	void sendEntitySpawn(const EntityPtr& entity);
+	void sendEntityRemove(const EntityPtr& entity);
 
 	void onAttribChange(const attrib::DirtyValue& v);
 public:
@@ -121,6 +134,11 @@ public:
 
 	int visibleCount() const;
 
+	/**
+	 * @return The payload size of the entity updates that were sent with the last @c updateVisible() call
+	 */
+	uint32_t replicationBytes() const;
+
 	/**
 	 * @brief Allows to execute a functor/lambda on the visible objects
 	 * @note This is thread safe
@@ -138,17 +156,19 @@ public:
 	 * @brief Creates a copy of the currently visible objects. If you don't need a copy, use the @c Entity::visibleVisible method.
 	 * @note This is thread safe
 	 */
-	inline EntitySet visibleCopy() const {
+	inline EntityList visibleCopy() const {
 		core::ScopedReadLock lock(_visibleLock);
-		return EntitySet(_visible);
+		return EntityList(_visible);
 	}
 
 	/**
 	 * @brief This will inform the entity about all the other entities that it can see.
-	 * @param[in] set The entities that are currently visible
+	 * @param[in,out] entities The entities that are currently visible. The list is swapped with the
+	 * previously visible entities and cleared - this allows the caller to reuse the memory for the next call.
 	 * @note All entities have the same view range - see @c Entity::regionRect
 	 * @note This is thread safe
 	 */
+	void updateVisible(EntityList& entities);
 	void updateVisible(const EntitySet& set);
 
 	/**
@@ -204,6 +224,10 @@ inline int Entity::visibleCount() const {
 	return (int)_visible.size();
 }
 
+inline uint32_t Entity::replicationBytes() const {
+	return _replicationBytes;
+}
+
 inline const MapPtr& Entity::map() const {
 	return _map;
 }
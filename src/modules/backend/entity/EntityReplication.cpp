@@ -0,0 +1,79 @@
+/**
+ * @file
+ */
+
+#include "EntityReplication.h"
+#include "shared/Quantize.h"
+#include "core/Common.h"
+
+namespace backend {
+
+void EntityReplication::add(EntityId id, const glm::vec3& pos, float orientation, network::Animation animation) {
+	State& state = _sent[id];
+	state.pos = shared::quantizePosition(pos);
+	state.rotation = shared::quantizeOrientation(orientation);
+	state.animation = animation;
+}
+
+void EntityReplication::remove(EntityId id) {
+	_sent.erase(id);
+}
+
+void EntityReplication::clear() {
+	_sent.clear();
+	_deltas.clear();
+}
+
+bool EntityReplication::update(flatbuffers::FlatBufferBuilder& fbb, EntityId id, const glm::vec3& pos, float orientation, network::Animation animation) {
+	auto i = _sent.find(id);
+	if (i == _sent.end()) {
+		return false;
+	}
+	State& state = i->second;
+	const glm::ivec3& qpos = shared::quantizePosition(pos);
+	const uint16_t qrotation = shared::quantizeOrientation(orientation);
+	network::EntityDeltaField fields = network::EntityDeltaField::NONE;
+	if (qpos != state.pos) {
+		fields |= network::EntityDeltaField::Position;
+		state.pos = qpos;
+	}
+	if (qrotation != state.rotation) {
+		fields |= network::EntityDeltaField::Rotation;
+		state.rotation = qrotation;
+	}
+	if (animation != state.animation) {
+		fields |= network::EntityDeltaField::Animation;
+		state.animation = animation;
+	}
+	if (fields == network::EntityDeltaField::NONE) {
+		return false;
+	}
+	// unchanged fields are left at their default values - flatbuffers doesn't serialize them
+	network::EntityDeltaBuilder builder(fbb);
+	builder.add_id(id);
+	builder.add_fields(fields);
+	if ((fields & network::EntityDeltaField::Position) != network::EntityDeltaField::NONE) {
+		builder.add_x(qpos.x);
+		builder.add_y(qpos.y);
+		builder.add_z(qpos.z);
+	}
+	if ((fields & network::EntityDeltaField::Rotation) != network::EntityDeltaField::NONE) {
+		builder.add_rotation(qrotation);
+	}
+	if ((fields & network::EntityDeltaField::Animation) != network::EntityDeltaField::NONE) {
+		builder.add_animation(animation);
+	}
+	_deltas.push_back(builder.Finish());
+	return true;
+}
+
+flatbuffers::Offset<network::EntityUpdates> EntityReplication::finish(flatbuffers::FlatBufferBuilder& fbb) {
+	if (_deltas.empty()) {
+		return flatbuffers::Offset<network::EntityUpdates>();
+	}
+	const auto& entities = fbb.CreateVector(_deltas);
+	_deltas.clear();
+	return network::CreateEntityUpdates(fbb, entities);
+}
+
+}
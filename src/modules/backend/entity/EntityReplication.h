@@ -0,0 +1,68 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "EntityId.h"
+#include "core/GLM.h"
+#include "ServerMessages_generated.h"
+#include <glm/vec3.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace backend {
+
+/**
+ * @brief Keeps track of the entity state that was sent to one observer and builds the delta
+ * compressed @c network::EntityUpdates message for it.
+ *
+ * Positions and orientations are compared in their quantized form - an entity that moved less
+ * than the quantization step doesn't produce any traffic.
+ *
+ * @sa shared::quantizePosition()
+ * @sa shared::quantizeOrientation()
+ */
+class EntityReplication {
+public:
+	struct State {
+		glm::ivec3 pos { 0 };
+		uint16_t rotation = 0u;
+		network::Animation animation = network::Animation::IDLE;
+	};
+private:
+	std::unordered_map<EntityId, State> _sent;
+	std::vector<flatbuffers::Offset<network::EntityDelta>> _deltas;
+public:
+	/**
+	 * @brief Remember the state that was sent along with the spawn message of the entity
+	 */
+	void add(EntityId id, const glm::vec3& pos, float orientation, network::Animation animation);
+	void remove(EntityId id);
+	void clear();
+
+	/**
+	 * @brief Compare the given state with the state that was sent last and add a
+	 * @c network::EntityDelta with the changed fields to the given builder.
+	 * @note Entities that were not announced via @c add() are ignored
+	 * @return @c true if anything changed
+	 */
+	bool update(flatbuffers::FlatBufferBuilder& fbb, EntityId id, const glm::vec3& pos, float orientation, network::Animation animation);
+
+	/**
+	 * @brief Create the @c network::EntityUpdates message from all the deltas that were added since the last call
+	 * @return A null offset if there are no changes that must be sent
+	 */
+	flatbuffers::Offset<network::EntityUpdates> finish(flatbuffers::FlatBufferBuilder& fbb);
+
+	/**
+	 * @return The amount of entities the observer knows about
+	 */
+	int size() const;
+};
+
+inline int EntityReplication::size() const {
+	return (int)_sent.size();
+}
+
+}
@@ -24,6 +24,7 @@ EntityStorage::~EntityStorage() {
 void EntityStorage::shutdown() {
 	_eventBus->unsubscribe<EntityDeleteEvent>(*this);
 	visit([](const EntityPtr &e) { e->shutdown(); });
+	core::ScopedWriteLock lock(_lock);
 	_npcs.clear();
 	_users.clear();
 }
@@ -34,6 +35,7 @@ bool EntityStorage::init() {
 
 void EntityStorage::visit(const std::function<void(const EntityPtr&)>& visitor) {
 	core_trace_scoped(EntityStorageVisit);
+	core::ScopedReadLock lock(_lock);
 	for (auto& e : _users) {
 		visitor(e.second);
 	}
@@ -44,6 +46,7 @@ void EntityStorage::visit(const std::function<void(const EntityPtr&)>& visitor)
 
 void EntityStorage::visitNpcs(const std::function<void(const NpcPtr&)>& visitor) {
 	core_trace_scoped(EntityStorageVisitNpcs);
+	core::ScopedReadLock lock(_lock);
 	for (auto& e : _npcs) {
 		visitor(e.second);
 	}
@@ -51,31 +54,40 @@ void EntityStorage::visitNpcs(const std::function<void(const NpcPtr&)>& visitor)
 
 void EntityStorage::visitUsers(const std::function<void(const UserPtr&)>& visitor) {
 	core_trace_scoped(EntityStorageVisitUsers);
+	core::ScopedReadLock lock(_lock);
 	for (auto& e : _users) {
 		visitor(e.second);
 	}
 }
 
 bool EntityStorage::addUser(const UserPtr& user) {
-	auto i = _users.insert(std::make_pair(user->id(), user));
-	if (!i.second) {
-		Log::debug("User with id " PRIEntId " is already connected", user->id());
-		return false;
+	{
+		core::ScopedWriteLock lock(_lock);
+		auto i = _users.insert(std::make_pair(user->id(), user));
+		if (!i.second) {
+			Log::debug("User with id " PRIEntId " is already connected", user->id());
+			return false;
+		}
 	}
 	Log::info("User with id " PRIEntId " is connected", user->id());
+	// published without holding the lock - the handlers may access the storage
 	_eventBus->publish(EntityAddEvent(user));
 	return true;
 }
 
 bool EntityStorage::removeUser(EntityId userId) {
-	auto i = _users.find(userId);
-	if (i == _users.end()) {
-		Log::warn("User with id " PRIEntId " can't get removed. Reason: NotFound", userId);
-		return false;
+	UserPtr user;
+	{
+		core::ScopedWriteLock lock(_lock);
+		auto i = _users.find(userId);
+		if (i == _users.end()) {
+			Log::warn("User with id " PRIEntId " can't get removed. Reason: NotFound", userId);
+			return false;
+		}
+		Log::info("User with id " PRIEntId " is going to be removed", userId);
+		user = i->second;
+		_users.erase(i);
 	}
-	Log::info("User with id " PRIEntId " is going to be removed", userId);
-	UserPtr user = i->second;
-	_users.erase(i);
 	user->shutdown();
 	const uint64_t count = user.use_count();
 	if (count != 1) {
@@ -85,6 +97,7 @@ bool EntityStorage::removeUser(EntityId userId) {
 }
 
 UserPtr EntityStorage::user(EntityId id) {
+	core::ScopedReadLock lock(_lock);
 	UsersIter i = _users.find(id);
 	if (i == _users.end()) {
 		Log::trace("Could not find user with id " PRIEntId, id);
@@ -94,12 +107,16 @@ UserPtr EntityStorage::user(EntityId id) {
 }
 
 bool EntityStorage::addNpc(const NpcPtr& npc) {
-	auto i = _npcs.insert(std::make_pair(npc->id(), npc));
-	if (!i.second) {
-		Log::warn("Could not add npc with id " PRIEntId ". Reason: AlreadyExists", npc->id());
-		return false;
+	{
+		core::ScopedWriteLock lock(_lock);
+		auto i = _npcs.insert(std::make_pair(npc->id(), npc));
+		if (!i.second) {
+			Log::warn("Could not add npc with id " PRIEntId ". Reason: AlreadyExists", npc->id());
+			return false;
+		}
 	}
 	Log::debug("Add npc with id " PRIEntId, npc->id());
+	// published without holding the lock - the handlers may access the storage
 	_eventBus->publish(EntityAddEvent(npc));
 	return true;
 }
@@ -115,13 +132,17 @@ void EntityStorage::onEvent(const EntityDeleteEvent& event) {
 }
 
 bool EntityStorage::removeNpc(EntityId id) {
-	NpcsIter i = _npcs.find(id);
-	if (i == _npcs.end()) {
-		Log::warn("Could not delete npc with id " PRIEntId, id);
-		return false;
+	NpcPtr npc;
+	{
+		core::ScopedWriteLock lock(_lock);
+		NpcsIter i = _npcs.find(id);
+		if (i == _npcs.end()) {
+			Log::warn("Could not delete npc with id " PRIEntId, id);
+			return false;
+		}
+		npc = i->second;
+		_npcs.erase(i);
 	}
-	NpcPtr npc = i->second;
-	_npcs.erase(i);
 	npc->shutdown();
 	const uint64_t count = npc.use_count();
 	if (count != 1) {
@@ -131,6 +152,7 @@ bool EntityStorage::removeNpc(EntityId id) {
 }
 
 NpcPtr EntityStorage::npc(EntityId id) {
+	core::ScopedReadLock lock(_lock);
 	NpcsIter i = _npcs.find(id);
 	if (i == _npcs.end()) {
 		Log::trace("Could not find npc with id " PRIEntId, id);
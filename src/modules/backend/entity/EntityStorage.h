@@ -7,6 +7,7 @@
 #include "backend/ForwardDecl.h"
 #include "ai-shared/common/CharacterId.h"
 #include "core/EventBus.h"
+#include "core/concurrent/ReadWriteLock.h"
 #include "backend/eventbus/Event.h"
 #include <functional>
 #include <unordered_map>
@@ -17,6 +18,10 @@ namespace backend {
  * @brief Manages the Entity instances of the backend.
  *
  * This includes calling the Entity::update() method as well as performing the visibility calculations.
+ *
+ * @note This is thread safe - the maps are adding their npcs from the threads they are ticked in.
+ * The visitor callbacks are executed while the storage is locked and must not modify it. The @c EntityAddEvent
+ * is published synchronously from the thread that adds the entity - its handlers must be thread safe.
  */
 class EntityStorage : public core::IEventBusHandler<EntityDeleteEvent>{
 private:
@@ -28,6 +33,7 @@ private:
 	typedef Npcs::iterator NpcsIter;
 	Npcs _npcs;
 
+	core::ReadWriteLock _lock {"EntityStorage"};
 	core::EventBusPtr _eventBus;
 public:
 	EntityStorage(const core::EventBusPtr& eventBus);
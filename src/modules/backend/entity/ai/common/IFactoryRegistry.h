@@ -54,7 +54,7 @@ public:
 			return std::shared_ptr<TYPE>();
 		}
 
-		const IFactory<TYPE, CTX>* factory = i->second;
+		const IFactory<TYPE, CTX>* factory = i->value;
 
 		return factory->create(ctx);
 	}
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <new>
+#include <stddef.h>
 
 namespace backend {
 
@@ -116,8 +116,8 @@ void Server::broadcastState(const Zone* zone) {
 		auto metaAttributeIter = chrMetaAttributes.begin();
 		auto metaAttributes = _stateFBB.CreateVector<flatbuffers::Offset<ai::MapEntry>>(chrMetaAttributes.size(),
 			[&] (size_t i) {
-				const core::String& sname = metaAttributeIter->first;
-				const core::String& svalue = metaAttributeIter->second;
+				const core::String& sname = metaAttributeIter->key;
+				const core::String& svalue = metaAttributeIter->value;
 				auto name = _stateFBB.CreateString(sname.c_str(), sname.size());
 				auto value = _stateFBB.CreateString(svalue.c_str(), svalue.size());
 				++metaAttributeIter;
@@ -199,10 +199,20 @@ public:
 	 */
 	void step(int64_t stepMillis = 1L);
 
+	/**
+	 * @return The @ai{Zone} that is currently debugged or @c nullptr
+	 */
+	const Zone* zone() const;
+
 	/**
 	 * @brief call this to update the server - should get called somewhere from your game tick
+	 * @note The debugged zone is read and modified - it must not be updated concurrently
 	 */
 	void update(int64_t deltaTime);
 };
 
+inline const Zone* Server::zone() const {
+	return _zone;
+}
+
 }
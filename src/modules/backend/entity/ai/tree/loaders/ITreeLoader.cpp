@@ -44,7 +44,7 @@ TreeNodePtr ITreeLoader::load(const core::String &name) {
 	core::ScopedLock scopedLock(_lock);
 	auto i = _treeMap.find(name);
 	if (i != _treeMap.end())
-		return i->second;
+		return i->value;
 	return TreeNodePtr();
 }
 
@@ -0,0 +1,82 @@
+/**
+ * @file
+ */
+
+#include "AIScheduler.h"
+#include <glm/common.hpp>
+
+namespace backend {
+
+/**
+ * @brief Marks the threads that are currently working on a batch - to execute nested batches inline
+ */
+static thread_local bool t_insideBatch = false;
+
+AIScheduler::AIScheduler(int threads, int chunkSize) :
+		_threads(glm::max(1, threads)), _chunkSize(glm::max(1, chunkSize)), _slices(_threads),
+		_tasks((size_t)glm::max(1, _threads - 1), "AIScheduler") {
+}
+
+AIScheduler::~AIScheduler() {
+	shutdown();
+}
+
+void AIScheduler::init() {
+	_tasks.init();
+}
+
+void AIScheduler::shutdown() {
+	// the queued tasks of enqueue() are dropped
+	_tasks.shutdown(false);
+}
+
+void AIScheduler::work(int slice) {
+	for (int i = 0; i < _threads; ++i) {
+		// start with the own slice - and steal from the others afterwards
+		Slice& s = _slices[(slice + i) % _threads];
+		for (;;) {
+			const int begin = s.next.fetch_add(_chunkSize, std::memory_order_relaxed);
+			if (begin >= s.end) {
+				break;
+			}
+			_func(_userdata, begin, glm::min(begin + _chunkSize, s.end));
+		}
+	}
+}
+
+void AIScheduler::run(int n, BatchFunc func, void *userdata) {
+	if (n <= 0) {
+		return;
+	}
+	if (t_insideBatch || _threads == 1 || n <= _chunkSize) {
+		func(userdata, 0, n);
+		return;
+	}
+	core_trace_scoped(AISchedulerRun);
+	core::ScopedLock runLock(_runLock);
+	const int perSlice = (n + _threads - 1) / _threads;
+	for (int i = 0; i < _threads; ++i) {
+		_slices[i].next.store(glm::min(i * perSlice, n), std::memory_order_relaxed);
+		_slices[i].end = glm::min((i + 1) * perSlice, n);
+	}
+	_func = func;
+	_userdata = userdata;
+
+	// the thread that calls run() is working on slice 0
+	core::TaskGroup group;
+	for (int i = 1; i < _threads; ++i) {
+		_tasks.schedule([this, i] () {
+			core_trace_scoped(AISchedulerWorker);
+			t_insideBatch = true;
+			work(i);
+			t_insideBatch = false;
+		}, core::TaskPriority::High, &group);
+	}
+
+	t_insideBatch = true;
+	work(0);
+	_tasks.wait(group);
+	t_insideBatch = false;
+}
+
+}
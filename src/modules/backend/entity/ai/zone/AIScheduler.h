@@ -0,0 +1,113 @@
+/**
+ * @file
+ * @ingroup Zone
+ */
+#pragma once
+
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/TaskScheduler.h"
+#include "core/Trace.h"
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace backend {
+
+/**
+ * @brief Chunked parallel-for over a flat array for the @c AI ticks of a @c Zone
+ *
+ * Each thread (the calling thread is one of them) gets an equal slice of the index range and
+ * processes it in chunks of @c chunkSize elements. A thread that finished its own slice steals the
+ * remaining chunks of the other slices - so a few expensive behaviour trees don't leave the other
+ * threads idle. The slices are just atomic counters - there are no per element tasks and no futures.
+ *
+ * The slices are worked on by the workers of a @c core::TaskScheduler - that also executes the
+ * tasks of @c enqueue().
+ *
+ * @note Calls to @c run() are serialized. A @c run() from inside a running batch (e.g. nested
+ * @c Zone::executeParallel() calls) is executed inline by the calling thread.
+ */
+class AIScheduler {
+public:
+	/**
+	 * @brief Processes the elements in the range [begin, end)
+	 */
+	typedef void (*BatchFunc)(void *userdata, int begin, int end);
+private:
+	struct alignas(64) Slice {
+		std::atomic_int next { 0 };
+		int end = 0;
+	};
+
+	const int _threads;
+	const int _chunkSize;
+	std::vector<Slice> _slices;
+	// at least one worker - for the tasks of enqueue()
+	core::TaskScheduler _tasks;
+
+	core_trace_mutex(core::Lock, _runLock, "AISchedulerRun");
+	// the batch that is currently processed - guarded by the run lock
+	BatchFunc _func = nullptr;
+	void *_userdata = nullptr;
+
+	void work(int slice);
+public:
+	/**
+	 * @param[in] threads The amount of threads that are working on a batch - including the thread that
+	 * calls @c run(). A value of @c 1 executes the batches inline.
+	 * @param[in] chunkSize The amount of elements that are processed (or stolen) at once.
+	 */
+	AIScheduler(int threads, int chunkSize = 16);
+	~AIScheduler();
+
+	void init();
+	/**
+	 * @note The not yet executed tasks of @c enqueue() are dropped
+	 */
+	void shutdown();
+
+	int threads() const;
+
+	/**
+	 * @brief Calls the given function for all elements in [0, n) and returns once all of them were processed.
+	 */
+	void run(int n, BatchFunc func, void *userdata);
+
+	/**
+	 * @brief Calls the given functor with every index in [0, n) and returns once all of them were processed.
+	 * @note The functor is called concurrently from several threads.
+	 */
+	template<class FUNC>
+	void parallelFor(int n, const FUNC& func) {
+		run(n, [] (void *userdata, int begin, int end) {
+			const FUNC& f = *(const FUNC*)userdata;
+			for (int i = begin; i < end; ++i) {
+				f(i);
+			}
+		}, (void*)&func);
+	}
+
+	/**
+	 * @brief Executes the given functor in one of the worker threads
+	 * @return An invalid future if the scheduler is shutting down
+	 */
+	template<class F, class... Args>
+	auto enqueue(F&& f, Args&&... args) -> std::future<typename std::result_of<F(Args...)>::type> {
+		using return_type = typename std::result_of<F(Args...)>::type;
+		auto task = std::make_shared<std::packaged_task<return_type()> >(std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+		std::future<return_type> res = task->get_future();
+		if (!_tasks.schedule([task] () {(*task)();})) {
+			return std::future<return_type>();
+		}
+		return res;
+	}
+};
+
+inline int AIScheduler::threads() const {
+	return _threads;
+}
+
+}
@@ -9,7 +9,7 @@
 namespace backend {
 
 Zone::~Zone() {
-	_threadPool.shutdown();
+	_scheduler.shutdown();
 	for (const auto& e : _ais) {
 		e.second->setZone(nullptr);
 		_groupManager.removeFromAllGroups(e.second);
@@ -22,6 +22,12 @@ Zone::~Zone() {
 		doRemoveAI(ai);
 	}
 	_ais.clear();
+	_aiList.reset();
+}
+
+Zone::AIListPtr Zone::aiList() const {
+	core::ScopedLock scopedLock(_lock);
+	return _aiList;
 }
 
 AIPtr Zone::getAI(ai::CharacterId id) const {
@@ -106,18 +112,27 @@ void Zone::update(int64_t dt) {
 			scheduledDestroy.swap(_scheduledDestroy);
 		}
 		core::ScopedLock scopedLock(_lock);
+		bool changed = false;
 		for (const AIPtr& ai : scheduledAdd) {
-			doAddAI(ai);
+			changed |= doAddAI(ai);
 		}
 		scheduledAdd.clear();
 		for (auto id : scheduledRemove) {
-			doRemoveAI(id);
+			changed |= doRemoveAI(id);
 		}
 		scheduledRemove.clear();
 		for (auto id : scheduledDestroy) {
-			doDestroyAI(id);
+			changed |= doDestroyAI(id);
 		}
 		scheduledDestroy.clear();
+		if (changed) {
+			std::shared_ptr<AIScheduleList> list = std::make_shared<AIScheduleList>();
+			list->reserve(_ais.size());
+			for (const auto& e : _ais) {
+				list->push_back(e.second);
+			}
+			_aiList = list;
+		}
 	}
 
 	auto func = [&] (const AIPtr& ai) {
@@ -15,7 +15,7 @@
 
 #include "backend/entity/ai/ICharacter.h"
 #include "backend/entity/ai/group/GroupMgr.h"
-#include "core/concurrent/ThreadPool.h"
+#include "backend/entity/ai/zone/AIScheduler.h"
 #include "core/concurrent/Lock.h"
 #include "core/Trace.h"
 #include "ai-shared/common/CharacterId.h"
@@ -23,6 +23,7 @@
 #include <unordered_map>
 #include <vector>
 #include <memory>
+#include <future>
 
 namespace backend {
 
@@ -42,6 +43,7 @@ class Zone {
 public:
 	typedef std::unordered_map<ai::CharacterId, AIPtr> AIMap;
 	typedef std::vector<AIPtr> AIScheduleList;
+	typedef std::shared_ptr<const AIScheduleList> AIListPtr;
 	typedef std::vector<ai::CharacterId> CharacterIdList;
 	typedef AIMap::const_iterator AIMapConstIter;
 	typedef AIMap::iterator AIMapIter;
@@ -49,6 +51,11 @@ public:
 protected:
 	const core::String _name;
 	AIMap _ais;
+	/**
+	 * flat list of the values of @c _ais - only rebuilt if @c AI instances were added or removed. The
+	 * list is never modified, a running @c executeParallel() keeps its snapshot alive.
+	 */
+	AIListPtr _aiList;
 	AIScheduleList _scheduledAdd;
 	CharacterIdList _scheduledRemove;
 	CharacterIdList _scheduledDestroy;
@@ -56,7 +63,10 @@ protected:
 	mutable core_trace_mutex(core::Lock, _lock, "AIZone");
 	core_trace_mutex(core::Lock, _scheduleLock, "AIScheduleZone");
 	GroupMgr _groupManager;
-	mutable core::ThreadPool _threadPool;
+	/**
+	 * ticks the @c AI instances and executes the @c executeAsync() functors
+	 */
+	mutable AIScheduler _scheduler;
 
 	/**
 	 * @brief called in the zone update to add new @c AI instances.
@@ -78,10 +88,20 @@ protected:
 	 */
 	bool doDestroyAI(const ai::CharacterId& id);
 
+	/**
+	 * @note This locks the zone for reading
+	 */
+	AIListPtr aiList() const;
+
 public:
+	/**
+	 * @param[in] threadCount The amount of threads that tick the @c AI instances - including the thread
+	 * that calls @c update()
+	 */
 	Zone(const core::String& name, int threadCount = 1) :
-			_name(name), _debug(false), _threadPool(threadCount) {
-		_threadPool.init();
+			_name(name), _aiList(std::make_shared<AIScheduleList>()), _debug(false),
+			_scheduler(threadCount) {
+		_scheduler.init();
 	}
 
 	virtual ~Zone();
@@ -177,9 +197,9 @@ public:
 	 *
 	 * @return @c true if the func is going to get called for the character, @c false if not
 	 * e.g. in the case the given @c CharacterId wasn't found in this zone.
-	 * @note This is executed in a thread pool - so make sure to synchronize your lambda or functor.
-	 * We also don't wait for the functor or lambda here, we are scheduling it in a worker in the
-	 * thread pool.
+	 * @note This is executed by the workers of the @c AIScheduler - so make sure to synchronize your lambda or functor.
+	 * We also don't wait for the functor or lambda here, we are scheduling it in a worker of the
+	 * scheduler.
 	 *
 	 * @note This locks the zone for reading to perform the CharacterId lookup
 	 */
@@ -197,14 +217,14 @@ public:
 	 * @brief Executes a lambda or functor for the given character
 	 *
 	 * @returns @c std::future with the result of @c func.
-	 * @note This is executed in a thread pool - so make sure to synchronize your lambda or functor.
-	 * We also don't wait for the functor or lambda here, we are scheduling it in a worker in the
-	 * thread pool. If you want to wait - you have to use the returned future.
+	 * @note This is executed by the workers of the @c AIScheduler - so make sure to synchronize your lambda or functor.
+	 * We also don't wait for the functor or lambda here, we are scheduling it in a worker of the
+	 * scheduler. If you want to wait - you have to use the returned future.
 	 */
 	template<typename Func>
 	inline auto executeAsync(const AIPtr& ai, const Func& func) const
 		-> std::future<typename std::result_of<Func(const AIPtr&)>::type> {
-		return _threadPool.enqueue(func, ai);
+		return _scheduler.enqueue(func, ai);
 	}
 
 	template<typename Func>
@@ -243,48 +263,38 @@ public:
 
 	/**
 	 * @brief Executes a lambda or functor for all the @c AI instances in this zone
-	 * @note This is executed in a thread pool - so make sure to synchronize your lambda or functor.
+	 * @note This is executed in parallel - so make sure to synchronize your lambda or functor.
 	 * We are waiting for the execution of this.
+	 * @sa AIScheduler
 	 *
 	 * @note This locks the zone for reading
 	 */
 	template<typename Func>
 	void executeParallel(Func& func) {
 		core_trace_scoped(ZoneExecuteParallel);
-		std::vector<std::future<void> > results;
-		_lock.lock();
-		AIMap copy(_ais);
-		_lock.unlock();
-		for (auto i = copy.begin(); i != copy.end(); ++i) {
-			const AIPtr& ai = i->second;
-			results.emplace_back(executeAsync(ai, func));
-		}
-		for (auto & result: results) {
-			result.wait();
-		}
+		const AIListPtr list = aiList();
+		const AIScheduleList& ais = *list;
+		_scheduler.parallelFor((int)ais.size(), [&] (int i) {
+			func(ais[i]);
+		});
 	}
 
 	/**
 	 * @brief Executes a lambda or functor for all the @c AI instances in this zone.
-	 * @note This is executed in a thread pool - so make sure to synchronize your lambda or functor.
+	 * @note This is executed in parallel - so make sure to synchronize your lambda or functor.
 	 * We are waiting for the execution of this.
+	 * @sa AIScheduler
 	 *
 	 * @note This locks the zone for reading
 	 */
 	template<typename Func>
 	void executeParallel(const Func& func) const {
 		core_trace_scoped(ZoneExecuteParallel);
-		std::vector<std::future<void> > results;
-		_lock.lock();
-		AIMap copy(_ais);
-		_lock.unlock();
-		for (auto i = copy.begin(); i != copy.end(); ++i) {
-			const AIPtr& ai = i->second;
-			results.emplace_back(executeAsync(ai, func));
-		}
-		for (auto & result: results) {
-			result.wait();
-		}
+		const AIListPtr list = aiList();
+		const AIScheduleList& ais = *list;
+		_scheduler.parallelFor((int)ais.size(), [&] (int i) {
+			func(ais[i]);
+		});
 	}
 
 	/**
@@ -296,11 +306,8 @@ public:
 	template<typename Func>
 	void execute(const Func& func) const {
 		core_trace_scoped(ZoneExecute);
-		_lock.lock();
-		AIMap copy(_ais);
-		_lock.unlock();
-		for (auto i = copy.begin(); i != copy.end(); ++i) {
-			const AIPtr& ai = i->second;
+		const AIListPtr list = aiList();
+		for (const AIPtr& ai : *list) {
 			func(ai);
 		}
 	}
@@ -314,11 +321,8 @@ public:
 	template<typename Func>
 	void execute(Func& func) {
 		core_trace_scoped(ZoneExecute);
-		_lock.lock();
-		AIMap copy(_ais);
-		_lock.unlock();
-		for (auto i = copy.begin(); i != copy.end(); ++i) {
-			const AIPtr& ai = i->second;
+		const AIListPtr list = aiList();
+		for (const AIPtr& ai : *list) {
 			func(ai);
 		}
 	}
@@ -69,7 +69,8 @@ UserPtr UserConnectHandler::login(ENetPeer* peer, const core::String& email, con
 	const UserPtr& u = std::make_shared<User>(peer, model.id(), model.name(), map, _messageSender, _timeProvider,
 			_containerProvider, _cooldownProvider, _dbHandler, _persistenceMgr, _stockDataProvider);
 	u->init();
-	map->addUser(u);
+	// the map might be ticked in another thread right now
+	map->enqueueUser(u);
 	_entityStorage->addUser(u);
 	return u;
 }
@@ -70,6 +70,29 @@ TEST_F(AITest, testFilterSelectVisible) {
 		<< "This npc should not be part of the visible set";
 }
 
+TEST_F(AITest, testUpdateVisibleChanges) {
+	const NpcPtr& npc = create();
+	const NpcPtr& npc2 = create();
+	const NpcPtr& npc3 = create();
+	const NpcPtr& npc4 = create();
+	EntityList visible {npc3, npc2};
+	npc->updateVisible(visible);
+	EXPECT_EQ(2, npc->visibleCount());
+	EXPECT_TRUE(visible.empty()) << "Expected to get an empty buffer back";
+
+	visible = {npc4, npc2};
+	npc->updateVisible(visible);
+	EXPECT_TRUE(visible.empty()) << "The buffer must not keep the previously visible entities alive";
+	const EntityList& current = npc->visibleCopy();
+	ASSERT_EQ(2u, current.size());
+	EXPECT_TRUE(core::find(current.begin(), current.end(), EntityPtr(npc2)) != current.end());
+	EXPECT_TRUE(core::find(current.begin(), current.end(), EntityPtr(npc4)) != current.end());
+
+	visible.clear();
+	npc->updateVisible(visible);
+	EXPECT_EQ(0, npc->visibleCount());
+}
+
 TEST_F(AITest, testFilterSelectEntitiesOfTypes) {
 	const NpcPtr& npc = create(network::EntityType::ANIMAL_RABBIT);
 	const NpcPtr& typeOne1 = create(network::EntityType::ANIMAL_RABBIT);
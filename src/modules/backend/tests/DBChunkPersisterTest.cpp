@@ -0,0 +1,144 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "backend/world/DBChunkPersister.h"
+#include "persistence/tests/Mocks.h"
+#include "voxel/MaterialColor.h"
+
+namespace backend {
+
+class DBChunkPersisterTest: public app::AbstractTest {
+protected:
+	class Pager : public voxel::PagedVolume::Pager {
+	public:
+		bool pageIn(voxel::PagedVolume::PagerContext& ctx) override {
+			return false;
+		}
+
+		void pageOut(voxel::PagedVolume::Chunk* chunk) override {
+		}
+	};
+	Pager _pager;
+	persistence::DBHandlerPtr _dbHandler;
+
+	/**
+	 * @brief Simulates the queries of a prefetch and the completion of the writer thread - the mock database
+	 * fails every query
+	 */
+	class TestPersister : public DBChunkPersister {
+	public:
+		using DBChunkPersister::DBChunkPersister;
+		using DBChunkPersister::BlockWrites;
+		using DBChunkPersister::Chunks;
+		using DBChunkPersister::ChunkData;
+		using DBChunkPersister::ChunkDataPtr;
+		using DBChunkPersister::Write;
+		using DBChunkPersister::beginPrefetch;
+		using DBChunkPersister::finishPrefetch;
+		using DBChunkPersister::writesFinished;
+		using DBChunkPersister::cached;
+		using DBChunkPersister::key;
+
+		uint32_t generation(const glm::ivec4& k) const {
+			auto i = _pendingWrites.find(k);
+			return i == _pendingWrites.end() ? 0u : i->second.generation;
+		}
+	};
+
+	voxel::PagedVolume::ChunkPtr chunk(const glm::ivec3& chunkPos, uint8_t color) {
+		const voxel::PagedVolume::ChunkPtr& c = core::make_shared<voxel::PagedVolume::Chunk>(chunkPos, 16, &_pager);
+		c->setVoxel(1, 2, 3, voxel::createVoxel(voxel::VoxelType::Generic, color));
+		return c;
+	}
+
+	static voxel::Region chunkRegion(const glm::ivec3& chunkPos) {
+		return voxel::Region(chunkPos * 16, chunkPos * 16 + 15);
+	}
+public:
+	void SetUp() override {
+		app::AbstractTest::SetUp();
+		ASSERT_TRUE(voxel::initDefaultMaterialColors());
+		// the mock doesn't have a connection - every query fails and the chunks stay queued
+		_dbHandler = persistence::createDbHandlerMock();
+	}
+
+	void TearDown() override {
+		_dbHandler.reset();
+		app::AbstractTest::TearDown();
+	}
+};
+
+TEST_F(DBChunkPersisterTest, testCoalesceWrites) {
+	DBChunkPersister persister(_dbHandler, 1);
+	ASSERT_TRUE(persister.save(chunk(glm::ivec3(0), 1), 1u));
+	ASSERT_TRUE(persister.save(chunk(glm::ivec3(1, 0, 0), 1), 1u));
+	EXPECT_EQ(2, persister.pendingWrites());
+	ASSERT_TRUE(persister.save(chunk(glm::ivec3(0), 2), 1u));
+	EXPECT_EQ(2, persister.pendingWrites());
+	// another seed is another chunk
+	ASSERT_TRUE(persister.save(chunk(glm::ivec3(0), 3), 2u));
+	EXPECT_EQ(3, persister.pendingWrites());
+	EXPECT_FALSE(persister.flush());
+	EXPECT_EQ(3, persister.pendingWrites());
+}
+
+TEST_F(DBChunkPersisterTest, testLoadQueuedWrite) {
+	DBChunkPersister persister(_dbHandler, 1);
+	ASSERT_TRUE(persister.save(chunk(glm::ivec3(0), 1), 1u));
+	ASSERT_TRUE(persister.save(chunk(glm::ivec3(0), 2), 1u));
+	const voxel::PagedVolume::ChunkPtr& loaded = core::make_shared<voxel::PagedVolume::Chunk>(glm::ivec3(0), 16, &_pager);
+	ASSERT_TRUE(persister.load(loaded, 1u));
+	EXPECT_EQ(2, loaded->voxel(1, 2, 3).getColor());
+	EXPECT_FALSE(persister.load(loaded, 2u));
+}
+
+TEST_F(DBChunkPersisterTest, testErase) {
+	DBChunkPersister persister(_dbHandler, 1);
+	const glm::ivec3 chunkPos(-1, 0, 2);
+	ASSERT_TRUE(persister.save(chunk(chunkPos, 1), 1u));
+	persister.erase(chunkRegion(chunkPos), 1u);
+	// the delete is queued, too
+	EXPECT_EQ(1, persister.pendingWrites());
+	const voxel::PagedVolume::ChunkPtr& loaded = core::make_shared<voxel::PagedVolume::Chunk>(chunkPos, 16, &_pager);
+	EXPECT_FALSE(persister.load(loaded, 1u));
+}
+
+TEST_F(DBChunkPersisterTest, testPrefetchSkipsQueuedWrites) {
+	TestPersister persister(_dbHandler, 1);
+	const glm::ivec3 chunkPos(1, 2, 3);
+	const glm::ivec4& k = TestPersister::key(chunkPos, 1u);
+	const voxel::Region& region = voxel::Region(glm::ivec3(0), glm::ivec3(DBChunkPersister::PrefetchBlockSize - 1));
+	// the state the database had before the save was written
+	TestPersister::Chunks selected;
+	selected[k] = std::make_shared<const TestPersister::ChunkData>(TestPersister::ChunkData{1, 2, 3});
+
+	ASSERT_TRUE(persister.save(chunk(chunkPos, 2), 1u));
+	const TestPersister::Write write{k, TestPersister::ChunkDataPtr(), persister.generation(k)};
+	TestPersister::BlockWrites blockWrites;
+	persister.beginPrefetch(blockWrites);
+	persister.finishPrefetch(region, 1u, selected, blockWrites);
+	persister.writesFinished({write});
+	TestPersister::ChunkDataPtr data;
+	EXPECT_FALSE(persister.cached(k, data)) << "The outdated state of the prefetch is used";
+
+	// the write completes while the query is running
+	ASSERT_TRUE(persister.save(chunk(chunkPos, 3), 1u));
+	const TestPersister::Write write2{k, TestPersister::ChunkDataPtr(), persister.generation(k)};
+	TestPersister::BlockWrites blockWrites2;
+	persister.beginPrefetch(blockWrites2);
+	persister.writesFinished({write2});
+	persister.finishPrefetch(region, 1u, selected, blockWrites2);
+	EXPECT_FALSE(persister.cached(k, data)) << "The outdated state of the prefetch is used";
+
+	// no pending writes - the prefetched state is kept
+	TestPersister::BlockWrites blockWrites3;
+	persister.beginPrefetch(blockWrites3);
+	persister.finishPrefetch(region, 1u, selected, blockWrites3);
+	ASSERT_TRUE(persister.cached(k, data));
+	ASSERT_TRUE(data);
+	EXPECT_EQ(3u, data->size());
+}
+
+}
@@ -0,0 +1,94 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "backend/entity/EntityReplication.h"
+#include "shared/Quantize.h"
+
+namespace backend {
+
+class EntityReplicationTest: public app::AbstractTest {
+protected:
+	flatbuffers::FlatBufferBuilder _fbb;
+
+	const network::EntityUpdates* finish(EntityReplication& replication) {
+		const flatbuffers::Offset<network::EntityUpdates>& updates = replication.finish(_fbb);
+		if (updates.IsNull()) {
+			return nullptr;
+		}
+		_fbb.Finish(updates);
+		return flatbuffers::GetRoot<network::EntityUpdates>(_fbb.GetBufferPointer());
+	}
+
+	void SetUp() override {
+		app::AbstractTest::SetUp();
+		_fbb.Clear();
+	}
+};
+
+TEST_F(EntityReplicationTest, testUnchanged) {
+	EntityReplication replication;
+	replication.add(1, glm::vec3(1.0f, 2.0f, 3.0f), 0.5f, network::Animation::IDLE);
+	EXPECT_FALSE(replication.update(_fbb, 1, glm::vec3(1.0f, 2.0f, 3.0f), 0.5f, network::Animation::IDLE));
+	// below the quantization step
+	EXPECT_FALSE(replication.update(_fbb, 1, glm::vec3(1.01f, 2.0f, 3.0f), 0.50001f, network::Animation::IDLE));
+	EXPECT_EQ(nullptr, finish(replication));
+}
+
+TEST_F(EntityReplicationTest, testUnknownEntity) {
+	EntityReplication replication;
+	EXPECT_FALSE(replication.update(_fbb, 1, glm::vec3(1.0f), 0.0f, network::Animation::IDLE));
+	replication.add(1, glm::vec3(1.0f), 0.0f, network::Animation::IDLE);
+	replication.remove(1);
+	EXPECT_FALSE(replication.update(_fbb, 1, glm::vec3(2.0f), 0.0f, network::Animation::IDLE));
+	EXPECT_EQ(0, replication.size());
+}
+
+TEST_F(EntityReplicationTest, testChangedFieldsOnly) {
+	EntityReplication replication;
+	replication.add(1, glm::vec3(0.0f), 0.0f, network::Animation::IDLE);
+	replication.add(2, glm::vec3(0.0f), 0.0f, network::Animation::IDLE);
+	replication.add(3, glm::vec3(0.0f), 0.0f, network::Animation::IDLE);
+	EXPECT_TRUE(replication.update(_fbb, 1, glm::vec3(10.5f, 0.0f, -3.25f), 0.0f, network::Animation::IDLE));
+	EXPECT_TRUE(replication.update(_fbb, 2, glm::vec3(0.0f), 0.0f, network::Animation::RUN));
+	EXPECT_FALSE(replication.update(_fbb, 3, glm::vec3(0.0f), 0.0f, network::Animation::IDLE));
+	const network::EntityUpdates* updates = finish(replication);
+	ASSERT_NE(nullptr, updates);
+	ASSERT_EQ(2u, updates->entities()->size());
+
+	const network::EntityDelta* moved = updates->entities()->Get(0);
+	EXPECT_EQ(1, moved->id());
+	EXPECT_EQ(network::EntityDeltaField::Position, moved->fields());
+	const glm::vec3& pos = shared::dequantizePosition(glm::ivec3(moved->x(), moved->y(), moved->z()));
+	EXPECT_FLOAT_EQ(10.5f, pos.x);
+	EXPECT_FLOAT_EQ(0.0f, pos.y);
+	EXPECT_FLOAT_EQ(-3.25f, pos.z);
+
+	const network::EntityDelta* animated = updates->entities()->Get(1);
+	EXPECT_EQ(2, animated->id());
+	EXPECT_EQ(network::EntityDeltaField::Animation, animated->fields());
+	EXPECT_EQ(network::Animation::RUN, animated->animation());
+}
+
+TEST_F(EntityReplicationTest, testDeltaAgainstLastSent) {
+	EntityReplication replication;
+	replication.add(1, glm::vec3(0.0f), 0.0f, network::Animation::IDLE);
+	EXPECT_TRUE(replication.update(_fbb, 1, glm::vec3(0.0f), glm::half_pi<float>(), network::Animation::IDLE));
+	const network::EntityUpdates* updates = finish(replication);
+	ASSERT_NE(nullptr, updates);
+	const network::EntityDelta* delta = updates->entities()->Get(0);
+	EXPECT_EQ(network::EntityDeltaField::Rotation, delta->fields());
+	EXPECT_NEAR(glm::half_pi<float>(), shared::dequantizeOrientation(delta->rotation()), 0.001f);
+
+	_fbb.Clear();
+	EXPECT_FALSE(replication.update(_fbb, 1, glm::vec3(0.0f), glm::half_pi<float>(), network::Animation::IDLE));
+	EXPECT_EQ(nullptr, finish(replication));
+}
+
+TEST_F(EntityReplicationTest, testOrientationWrap) {
+	EXPECT_EQ(shared::quantizeOrientation(0.0f), shared::quantizeOrientation(glm::two_pi<float>()));
+	EXPECT_NEAR((int)shared::quantizeOrientation(-glm::half_pi<float>()), (int)shared::quantizeOrientation(glm::three_over_two_pi<float>()), 1);
+}
+
+}
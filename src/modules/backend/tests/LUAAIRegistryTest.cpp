@@ -97,7 +97,7 @@ protected:
 		EXPECT_EQ(2, ai.use_count()) << "We are holding more references than expected. One is here, one should be in the pending zone add queue. Nodename: " << nodeName;
 		ai->setPause(true);
 		zone.update(1l);
-		EXPECT_EQ(2, ai.use_count()) << "We are holding more references than expected. One is here, one should be in the zone ai collection. Nodename: " << nodeName;
+		EXPECT_EQ(3, ai.use_count()) << "We are holding more references than expected. One is here, one should be in the zone ai collection and one in the flat list for the parallel update. Nodename: " << nodeName;
 		ai->setPause(false);
 		for (int i = 0; i < n; ++i) {
 			const ai::TreeNodeStatus executionStatus = node->execute(ai, 1L);
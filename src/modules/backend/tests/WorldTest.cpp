@@ -17,6 +17,8 @@
 #include "voxelformat/VolumeCache.h"
 #include "persistence/tests/Mocks.h"
 #include "io/Filesystem.h"
+#include "core/GameConfig.h"
+#include "core/Var.h"
 
 namespace backend {
 
@@ -100,6 +102,31 @@ TEST_F(WorldTest, testUpdate) {
 	world.shutdown();
 }
 
+TEST_F(WorldTest, testParallelUpdate) {
+	core::Var::get(cfg::ServerWorldThreads, "0")->setVal(2);
+	core::Var::get(cfg::ServerMapTickBarrier, "true")->setVal(true);
+	create(world);
+	ASSERT_TRUE(world.init());
+	for (int i = 0; i < 10; ++i) {
+		world.update(10ul);
+	}
+	world.shutdown();
+	core::Var::get(cfg::ServerWorldThreads)->setVal(0);
+}
+
+TEST_F(WorldTest, testParallelUpdateWithoutBarrier) {
+	core::Var::get(cfg::ServerWorldThreads, "0")->setVal(2);
+	core::Var::get(cfg::ServerMapTickBarrier, "true")->setVal(false);
+	create(world);
+	ASSERT_TRUE(world.init());
+	for (int i = 0; i < 10; ++i) {
+		world.update(10ul);
+	}
+	world.shutdown();
+	core::Var::get(cfg::ServerWorldThreads)->setVal(0);
+	core::Var::get(cfg::ServerMapTickBarrier)->setVal(true);
+}
+
 #undef create
 
 }
@@ -5,7 +5,10 @@
 #include "TestShared.h"
 #include "backend/entity/ai/tree/PrioritySelector.h"
 #include "backend/entity/ai/zone/Zone.h"
+#include "backend/entity/ai/zone/AIScheduler.h"
 #include "backend/entity/ai/condition/True.h"
+#include <atomic>
+#include <vector>
 
 namespace backend {
 
@@ -52,4 +55,58 @@ TEST_F(ZoneTest, testAdd100) {
 	ASSERT_EQ(n, (int)zone.size());
 }
 
+TEST_F(ZoneTest, testAdd100Parallel) {
+	Zone zone("test1", 4);
+	TreeNodePtr root = std::make_shared<PrioritySelector>("test", "", True::get());
+	const int n = 100;
+	for (int i = 0; i < n; ++i) {
+		ICharacterPtr character = core::make_shared<TestEntity>(i);
+		AIPtr ai = std::make_shared<AI>(root);
+		ai->setCharacter(character);
+		ASSERT_TRUE(zone.addAI(ai)) << "Could not add ai to the zone";
+	}
+	zone.update(0l);
+	ASSERT_EQ(n, (int)zone.size());
+	std::atomic_int visited { 0 };
+	zone.executeParallel([&] (const AIPtr& ai) {
+		++visited;
+	});
+	EXPECT_EQ(n, visited);
+	ASSERT_TRUE(zone.removeAI(1)) << "Could not remove ai from zone";
+	zone.update(0l);
+	visited = 0;
+	zone.executeParallel([&] (const AIPtr& ai) {
+		++visited;
+	});
+	EXPECT_EQ(n - 1, visited);
+}
+
+TEST_F(ZoneTest, testSchedulerVisitsAll) {
+	AIScheduler scheduler(4, 3);
+	scheduler.init();
+	for (int n : {0, 1, 3, 4, 17, 1000}) {
+		std::vector<std::atomic_int> counts(n);
+		scheduler.parallelFor(n, [&] (int i) {
+			++counts[i];
+		});
+		for (int i = 0; i < n; ++i) {
+			ASSERT_EQ(1, counts[i]) << "index " << i << " of " << n << " was not visited exactly once";
+		}
+	}
+	scheduler.shutdown();
+}
+
+TEST_F(ZoneTest, testSchedulerNested) {
+	AIScheduler scheduler(4, 1);
+	scheduler.init();
+	std::atomic_int visited { 0 };
+	scheduler.parallelFor(8, [&] (int) {
+		scheduler.parallelFor(8, [&] (int) {
+			++visited;
+		});
+	});
+	EXPECT_EQ(64, visited);
+	scheduler.shutdown();
+}
+
 }
@@ -6,89 +6,416 @@
 #include "BackendModels.h"
 #include "voxel/PagedVolume.h"
 #include "voxel/Region.h"
+#include "core/Log.h"
+#include <glm/common.hpp>
 
 namespace backend {
 
 DBChunkPersister::DBChunkPersister(const persistence::DBHandlerPtr &dbHandler, MapId mapId) :
-		_dbHandler(dbHandler), _mapId(mapId) {
+		_dbHandler(dbHandler), _mapId(mapId), _writerThread(1, "ChunkWriter") {
+}
+
+DBChunkPersister::~DBChunkPersister() {
+	shutdown();
+}
+
+glm::ivec4 DBChunkPersister::key(const glm::ivec3& chunkPos, unsigned int seed) {
+	return glm::ivec4(chunkPos, (int)seed);
+}
+
+glm::ivec4 DBChunkPersister::blockKey(const glm::ivec3& chunkPos, unsigned int seed) {
+	const glm::ivec3 blockPos = glm::ivec3(glm::floor(glm::vec3(chunkPos) / (float)PrefetchBlockSize));
+	return glm::ivec4(blockPos, (int)seed);
 }
 
 bool DBChunkPersister::init() {
 	if (!_dbHandler->createTable(db::ChunkModel())) {
 		return false;
 	}
+	_stop = false;
+	{
+		core::ScopedLock lock(_lock);
+		_writerRunning = true;
+	}
+	_writerThread.init();
+	_writerThread.enqueue([this] () {
+		writerLoop();
+	});
 	return true;
 }
 
+void DBChunkPersister::shutdown() {
+	if (!_stop.exchange(true)) {
+		{
+			core::ScopedLock lock(_lock);
+			_writeCondition.notify_all();
+		}
+		_writerThread.shutdown(true);
+		{
+			core::ScopedLock lock(_lock);
+			_writerRunning = false;
+			_flushCondition.notify_all();
+		}
+		// the chunks that were queued while the writer thread was stopped
+		while (writeBatch() > 0) {
+		}
+		const int pending = pendingWrites();
+		if (pending > 0) {
+			Log::error("Failed to persist %i chunks of map %i", pending, _mapId);
+		}
+	}
+	core::ScopedLock lock(_lock);
+	_prefetched.clear();
+	_prefetchedBlocks.clear();
+}
+
+void DBChunkPersister::writerLoop() {
+	while (!_stop) {
+		{
+			core::ScopedLock lock(_lock);
+			if (_pendingWrites.empty() && !_stop) {
+				_writeCondition.waitTimeout(_lock, _flushIntervalMillis);
+			}
+		}
+		const int written = writeBatch();
+		if (written < 0) {
+			// the database is not available - don't spin but try again later, the chunks are still queued
+			core::ScopedLock lock(_lock);
+			++_writeFailures;
+			_flushCondition.notify_all();
+			if (!_stop) {
+				_writeCondition.waitTimeout(_lock, _flushIntervalMillis);
+			}
+		} else if (written > 0) {
+			core::ScopedLock lock(_lock);
+			_flushCondition.notify_all();
+		}
+	}
+}
+
+int DBChunkPersister::writeBatch() {
+	core_trace_scoped(DBChunkPersisterWriteBatch);
+	std::vector<Write> writes;
+	{
+		core::ScopedLock lock(_lock);
+		for (auto i = _pendingWrites.begin(); i != _pendingWrites.end() && (int)writes.size() < WriteBatchSize; ++i) {
+			writes.push_back(Write{i->first, i->second.data, i->second.generation});
+		}
+	}
+	if (writes.empty()) {
+		return 0;
+	}
+
+	std::vector<db::ChunkModel> inserts;
+	inserts.reserve(writes.size());
+	bool success = true;
+	for (const Write& write : writes) {
+		db::ChunkModel model;
+		model.setMapid(_mapId);
+		model.setX(write.key.x);
+		model.setY(write.key.y);
+		model.setZ(write.key.z);
+		model.setSeed(write.key.w);
+		if (!write.data) {
+			// erased - see erase()
+			success &= _dbHandler->deleteModel(model);
+			continue;
+		}
+		model.setData(persistence::Blob((uint8_t*)write.data->data(), write.data->size()));
+		inserts.push_back(model);
+	}
+	if (!inserts.empty()) {
+		success &= _dbHandler->insert(inserts);
+	}
+	if (!success) {
+		Log::warn("Failed to write %i chunks of map %i", (int)writes.size(), _mapId);
+		return -1;
+	}
+	Log::debug("Wrote %i chunks of map %i", (int)writes.size(), _mapId);
+	writesFinished(writes);
+	return (int)writes.size();
+}
+
+void DBChunkPersister::writesFinished(const std::vector<Write>& writes) {
+	core::ScopedLock lock(_lock);
+	for (const Write& write : writes) {
+		auto i = _pendingWrites.find(write.key);
+		// only remove the chunk if it wasn't saved again in the meantime
+		if (i != _pendingWrites.end() && i->second.generation == write.generation) {
+			_pendingWrites.erase(i);
+			// a running prefetch might have selected the old state - see finishPrefetch()
+			blockWritten(glm::ivec3(write.key), (unsigned int)write.key.w);
+		}
+	}
+}
+
+bool DBChunkPersister::flush() {
+	{
+		core::ScopedLock lock(_lock);
+		if (_writerRunning) {
+			// don't write concurrently to the writer thread - the batches could overwrite newer data with older
+			const uint32_t writeFailures = _writeFailures;
+			_writeCondition.notify_one();
+			_flushCondition.wait(_lock, [&] () {
+				return _pendingWrites.empty() || _writeFailures != writeFailures || !_writerRunning;
+			});
+			return _pendingWrites.empty();
+		}
+	}
+	while (pendingWrites() > 0) {
+		if (writeBatch() < 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int DBChunkPersister::pendingWrites() {
+	core::ScopedLock lock(_lock);
+	return (int)_pendingWrites.size();
+}
+
 void DBChunkPersister::erase(const voxel::Region& region, unsigned int seed) {
-	db::ChunkModel model;
-	model.setMapid(_mapId);
-	model.setX(region.getLowerX());
-	model.setY(region.getLowerY());
-	model.setZ(region.getLowerZ());
-	model.setSeed(seed);
-	_dbHandler->deleteModel(model);
+	// the region of a chunk is given - see WorldPager::erase()
+	const int sideLength = region.getWidthInVoxels();
+	const glm::ivec3 chunkPos = glm::ivec3(glm::floor(glm::vec3(region.getLowerCorner()) / (float)sideLength));
+	const glm::ivec4& k = key(chunkPos, seed);
+	core::ScopedLock lock(_lock);
+	PendingWrite& pending = _pendingWrites[k];
+	pending.data = ChunkDataPtr();
+	pending.generation = ++_generation;
+	blockWritten(chunkPos, seed);
+	_prefetched.erase(k);
+	_writeCondition.notify_one();
 }
 
 bool DBChunkPersister::truncate(unsigned int seed) {
+	{
+		core::ScopedLock lock(_lock);
+		for (auto i = _pendingWrites.begin(); i != _pendingWrites.end();) {
+			if (i->first.w == (int)seed) {
+				i = _pendingWrites.erase(i);
+			} else {
+				++i;
+			}
+		}
+		_prefetched.clear();
+		_prefetchedBlocks.clear();
+	}
 	db::ChunkModel model;
 	model.setMapid(_mapId);
 	model.setSeed(seed);
 	return _dbHandler->truncate(model);
 }
 
-persistence::Blob DBChunkPersister::load(int x, int y, int z, MapId mapId, unsigned int seed) const {
+bool DBChunkPersister::cached(const glm::ivec4& k, ChunkDataPtr& data) {
+	core::ScopedLock lock(_lock);
+	auto pending = _pendingWrites.find(k);
+	if (pending != _pendingWrites.end()) {
+		data = pending->second.data;
+		return true;
+	}
+	auto prefetched = _prefetched.find(k);
+	if (prefetched != _prefetched.end()) {
+		data = prefetched->second;
+		// the chunk is in the volume now - it's saved again before it's evicted
+		_prefetched.erase(prefetched);
+		return true;
+	}
+	return false;
+}
+
+void DBChunkPersister::blockWritten(const glm::ivec3& chunkPos, unsigned int seed) {
+	if (_runningPrefetches > 0) {
+		++_blockWrites[blockKey(chunkPos, seed)];
+	}
+}
+
+void DBChunkPersister::prefetchFinished() {
+	if (--_runningPrefetches == 0) {
+		// the write counters are only compared while a prefetch is running
+		_blockWrites.clear();
+	}
+}
+
+void DBChunkPersister::addPrefetchedBlock(const glm::ivec4& bk) {
+	for (auto i = _prefetchedBlocks.begin(); i != _prefetchedBlocks.end(); ++i) {
+		if (*i == bk) {
+			_prefetchedBlocks.erase(i);
+			break;
+		}
+	}
+	_prefetchedBlocks.push_back(bk);
+	while ((int)_prefetchedBlocks.size() > MaxPrefetchedBlocks) {
+		const glm::ivec4 evict = _prefetchedBlocks.front();
+		_prefetchedBlocks.pop_front();
+		const glm::ivec3 blockMins = glm::ivec3(evict) * PrefetchBlockSize;
+		for (int z = 0; z < PrefetchBlockSize; ++z) {
+			for (int y = 0; y < PrefetchBlockSize; ++y) {
+				for (int x = 0; x < PrefetchBlockSize; ++x) {
+					_prefetched.erase(key(blockMins + glm::ivec3(x, y, z), (unsigned int)evict.w));
+				}
+			}
+		}
+	}
+}
+
+DBChunkPersister::ChunkDataPtr DBChunkPersister::selectChunk(const glm::ivec3& chunkPos, unsigned int seed) const {
 	db::ChunkModel model;
-	model.setMapid(mapId);
-	model.setX(x);
-	model.setY(y);
-	model.setZ(z);
+	model.setMapid(_mapId);
+	model.setX(chunkPos.x);
+	model.setY(chunkPos.y);
+	model.setZ(chunkPos.z);
 	model.setSeed(seed);
 	if (!_dbHandler->select(model, persistence::DBConditionOne())) {
 		Log::warn("Failed to load the model");
 	}
-	return model.data();
+	persistence::Blob blob = model.data();
+	if (blob.length <= 0) {
+		blob.release();
+		return ChunkDataPtr();
+	}
+	ChunkDataPtr data = std::make_shared<const ChunkData>(blob.data, blob.data + blob.length);
+	blob.release();
+	return data;
+}
+
+void DBChunkPersister::beginPrefetch(BlockWrites& blockWrites) {
+	// remember the writes to the blocks to be able to detect saves that happen during the query
+	core::ScopedLock lock(_lock);
+	++_runningPrefetches;
+	for (auto i = _blockWrites.begin(); i != _blockWrites.end(); ++i) {
+		blockWrites.insert(*i);
+	}
+}
+
+void DBChunkPersister::finishPrefetch(const voxel::Region& chunkRegion, unsigned int seed, const Chunks& selected, const BlockWrites& blockWrites) {
+	const glm::ivec3& mins = chunkRegion.getLowerCorner();
+	const glm::ivec3& maxs = chunkRegion.getUpperCorner();
+	core::ScopedLock lock(_lock);
+	const glm::ivec3 blockMins(blockKey(mins, seed));
+	const glm::ivec3 blockMaxs(blockKey(maxs, seed));
+	for (int bz = blockMins.z; bz <= blockMaxs.z; ++bz) {
+		for (int by = blockMins.y; by <= blockMaxs.y; ++by) {
+			for (int bx = blockMins.x; bx <= blockMaxs.x; ++bx) {
+				const glm::ivec4 bk(bx, by, bz, (int)seed);
+				auto before = blockWrites.find(bk);
+				auto after = _blockWrites.find(bk);
+				const uint32_t writesBefore = before == blockWrites.end() ? 0u : before->second;
+				const uint32_t writesAfter = after == _blockWrites.end() ? 0u : after->second;
+				if (writesBefore != writesAfter) {
+					// a chunk of this block was saved or written while the query was running - the result might be outdated
+					continue;
+				}
+				const glm::ivec3 chunkMins = glm::max(mins, glm::ivec3(bx, by, bz) * PrefetchBlockSize);
+				const glm::ivec3 chunkMaxs = glm::min(maxs, glm::ivec3(bx, by, bz) * PrefetchBlockSize + PrefetchBlockSize - 1);
+				for (int z = chunkMins.z; z <= chunkMaxs.z; ++z) {
+					for (int y = chunkMins.y; y <= chunkMaxs.y; ++y) {
+						for (int x = chunkMins.x; x <= chunkMaxs.x; ++x) {
+							const glm::ivec4& k = key(glm::ivec3(x, y, z), seed);
+							if (_pendingWrites.find(k) != _pendingWrites.end()) {
+								// the queued state is newer than the selected one
+								continue;
+							}
+							auto i = selected.find(k);
+							_prefetched[k] = i == selected.end() ? ChunkDataPtr() : i->second;
+						}
+					}
+				}
+				addPrefetchedBlock(bk);
+			}
+		}
+	}
+	prefetchFinished();
+}
+
+int DBChunkPersister::prefetch(const voxel::Region& chunkRegion, unsigned int seed) {
+	core_trace_scoped(DBChunkPersisterPrefetch);
+	const glm::ivec3& mins = chunkRegion.getLowerCorner();
+	const glm::ivec3& maxs = chunkRegion.getUpperCorner();
+	BlockWrites blockWrites;
+	beginPrefetch(blockWrites);
+
+	const db::DBConditionChunkModelMapid mapIdCond(_mapId);
+	const db::DBConditionChunkModelSeed seedCond((int32_t)seed);
+	const db::DBConditionChunkModelX minX(mins.x, persistence::Comparator::BiggerOrEqual);
+	const db::DBConditionChunkModelX maxX(maxs.x, persistence::Comparator::LessOrEqual);
+	const db::DBConditionChunkModelY minY(mins.y, persistence::Comparator::BiggerOrEqual);
+	const db::DBConditionChunkModelY maxY(maxs.y, persistence::Comparator::LessOrEqual);
+	const db::DBConditionChunkModelZ minZ(mins.z, persistence::Comparator::BiggerOrEqual);
+	const db::DBConditionChunkModelZ maxZ(maxs.z, persistence::Comparator::LessOrEqual);
+	const persistence::DBConditionMultiple condition(true, {&mapIdCond, &seedCond, &minX, &maxX, &minY, &maxY, &minZ, &maxZ});
+	Chunks selected;
+	const bool success = _dbHandler->select(db::ChunkModel(), condition, [&] (db::ChunkModel&& model) {
+		persistence::Blob blob = model.data();
+		if (blob.length > 0) {
+			const glm::ivec3 chunkPos(model.x(), model.y(), model.z());
+			selected[key(chunkPos, seed)] = std::make_shared<const ChunkData>(blob.data, blob.data + blob.length);
+		}
+		blob.release();
+	});
+	if (!success) {
+		core::ScopedLock lock(_lock);
+		prefetchFinished();
+		return -1;
+	}
+	finishPrefetch(chunkRegion, seed, selected, blockWrites);
+	return (int)selected.size();
+}
+
+bool DBChunkPersister::loadData(const glm::ivec3& chunkPos, unsigned int seed, std::vector<uint8_t>& data) {
+	const glm::ivec4& k = key(chunkPos, seed);
+	ChunkDataPtr chunkData;
+	if (!cached(k, chunkData)) {
+		const glm::ivec3 blockMins = glm::ivec3(blockKey(chunkPos, seed)) * PrefetchBlockSize;
+		if (prefetch(voxel::Region(blockMins, blockMins + PrefetchBlockSize - 1), seed) < 0) {
+			return false;
+		}
+		if (!cached(k, chunkData)) {
+			// the block was modified during the prefetch
+			chunkData = selectChunk(chunkPos, seed);
+		}
+	}
+	if (!chunkData) {
+		return false;
+	}
+	data = *chunkData;
+	return true;
 }
 
 bool DBChunkPersister::load(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int seed) {
 	core_trace_scoped(DBChunkPersisterLoad);
-	const glm::ivec3& region = chunk->chunkPos();
-	persistence::Blob blob = load(region.x, region.y, region.z, _mapId, seed);
-	if (blob.length <= 0) {
+	static thread_local std::vector<uint8_t> data;
+	if (!loadData(chunk->chunkPos(), seed, data)) {
 		Log::debug("No chunk found in database");
-		blob.release();
 		return false;
 	}
-	if (!loadCompressed(chunk, blob.data, blob.length)) {
+	if (!loadCompressed(chunk, data.data(), data.size())) {
 		Log::warn("Failed to uncompress the model");
-		blob.release();
 		return false;
 	}
-	blob.release();
 	return true;
 }
 
-// TODO: this must be done async
 bool DBChunkPersister::save(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int seed) {
 	core_trace_scoped(DBChunkPersisterSave);
 	core::ByteStream out;
 	if (!saveCompressed(chunk, out)) {
 		return false;
 	}
-
-	persistence::Blob data;
-	data.data = (uint8_t*)out.getBuffer();
-	data.length = out.getSize();
-	Log::info("Store compressed chunk with size %i", (int)data.length);
-	db::ChunkModel model;
-	model.setMapid(_mapId);
+	const ChunkDataPtr& data = std::make_shared<const ChunkData>(out.getBuffer(), out.getBuffer() + out.getSize());
 	const glm::ivec3& chunkPos = chunk->chunkPos();
-	model.setX(chunkPos.x);
-	model.setY(chunkPos.y);
-	model.setZ(chunkPos.z);
-	model.setSeed(seed);
-	model.setData(data);
-	return _dbHandler->insert(model);
+	const glm::ivec4& k = key(chunkPos, seed);
+	core::ScopedLock lock(_lock);
+	// replaces the queued data if the chunk wasn't written yet
+	PendingWrite& pending = _pendingWrites[k];
+	pending.data = data;
+	pending.generation = ++_generation;
+	blockWritten(chunkPos, seed);
+	_prefetched.erase(k);
+	_writeCondition.notify_one();
+	Log::debug("Queued compressed chunk with size %i", (int)data->size());
+	return true;
 }
 
 }
@@ -9,21 +9,158 @@
 #include "persistence/Blob.h"
 #include "voxel/PagedVolume.h"
 #include "voxel/Region.h"
+#include "core/GLM.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ThreadPool.h"
+#include "core/Trace.h"
 #include "MapId.h"
+#include <glm/vec4.hpp>
+#include <unordered_map>
+#include <deque>
+#include <memory>
+#include <vector>
 
 namespace backend {
 
+/**
+ * @brief Persists the chunks of a map in the database.
+ *
+ * Saving a chunk only compresses it and queues the data - a writer thread stores the queued chunks in batches with
+ * multi-row inserts. A chunk that is saved again before it was written only replaces the queued data. Chunks
+ * are loaded from the queue until they were written - so a load always gets the latest saved state.
+ *
+ * Loading a chunk that is not in memory selects the whole block of @c PrefetchBlockSize^3 chunks around it with
+ * one query and keeps the neighbours for the loads that usually follow. Only the last @c MaxPrefetchedBlocks
+ * blocks are kept.
+ */
 class DBChunkPersister : public voxelworld::ChunkPersister {
+public:
+	/** the amount of chunks per side of the blocks that are selected with one query */
+	static constexpr int PrefetchBlockSize = 4;
+	/** the max amount of prefetched blocks that are kept until their chunks are loaded */
+	static constexpr int MaxPrefetchedBlocks = 64;
+	/** the max amount of chunks per insert statement */
+	static constexpr int WriteBatchSize = 64;
 protected:
+	typedef std::vector<uint8_t> ChunkData;
+	typedef std::shared_ptr<const ChunkData> ChunkDataPtr;
+	// chunk position and seed
+	typedef std::unordered_map<glm::ivec4, ChunkDataPtr, glm::hash<glm::ivec4>> Chunks;
+
+	struct PendingWrite {
+		ChunkDataPtr data;
+		// increased for each save of the chunk
+		uint32_t generation = 0u;
+	};
+	typedef std::unordered_map<glm::ivec4, PendingWrite, glm::hash<glm::ivec4>> PendingWrites;
+	// block position and seed - see blockWritten()
+	typedef std::unordered_map<glm::ivec4, uint32_t, glm::hash<glm::ivec4>> BlockWrites;
+
+	struct Write {
+		glm::ivec4 key;
+		ChunkDataPtr data;
+		uint32_t generation;
+	};
+
 	persistence::DBHandlerPtr _dbHandler;
 	const MapId _mapId;
+
+	PendingWrites _pendingWrites;
+	// the chunks of the prefetched blocks - a null pointer marks a chunk that is not in the database
+	Chunks _prefetched;
+	// block position and seed of the prefetched blocks - the least recently prefetched block is the first
+	std::deque<glm::ivec4> _prefetchedBlocks;
+	// increased for each save or completed write of a chunk in the block while a prefetch is running,
+	// see prefetch()
+	BlockWrites _blockWrites;
+	int _runningPrefetches = 0;
+	uint32_t _generation = 0u;
+	// increased for each failed batch of the writer thread
+	uint32_t _writeFailures = 0u;
+	bool _writerRunning = false;
+	core_trace_mutex(core::Lock, _lock, "DBChunkPersister");
+	core::ConditionVariable _writeCondition;
+	// signaled by the writer thread after each batch - see flush()
+	core::ConditionVariable _flushCondition;
+	core::AtomicBool _stop { false };
+	core::ThreadPool _writerThread;
+	uint32_t _flushIntervalMillis = 100u;
+
+	static glm::ivec4 key(const glm::ivec3& chunkPos, unsigned int seed);
+	static glm::ivec4 blockKey(const glm::ivec3& chunkPos, unsigned int seed);
+
+	/**
+	 * @brief The chunk data that is either queued for writing or was prefetched
+	 * @return @c false if the chunk is unknown, @c true with a null pointer if the chunk is known to not exist
+	 */
+	bool cached(const glm::ivec4& k, ChunkDataPtr& data);
+	/**
+	 * @brief Keeps the chunks of the given block and evicts the least recently prefetched blocks
+	 * @note The lock must be held
+	 */
+	void addPrefetchedBlock(const glm::ivec4& bk);
+	/**
+	 * @note The lock must be held
+	 */
+	void blockWritten(const glm::ivec3& chunkPos, unsigned int seed);
+	/**
+	 * @note The lock must be held
+	 */
+	void prefetchFinished();
+	/**
+	 * @brief Registers a running prefetch
+	 * @param[out] blockWrites The write counters of the blocks before the query is executed
+	 */
+	void beginPrefetch(BlockWrites& blockWrites);
+	/**
+	 * @brief Keeps the selected chunks of the blocks that weren't written to since @c beginPrefetch().
+	 * Chunks that are queued for writing are skipped - the database might not contain their latest state.
+	 */
+	void finishPrefetch(const voxel::Region& chunkRegion, unsigned int seed, const Chunks& selected, const BlockWrites& blockWrites);
+	/**
+	 * @brief Removes the written chunks from the queue - unless they were saved again in the meantime
+	 */
+	void writesFinished(const std::vector<Write>& writes);
+	ChunkDataPtr selectChunk(const glm::ivec3& chunkPos, unsigned int seed) const;
+	void writerLoop();
+	/**
+	 * @brief Writes up to @c WriteBatchSize queued chunks
+	 * @return The amount of written chunks or @c -1 on error
+	 */
+	int writeBatch();
 public:
 	DBChunkPersister(const persistence::DBHandlerPtr& dbHandler, MapId mapId);
-	virtual ~DBChunkPersister() {}
+	virtual ~DBChunkPersister();
 
 	bool init() override;
+	/**
+	 * @brief Writes all queued chunks
+	 */
+	void shutdown() override;
 
-	persistence::Blob load(int x, int y, int z, MapId mapId, unsigned int seed) const;
+	/**
+	 * @brief The compressed chunk data as it is stored in the database - queued writes included
+	 * @return @c false if the chunk wasn't persisted yet
+	 */
+	bool loadData(const glm::ivec3& chunkPos, unsigned int seed, std::vector<uint8_t>& data);
+	/**
+	 * @brief Selects all chunks of the given region (in chunk coordinates) with one query and keeps them for the
+	 * next loads
+	 * @return The amount of prefetched chunks or @c -1 on error
+	 */
+	int prefetch(const voxel::Region& chunkRegion, unsigned int seed);
+	/**
+	 * @brief Blocks until all chunks that are queued for writing are in the database
+	 * @note The chunks are written by the writer thread if it's running - this only waits for it
+	 * @return @c false if a write failed
+	 */
+	bool flush();
+	/**
+	 * @return The amount of chunks that are queued for writing
+	 */
+	int pendingWrites();
 	/**
 	 * @brief Removes all persisted chunks from the database for the given parameters
 	 */
@@ -9,7 +9,7 @@
 #include "core/EventBus.h"
 #include "app/App.h"
 #include "core/Trace.h"
-#include "math/QuadTree.h"
+#include "core/Common.h"
 #include "io/Filesystem.h"
 #include "backend/entity/Npc.h"
 #include "backend/entity/User.h"
@@ -22,14 +22,18 @@
 
 namespace backend {
 
-math::RectFloat Map::QuadTreeNode::getRect() const {
+math::RectFloat Map::GridNode::getRect() const {
 	return entity->rect();
 }
 
-bool Map::QuadTreeNode::operator==(const QuadTreeNode& rhs) const {
+bool Map::GridNode::operator==(const GridNode& rhs) const {
 	return rhs.entity == entity;
 }
 
+size_t Map::GridNodeHash::operator()(const GridNode& node) const {
+	return std::hash<Entity*>()(node.entity.get());
+}
+
 Map::Map(MapId mapId,
 		const core::EventBusPtr& eventBus,
 		const core::TimeProviderPtr& timeProvider,
@@ -46,7 +50,7 @@ Map::Map(MapId mapId,
 		_eventBus(eventBus), _filesystem(filesystem), _persistenceMgr(persistenceMgr),
 		_volumeCache(volumeCache), _attackMgr(this), _poiProvider(timeProvider), _spawnMgr(this, filesystem, entityStorage, messageSender,
 			timeProvider, loader, containerProvider, cooldownProvider),
-		_quadTree(math::RectFloat::getMaxRect(), 100.0f), _chunkPersister(chunkPersister) {
+		_grid(64.0f), _chunkPersister(chunkPersister) {
 }
 
 Map::~Map() {
@@ -62,40 +66,98 @@ bool Map::updateEntity(const EntityPtr& entity, long dt) {
 	if (!entity->update(dt)) {
 		return false;
 	}
+	_grid.update(GridNode { entity });
 	const math::RectFloat& rect = entity->viewRect();
-	// TODO: maybe move into the entity instance to reduce memory allocations.
-	math::QuadTree<QuadTreeNode, float>::Contents contents;
-	_quadTree.query(rect, contents);
-	EntitySet set;
-	set.reserve(contents.size());
-	for (const QuadTreeNode& node : contents) {
+	_visibleBuffer.clear();
+	_grid.visit(rect, [&] (const GridNode& node) {
 		// TODO: check the distance - the rect might contain more than the circle would...
-		if (node.entity->id() != entity->id()) {
-			set.insert(node.entity);
+		if (node.entity != entity) {
+			_visibleBuffer.push_back(node.entity);
 		}
+	});
+	entity->updateVisible(_visibleBuffer);
+	return true;
+}
+
+void Map::post(const Task& task) {
+	core::ScopedLock<core::Lock> lock(_tasksLock);
+	_tasks.push_back(task);
+}
+
+void Map::executeTasks() {
+	core_trace_scoped(MapExecuteTasks);
+	{
+		core::ScopedLock<core::Lock> lock(_tasksLock);
+		_executeTasks.swap(_tasks);
+	}
+	for (const Task& task : _executeTasks) {
+		task(*this);
 	}
-	entity->updateVisible(set);
+	_executeTasks.clear();
+}
+
+void Map::enqueueUser(const UserPtr& user) {
+	post([user] (Map& map) {
+		map.addUser(user);
+	});
+}
+
+void Map::enqueueNpc(const NpcPtr& npc) {
+	post([npc] (Map& map) {
+		map.addNpc(npc);
+	});
+}
+
+bool Map::transferUser(EntityId id, const MapPtr& target) {
+	const UserPtr& user = this->user(id);
+	if (!user || !removeUser(id)) {
+		return false;
+	}
+	target->enqueueUser(user);
+	return true;
+}
+
+bool Map::transferNpc(EntityId id, const MapPtr& target) {
+	const NpcPtr& npc = this->npc(id);
+	if (!npc || !removeNpc(id)) {
+		return false;
+	}
+	target->enqueueNpc(npc);
 	return true;
 }
 
 void Map::update(long dt) {
 	core_trace_scoped(MapUpdate);
 	Log::trace("tick map %i", (int)_mapId);
+	executeTasks();
 	_spawnMgr.update(dt);
 	_zone->update(dt);
 	_attackMgr.update(dt);
 
+	uint32_t replicationBytes = 0u;
+	uint32_t maxReplicationBytes = 0u;
 	for (auto i = _users.begin(); i != _users.end();) {
 		UserPtr user = i->second;
 		if (updateEntity(user, dt)) {
+			replicationBytes += user->replicationBytes();
+			maxReplicationBytes = core_max(maxReplicationBytes, user->replicationBytes());
+			// page in the terrain the user is running into before anything needs it
+			_voxelWorldMgr->prefetch(glm::ivec3(user->pos()), _voxelWorldMgr->volumeData()->chunkSideLength());
 			++i;
 			continue;
 		}
 		Log::debug("remove user " PRIEntId, user->id());
-		_quadTree.remove(QuadTreeNode { user });
+		_grid.remove(GridNode { user });
 		i = _users.erase(i);
 		_eventBus->enqueue(std::make_shared<EntityDeleteEvent>(user->id(), user->entityType()));
 	}
+	if (!_users.empty()) {
+		const metric::TagMap& tags {{"map", _mapIdStr}};
+		_eventBus->enqueue(std::make_shared<metric::MetricEvent>(metric::gauge("replication_bytes_per_user",
+				replicationBytes / (uint32_t)_users.size(), tags)));
+		_eventBus->enqueue(std::make_shared<metric::MetricEvent>(metric::gauge("replication_bytes_per_user_max",
+				maxReplicationBytes, tags)));
+	}
 	for (auto i = _npcs.begin(); i != _npcs.end();) {
 		NpcPtr npc = i->second;
 		if (updateEntity(npc, dt)) {
@@ -103,7 +165,7 @@ void Map::update(long dt) {
 			continue;
 		}
 		Log::debug("remove npc " PRIEntId, npc->id());
-		_quadTree.remove(QuadTreeNode { npc });
+		_grid.remove(GridNode { npc });
 		i = _npcs.erase(i);
 		_zone->removeAI(npc->id());
 		_eventBus->enqueue(std::make_shared<EntityDeleteEvent>(npc->id(), npc->entityType()));
@@ -136,7 +198,8 @@ bool Map::init() {
 	_pager->setNoiseOffset(glm::vec2(0.0f));
 
 	_voxelWorldMgr->setSeed(seed->uintVal());
-	_zone = new Zone(core::string::format("Zone %i", _mapId));
+	const int zoneThreads = core::Var::get(cfg::ServerZoneThreads, "1")->intVal();
+	_zone = new Zone(core::string::format("Zone %i", _mapId), zoneThreads);
 
 	if (!_spawnMgr.init()) {
 		Log::error("Failed to init the spawn manager");
@@ -157,9 +220,16 @@ void Map::shutdown() {
 		delete _voxelWorldMgr;
 		_voxelWorldMgr = nullptr;
 	}
+	// write the chunks that were saved while the volume was destroyed
+	_chunkPersister->shutdown();
 	delete _zone;
 	_zone = nullptr;
-	_quadTree.clear();
+	_grid.clear();
+	_visibleBuffer.clear();
+	{
+		core::ScopedLock<core::Lock> lock(_tasksLock);
+		_tasks.clear();
+	}
 	_npcs.clear();
 	_users.clear();
 	_persistenceMgr->unregisterSavable(FOURCC, this);
@@ -180,7 +250,7 @@ void Map::addUser(const UserPtr& user) {
 	}
 	const glm::vec3& pos = findStartPosition(user);
 	user->setMap(ptr(), pos);
-	_quadTree.insert(QuadTreeNode { user });
+	_grid.insert(GridNode { user });
 	_eventBus->enqueue(std::make_shared<EntityAddToMapEvent>(user));
 	_poiProvider.add(pos, poi::Type::SPAWN);
 }
@@ -191,7 +261,7 @@ bool Map::removeUser(EntityId id) {
 		return false;
 	}
 	UserPtr user = i->second;
-	_quadTree.remove(QuadTreeNode { user });
+	_grid.remove(GridNode { user });
 	_users.erase(i);
 	_eventBus->enqueue(std::make_shared<EntityRemoveFromMapEvent>(user));
 	return true;
@@ -214,7 +284,7 @@ bool Map::addNpc(const NpcPtr& npc) {
 	const glm::vec3& pos = findStartPosition(npc);
 	npc->setMap(ptr(), pos);
 	_zone->addAI(npc->ai());
-	_quadTree.insert(QuadTreeNode { npc });
+	_grid.insert(GridNode { npc });
 	_eventBus->enqueue(std::make_shared<EntityAddToMapEvent>(npc));
 	_poiProvider.add(pos, poi::Type::SPAWN);
 	return true;
@@ -226,7 +296,7 @@ bool Map::removeNpc(EntityId id) {
 		return false;
 	}
 	NpcPtr npc = i->second;
-	_quadTree.remove(QuadTreeNode { npc });
+	_grid.remove(GridNode { npc });
 	_npcs.erase(i);
 	_zone->removeAI(npc->id());
 	_eventBus->enqueue(std::make_shared<EntityRemoveFromMapEvent>(npc));
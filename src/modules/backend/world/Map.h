@@ -5,7 +5,7 @@
 #pragma once
 
 #include "backend/ForwardDecl.h"
-#include "math/QuadTree.h"
+#include "math/SpatialHashGrid.h"
 #include "math/Rect.h"
 #include "core/Common.h"
 #include "core/FourCC.h"
@@ -20,7 +20,12 @@
 #include "voxel/Constants.h"
 #include "DBChunkPersister.h"
 #include "MapId.h"
+#include "core/Trace.h"
+#include "core/concurrent/Lock.h"
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <vector>
 #include <unordered_map>
 #include <glm/fwd.hpp>
 #include <glm/vec3.hpp>
@@ -29,6 +34,9 @@ namespace backend {
 
 /**
  * @brief A map contains the Entity instances. This is where the players are moving and npcs are living.
+ *
+ * The maps might get ticked in parallel (see @c World). Everything that modifies a map from the outside
+ * must be handed over with @c post() - e.g. users that connect or change the map.
  */
 class Map : public std::enable_shared_from_this<Map>, public core::IComponent, public persistence::ISavable {
 private:
@@ -57,14 +65,29 @@ private:
 	poi::PoiProvider _poiProvider;
 	SpawnMgr _spawnMgr;
 
-	struct QuadTreeNode {
+	struct GridNode {
 		EntityPtr entity;
 
 		math::RectFloat getRect() const;
-		bool operator==(const QuadTreeNode& rhs) const;
+		bool operator==(const GridNode& rhs) const;
 	};
+	struct GridNodeHash {
+		size_t operator()(const GridNode& node) const;
+	};
+
+	typedef std::function<void(Map&)> Task;
+	core_trace_mutex(core::Lock, _tasksLock, "MapTasks");
+	std::vector<Task> _tasks;
+	// only touched by the thread that ticks the map - swapped with _tasks
+	std::vector<Task> _executeTasks;
+	// read by the world loop while the map might tick
+	std::atomic_long _tickInterval { 0l };
 
-	math::QuadTree<QuadTreeNode, float> _quadTree;
+	void executeTasks();
+
+	math::SpatialHashGrid<GridNode, float, GridNodeHash> _grid;
+	// reused for the visibility queries to reduce memory allocations
+	EntityList _visibleBuffer;
 	DBChunkPersisterPtr _chunkPersister;
 	/**
 	 * @return @c false if the entity should be removed from the server.
@@ -88,8 +111,48 @@ public:
 			const DBChunkPersisterPtr& chunkPersister);
 	~Map();
 
+	/**
+	 * @param[in] dt The millis since the last tick of this map - see @c tickInterval()
+	 */
 	void update(long dt);
 
+	/**
+	 * @brief Executes the given task in the thread that ticks this map - right before the next tick.
+	 * @note This is thread safe
+	 */
+	void post(const Task& task);
+
+	/**
+	 * @brief Adds the user to this map in the next tick.
+	 * @note This is thread safe
+	 * @sa addUser()
+	 */
+	void enqueueUser(const UserPtr& user);
+	/**
+	 * @brief Adds the npc to this map in the next tick.
+	 * @note This is thread safe
+	 * @sa addNpc()
+	 */
+	void enqueueNpc(const NpcPtr& npc);
+
+	/**
+	 * @brief Removes the user from this map and hands it over to the target map
+	 * @note Must be called from the thread that ticks this map
+	 */
+	bool transferUser(EntityId id, const MapPtr& target);
+	/**
+	 * @brief Removes the npc from this map and hands it over to the target map
+	 * @note Must be called from the thread that ticks this map
+	 */
+	bool transferNpc(EntityId id, const MapPtr& target);
+
+	/**
+	 * @brief The minimum amount of millis between two ticks of this map. @c 0 means that the map is
+	 * ticked with every world tick.
+	 */
+	long tickInterval() const;
+	void setTickInterval(long millis);
+
 	bool init() override;
 	void shutdown() override;
 
@@ -146,6 +209,14 @@ public:
 	poi::PoiProvider& poiProvider();
 };
 
+inline long Map::tickInterval() const {
+	return _tickInterval;
+}
+
+inline void Map::setTickInterval(long millis) {
+	_tickInterval = millis;
+}
+
 inline const DBChunkPersisterPtr& Map::chunkPersister() {
 	return _chunkPersister;
 }
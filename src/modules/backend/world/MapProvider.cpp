@@ -91,23 +91,21 @@ bool MapProvider::init() {
 		voxel::PagedVolume* volume = worldMgr->volumeData();
 		const glm::ivec3& chunkPos = volume->chunkPos(x, y, z);
 		const core::VarPtr& seed = core::Var::getSafe(cfg::ServerSeed);
-		persistence::Blob blob = persister->load(chunkPos.x, chunkPos.y, chunkPos.z, mapid, seed->uintVal());
-		if (blob.length <= 0) {
+		std::vector<uint8_t> data;
+		if (!persister->loadData(chunkPos, seed->uintVal(), data)) {
 			(void)volume->voxel(x, y, z);
-			blob = persister->load(chunkPos.x, chunkPos.y, chunkPos.z, mapid, seed->uintVal());
-			if (blob.length <= 0) {
+			if (!persister->loadData(chunkPos, seed->uintVal(), data)) {
 				response->status = http::HttpStatus::NotFound;
 				response->setText(core::string::format("Chunk not found at %i:%i:%i on map %i with seed %u",
 						chunkPos.x, chunkPos.y, chunkPos.z, mapid, seed->uintVal()));
 				return;
 			}
 		}
-		response->body = (char*)core_malloc(blob.length);
-		core_memcpy((void*)response->body, blob.data, blob.length);
+		response->body = (char*)core_malloc(data.size());
+		core_memcpy((void*)response->body, data.data(), data.size());
 		response->freeBody = true;
-		response->contentLength(blob.length);
+		response->contentLength(data.size());
 		response->headers.put(http::header::CONTENT_TYPE, http::mimetype::APPLICATION_CHUNK);
-		blob.release();
 	});
 
 	const MapId mapId = 1;
@@ -14,6 +14,10 @@
 #include "core/StringUtil.h"
 #include "core/Common.h"
 #include "core/Trace.h"
+#include "core/GameConfig.h"
+#include "core/TimeProvider.h"
+#include "core/Var.h"
+#include <chrono>
 #include "LUAFunctions.h"
 #include "attrib/ContainerProvider.h"
 
@@ -30,16 +34,86 @@ World::~World() {
 	core_assert_msg(_maps.empty(), "World was not properly shut down");
 }
 
+void World::tick(MapTicker& ticker, long dt) {
+	const uint64_t start = core::TimeProvider::systemMillis();
+	ticker.map->update(dt);
+	ticker.tickDurationMillis = core::TimeProvider::systemMillis() - start;
+}
+
+void World::finishTick(MapTicker& ticker) {
+	if (ticker.future.valid()) {
+		ticker.future.get();
+	}
+	const metric::TagMap& tags {{"map", ticker.map->idStr()}};
+	_metric->timing("map_tick", (uint32_t)ticker.tickDurationMillis, tags);
+}
+
 void World::update(long dt) {
 	core_trace_scoped(WorldUpdate);
-	for (const auto& e : _maps) {
-		const MapPtr& map = e->value;
-		map->update(dt);
+	for (MapTicker& ticker : _tickers) {
+		ticker.pendingMillis += dt;
+		if (ticker.future.valid()) {
+			if (ticker.future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+				// the map is still busy with its last tick - it will get the accumulated delta with the next one
+				_metric->increment("map_tick_skipped", {{"map", ticker.map->idStr()}});
+				continue;
+			}
+			finishTick(ticker);
+		}
+		if (ticker.pendingMillis < ticker.map->tickInterval()) {
+			continue;
+		}
+		const long mapDt = ticker.pendingMillis;
+		ticker.pendingMillis = 0l;
+		if (_threadPool == nullptr) {
+			tick(ticker, mapDt);
+			finishTick(ticker);
+			continue;
+		}
+		MapTicker* t = &ticker;
+		ticker.future = _threadPool->enqueue([this, t, mapDt] () {
+			tick(*t, mapDt);
+		});
+	}
+	if (_threadPool != nullptr && _mapTickBarrier->boolVal()) {
+		core_trace_scoped(WorldUpdateBarrier);
+		for (MapTicker& ticker : _tickers) {
+			if (ticker.future.valid()) {
+				finishTick(ticker);
+			}
+		}
+	}
+	updateAIServer(dt);
+}
+
+void World::updateAIServer(long dt) {
+	// the debugged zone is modified by the server - it must not tick in the meantime
+	const Zone* zone = _aiServer->zone();
+	if (zone != nullptr) {
+		for (MapTicker& ticker : _tickers) {
+			if (ticker.future.valid() && ticker.map->zone() == zone) {
+				finishTick(ticker);
+			}
+		}
 	}
 	_aiServer->update(dt);
 }
 
 void World::construct() {
+	command::Command::registerCommand("sv_maptickinterval", [this] (const command::CmdArgs& args) {
+		if (args.size() != 2) {
+			Log::info("Usage: sv_maptickinterval <mapid> <millis>");
+			return;
+		}
+		const MapId id = core::string::toInt(args[0]);
+		const MapPtr& map = this->map(id);
+		if (!map) {
+			Log::info("Could not find the specified map");
+			return;
+		}
+		map->setTickInterval(core::string::toInt(args[1]));
+	}).setHelp("Set the minimum millis between two ticks of the specified map");
+
 	command::Command::registerCommand("sv_maplist", [this] (const command::CmdArgs& args) {
 		for (const auto& e : _maps) {
 			const MapPtr& map = e->value;
@@ -69,7 +143,9 @@ void World::construct() {
 			return;
 		}
 		const int amount = args.size() == 3 ? core::string::toInt(args[2]) : 1;
-		map->spawnMgr().spawn((network::EntityType)type, amount);
+		map->post([type, amount] (Map& m) {
+			m.spawnMgr().spawn((network::EntityType)type, amount);
+		});
 	}).setHelp("Spawns a given amount of npcs of a particular type on the specified map");
 
 	command::Command::registerCommand("sv_chunkstruncate", [this] (const command::CmdArgs& args) {
@@ -115,10 +191,35 @@ bool World::init() {
 		_aiServer->addZone(map->zone());
 	}
 
+	_tickers.resize(_maps.size());
+	int tickerIndex = 0;
+	for (const auto& e : _maps) {
+		_tickers[tickerIndex++].map = e->value;
+	}
+
+	_mapTickBarrier = core::Var::get(cfg::ServerMapTickBarrier, "true");
+	const int threads = core::Var::get(cfg::ServerWorldThreads, "0")->intVal();
+	if (threads > 0) {
+		Log::info("Tick the maps in %i threads", threads);
+		_threadPool = new core::ThreadPool(threads, "World");
+		_threadPool->init();
+	}
+
 	return true;
 }
 
 void World::shutdown() {
+	for (MapTicker& ticker : _tickers) {
+		if (ticker.future.valid()) {
+			ticker.future.wait();
+		}
+	}
+	_tickers.clear();
+	if (_threadPool != nullptr) {
+		_threadPool->shutdown(true);
+		delete _threadPool;
+		_threadPool = nullptr;
+	}
 	for (const auto& e : _maps) {
 		const MapPtr& map = e->value;
 		_aiServer->removeZone(map->zone());
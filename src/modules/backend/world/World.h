@@ -8,11 +8,21 @@
 #include "core/IComponent.h"
 #include "backend/ForwardDecl.h"
 #include "backend/entity/ai/server/Server.h"
+#include "core/concurrent/ThreadPool.h"
+#include <future>
+#include <vector>
 
 namespace backend {
 
 /**
  * @brief The world is the whole universe of all @c Map instances.
+ *
+ * The maps are ticked in parallel in a thread pool if @c cfg::ServerWorldThreads is bigger than @c 0.
+ * With @c cfg::ServerMapTickBarrier the world tick waits for all maps - otherwise a map that is still
+ * busy with its last tick is skipped and gets the accumulated delta with its next tick. Every map can
+ * also define its own tick rate with @c Map::setTickInterval().
+ *
+ * @note Maps must not touch each other directly while they are ticked - see @c Map::post()
  */
 class World : public core::IComponent {
 private:
@@ -23,6 +33,22 @@ private:
 	metric::MetricPtr _metric;
 	Server* _aiServer = nullptr;
 	core::Map<MapId, MapPtr> _maps;
+
+	struct MapTicker {
+		MapPtr map;
+		std::future<void> future;
+		// the millis that passed since the last tick of the map
+		long pendingMillis = 0l;
+		// written by the thread that ticks the map
+		uint64_t tickDurationMillis = 0u;
+	};
+	std::vector<MapTicker> _tickers;
+	core::ThreadPool* _threadPool = nullptr;
+	core::VarPtr _mapTickBarrier;
+
+	void tick(MapTicker& ticker, long dt);
+	void finishTick(MapTicker& ticker);
+	void updateAIServer(long dt);
 public:
 	World(const MapProviderPtr& mapProvider, const AIRegistryPtr& registry,
 			const core::EventBusPtr& eventBus, const io::FilesystemPtr& filesystem,
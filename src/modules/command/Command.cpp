@@ -195,8 +195,8 @@ bool Command::execute(const core::String& command, const CmdArgs& args) {
 			Log::debug("could not find command callback for %s", command.c_str());
 			return false;
 		}
-		if (!isSuitableBindingContext(i->second._bindingContext)) {
-			Log::trace("command '%s' has binding context  %i - but we are in %i", command.c_str(), (int) i->second._bindingContext,
+		if (!isSuitableBindingContext(i->value._bindingContext)) {
+			Log::trace("command '%s' has binding context  %i - but we are in %i", command.c_str(), (int) i->value._bindingContext,
 					(int) core::bindingContext());
 			return false;
 		}
@@ -210,7 +210,7 @@ bool Command::execute(const core::String& command, const CmdArgs& args) {
 			_delayedTokens.push_back(fullCmd);
 			return true;
 		}
-		cmd = i->second;
+		cmd = i->value;
 	}
 	Log::debug("execute %s with %i arguments", command.c_str(), (int)args.size());
 	cmd._func(args);
@@ -53,6 +53,12 @@ constexpr const char *ServerPort = "sv_port";
 constexpr const char *ServerMaxClients = "sv_maxclients";
 constexpr const char *ServerPostgresLib = "sv_postgreslib";
 constexpr const char *ServerHttpPort = "sv_httpport";
+// the amount of threads the maps are ticked in - 0 means that they are ticked in the main loop
+constexpr const char *ServerWorldThreads = "sv_worldthreads";
+// wait for all maps to finish their tick in each world tick - otherwise every map runs at its own pace
+constexpr const char *ServerMapTickBarrier = "sv_maptickbarrier";
+// the amount of threads that tick the npcs of one map - including the thread that ticks the map
+constexpr const char *ServerZoneThreads = "sv_zonethreads";
 // the download urls for the chunks
 constexpr const char *ServerChunkBaseUrl = "sv_httpchunkurl";
 
@@ -65,6 +71,8 @@ constexpr const char *CorePath = "core_path";
 
 // The size of the chunk that is extracted with each step
 constexpr const char *VoxelMeshSize = "voxel_meshsize";
+// Extract the world meshes with the binary greedy mesher instead of the cubic surface extractor
+constexpr const char *VoxelMeshBinaryGreedy = "voxel_meshbinarygreedy";
 
 constexpr const char *DatabaseName = "db_name";
 constexpr const char *DatabaseHost = "db_host";
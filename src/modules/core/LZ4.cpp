@@ -0,0 +1,202 @@
+/**
+ * @file
+ */
+
+#include "LZ4.h"
+#include "Log.h"
+#include "Assert.h"
+#include <string.h>
+
+namespace core {
+namespace lz4 {
+
+// see https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+static constexpr size_t MinMatch = 4u;
+// the last five bytes are always literals
+static constexpr size_t LastLiterals = 5u;
+// the last match must start at least twelve bytes before the end of the block
+static constexpr size_t MatchFindLimit = 12u;
+static constexpr size_t MaxDistance = 65535u;
+static constexpr int HashLog = 12;
+
+static inline uint32_t read32(const uint8_t *p) {
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint64_t read64(const uint8_t *p) {
+	uint64_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint32_t hash(uint32_t sequence) {
+	return (sequence * 2654435761u) >> (32 - HashLog);
+}
+
+static inline uint8_t* writeLength(uint8_t *op, size_t len) {
+	while (len >= 255u) {
+		*op++ = 255u;
+		len -= 255u;
+	}
+	*op++ = (uint8_t)len;
+	return op;
+}
+
+static inline uint8_t* writeSequence(uint8_t *op, const uint8_t *literals, size_t literalsLen, size_t offset, size_t matchLen) {
+	uint8_t *token = op++;
+	const size_t literalsToken = literalsLen >= 15u ? 15u : literalsLen;
+	const size_t matchToken = matchLen >= 15u ? 15u : matchLen;
+	*token = (uint8_t)((literalsToken << 4) | matchToken);
+	if (literalsLen >= 15u) {
+		op = writeLength(op, literalsLen - 15u);
+	}
+	memcpy(op, literals, literalsLen);
+	op += literalsLen;
+	if (offset == 0u) {
+		// the last sequence only consists of literals
+		return op;
+	}
+	*op++ = (uint8_t)(offset & 0xFF);
+	*op++ = (uint8_t)(offset >> 8);
+	if (matchLen >= 15u) {
+		op = writeLength(op, matchLen - 15u);
+	}
+	return op;
+}
+
+uint32_t compressBound(uint32_t in) {
+	return in + in / 255u + 16u;
+}
+
+bool compress(const uint8_t *inputBuf, size_t inputBufSize,
+		uint8_t* outputBuf, size_t outputBufSize, size_t* finalBufSize) {
+	if (outputBufSize < compressBound((uint32_t)inputBufSize)) {
+		Log::error("Output buffer of size %i is too small to compress %i bytes", (int)outputBufSize, (int)inputBufSize);
+		return false;
+	}
+	const uint8_t *ip = inputBuf;
+	const uint8_t *anchor = inputBuf;
+	const uint8_t *end = inputBuf + inputBufSize;
+	uint8_t *op = outputBuf;
+
+	if (inputBufSize >= MatchFindLimit + 1u) {
+		// positions relative to the input buffer - a wrong candidate is rejected by comparing the bytes
+		uint32_t table[1 << HashLog];
+		memset(table, 0, sizeof(table));
+		const uint8_t *matchLimit = end - LastLiterals;
+		const uint8_t *matchFindLimit = end - MatchFindLimit;
+		++ip;
+		while (ip < matchFindLimit) {
+			const uint32_t sequence = read32(ip);
+			const uint32_t h = hash(sequence);
+			const uint8_t *ref = inputBuf + table[h];
+			table[h] = (uint32_t)(ip - inputBuf);
+			if ((size_t)(ip - ref) > MaxDistance || read32(ref) != sequence) {
+				++ip;
+				continue;
+			}
+			while (ip > anchor && ref > inputBuf && ip[-1] == ref[-1]) {
+				--ip;
+				--ref;
+			}
+			const uint8_t *mp = ip + MinMatch;
+			const uint8_t *rp = ref + MinMatch;
+			while (mp + sizeof(uint64_t) <= matchLimit && read64(mp) == read64(rp)) {
+				mp += sizeof(uint64_t);
+				rp += sizeof(uint64_t);
+			}
+			while (mp < matchLimit && *mp == *rp) {
+				++mp;
+				++rp;
+			}
+			op = writeSequence(op, anchor, (size_t)(ip - anchor), (size_t)(ip - ref), (size_t)(mp - ip) - MinMatch);
+			ip = mp;
+			anchor = ip;
+			if (ip < matchFindLimit) {
+				// make the bytes inside of the match available for the following matches
+				table[hash(read32(ip - 2))] = (uint32_t)(ip - 2 - inputBuf);
+			}
+		}
+	}
+
+	op = writeSequence(op, anchor, (size_t)(end - anchor), 0u, 0u);
+	if (finalBufSize != nullptr) {
+		*finalBufSize = (size_t)(op - outputBuf);
+	}
+	return true;
+}
+
+static inline bool readLength(const uint8_t *&ip, const uint8_t *end, size_t &len) {
+	uint8_t b;
+	do {
+		if (ip >= end) {
+			return false;
+		}
+		b = *ip++;
+		len += b;
+	} while (b == 255u);
+	return true;
+}
+
+bool uncompress(const uint8_t *inputBuf, size_t inputBufSize,
+		uint8_t* outputBuf, size_t outputBufSize, size_t* finalBufSize) {
+	const uint8_t *ip = inputBuf;
+	const uint8_t *end = inputBuf + inputBufSize;
+	uint8_t *op = outputBuf;
+	uint8_t *outEnd = outputBuf + outputBufSize;
+
+	while (ip < end) {
+		const uint8_t token = *ip++;
+		size_t literalsLen = token >> 4;
+		if (literalsLen == 15u && !readLength(ip, end, literalsLen)) {
+			break;
+		}
+		if (literalsLen > (size_t)(end - ip) || literalsLen > (size_t)(outEnd - op)) {
+			break;
+		}
+		memcpy(op, ip, literalsLen);
+		op += literalsLen;
+		ip += literalsLen;
+		if (ip == end) {
+			// the last sequence doesn't have a match
+			if (finalBufSize != nullptr) {
+				*finalBufSize = (size_t)(op - outputBuf);
+			}
+			return true;
+		}
+		if (end - ip < 2) {
+			break;
+		}
+		const size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+		ip += 2;
+		if (offset == 0u || offset > (size_t)(op - outputBuf)) {
+			break;
+		}
+		size_t matchLen = token & 15u;
+		if (matchLen == 15u && !readLength(ip, end, matchLen)) {
+			break;
+		}
+		matchLen += MinMatch;
+		if (matchLen > (size_t)(outEnd - op)) {
+			break;
+		}
+		// the match might overlap with the output - e.g. for runs of the same bytes. Copy the already
+		// repeated pattern in non overlapping pieces - the size of these pieces doubles with each copy.
+		const uint8_t *match = op - offset;
+		while (matchLen > 0u) {
+			const size_t available = (size_t)(op - match);
+			const size_t n = matchLen < available ? matchLen : available;
+			memcpy(op, match, n);
+			op += n;
+			matchLen -= n;
+		}
+	}
+	Log::error("Failed to uncompress input buffer of size %i into output buffer of size %i - the input data was corrupted",
+			(int)inputBufSize, (int)outputBufSize);
+	return false;
+}
+
+}
+}
@@ -0,0 +1,35 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace core {
+/**
+ * @brief Fast compression with the LZ4 block format.
+ *
+ * The compression ratio is worse than the one of @c core::zip - but compression and decompression are
+ * several times faster. The produced blocks are compatible with the LZ4 block format.
+ */
+namespace lz4 {
+
+/**
+ * @return The size of the output buffer that is needed to compress @c in bytes in the worst case
+ */
+extern uint32_t compressBound(uint32_t in);
+/**
+ * @param[in] outputBufSize Must be at least @c compressBound(inputBufSize)
+ */
+extern bool compress(const uint8_t *inputBuf, size_t inputBufSize,
+		uint8_t* outputBuf, size_t outputBufSize, size_t* finalBufSize = nullptr);
+/**
+ * @note Corrupted input data is detected - the output buffer is never written out of bounds.
+ */
+extern bool uncompress(const uint8_t *inputBuf, size_t inputBufSize,
+		uint8_t* outputBuf, size_t outputBufSize, size_t* finalBufSize = nullptr);
+
+}
+}
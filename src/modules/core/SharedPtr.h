@@ -47,6 +47,13 @@ private:
 		return _refCnt->decrement(1) - 1;
 	}
 public:
+	/**
+	 * @return The amount of SharedPtr instances that share the ownership of the managed object
+	 */
+	inline int use_count() const {
+		return count();
+	}
+
 	constexpr SharedPtr() : _ptr(nullptr), _refCnt(nullptr) {
 	}
 
@@ -12,16 +12,23 @@
 
 namespace core {
 
-size_t StringHash::operator()(const core::String &p) const {
+static inline size_t hashString(const char *p, size_t s) {
 	size_t result = 0;
 	const size_t prime = 31;
-	const size_t s = p.size();
 	for (size_t i = 0; i < s; ++i) {
 		result = SDL_tolower(p[i]) + (result * prime);
 	}
 	return result;
 }
 
+size_t StringHash::operator()(const core::String &p) const {
+	return hashString(p.c_str(), p.size());
+}
+
+size_t StringHash::operator()(const char *p) const {
+	return hashString(p, SDL_strlen(p));
+}
+
 static inline constexpr size_t align(size_t val, size_t size) {
 	const size_t len = size - 1u;
 	return (size_t)((val + len) & ~len);
@@ -171,8 +171,12 @@ String operator+(const String &x, const char *y);
 bool operator==(const char *x, const String &y);
 bool operator!=(const char *x, const String &y);
 
+/**
+ * @brief Case insensitive hash - the @c const @c char* overload allows lookups without creating a @c String
+ */
 struct StringHash {
 	size_t operator()(const core::String &p) const;
+	size_t operator()(const char *p) const;
 };
 
 }
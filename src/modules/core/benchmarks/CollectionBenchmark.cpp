@@ -1,5 +1,7 @@
 #include "app/benchmark/AbstractBenchmark.h"
 #include "core/collection/Map.h"
+#include "core/collection/HashMap.h"
+#include "core/collection/StringMap.h"
 #include "core/Assert.h"
 #include <unordered_map>
 #include <map>
@@ -53,8 +55,132 @@ BENCHMARK_DEFINE_F(MapBenchmark, compareToMapCore) (benchmark::State& state) {
 	}
 }
 
+BENCHMARK_DEFINE_F(MapBenchmark, compareToHashMapCore) (benchmark::State& state) {
+	core::HashMap<int64_t, int64_t, std::hash<int64_t>> map;
+	for (auto _ : state) {
+		const int64_t n = state.range(0);
+		for (int64_t i = 0; i < n; ++i) {
+			map.put(i, i);
+			int64_t value;
+			const bool found = map.get(i, value);
+			if (!found || value != i) {
+				state.SkipWithError("Failed!");
+				break;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Large maps - the @c core::Map can't take that many entries
+ *
+ * - Insert: fill an empty map with n entries
+ * - Lookup: n lookups into a map with n entries - the second argument is the percentage of the lookups that hit
+ */
+class LargeMapBenchmark: public app::AbstractBenchmark {
+public:
+	static inline int64_t lookupKey(int64_t i, int64_t n, int64_t hitPercent) {
+		// the misses are keys above the inserted range
+		return (i % 100) < hitPercent ? i : n + i;
+	}
+};
+
+BENCHMARK_DEFINE_F(LargeMapBenchmark, InsertUnorderedMapStd) (benchmark::State& state) {
+	const int64_t n = state.range(0);
+	for (auto _ : state) {
+		std::unordered_map<int64_t, int64_t> map;
+		for (int64_t i = 0; i < n; ++i) {
+			map.emplace(i, i);
+		}
+		benchmark::DoNotOptimize(map.size());
+	}
+	state.SetItemsProcessed(state.iterations() * n);
+}
+
+BENCHMARK_DEFINE_F(LargeMapBenchmark, InsertHashMapCore) (benchmark::State& state) {
+	const int64_t n = state.range(0);
+	for (auto _ : state) {
+		core::HashMap<int64_t, int64_t> map;
+		for (int64_t i = 0; i < n; ++i) {
+			map.put(i, i);
+		}
+		benchmark::DoNotOptimize(map.size());
+	}
+	state.SetItemsProcessed(state.iterations() * n);
+}
+
+BENCHMARK_DEFINE_F(LargeMapBenchmark, LookupUnorderedMapStd) (benchmark::State& state) {
+	const int64_t n = state.range(0);
+	const int64_t hitPercent = state.range(1);
+	std::unordered_map<int64_t, int64_t> map;
+	for (int64_t i = 0; i < n; ++i) {
+		map.emplace(i, i);
+	}
+	int64_t hits = 0;
+	for (auto _ : state) {
+		for (int64_t i = 0; i < n; ++i) {
+			hits += map.find(lookupKey(i, n, hitPercent)) != map.end();
+		}
+	}
+	benchmark::DoNotOptimize(hits);
+	state.SetItemsProcessed(state.iterations() * n);
+}
+
+BENCHMARK_DEFINE_F(LargeMapBenchmark, LookupHashMapCore) (benchmark::State& state) {
+	const int64_t n = state.range(0);
+	const int64_t hitPercent = state.range(1);
+	core::HashMap<int64_t, int64_t> map;
+	for (int64_t i = 0; i < n; ++i) {
+		map.put(i, i);
+	}
+	int64_t hits = 0;
+	for (auto _ : state) {
+		for (int64_t i = 0; i < n; ++i) {
+			hits += map.hasKey(lookupKey(i, n, hitPercent));
+		}
+	}
+	benchmark::DoNotOptimize(hits);
+	state.SetItemsProcessed(state.iterations() * n);
+}
+
+BENCHMARK_DEFINE_F(LargeMapBenchmark, LookupStringMapCore) (benchmark::State& state) {
+	const int64_t n = state.range(0);
+	const int64_t hitPercent = state.range(1);
+	core::StringMap<int64_t> map;
+	char buf[32];
+	for (int64_t i = 0; i < n; ++i) {
+		SDL_snprintf(buf, sizeof(buf), "key%i", (int)i);
+		map.put(buf, i);
+	}
+	int64_t hits = 0;
+	for (auto _ : state) {
+		for (int64_t i = 0; i < n; ++i) {
+			SDL_snprintf(buf, sizeof(buf), "key%i", (int)lookupKey(i, n, hitPercent));
+			// no core::String is created for the lookup
+			hits += map.hasKey((const char*)buf);
+		}
+	}
+	benchmark::DoNotOptimize(hits);
+	state.SetItemsProcessed(state.iterations() * n);
+}
+
 BENCHMARK_REGISTER_F(MapBenchmark, compareToMapCore)->RangeMultiplier(2)->Range(8, 512);
 BENCHMARK_REGISTER_F(MapBenchmark, compareToMapStd)->RangeMultiplier(2)->Range(8, 512);
 BENCHMARK_REGISTER_F(MapBenchmark, compareToUnorderedMapStd)->RangeMultiplier(2)->Range(8, 512);
+BENCHMARK_REGISTER_F(MapBenchmark, compareToHashMapCore)->RangeMultiplier(2)->Range(8, 512);
+
+static void lookupArguments(benchmark::internal::Benchmark* b) {
+	for (int n : {1 << 10, 1 << 15, 1 << 20}) {
+		for (int hitPercent : {0, 50, 100}) {
+			b->Args({n, hitPercent});
+		}
+	}
+}
+
+BENCHMARK_REGISTER_F(LargeMapBenchmark, InsertUnorderedMapStd)->RangeMultiplier(32)->Range(1 << 10, 1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(LargeMapBenchmark, InsertHashMapCore)->RangeMultiplier(32)->Range(1 << 10, 1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(LargeMapBenchmark, LookupUnorderedMapStd)->Apply(lookupArguments)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(LargeMapBenchmark, LookupHashMapCore)->Apply(lookupArguments)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(LargeMapBenchmark, LookupStringMapCore)->Apply(lookupArguments)->Unit(benchmark::kMillisecond);
 
 BENCHMARK_MAIN();
@@ -0,0 +1,146 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "core/collection/ConcurrentQueue.h"
+#include "core/collection/MPMCQueue.h"
+#include "core/collection/BucketedPriorityQueue.h"
+#include "core/concurrent/Atomic.h"
+#include <glm/vec3.hpp>
+#include <glm/common.hpp>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Compares the @c core::ConcurrentQueue with the @c core::MPMCQueue and the @c core::BucketedPriorityQueue
+ *
+ * - Handoff: the same amount of producer and consumer threads push and pop values at the same time
+ * - Reprioritize: the focus position changes every few pops - just like the pending mesh extraction
+ *   positions while the camera moves
+ */
+class ConcurrentQueueBenchmark : public app::AbstractBenchmark {
+public:
+	static constexpr int Items = 20000;
+	static constexpr int Positions = 4096;
+	static constexpr int PopsPerMove = 16;
+
+	struct CloseToPoint {
+		glm::ivec3 _refPoint;
+		CloseToPoint(const glm::ivec3& refPoint = glm::ivec3(0)) : _refPoint(refPoint) {
+		}
+		inline int distance(const glm::ivec3& pos) const {
+			const glm::ivec3 d = _refPoint - pos;
+			return d.x * d.x + d.z * d.z;
+		}
+		inline bool operator()(const glm::ivec3& lhs, const glm::ivec3& rhs) const {
+			return distance(lhs) > distance(rhs);
+		}
+	};
+
+	struct DistanceRing {
+		glm::ivec3 _refPoint;
+		DistanceRing(const glm::ivec3& refPoint = glm::ivec3(0)) : _refPoint(refPoint) {
+		}
+		inline int operator()(const glm::ivec3& pos) const {
+			return glm::max(glm::abs(_refPoint.x - pos.x), glm::abs(_refPoint.z - pos.z)) / 4;
+		}
+	};
+
+	template<class PUSH, class POP>
+	static void handoff(int threads, PUSH&& push, POP&& pop) {
+		const int perThread = Items / threads;
+		core::AtomicInt popped;
+		std::vector<std::thread> workers;
+		workers.reserve(threads * 2);
+		for (int t = 0; t < threads; ++t) {
+			workers.emplace_back([&] () {
+				for (int i = 0; i < perThread; ++i) {
+					while (!push(i)) {
+						std::this_thread::yield();
+					}
+				}
+			});
+			workers.emplace_back([&] () {
+				while (popped < perThread * threads) {
+					if (pop()) {
+						popped.increment();
+					} else {
+						std::this_thread::yield();
+					}
+				}
+			});
+		}
+		for (std::thread& t : workers) {
+			t.join();
+		}
+	}
+
+	static inline glm::ivec3 position(int i) {
+		return glm::ivec3((i % 64) * 4, 0, (i / 64) * 4);
+	}
+};
+
+BENCHMARK_DEFINE_F(ConcurrentQueueBenchmark, ConcurrentQueueHandoff)(benchmark::State &state) {
+	core::ConcurrentQueue<int> queue;
+	for (auto _ : state) {
+		handoff((int)state.range(0), [&] (int v) {
+			queue.push(v);
+			return true;
+		}, [&] () {
+			int v;
+			return queue.pop(v);
+		});
+	}
+	state.SetItemsProcessed(state.iterations() * Items);
+}
+
+BENCHMARK_DEFINE_F(ConcurrentQueueBenchmark, MPMCQueueHandoff)(benchmark::State &state) {
+	core::MPMCQueue<int> queue(1024);
+	for (auto _ : state) {
+		handoff((int)state.range(0), [&] (int v) {
+			return queue.push(v);
+		}, [&] () {
+			int v;
+			return queue.pop(v);
+		});
+	}
+	state.SetItemsProcessed(state.iterations() * Items);
+}
+
+BENCHMARK_DEFINE_F(ConcurrentQueueBenchmark, ConcurrentQueueReprioritize)(benchmark::State &state) {
+	core::ConcurrentQueue<glm::ivec3, CloseToPoint> queue;
+	for (auto _ : state) {
+		for (int i = 0; i < Positions; ++i) {
+			queue.push(position(i));
+		}
+		glm::ivec3 pos;
+		for (int i = 0; queue.pop(pos); ++i) {
+			if (i % PopsPerMove == 0) {
+				queue.setComparator(CloseToPoint(position(i)));
+			}
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * Positions);
+}
+
+BENCHMARK_DEFINE_F(ConcurrentQueueBenchmark, BucketedPriorityQueueReprioritize)(benchmark::State &state) {
+	core::BucketedPriorityQueue<glm::ivec3, DistanceRing> queue;
+	for (auto _ : state) {
+		for (int i = 0; i < Positions; ++i) {
+			queue.push(position(i));
+		}
+		glm::ivec3 pos;
+		for (int i = 0; queue.pop(pos); ++i) {
+			if (i % PopsPerMove == 0) {
+				queue.setBucketFunc(DistanceRing(position(i)));
+			}
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * Positions);
+}
+
+BENCHMARK_REGISTER_F(ConcurrentQueueBenchmark, ConcurrentQueueHandoff)->Arg(1)->Arg(4)->UseRealTime();
+BENCHMARK_REGISTER_F(ConcurrentQueueBenchmark, MPMCQueueHandoff)->Arg(1)->Arg(4)->UseRealTime();
+BENCHMARK_REGISTER_F(ConcurrentQueueBenchmark, ConcurrentQueueReprioritize);
+BENCHMARK_REGISTER_F(ConcurrentQueueBenchmark, BucketedPriorityQueueReprioritize);
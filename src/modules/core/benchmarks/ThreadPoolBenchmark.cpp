@@ -0,0 +1,124 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "core/concurrent/ThreadPool.h"
+#include "core/concurrent/TaskScheduler.h"
+#include "core/concurrent/Atomic.h"
+#include <future>
+#include <vector>
+
+/**
+ * @brief Compares the @c core::ThreadPool with the @c core::TaskScheduler
+ *
+ * - Throughput: schedule a lot of small tasks and wait for all of them
+ * - Latency: schedule a single task and wait for it
+ * - ForkJoin: the tasks schedule tasks on their own and wait for them
+ */
+class ThreadPoolBenchmark : public app::AbstractBenchmark {
+public:
+	static constexpr int Tasks = 10000;
+
+	static inline void work(core::AtomicInt& counter) {
+		counter.increment();
+	}
+};
+
+BENCHMARK_DEFINE_F(ThreadPoolBenchmark, ThreadPoolThroughput)(benchmark::State &state) {
+	core::ThreadPool pool((size_t)state.range(0), "Benchmark");
+	pool.init();
+	core::AtomicInt counter;
+	std::vector<std::future<void> > results;
+	results.reserve(Tasks);
+	for (auto _ : state) {
+		results.clear();
+		for (int i = 0; i < Tasks; ++i) {
+			results.emplace_back(pool.enqueue([&counter] () {
+				work(counter);
+			}));
+		}
+		for (auto& result : results) {
+			result.wait();
+		}
+	}
+	pool.shutdown(true);
+	state.SetItemsProcessed(state.iterations() * Tasks);
+}
+
+BENCHMARK_DEFINE_F(ThreadPoolBenchmark, TaskSchedulerThroughput)(benchmark::State &state) {
+	core::TaskScheduler scheduler((size_t)state.range(0), "Benchmark");
+	scheduler.init();
+	core::AtomicInt counter;
+	for (auto _ : state) {
+		core::TaskGroup group;
+		for (int i = 0; i < Tasks; ++i) {
+			scheduler.schedule([&counter] () {
+				work(counter);
+			}, core::TaskPriority::Normal, &group);
+		}
+		scheduler.wait(group);
+	}
+	scheduler.shutdown(true);
+	state.SetItemsProcessed(state.iterations() * Tasks);
+}
+
+BENCHMARK_DEFINE_F(ThreadPoolBenchmark, ThreadPoolLatency)(benchmark::State &state) {
+	core::ThreadPool pool((size_t)state.range(0), "Benchmark");
+	pool.init();
+	core::AtomicInt counter;
+	for (auto _ : state) {
+		pool.enqueue([&counter] () {
+			work(counter);
+		}).wait();
+	}
+	pool.shutdown(true);
+}
+
+BENCHMARK_DEFINE_F(ThreadPoolBenchmark, TaskSchedulerLatency)(benchmark::State &state) {
+	core::TaskScheduler scheduler((size_t)state.range(0), "Benchmark");
+	scheduler.init();
+	core::AtomicInt counter;
+	for (auto _ : state) {
+		core::TaskGroup group;
+		scheduler.schedule([&counter] () {
+			work(counter);
+		}, core::TaskPriority::Normal, &group);
+		// don't help - measure the roundtrip to a worker
+		while (!group.done()) {
+			std::this_thread::yield();
+		}
+	}
+	scheduler.shutdown(true);
+}
+
+BENCHMARK_DEFINE_F(ThreadPoolBenchmark, TaskSchedulerForkJoin)(benchmark::State &state) {
+	core::TaskScheduler scheduler((size_t)state.range(0), "Benchmark");
+	scheduler.init();
+	core::AtomicInt counter;
+	const int outer = 100;
+	const int inner = Tasks / outer;
+	for (auto _ : state) {
+		core::TaskGroup group;
+		for (int i = 0; i < outer; ++i) {
+			scheduler.schedule([&scheduler, &counter, inner] () {
+				core::TaskGroup innerGroup;
+				for (int j = 0; j < inner; ++j) {
+					scheduler.schedule([&counter] () {
+						work(counter);
+					}, core::TaskPriority::Normal, &innerGroup);
+				}
+				scheduler.wait(innerGroup);
+			}, core::TaskPriority::Normal, &group);
+		}
+		scheduler.wait(group);
+	}
+	scheduler.shutdown(true);
+	state.SetItemsProcessed(state.iterations() * Tasks);
+}
+
+BENCHMARK_REGISTER_F(ThreadPoolBenchmark, ThreadPoolThroughput)->Arg(1)->Arg(4)->UseRealTime();
+BENCHMARK_REGISTER_F(ThreadPoolBenchmark, TaskSchedulerThroughput)->Arg(1)->Arg(4)->UseRealTime();
+BENCHMARK_REGISTER_F(ThreadPoolBenchmark, ThreadPoolLatency)->Arg(1)->Arg(4)->UseRealTime();
+BENCHMARK_REGISTER_F(ThreadPoolBenchmark, TaskSchedulerLatency)->Arg(1)->Arg(4)->UseRealTime();
+BENCHMARK_REGISTER_F(ThreadPoolBenchmark, TaskSchedulerForkJoin)->Arg(1)->Arg(4)->UseRealTime();
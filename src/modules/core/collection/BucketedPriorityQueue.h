@@ -0,0 +1,193 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/Trace.h"
+#include "core/Common.h"
+#include <stdint.h>
+#include <vector>
+
+namespace core {
+
+/**
+ * @brief Thread safe priority queue for a fixed amount of priority classes.
+ *
+ * The @c BucketFunc maps a value to its bucket - @c 0 is the highest priority, values outside of
+ * [0, BUCKETS) are clamped. A typical bucket function returns the distance ring of a position around
+ * the camera. @c push() and @c pop() are O(1) and don't compare values.
+ *
+ * Changing the bucket function (e.g. because the camera moved) only stores the new function - the values
+ * are sorted into their new buckets with the next @c pop() in one linear pass.
+ *
+ * @note The values inside of one bucket are not ordered.
+ * @sa ConcurrentQueue
+ */
+template<class Data, class BucketFunc, int BUCKETS = 64>
+class BucketedPriorityQueue {
+private:
+	using Bucket = std::vector<Data>;
+	Bucket _buckets[BUCKETS];
+	// no bucket below this index contains a value
+	int _first = BUCKETS;
+	uint32_t _size = 0u;
+	bool _dirty = false;
+	BucketFunc _bucketFunc;
+	mutable core_trace_mutex(core::Lock, _mutex, "BucketedPriorityQueue");
+	core::ConditionVariable _conditionVariable;
+	core::AtomicBool _abort { false };
+
+	inline int bucket(const Data& data) const {
+		const int b = _bucketFunc(data);
+		if (b < 0) {
+			return 0;
+		}
+		if (b >= BUCKETS) {
+			return BUCKETS - 1;
+		}
+		return b;
+	}
+
+	void rebucket() {
+		core_trace_scoped(BucketedPriorityQueueRebucket);
+		_dirty = false;
+		_first = BUCKETS;
+		for (int b = 0; b < BUCKETS; ++b) {
+			Bucket& from = _buckets[b];
+			for (size_t i = from.size(); i-- > 0u;) {
+				const int to = bucket(from[i]);
+				if (to == b) {
+					continue;
+				}
+				_buckets[to].push_back(core::move(from[i]));
+				if (i != from.size() - 1u) {
+					from[i] = core::move(from.back());
+				}
+				from.pop_back();
+			}
+		}
+		for (int b = 0; b < BUCKETS; ++b) {
+			if (!_buckets[b].empty()) {
+				_first = b;
+				break;
+			}
+		}
+	}
+
+	void add(Data&& data) {
+		const int b = bucket(data);
+		_buckets[b].push_back(core::move(data));
+		if (b < _first) {
+			_first = b;
+		}
+		++_size;
+		_conditionVariable.notify_one();
+	}
+
+	bool take(Data& poppedValue) {
+		if (_size == 0u) {
+			return false;
+		}
+		if (_dirty) {
+			rebucket();
+		}
+		while (_buckets[_first].empty()) {
+			++_first;
+		}
+		Bucket& b = _buckets[_first];
+		poppedValue = core::move(b.back());
+		b.pop_back();
+		--_size;
+		return true;
+	}
+
+public:
+	using value_type = Data;
+	using Key = Data;
+
+	BucketedPriorityQueue(BucketFunc bucketFunc = BucketFunc()) :
+			_bucketFunc(bucketFunc) {
+	}
+
+	~BucketedPriorityQueue() {
+		abortWait();
+	}
+
+	/**
+	 * @brief Sets the function that maps the values to their buckets. The queued values are moved into
+	 * their new buckets with the next @c pop()
+	 */
+	void setBucketFunc(BucketFunc bucketFunc) {
+		core::ScopedLock lock(_mutex);
+		_bucketFunc = bucketFunc;
+		_dirty = _size > 0u;
+	}
+
+	void abortWait() {
+		_abort = true;
+		core::ScopedLock lock(_mutex);
+		_conditionVariable.notify_all();
+	}
+
+	void reset() {
+		_abort = false;
+	}
+
+	/**
+	 * @note Keeps the memory of the buckets
+	 */
+	void clear() {
+		core::ScopedLock lock(_mutex);
+		for (Bucket& b : _buckets) {
+			b.clear();
+		}
+		_first = BUCKETS;
+		_size = 0u;
+		_dirty = false;
+	}
+
+	void push(Data const& data) {
+		core::ScopedLock lock(_mutex);
+		add(Data(data));
+	}
+
+	void push(Data&& data) {
+		core::ScopedLock lock(_mutex);
+		add(core::move(data));
+	}
+
+	inline bool empty() const {
+		core::ScopedLock lock(_mutex);
+		return _size == 0u;
+	}
+
+	inline uint32_t size() const {
+		core::ScopedLock lock(_mutex);
+		return _size;
+	}
+
+	bool pop(Data& poppedValue) {
+		core::ScopedLock lock(_mutex);
+		return take(poppedValue);
+	}
+
+	/**
+	 * @return @c false if the wait was aborted
+	 */
+	bool waitAndPop(Data& poppedValue) {
+		core::ScopedLock lock(_mutex);
+		while (_size == 0u && !_abort) {
+			_conditionVariable.wait(_mutex);
+		}
+		if (_abort) {
+			return false;
+		}
+		return take(poppedValue);
+	}
+};
+
+}
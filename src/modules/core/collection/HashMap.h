@@ -0,0 +1,392 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/collection/Map.h"
+#include "core/StandardLib.h"
+#include "core/Common.h"
+#include "core/Assert.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <initializer_list>
+#include <new>
+
+namespace core {
+
+namespace priv {
+
+/**
+ * @brief Finalizer of MurmurHash3 - spreads the bits of weak hashes (like the identity hash of integers)
+ * over the whole range before the hash is masked down to the table size.
+ */
+inline uint64_t mixHash(uint64_t h) {
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+}
+
+/**
+ * @brief Open addressing hash map that grows with the amount of entries
+ *
+ * The entries are stored inline in one array and collisions are resolved by linear probing with robin hood
+ * hashing: an entry that is further away from its home slot than the entry it collides with takes the slot,
+ * which keeps the probe sequences short even for high load factors. Removing entries shifts the following
+ * entries of the probe sequence back, so there are no tombstones.
+ *
+ * Lookups are heterogeneous - the key type of @c find(), @c get(), @c hasKey() and @c remove() may differ from
+ * @c KEYTYPE as long as the @c HASHER and the @c COMPARE functors accept it (e.g. @c const @c char* for
+ * @c core::String keys). Use the same hash for both types.
+ *
+ * @note Inserting and removing entries invalidates the iterators and the pointers to the entries.
+ * @sa Map
+ * @ingroup Collections
+ */
+template<typename KEYTYPE, typename VALUETYPE, typename HASHER = priv::DefaultHasher, typename COMPARE = priv::EqualCompare>
+class HashMap {
+public:
+	using value_type = VALUETYPE;
+	using key_type = KEYTYPE;
+
+	struct KeyValue {
+		inline KeyValue(const KEYTYPE& _key, const VALUETYPE& _value) :
+				key(_key), value(_value) {
+		}
+
+		inline KeyValue(const KEYTYPE& _key, VALUETYPE&& _value) :
+				key(_key), value(core::move(_value)) {
+		}
+
+		KEYTYPE key;
+		VALUETYPE value;
+	};
+private:
+	// the max load factor in percent
+	static constexpr size_t MaxLoad = 80u;
+	static constexpr size_t MinCapacity = 8u;
+	// the probe distance is stored in 8 bits - the table is grown before it overflows
+	static constexpr uint8_t MaxDistance = 0xFFu;
+
+	KeyValue *_entries = nullptr;
+	// 0 for free slots - otherwise the distance to the home slot plus one
+	uint8_t *_distances = nullptr;
+	size_t _capacity = 0u;
+	size_t _size = 0u;
+	HASHER _hasher;
+
+	template<typename K>
+	inline size_t home(const K& key) const {
+		return (size_t)priv::mixHash((uint64_t)_hasher(key)) & (_capacity - 1u);
+	}
+
+	template<typename K>
+	size_t lookup(const K& key) const {
+		if (_size == 0u) {
+			return _capacity;
+		}
+		size_t idx = home(key);
+		for (uint8_t distance = 1u;; ++distance) {
+			// an entry of this probe sequence would have taken this slot
+			if (_distances[idx] < distance) {
+				return _capacity;
+			}
+			if (_distances[idx] == distance && COMPARE()(_entries[idx].key, key)) {
+				return idx;
+			}
+			idx = (idx + 1u) & (_capacity - 1u);
+		}
+	}
+
+	/**
+	 * @brief Insert an entry that is not yet part of the map
+	 */
+	void insertNew(KeyValue&& entry) {
+		if (_capacity == 0u || (_size + 1u) * 100u > _capacity * MaxLoad) {
+			rehash(_capacity == 0u ? MinCapacity : _capacity * 2u);
+		}
+		size_t idx = home(entry.key);
+		uint8_t distance = 1u;
+		for (;;) {
+			if (_distances[idx] == 0u) {
+				new (&_entries[idx]) KeyValue(core::move(entry));
+				_distances[idx] = distance;
+				++_size;
+				return;
+			}
+			if (_distances[idx] < distance) {
+				// robin hood - the new entry is poorer, so it takes the slot and the rich entry moves on
+				KeyValue tmp(core::move(_entries[idx]));
+				_entries[idx] = core::move(entry);
+				entry = core::move(tmp);
+				const uint8_t d = _distances[idx];
+				_distances[idx] = distance;
+				distance = d;
+			}
+			idx = (idx + 1u) & (_capacity - 1u);
+			if (++distance == MaxDistance) {
+				rehash(_capacity * 2u);
+				insertNew(core::move(entry));
+				return;
+			}
+		}
+	}
+
+	void rehash(size_t capacity) {
+		KeyValue *entries = _entries;
+		uint8_t *distances = _distances;
+		const size_t oldCapacity = _capacity;
+		_entries = (KeyValue*)core_malloc(capacity * sizeof(KeyValue));
+		_distances = (uint8_t*)core_malloc(capacity);
+		core_assert_always(_entries != nullptr && _distances != nullptr);
+		memset(_distances, 0, capacity);
+		_capacity = capacity;
+		_size = 0u;
+		for (size_t i = 0u; i < oldCapacity; ++i) {
+			if (distances[i] == 0u) {
+				continue;
+			}
+			insertNew(core::move(entries[i]));
+			entries[i].~KeyValue();
+		}
+		core_free(entries);
+		core_free(distances);
+	}
+
+	void removeAt(size_t idx) {
+		_entries[idx].~KeyValue();
+		// shift the following entries of the probe sequence back by one slot
+		size_t next = (idx + 1u) & (_capacity - 1u);
+		while (_distances[next] > 1u) {
+			new (&_entries[idx]) KeyValue(core::move(_entries[next]));
+			_entries[next].~KeyValue();
+			_distances[idx] = _distances[next] - 1u;
+			idx = next;
+			next = (next + 1u) & (_capacity - 1u);
+		}
+		_distances[idx] = 0u;
+		--_size;
+	}
+
+	void release() {
+		clear();
+		core_free(_entries);
+		core_free(_distances);
+		_entries = nullptr;
+		_distances = nullptr;
+		_capacity = 0u;
+	}
+
+	void copy(const HashMap& other) {
+		reserve(other.size());
+		for (auto i = other.begin(); i != other.end(); ++i) {
+			put(i->key, i->value);
+		}
+	}
+
+public:
+	HashMap(std::initializer_list<KeyValue> other) {
+		reserve(other.size());
+		for (auto i = other.begin(); i != other.end(); ++i) {
+			put(i->key, i->value);
+		}
+	}
+
+	/**
+	 * @param[in] capacity The amount of entries the map can take without growing
+	 */
+	HashMap(size_t capacity = 0u) {
+		reserve(capacity);
+	}
+
+	HashMap(const HashMap& other) {
+		copy(other);
+	}
+
+	HashMap(HashMap&& other) noexcept :
+			_entries(other._entries), _distances(other._distances), _capacity(other._capacity), _size(other._size) {
+		other._entries = nullptr;
+		other._distances = nullptr;
+		other._capacity = 0u;
+		other._size = 0u;
+	}
+
+	~HashMap() {
+		release();
+	}
+
+	HashMap& operator=(const HashMap& other) {
+		if (&other != this) {
+			clear();
+			copy(other);
+		}
+		return *this;
+	}
+
+	HashMap& operator=(HashMap&& other) noexcept {
+		if (&other != this) {
+			release();
+			_entries = other._entries;
+			_distances = other._distances;
+			_capacity = other._capacity;
+			_size = other._size;
+			other._entries = nullptr;
+			other._distances = nullptr;
+			other._capacity = 0u;
+			other._size = 0u;
+		}
+		return *this;
+	}
+
+	class iterator {
+	private:
+		const HashMap* _map;
+		size_t _idx;
+
+		void skipFree() {
+			while (_idx < _map->_capacity && _map->_distances[_idx] == 0u) {
+				++_idx;
+			}
+		}
+	public:
+		constexpr iterator() :
+			_map(nullptr), _idx(0u) {
+		}
+
+		iterator(const HashMap* map, size_t idx) :
+				_map(map), _idx(idx) {
+			skipFree();
+		}
+
+		inline KeyValue* operator*() const {
+			return &_map->_entries[_idx];
+		}
+
+		iterator& operator++() {
+			++_idx;
+			skipFree();
+			return *this;
+		}
+
+		inline KeyValue* operator->() const {
+			return &_map->_entries[_idx];
+		}
+
+		inline bool operator!=(const iterator& rhs) const {
+			return _idx != rhs._idx;
+		}
+
+		inline bool operator==(const iterator& rhs) const {
+			return _idx == rhs._idx;
+		}
+	};
+
+	inline size_t size() const {
+		return _size;
+	}
+
+	inline bool empty() const {
+		return _size == 0u;
+	}
+
+	/**
+	 * @return The amount of slots - the map grows before all of them are used
+	 */
+	inline size_t capacity() const {
+		return _capacity;
+	}
+
+	/**
+	 * @brief Make sure that the given amount of entries fit into the map without growing
+	 */
+	void reserve(size_t entries) {
+		size_t capacity = MinCapacity;
+		while (capacity * MaxLoad < entries * 100u) {
+			capacity *= 2u;
+		}
+		if (entries > 0u && capacity > _capacity) {
+			rehash(capacity);
+		}
+	}
+
+	template<typename K>
+	bool get(const K& key, VALUETYPE& value) const {
+		const size_t idx = lookup(key);
+		if (idx == _capacity) {
+			return false;
+		}
+		value = _entries[idx].value;
+		return true;
+	}
+
+	template<typename K>
+	inline bool hasKey(const K& key) const {
+		return lookup(key) != _capacity;
+	}
+
+	template<typename K>
+	inline iterator find(const K& key) const {
+		return iterator(this, lookup(key));
+	}
+
+	void emplace(const KEYTYPE& key, VALUETYPE&& value) {
+		const size_t idx = lookup(key);
+		if (idx != _capacity) {
+			_entries[idx].value = core::move(value);
+			return;
+		}
+		insertNew(KeyValue(key, core::move(value)));
+	}
+
+	void put(const KEYTYPE& key, const VALUETYPE& value) {
+		const size_t idx = lookup(key);
+		if (idx != _capacity) {
+			_entries[idx].value = value;
+			return;
+		}
+		insertNew(KeyValue(key, value));
+	}
+
+	inline iterator begin() const {
+		return iterator(this, 0u);
+	}
+
+	inline iterator end() const {
+		return iterator(this, _capacity);
+	}
+
+	/**
+	 * @note Keeps the memory
+	 */
+	void clear() {
+		for (size_t i = 0u; i < _capacity; ++i) {
+			if (_distances[i] != 0u) {
+				_entries[i].~KeyValue();
+				_distances[i] = 0u;
+			}
+		}
+		_size = 0u;
+	}
+
+	inline void erase(const iterator& iter) {
+		remove(iter->key);
+	}
+
+	template<typename K>
+	bool remove(const K& key) {
+		const size_t idx = lookup(key);
+		if (idx == _capacity) {
+			return false;
+		}
+		removeAt(idx);
+		return true;
+	}
+};
+
+}
@@ -0,0 +1,160 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+
+namespace core {
+
+/**
+ * @brief Lock-free bounded multi producer multi consumer queue
+ *
+ * Ring buffer where each slot has a sequence number that tells the producers and consumers whether the slot
+ * is free or contains data for the current lap (see Dmitry Vyukov's bounded MPMC queue). Producers and
+ * consumers only synchronize on the slot they claimed with a single compare-and-swap of the position.
+ *
+ * @note The capacity is rounded up to the next power of two - @c push() fails if the queue is full.
+ * @note The slots are default constructed up front and the popped values are moved out of them.
+ * @sa ConcurrentQueue
+ */
+template<class Data>
+class MPMCQueue {
+private:
+	struct alignas(64) Slot {
+		std::atomic<size_t> sequence;
+		Data data;
+	};
+
+	const size_t _mask;
+	std::unique_ptr<Slot[]> _slots;
+	alignas(64) std::atomic<size_t> _pushPos { 0u };
+	alignas(64) std::atomic<size_t> _popPos { 0u };
+
+	static size_t roundCapacity(size_t capacity) {
+		size_t c = 2u;
+		while (c < capacity) {
+			c <<= 1;
+		}
+		return c;
+	}
+
+	Slot* claimPush() {
+		size_t pos = _pushPos.load(std::memory_order_relaxed);
+		for (;;) {
+			Slot* slot = &_slots[pos & _mask];
+			const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+			const intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+			if (diff == 0) {
+				if (_pushPos.compare_exchange_weak(pos, pos + 1u, std::memory_order_relaxed)) {
+					return slot;
+				}
+			} else if (diff < 0) {
+				// full
+				return nullptr;
+			} else {
+				pos = _pushPos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	static inline void publishPush(Slot* slot) {
+		slot->sequence.store(slot->sequence.load(std::memory_order_relaxed) + 1u, std::memory_order_release);
+	}
+
+public:
+	using value_type = Data;
+
+	explicit MPMCQueue(size_t capacity = 1024u) :
+			_mask(roundCapacity(capacity) - 1u), _slots(new Slot[_mask + 1u]) {
+		for (size_t i = 0u; i <= _mask; ++i) {
+			_slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	MPMCQueue(const MPMCQueue&) = delete;
+	MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+	inline size_t capacity() const {
+		return _mask + 1u;
+	}
+
+	/**
+	 * @return @c false if the queue is full - the given value is not touched in this case
+	 */
+	bool push(Data&& data) {
+		Slot* slot = claimPush();
+		if (slot == nullptr) {
+			return false;
+		}
+		slot->data = std::move(data);
+		publishPush(slot);
+		return true;
+	}
+
+	/**
+	 * @return @c false if the queue is full
+	 */
+	bool push(const Data& data) {
+		Slot* slot = claimPush();
+		if (slot == nullptr) {
+			return false;
+		}
+		slot->data = data;
+		publishPush(slot);
+		return true;
+	}
+
+	/**
+	 * @return @c false if the queue is empty
+	 */
+	bool pop(Data& poppedValue) {
+		size_t pos = _popPos.load(std::memory_order_relaxed);
+		Slot* slot;
+		for (;;) {
+			slot = &_slots[pos & _mask];
+			const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+			const intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1u);
+			if (diff == 0) {
+				if (_popPos.compare_exchange_weak(pos, pos + 1u, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (diff < 0) {
+				// empty
+				return false;
+			} else {
+				pos = _popPos.load(std::memory_order_relaxed);
+			}
+		}
+		poppedValue = std::move(slot->data);
+		// free the slot for the next lap
+		slot->sequence.store(pos + _mask + 1u, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * @note Only a snapshot if there are concurrent producers or consumers
+	 */
+	inline size_t size() const {
+		const size_t pushPos = _pushPos.load(std::memory_order_acquire);
+		const size_t popPos = _popPos.load(std::memory_order_acquire);
+		return pushPos > popPos ? pushPos - popPos : 0u;
+	}
+
+	inline bool empty() const {
+		return size() == 0u;
+	}
+
+	void clear() {
+		Data data;
+		while (pop(data)) {
+		}
+	}
+};
+
+}
@@ -15,8 +15,8 @@ namespace core {
 namespace priv {
 
 struct EqualCompare {
-	template<typename T>
-	inline bool operator() (const T& lhs, const T& rhs) const {
+	template<typename T, typename U>
+	inline bool operator() (const T& lhs, const U& rhs) const {
 		return lhs == rhs;
 	}
 };
@@ -219,7 +219,7 @@ public:
 				prev->next = entry;
 			}
 		} else {
-			entry->value = std::forward(value);
+			entry->value = core::move(value);
 		}
 	}
 
@@ -4,18 +4,20 @@
 
 #pragma once
 
-#include "core/collection/Map.h"
+#include "core/collection/HashMap.h"
 #include "core/String.h"
 
 namespace core {
 
 /**
  * @brief String key based hash map
- * @sa core::Map
+ *
+ * Lookups with @c const @c char* don't create a @c core::String
+ * @sa core::HashMap
  * @sa core::String
  * @ingroup Collections
  */
-template<class V, size_t SIZE = 11>
-using StringMap = core::Map<core::String, V, SIZE, core::StringHash>;
+template<class V>
+using StringMap = core::HashMap<core::String, V, core::StringHash>;
 
 }
@@ -5,11 +5,16 @@
 #pragma once
 
 #include "core/String.h"
+#include <shared_mutex>
 
 struct SDL_mutex;
 
 namespace core {
 
+/**
+ * @note The read and the write lock are the same recursive mutex - see @c SharedLock for a lock that
+ * lets several readers in at once.
+ */
 class ReadWriteLock {
 private:
 	const core::String _name;
@@ -27,11 +32,41 @@ public:
 	void unlockWrite();
 };
 
+/**
+ * @brief Shared/exclusive lock - any amount of readers or one writer
+ * @note Not recursive - a thread must not lock it again while it holds it (neither for reading nor for writing)
+ */
+class SharedLock {
+private:
+	mutable std::shared_mutex _mutex;
+public:
+	SharedLock() = default;
+	SharedLock(const SharedLock &) = delete;
+	SharedLock &operator=(const SharedLock &) = delete;
+
+	inline void lockRead() const {
+		_mutex.lock_shared();
+	}
+
+	inline void unlockRead() const {
+		_mutex.unlock_shared();
+	}
+
+	inline void lockWrite() {
+		_mutex.lock();
+	}
+
+	inline void unlockWrite() {
+		_mutex.unlock();
+	}
+};
+
+template<class LOCK>
 class ScopedReadLock {
 private:
-	const ReadWriteLock& _lock;
+	const LOCK& _lock;
 public:
-	inline ScopedReadLock(const ReadWriteLock& lock) : _lock(lock) {
+	inline ScopedReadLock(const LOCK& lock) : _lock(lock) {
 		_lock.lockRead();
 	}
 	inline ~ScopedReadLock() {
@@ -39,11 +74,12 @@ public:
 	}
 };
 
+template<class LOCK>
 class ScopedWriteLock {
 private:
-	ReadWriteLock& _lock;
+	LOCK& _lock;
 public:
-	inline ScopedWriteLock(ReadWriteLock& lock) : _lock(lock) {
+	inline ScopedWriteLock(LOCK& lock) : _lock(lock) {
 		_lock.lockWrite();
 	}
 	inline ~ScopedWriteLock() {
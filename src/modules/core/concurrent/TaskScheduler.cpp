@@ -0,0 +1,260 @@
+/**
+ * @file
+ */
+
+#include "TaskScheduler.h"
+#include "core/Assert.h"
+#include "core/StringUtil.h"
+#include "core/concurrent/Concurrency.h"
+
+namespace core {
+
+/**
+ * @brief The scheduler and the worker index of the current thread - or @c nullptr for non worker threads
+ */
+static thread_local const TaskScheduler *t_scheduler = nullptr;
+static thread_local int t_worker = -1;
+
+void Task::release() {
+	if (_manage != nullptr) {
+		_manage(nullptr, _storage);
+	}
+	_invoke = nullptr;
+	_manage = nullptr;
+}
+
+Task::Task(Task&& other) noexcept :
+		_invoke(other._invoke), _manage(other._manage), _group(other._group), _token(other._token) {
+	if (_manage != nullptr) {
+		_manage(_storage, other._storage);
+	}
+	other._invoke = nullptr;
+	other._manage = nullptr;
+}
+
+Task& Task::operator=(Task&& other) noexcept {
+	if (this == &other) {
+		return *this;
+	}
+	release();
+	_invoke = other._invoke;
+	_manage = other._manage;
+	_group = other._group;
+	_token = other._token;
+	if (_manage != nullptr) {
+		_manage(_storage, other._storage);
+	}
+	other._invoke = nullptr;
+	other._manage = nullptr;
+	return *this;
+}
+
+void TaskScheduler::WorkQueue::grow() {
+	const size_t capacity = _tasks.empty() ? 64u : _tasks.size() * 2u;
+	std::vector<Task> tasks(capacity);
+	for (size_t i = 0u; i < _count; ++i) {
+		tasks[i] = std::move(_tasks[(_head + i) & (_tasks.size() - 1u)]);
+	}
+	_tasks.swap(tasks);
+	_head = 0u;
+}
+
+void TaskScheduler::WorkQueue::push(Task&& task) {
+	SDL_AtomicLock(&_lock);
+	if (_count == _tasks.size()) {
+		grow();
+	}
+	_tasks[(_head + _count) & (_tasks.size() - 1u)] = std::move(task);
+	++_count;
+	SDL_AtomicUnlock(&_lock);
+}
+
+bool TaskScheduler::WorkQueue::popFront(Task& task) {
+	SDL_AtomicLock(&_lock);
+	if (_count == 0u) {
+		SDL_AtomicUnlock(&_lock);
+		return false;
+	}
+	task = std::move(_tasks[_head]);
+	_head = (_head + 1u) & (_tasks.size() - 1u);
+	--_count;
+	SDL_AtomicUnlock(&_lock);
+	return true;
+}
+
+bool TaskScheduler::WorkQueue::popBack(Task& task) {
+	SDL_AtomicLock(&_lock);
+	if (_count == 0u) {
+		SDL_AtomicUnlock(&_lock);
+		return false;
+	}
+	--_count;
+	task = std::move(_tasks[(_head + _count) & (_tasks.size() - 1u)]);
+	SDL_AtomicUnlock(&_lock);
+	return true;
+}
+
+TaskScheduler::TaskScheduler(size_t threads, const char *name) :
+		_threads(threads), _name(name) {
+	core_assert_msg(_threads > 0u, "The task scheduler needs at least one worker");
+	if (_name == nullptr) {
+		_name = "TaskScheduler";
+	}
+	_queues.reset(new Worker[_threads]);
+}
+
+TaskScheduler::~TaskScheduler() {
+	shutdown();
+}
+
+int TaskScheduler::currentWorker() const {
+	if (t_scheduler != this) {
+		return -1;
+	}
+	return t_worker;
+}
+
+void TaskScheduler::push(Task&& task, TaskPriority priority) {
+	int worker = currentWorker();
+	if (worker == -1) {
+		worker = (int)((unsigned int)_nextQueue.increment() % _threads);
+	}
+	_queues[worker].queues[(int)priority].push(std::move(task));
+	_queued.increment();
+	// the sleeping workers and waiters recheck the queued counter after they announced to sleep
+	if (_sleeping > 0 || _waiting > 0) {
+		core::ScopedLock lock(_sleepLock);
+		_sleepCondition.notify_one();
+		_waitCondition.notify_all();
+	}
+}
+
+bool TaskScheduler::pop(int worker, Task& task) {
+	const int threads = (int)_threads;
+	const int start = worker == -1 ? 0 : worker;
+	for (int lane = 0; lane < (int)TaskPriority::Max; ++lane) {
+		if (worker != -1 && _queues[worker].queues[lane].popFront(task)) {
+			_queued.decrement();
+			return true;
+		}
+		for (int i = 0; i < threads; ++i) {
+			const int victim = (start + i) % threads;
+			if (victim == worker) {
+				continue;
+			}
+			if (_queues[victim].queues[lane].popBack(task)) {
+				_queued.decrement();
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void TaskScheduler::execute(Task& task) {
+	if (!task.cancelled()) {
+		core_trace_scoped(TaskSchedulerExecute);
+		task();
+	}
+	discard(task);
+}
+
+void TaskScheduler::discard(Task& task) {
+	TaskGroup *group = task.group();
+	// destroy the functor before the group is marked as done
+	task = Task();
+	if (group != nullptr && group->_pending.decrement() == 1 && _waiting > 0) {
+		// the group must not be touched anymore - it might already be destroyed
+		core::ScopedLock lock(_sleepLock);
+		_waitCondition.notify_all();
+	}
+}
+
+void TaskScheduler::wait(TaskGroup& group) {
+	core_trace_scoped(TaskSchedulerWait);
+	const int worker = currentWorker();
+	while (!group.done()) {
+		Task task;
+		if (pop(worker, task)) {
+			execute(task);
+			continue;
+		}
+		// the tasks of the group are running on other threads
+		core::ScopedLock lock(_sleepLock);
+		_waiting.increment();
+		while (!group.done() && _queued == 0) {
+			_waitCondition.wait(_sleepLock);
+		}
+		_waiting.decrement();
+	}
+}
+
+void TaskScheduler::workerLoop(int worker) {
+	t_scheduler = this;
+	t_worker = worker;
+	for (;;) {
+		if (_stop && _force) {
+			break;
+		}
+		Task task;
+		if (pop(worker, task)) {
+			execute(task);
+			continue;
+		}
+		if (_stop && _queued == 0) {
+			break;
+		}
+		core::ScopedLock lock(_sleepLock);
+		_sleeping.increment();
+		while (_queued == 0 && !_stop) {
+			_sleepCondition.wait(_sleepLock);
+		}
+		_sleeping.decrement();
+	}
+	Log::debug(logid, "Shutdown worker thread %i", worker);
+	t_scheduler = nullptr;
+	t_worker = -1;
+}
+
+void TaskScheduler::init() {
+	_force = false;
+	_stop = false;
+	_workers.reserve(_threads);
+	for (size_t i = 0; i < _threads; ++i) {
+		_workers.emplace_back([this, i] {
+			const core::String n = core::string::format("%s-%i", this->_name, (int)i);
+			if (!setThreadName(n.c_str())) {
+				Log::error("Failed to set thread name for scheduler thread %i", (int)i);
+			}
+			core_trace_thread(n.c_str());
+			workerLoop((int)i);
+		});
+	}
+}
+
+void TaskScheduler::abort() {
+	Task task;
+	while (pop(-1, task)) {
+		discard(task);
+	}
+}
+
+void TaskScheduler::shutdown(bool wait) {
+	if (_stop) {
+		return;
+	}
+	_force = !wait;
+	_stop = true;
+	{
+		core::ScopedLock lock(_sleepLock);
+		_sleepCondition.notify_all();
+	}
+	for (std::thread &worker : _workers) {
+		worker.join();
+	}
+	_workers.clear();
+	// the groups of the tasks that were not executed are marked as done
+	abort();
+}
+
+}
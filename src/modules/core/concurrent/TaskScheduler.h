@@ -0,0 +1,268 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/Trace.h"
+#include "core/Log.h"
+#include <SDL_atomic.h>
+#include <cstddef>
+#include <stdint.h>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace core {
+
+/**
+ * @brief The lanes of the @c TaskScheduler - a task of a lower lane is only executed if there is nothing
+ * to do in the higher lanes (e.g. the chunks around the camera in @c High)
+ */
+enum class TaskPriority : uint8_t {
+	High, Normal, Low, Max
+};
+
+/**
+ * @brief Allows to skip tasks that were scheduled but are not yet executed.
+ *
+ * A task that is already running must check @c cancelled() on its own to stop early.
+ * @note The token must outlive the tasks it was handed to.
+ */
+class CancellationToken {
+private:
+	core::AtomicBool _cancelled { false };
+public:
+	inline void cancel() {
+		_cancelled = true;
+	}
+
+	inline void reset() {
+		_cancelled = false;
+	}
+
+	inline bool cancelled() const {
+		return _cancelled;
+	}
+};
+
+/**
+ * @brief Counts the not yet finished tasks that were scheduled for this group - use
+ * @c TaskScheduler::wait() to join them.
+ * @note The group must outlive the tasks it was handed to.
+ */
+class TaskGroup {
+private:
+	friend class TaskScheduler;
+	core::AtomicInt _pending { 0 };
+public:
+	inline int pending() const {
+		return _pending;
+	}
+
+	inline bool done() const {
+		return _pending == 0;
+	}
+};
+
+/**
+ * @brief Type erased functor with an inline storage of @c StorageSize bytes.
+ *
+ * Only functors (lambda captures) that don't fit into the inline storage are allocated on the heap.
+ */
+class Task final {
+public:
+	static constexpr size_t StorageSize = 48;
+private:
+	typedef void (*InvokeFunc)(void *storage);
+	/**
+	 * Move constructs the functor into @c dst and destroys the one in @c src - if @c dst is
+	 * @c nullptr the functor is just destroyed
+	 */
+	typedef void (*ManageFunc)(void *dst, void *src);
+
+	alignas(std::max_align_t) uint8_t _storage[StorageSize];
+	InvokeFunc _invoke = nullptr;
+	ManageFunc _manage = nullptr;
+	TaskGroup *_group = nullptr;
+	const CancellationToken *_token = nullptr;
+
+	void release();
+public:
+	Task() = default;
+
+	template<class F>
+	Task(F&& f, TaskGroup *group, const CancellationToken *token) :
+			_group(group), _token(token) {
+		typedef typename std::decay<F>::type Func;
+		if constexpr (sizeof(Func) <= StorageSize && alignof(Func) <= alignof(std::max_align_t)
+				&& std::is_nothrow_move_constructible<Func>::value) {
+			new (_storage) Func(std::forward<F>(f));
+			_invoke = [] (void *storage) {
+				(*(Func*)storage)();
+			};
+			_manage = [] (void *dst, void *src) {
+				Func *func = (Func*)src;
+				if (dst != nullptr) {
+					new (dst) Func(std::move(*func));
+				}
+				func->~Func();
+			};
+		} else {
+			new (_storage) Func*(new Func(std::forward<F>(f)));
+			_invoke = [] (void *storage) {
+				(**(Func**)storage)();
+			};
+			_manage = [] (void *dst, void *src) {
+				Func **func = (Func**)src;
+				if (dst != nullptr) {
+					new (dst) Func*(*func);
+				} else {
+					delete *func;
+				}
+			};
+		}
+	}
+
+	Task(Task&& other) noexcept;
+	Task& operator=(Task&& other) noexcept;
+	Task(const Task&) = delete;
+	Task& operator=(const Task&) = delete;
+
+	~Task() {
+		release();
+	}
+
+	inline bool valid() const {
+		return _invoke != nullptr;
+	}
+
+	inline bool cancelled() const {
+		return _token != nullptr && _token->cancelled();
+	}
+
+	inline TaskGroup* group() const {
+		return _group;
+	}
+
+	inline void operator()() {
+		_invoke(_storage);
+	}
+};
+
+/**
+ * @brief Work stealing task scheduler
+ *
+ * Every worker thread has its own queue per @c TaskPriority. Tasks that are scheduled from a worker
+ * thread are put into the queue of that worker, tasks from other threads are distributed round robin.
+ * A worker executes its own tasks in the order they were scheduled and steals the most recently scheduled
+ * tasks of the other workers if its own queues are empty - always starting with the highest lane.
+ *
+ * There are no futures - the tasks are fire-and-forget. Use a @c TaskGroup and @c wait() to join them and a
+ * @c CancellationToken to skip them. The queues are ring buffers that keep their memory, so scheduling
+ * a task that fits into the inline storage of @c Task doesn't allocate.
+ *
+ * @note @c wait() executes queued tasks while waiting - so it's fine to wait for a group from within a task.
+ * @sa ThreadPool
+ */
+class TaskScheduler final {
+private:
+	static constexpr auto logid = Log::logid("TaskScheduler");
+
+	class WorkQueue {
+	private:
+		SDL_SpinLock _lock = 0;
+		std::vector<Task> _tasks;
+		size_t _head = 0u;
+		size_t _count = 0u;
+
+		void grow();
+	public:
+		void push(Task&& task);
+		bool popFront(Task& task);
+		bool popBack(Task& task);
+	};
+
+	struct alignas(64) Worker {
+		WorkQueue queues[(int)TaskPriority::Max];
+	};
+
+	const size_t _threads;
+	const char *_name;
+	std::unique_ptr<Worker[]> _queues;
+	std::vector<std::thread> _workers;
+
+	core::AtomicInt _queued { 0 };
+	core::AtomicInt _sleeping { 0 };
+	core::AtomicInt _nextQueue { 0 };
+	// the threads that are blocked in wait()
+	core::AtomicInt _waiting { 0 };
+	core_trace_mutex(core::Lock, _sleepLock, "TaskSchedulerSleep");
+	core::ConditionVariable _sleepCondition;
+	// signaled if a task was queued or a group is done - see wait()
+	core::ConditionVariable _waitCondition;
+	core::AtomicBool _stop { false };
+	core::AtomicBool _force { false };
+
+	void push(Task&& task, TaskPriority priority);
+	/**
+	 * @param[in] worker The index of the worker that looks for work or @c -1 for other threads
+	 */
+	bool pop(int worker, Task& task);
+	void execute(Task& task);
+	void discard(Task& task);
+	void workerLoop(int worker);
+	int currentWorker() const;
+public:
+	/**
+	 * @param[in] threads The amount of worker threads - must be at least @c 1
+	 */
+	explicit TaskScheduler(size_t threads, const char *name = nullptr);
+	~TaskScheduler();
+
+	/**
+	 * @brief Schedule a functor or lambda
+	 * @param[in] group Optional group that the task is added to - see @c wait()
+	 * @param[in] token Optional token to skip the execution of the task
+	 * @return @c false if the scheduler is shutting down and the task was not scheduled
+	 */
+	template<class F>
+	bool schedule(F&& f, TaskPriority priority = TaskPriority::Normal, TaskGroup *group = nullptr,
+			const CancellationToken *token = nullptr) {
+		if (_stop) {
+			return false;
+		}
+		if (group != nullptr) {
+			group->_pending.increment();
+		}
+		push(Task(std::forward<F>(f), group, token), priority);
+		return true;
+	}
+
+	/**
+	 * @brief Blocks until all tasks of the given group are finished - the calling thread helps executing
+	 * the queued tasks in the meantime and sleeps if there are none
+	 */
+	void wait(TaskGroup& group);
+
+	size_t size() const;
+	void init();
+	/**
+	 * @brief Remove queued and not yet executed tasks
+	 * @note This does not abort the currently running tasks
+	 */
+	void abort();
+	void shutdown(bool wait = false);
+};
+
+inline size_t TaskScheduler::size() const {
+	return _threads;
+}
+
+}
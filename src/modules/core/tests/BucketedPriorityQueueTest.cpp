@@ -0,0 +1,101 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "core/collection/BucketedPriorityQueue.h"
+#include <chrono>
+#include <thread>
+
+namespace collection {
+
+class BucketedPriorityQueueTest : public testing::Test {
+public:
+	/**
+	 * @brief The distance to a reference value in steps of 10
+	 */
+	struct Ring {
+		int _ref;
+		Ring(int ref = 0) : _ref(ref) {
+		}
+		inline int operator()(int v) const {
+			return (v > _ref ? v - _ref : _ref - v) / 10;
+		}
+	};
+	using Queue = core::BucketedPriorityQueue<int, Ring, 8>;
+};
+
+TEST_F(BucketedPriorityQueueTest, testPushPop) {
+	Queue queue;
+	queue.push(35);
+	queue.push(5);
+	queue.push(1000);
+	queue.push(17);
+	ASSERT_EQ(4u, queue.size());
+	int v;
+	ASSERT_TRUE(queue.pop(v));
+	EXPECT_EQ(5, v);
+	ASSERT_TRUE(queue.pop(v));
+	EXPECT_EQ(17, v);
+	ASSERT_TRUE(queue.pop(v));
+	EXPECT_EQ(35, v);
+	ASSERT_TRUE(queue.pop(v));
+	EXPECT_EQ(1000, v) << "Values beyond the last bucket should end up in the last bucket";
+	ASSERT_FALSE(queue.pop(v));
+	ASSERT_TRUE(queue.empty());
+}
+
+TEST_F(BucketedPriorityQueueTest, testChangeBucketFunc) {
+	Queue queue;
+	for (int i = 0; i < 80; i += 10) {
+		queue.push(i);
+	}
+	queue.setBucketFunc(Ring(70));
+	for (int expected = 70; expected >= 0; expected -= 10) {
+		int v;
+		ASSERT_TRUE(queue.pop(v));
+		EXPECT_EQ(expected, v);
+	}
+}
+
+TEST_F(BucketedPriorityQueueTest, testClear) {
+	Queue queue;
+	queue.push(1);
+	queue.push(2);
+	queue.clear();
+	ASSERT_TRUE(queue.empty());
+	int v;
+	ASSERT_FALSE(queue.pop(v));
+	queue.push(3);
+	ASSERT_TRUE(queue.pop(v));
+	EXPECT_EQ(3, v);
+}
+
+TEST_F(BucketedPriorityQueueTest, testWaitAndPopConcurrent) {
+	Queue queue;
+	const int n = 1000;
+	std::thread thread([&] () {
+		for (int i = 0; i < n; ++i) {
+			queue.push(i);
+		}
+	});
+	for (int i = 0; i < n; ++i) {
+		int v;
+		ASSERT_TRUE(queue.waitAndPop(v));
+	}
+	thread.join();
+	ASSERT_TRUE(queue.empty());
+}
+
+TEST_F(BucketedPriorityQueueTest, testAbortWait) {
+	Queue queue;
+	std::thread threadWait([&] () {
+		int v;
+		ASSERT_FALSE(queue.waitAndPop(v));
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	queue.abortWait();
+	threadWait.join();
+}
+
+}
@@ -0,0 +1,137 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "core/collection/HashMap.h"
+#include "core/collection/StringMap.h"
+#include "core/SharedPtr.h"
+#include <unordered_map>
+
+namespace core {
+
+TEST(HashMapTest, testPutGet) {
+	core::HashMap<int64_t, int64_t, std::hash<int64_t>> map;
+	map.put(1, 1);
+	map.put(1, 2);
+	map.put(2, 1);
+	map.put(3, 1337);
+	EXPECT_EQ(3u, map.size());
+	int64_t value;
+	EXPECT_TRUE(map.get(1, value));
+	EXPECT_EQ(2, value);
+	EXPECT_TRUE(map.get(2, value));
+	EXPECT_EQ(1, value);
+	EXPECT_TRUE(map.get(3, value));
+	EXPECT_EQ(1337, value);
+	EXPECT_FALSE(map.get(4, value));
+}
+
+TEST(HashMapTest, testEmpty) {
+	core::HashMap<int64_t, int64_t> map;
+	EXPECT_EQ(0u, map.capacity());
+	EXPECT_TRUE(map.empty());
+	EXPECT_EQ(map.begin(), map.end());
+	EXPECT_EQ(map.find(1), map.end());
+	EXPECT_FALSE(map.remove(1));
+}
+
+TEST(HashMapTest, testGrow) {
+	core::HashMap<int64_t, int64_t> map;
+	const int64_t n = 100000;
+	for (int64_t i = 0; i < n; ++i) {
+		map.put(i, i * 2);
+	}
+	EXPECT_EQ((size_t)n, map.size());
+	EXPECT_GE(map.capacity(), (size_t)n);
+	for (int64_t i = 0; i < n; ++i) {
+		int64_t value;
+		ASSERT_TRUE(map.get(i, value)) << "Failed to find " << i;
+		ASSERT_EQ(i * 2, value);
+	}
+	EXPECT_FALSE(map.hasKey(n));
+}
+
+TEST(HashMapTest, testReserve) {
+	core::HashMap<int64_t, int64_t> map(1000);
+	const size_t capacity = map.capacity();
+	EXPECT_GE(capacity, 1000u);
+	for (int64_t i = 0; i < 1000; ++i) {
+		map.put(i, i);
+	}
+	EXPECT_EQ(capacity, map.capacity()) << "The map should not grow";
+}
+
+TEST(HashMapTest, testRemove) {
+	core::HashMap<int64_t, int64_t> map;
+	std::unordered_map<int64_t, int64_t> reference;
+	uint32_t seed = 1337u;
+	for (int i = 0; i < 20000; ++i) {
+		seed = seed * 1664525u + 1013904223u;
+		const int64_t key = (seed >> 8) % 2048;
+		if (seed & 1u) {
+			map.put(key, i);
+			reference[key] = i;
+		} else {
+			ASSERT_EQ(reference.erase(key) == 1u, map.remove(key));
+		}
+	}
+	ASSERT_EQ(reference.size(), map.size());
+	for (const auto& e : reference) {
+		int64_t value;
+		ASSERT_TRUE(map.get(e.first, value));
+		ASSERT_EQ(e.second, value);
+	}
+	size_t cnt = 0u;
+	for (auto iter : map) {
+		ASSERT_EQ(1u, reference.count(iter->key));
+		++cnt;
+	}
+	EXPECT_EQ(reference.size(), cnt);
+}
+
+TEST(HashMapTest, testStringLookup) {
+	core::StringMap<int> map;
+	map.put("foobar", 1);
+	map.put(core::String("barfoo"), 2);
+	int value;
+	EXPECT_TRUE(map.get("foobar", value));
+	EXPECT_EQ(1, value);
+	const char *key = "barfoo";
+	EXPECT_TRUE(map.get(key, value));
+	EXPECT_EQ(2, value);
+	EXPECT_TRUE(map.hasKey(core::String("foobar")));
+	EXPECT_FALSE(map.hasKey("FOOBAR"));
+	EXPECT_TRUE(map.remove(key));
+	EXPECT_EQ(1u, map.size());
+}
+
+TEST(HashMapTest, testCopyAndMove) {
+	core::StringMap<core::SharedPtr<core::String>> map;
+	auto foobar = core::SharedPtr<core::String>::create("foobar");
+	map.put("foobar", foobar);
+	EXPECT_EQ(2, foobar.use_count());
+	core::StringMap<core::SharedPtr<core::String>> copy = map;
+	EXPECT_EQ(3, foobar.use_count());
+	core::StringMap<core::SharedPtr<core::String>> moved(core::move(copy));
+	EXPECT_EQ(3, foobar.use_count());
+	EXPECT_TRUE(copy.empty());
+	EXPECT_EQ(1u, moved.size());
+	map = moved;
+	EXPECT_EQ(3, foobar.use_count());
+	moved.clear();
+	map.clear();
+	EXPECT_EQ(1, foobar.use_count());
+}
+
+TEST(HashMapTest, testErase) {
+	core::StringMap<int> map;
+	map.put("foobar", 1);
+	auto iter = map.find("foobar");
+	ASSERT_NE(iter, map.end());
+	EXPECT_EQ(1, iter->value);
+	map.erase(iter);
+	EXPECT_TRUE(map.empty());
+}
+
+}
@@ -0,0 +1,69 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "core/LZ4.h"
+#include <vector>
+
+namespace core {
+
+class LZ4Test: public testing::Test {
+protected:
+	void roundTrip(const std::vector<uint8_t>& input) {
+		std::vector<uint8_t> compressed(lz4::compressBound((uint32_t)input.size()));
+		size_t compressedSize = 0;
+		ASSERT_TRUE(lz4::compress(input.data(), input.size(), compressed.data(), compressed.size(), &compressedSize));
+		ASSERT_LE(compressedSize, compressed.size());
+
+		std::vector<uint8_t> output(input.size());
+		size_t finalSize = 0;
+		ASSERT_TRUE(lz4::uncompress(compressed.data(), compressedSize, output.data(), output.size(), &finalSize));
+		ASSERT_EQ(input.size(), finalSize);
+		EXPECT_EQ(input, output);
+	}
+};
+
+TEST_F(LZ4Test, testCompressRuns) {
+	std::vector<uint8_t> input(64 * 1024, 0);
+	for (size_t i = 0u; i < input.size() / 2; i += 2) {
+		input[i + 0] = 3;
+		input[i + 1] = (uint8_t)(i / 1000);
+	}
+	std::vector<uint8_t> compressed(lz4::compressBound((uint32_t)input.size()));
+	size_t compressedSize = 0;
+	ASSERT_TRUE(lz4::compress(input.data(), input.size(), compressed.data(), compressed.size(), &compressedSize));
+	EXPECT_LT(compressedSize, input.size() / 50) << "Expected runs to compress well";
+	roundTrip(input);
+}
+
+TEST_F(LZ4Test, testRoundTrip) {
+	std::vector<uint8_t> input(100000);
+	uint32_t state = 1u;
+	for (size_t i = 0u; i < input.size(); ++i) {
+		state = state * 1103515245u + 12345u;
+		// mix random bytes with repeated sequences of different lengths and distances
+		input[i] = (i % 1000) < 300 ? (uint8_t)(state >> 16) : input[i - (1 + (i / 1000) % 700) % i];
+	}
+	roundTrip(input);
+}
+
+TEST_F(LZ4Test, testSmallInputs) {
+	for (size_t size = 1u; size < 40u; ++size) {
+		roundTrip(std::vector<uint8_t>(size, (uint8_t)size));
+	}
+}
+
+TEST_F(LZ4Test, testCorruptedInput) {
+	std::vector<uint8_t> input(4096, 7);
+	std::vector<uint8_t> compressed(lz4::compressBound((uint32_t)input.size()));
+	size_t compressedSize = 0;
+	ASSERT_TRUE(lz4::compress(input.data(), input.size(), compressed.data(), compressed.size(), &compressedSize));
+	std::vector<uint8_t> output(input.size());
+	// truncated input
+	EXPECT_FALSE(lz4::uncompress(compressed.data(), compressedSize - 3, output.data(), output.size()));
+	// output buffer too small
+	EXPECT_FALSE(lz4::uncompress(compressed.data(), compressedSize, output.data(), output.size() / 2));
+}
+
+}
@@ -0,0 +1,90 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "core/collection/MPMCQueue.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace collection {
+
+class MPMCQueueTest : public testing::Test {
+};
+
+TEST_F(MPMCQueueTest, testPushPop) {
+	core::MPMCQueue<int> queue(16);
+	ASSERT_EQ(16u, queue.capacity());
+	for (int i = 0; i < 16; ++i) {
+		ASSERT_TRUE(queue.push(i));
+	}
+	ASSERT_FALSE(queue.push(16)) << "The queue should be full";
+	ASSERT_EQ(16u, queue.size());
+	for (int i = 0; i < 16; ++i) {
+		int v;
+		ASSERT_TRUE(queue.pop(v));
+		ASSERT_EQ(i, v);
+	}
+	int v;
+	ASSERT_FALSE(queue.pop(v)) << "The queue should be empty";
+	ASSERT_TRUE(queue.empty());
+}
+
+TEST_F(MPMCQueueTest, testCapacity) {
+	core::MPMCQueue<int> queue(10);
+	ASSERT_EQ(16u, queue.capacity());
+}
+
+TEST_F(MPMCQueueTest, testWrapAround) {
+	core::MPMCQueue<int> queue(4);
+	for (int i = 0; i < 100; ++i) {
+		ASSERT_TRUE(queue.push(i));
+		ASSERT_TRUE(queue.push(i + 1));
+		int v;
+		ASSERT_TRUE(queue.pop(v));
+		ASSERT_EQ(i, v);
+		ASSERT_TRUE(queue.pop(v));
+		ASSERT_EQ(i + 1, v);
+	}
+}
+
+TEST_F(MPMCQueueTest, testMultipleThreads) {
+	core::MPMCQueue<int> queue(64);
+	const int producers = 4;
+	const int consumers = 4;
+	const int n = 10000;
+	std::atomic_int popped { 0 };
+	std::atomic<int64_t> sum { 0 };
+	std::vector<std::thread> threads;
+	for (int p = 0; p < producers; ++p) {
+		threads.emplace_back([&] () {
+			for (int i = 1; i <= n; ++i) {
+				while (!queue.push(i)) {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+	for (int c = 0; c < consumers; ++c) {
+		threads.emplace_back([&] () {
+			while (popped < producers * n) {
+				int v;
+				if (queue.pop(v)) {
+					sum += v;
+					++popped;
+				} else {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+	for (std::thread& t : threads) {
+		t.join();
+	}
+	ASSERT_EQ(producers * n, popped);
+	ASSERT_EQ((int64_t)producers * n * (n + 1) / 2, sum);
+	ASSERT_TRUE(queue.empty());
+}
+
+}
@@ -8,7 +8,7 @@
 
 namespace core {
 
-TEST(HashMapTest, testPutGet) {
+TEST(MapTest, testPutGet) {
 	core::Map<int64_t, int64_t, 11, std::hash<int64_t>> map;
 	map.put(1, 1);
 	map.put(1, 2);
@@ -32,7 +32,7 @@ TEST(HashMapTest, testPutGet) {
 	EXPECT_EQ(1111, value);
 }
 
-TEST(HashMapTest, testCollision) {
+TEST(MapTest, testCollision) {
 	core::Map<int64_t, int64_t, 11, std::hash<int64_t>> map;
 	for (int64_t i = 0; i < 128; ++i) {
 		map.put(i, i);
@@ -44,7 +44,7 @@ TEST(HashMapTest, testCollision) {
 	}
 }
 
-TEST(HashMapTest, testClear) {
+TEST(MapTest, testClear) {
 	core::Map<int64_t, int64_t, 11, std::hash<int64_t>> map;
 	for (int64_t i = 0; i < 16; ++i) {
 		map.put(i, i);
@@ -56,7 +56,7 @@ TEST(HashMapTest, testClear) {
 	EXPECT_TRUE(map.empty());
 }
 
-TEST(HashMapTest, testFind) {
+TEST(MapTest, testFind) {
 	core::Map<int64_t, int64_t, 11, std::hash<int64_t>> map;
 	for (int64_t i = 0; i < 1024; i += 2) {
 		map.put(i, i);
@@ -69,7 +69,7 @@ TEST(HashMapTest, testFind) {
 	EXPECT_EQ(map.end(), iter);
 }
 
-TEST(HashMapTest, testIterator) {
+TEST(MapTest, testIterator) {
 	core::Map<int64_t, int64_t, 11, std::hash<int64_t>> map;
 	EXPECT_EQ(map.begin(), map.end());
 	EXPECT_EQ(map.end(), map.find(42));
@@ -78,7 +78,7 @@ TEST(HashMapTest, testIterator) {
 	EXPECT_EQ(++map.begin(), map.end());
 }
 
-TEST(HashMapTest, testIterate) {
+TEST(MapTest, testIterate) {
 	// leave empty buckets
 	core::Map<int64_t, int64_t, 11, std::hash<int64_t>> map;
 	for (int64_t i = 0; i < 32; i += 2) {
@@ -102,7 +102,7 @@ TEST(HashMapTest, testIterate) {
 	EXPECT_EQ(1024, cnt);
 }
 
-TEST(HashMapTest, testIterateRangeBased) {
+TEST(MapTest, testIterateRangeBased) {
 	core::Map<int64_t, int64_t, 11, std::hash<int64_t>> map;
 	for (int64_t i = 0; i < 32; i += 2) {
 		map.put(i, i);
@@ -116,8 +116,8 @@ TEST(HashMapTest, testIterateRangeBased) {
 	EXPECT_EQ(16, cnt);
 }
 
-TEST(HashMapTest, testStringSharedPtr) {
-	core::StringMap<core::SharedPtr<core::String>, 4> map;
+TEST(MapTest, testStringSharedPtr) {
+	core::StringMap<core::SharedPtr<core::String>> map;
 	auto foobar = core::SharedPtr<core::String>::create("foobar");
 	map.put("foobar", foobar);
 	map.put("barfoo", core::SharedPtr<core::String>::create("barfoo"));
@@ -128,14 +128,14 @@ TEST(HashMapTest, testStringSharedPtr) {
 	foobar = core::SharedPtr<core::String>();
 }
 
-TEST(HashMapTest, testCopy) {
+TEST(MapTest, testCopy) {
 	core::StringMap<core::SharedPtr<core::String>> map;
 	map.put("foobar", core::SharedPtr<core::String>::create("barfoo"));
 	auto map2 = map;
 	map2.clear();
 }
 
-TEST(HashMapTest, testErase) {
+TEST(MapTest, testErase) {
 	core::StringMap<core::SharedPtr<core::String>> map;
 	map.put("foobar", core::SharedPtr<core::String>::create("barfoo"));
 	EXPECT_EQ(1u, map.size());
@@ -145,7 +145,7 @@ TEST(HashMapTest, testErase) {
 	EXPECT_EQ(0u, map.size());
 }
 
-TEST(HashMapTest, testAssign) {
+TEST(MapTest, testAssign) {
 	core::StringMap<core::SharedPtr<core::String>> map;
 	map.put("foobar", core::SharedPtr<core::String>::create("barfoo"));
 	core::StringMap<core::SharedPtr<core::String>> map2;
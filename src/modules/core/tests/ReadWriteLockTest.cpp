@@ -77,4 +77,33 @@ TEST_F(ReadWriteLockTest, testMoreWritersThanReaders) {
 	EXPECT_EQ(n1, limit);
 }
 
+TEST(SharedLockTest, testConcurrentReaders) {
+	core::SharedLock lock;
+	lock.lockRead();
+	// another reader must get the lock while it's held for reading
+	auto futureRead = std::async(std::launch::async, [&] {
+		core::ScopedReadLock scoped(lock);
+	});
+	const bool read = futureRead.wait_for(std::chrono::seconds(10)) == std::future_status::ready;
+	lock.unlockRead();
+	EXPECT_TRUE(read);
+}
+
+TEST(SharedLockTest, testWriters) {
+	core::SharedLock lock;
+	int value = 0;
+	const int limit = 100000;
+	auto write = [&] {
+		for (int i = 0; i < limit; ++i) {
+			core::ScopedWriteLock scoped(lock);
+			++value;
+		}
+	};
+	auto futureWrite1 = std::async(std::launch::async, write);
+	auto futureWrite2 = std::async(std::launch::async, write);
+	futureWrite1.wait();
+	futureWrite2.wait();
+	EXPECT_EQ(limit * 2, value);
+}
+
 }
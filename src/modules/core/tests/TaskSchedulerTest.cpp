@@ -0,0 +1,183 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "core/concurrent/TaskScheduler.h"
+#include "core/concurrent/Atomic.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace core {
+
+class TaskSchedulerTest: public testing::Test {
+public:
+	core::AtomicInt _count;
+
+	void SetUp() override {
+		_count = 0;
+	}
+
+	static int fib(TaskScheduler& scheduler, int n) {
+		if (n < 2) {
+			return n;
+		}
+		int a = 0;
+		TaskGroup group;
+		scheduler.schedule([&] () {
+			a = fib(scheduler, n - 1);
+		}, TaskPriority::Normal, &group);
+		const int b = fib(scheduler, n - 2);
+		scheduler.wait(group);
+		return a + b;
+	}
+};
+
+TEST_F(TaskSchedulerTest, testSchedule) {
+	TaskScheduler scheduler(1);
+	scheduler.init();
+	TaskGroup group;
+	ASSERT_TRUE(scheduler.schedule([this] () {
+		++_count;
+	}, TaskPriority::Normal, &group));
+	scheduler.wait(group);
+	ASSERT_EQ(1, _count) << "Task wasn't executed";
+}
+
+TEST_F(TaskSchedulerTest, testMultipleSchedule) {
+	const int x = 1000;
+	TaskScheduler scheduler(2);
+	scheduler.init();
+	for (int i = 0; i < x; ++i) {
+		scheduler.schedule([this] () {
+			++_count;
+		});
+	}
+	scheduler.shutdown(true);
+	ASSERT_EQ(x, _count) << "Not all tasks were executed";
+}
+
+TEST_F(TaskSchedulerTest, testForkJoin) {
+	TaskScheduler scheduler(4);
+	scheduler.init();
+	EXPECT_EQ(610, fib(scheduler, 15));
+}
+
+TEST_F(TaskSchedulerTest, testWaitForRunningTask) {
+	TaskScheduler scheduler(1);
+	scheduler.init();
+	TaskGroup group;
+	// the waiting thread has nothing to execute while the first task runs - and is woken up for the task that
+	// is scheduled afterwards
+	ASSERT_TRUE(scheduler.schedule([&] () {
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		scheduler.schedule([this] () {
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			++_count;
+		}, TaskPriority::Normal, &group);
+		++_count;
+	}, TaskPriority::Normal, &group));
+	scheduler.wait(group);
+	EXPECT_EQ(2, _count);
+	EXPECT_TRUE(group.done());
+}
+
+TEST_F(TaskSchedulerTest, testLargeTask) {
+	TaskScheduler scheduler(2);
+	scheduler.init();
+	uint8_t payload[Task::StorageSize * 2];
+	for (size_t i = 0; i < sizeof(payload); ++i) {
+		payload[i] = (uint8_t)i;
+	}
+	TaskGroup group;
+	scheduler.schedule([this, payload] () {
+		_count = payload[sizeof(payload) - 1];
+	}, TaskPriority::Normal, &group);
+	scheduler.wait(group);
+	ASSERT_EQ((int)(uint8_t)(sizeof(payload) - 1), _count);
+}
+
+TEST_F(TaskSchedulerTest, testCancel) {
+	TaskScheduler scheduler(1);
+	scheduler.init();
+	core::AtomicBool started { false };
+	core::AtomicBool release { false };
+	TaskGroup group;
+	scheduler.schedule([&] () {
+		started = true;
+		while (!release) {
+			std::this_thread::yield();
+		}
+	}, TaskPriority::Normal, &group);
+	while (!started) {
+		std::this_thread::yield();
+	}
+	CancellationToken token;
+	for (int i = 0; i < 10; ++i) {
+		scheduler.schedule([this] () {
+			++_count;
+		}, TaskPriority::Normal, &group, &token);
+	}
+	token.cancel();
+	release = true;
+	scheduler.wait(group);
+	ASSERT_EQ(0, _count) << "Cancelled tasks were executed";
+}
+
+TEST_F(TaskSchedulerTest, testPriority) {
+	TaskScheduler scheduler(1);
+	scheduler.init();
+	core::AtomicBool started { false };
+	core::AtomicBool release { false };
+	scheduler.schedule([&] () {
+		started = true;
+		while (!release) {
+			std::this_thread::yield();
+		}
+	});
+	while (!started) {
+		std::this_thread::yield();
+	}
+	std::vector<TaskPriority> order;
+	const TaskPriority priorities[] = {TaskPriority::Low, TaskPriority::Normal, TaskPriority::High};
+	for (TaskPriority priority : priorities) {
+		scheduler.schedule([&order, priority] () {
+			order.push_back(priority);
+		}, priority);
+	}
+	release = true;
+	scheduler.shutdown(true);
+	ASSERT_EQ(3u, order.size());
+	EXPECT_EQ(TaskPriority::High, order[0]);
+	EXPECT_EQ(TaskPriority::Normal, order[1]);
+	EXPECT_EQ(TaskPriority::Low, order[2]);
+}
+
+TEST_F(TaskSchedulerTest, testAbort) {
+	TaskScheduler scheduler(1);
+	scheduler.init();
+	core::AtomicBool started { false };
+	core::AtomicBool release { false };
+	TaskGroup group;
+	scheduler.schedule([&] () {
+		started = true;
+		while (!release) {
+			std::this_thread::yield();
+		}
+	}, TaskPriority::Normal, &group);
+	while (!started) {
+		std::this_thread::yield();
+	}
+	for (int i = 0; i < 10; ++i) {
+		scheduler.schedule([this] () {
+			++_count;
+		}, TaskPriority::Normal, &group);
+	}
+	scheduler.abort();
+	release = true;
+	scheduler.wait(group);
+	ASSERT_EQ(0, _count) << "Aborted tasks were executed";
+}
+
+}
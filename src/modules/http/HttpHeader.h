@@ -9,6 +9,11 @@
 namespace http {
 
 using HeaderMap = core::CharPointerMap;
+/**
+ * @brief The max amount of header entries of a request or response. The entries of the map are
+ * allocated up front - the default size of the map would be initialized for every request.
+ */
+static constexpr int MaxHeaders = 64;
 
 namespace header {
 
@@ -7,14 +7,15 @@
 
 namespace http {
 
-HttpParser::HttpParser(uint8_t* buffer, const size_t bufferSize) :
-		buf(buffer), bufSize(bufferSize) {
+HttpParser::HttpParser(uint8_t* buffer, const size_t bufferSize, bool freeBuffer) :
+		buf(buffer), bufSize(bufferSize), _freeBuffer(freeBuffer) {
 }
 
 HttpParser& HttpParser::operator=(HttpParser&& other) noexcept {
 	buf = other.buf;
 	bufSize = other.bufSize;
 	_valid = other._valid;
+	_freeBuffer = other._freeBuffer;
 	protocolVersion = other.protocolVersion;
 	headers = HTTP_PARSER_NEW_BASE_CHARPTR_MAP(other.headers);
 	content = other.content;
@@ -34,6 +35,7 @@ HttpParser::HttpParser(HttpParser&& other) noexcept {
 	buf = other.buf;
 	bufSize = other.bufSize;
 	_valid = other._valid;
+	_freeBuffer = other._freeBuffer;
 	protocolVersion = other.protocolVersion;
 	headers = HTTP_PARSER_NEW_BASE_CHARPTR_MAP(other.headers);
 	content = other.content;
@@ -55,6 +57,7 @@ HttpParser& HttpParser::operator=(const HttpParser& other) {
 	SDL_memcpy(buf, other.buf, other.bufSize);
 	bufSize = other.bufSize;
 	_valid = other._valid;
+	_freeBuffer = true;
 
 	protocolVersion = HTTP_PARSER_NEW_BASE(other.protocolVersion);
 
@@ -71,6 +74,7 @@ HttpParser::HttpParser(const HttpParser& other) {
 	SDL_memcpy(buf, other.buf, other.bufSize);
 	bufSize = other.bufSize;
 	_valid = other._valid;
+	_freeBuffer = true;
 
 	protocolVersion = HTTP_PARSER_NEW_BASE(other.protocolVersion);
 
@@ -82,7 +86,9 @@ HttpParser::HttpParser(const HttpParser& other) {
 }
 
 HttpParser::~HttpParser() {
-	SDL_free(buf);
+	if (_freeBuffer) {
+		SDL_free(buf);
+	}
 	buf = nullptr;
 	bufSize = 0;
 }
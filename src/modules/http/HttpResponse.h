@@ -13,7 +13,7 @@
 namespace http {
 
 struct HttpResponse {
-	HeaderMap headers;
+	HeaderMap headers { MaxHeaders };
 	HttpStatus status = HttpStatus::Ok;
 	// the memory is managed by the server and freed after the response was sent.
 	const char *body = nullptr;
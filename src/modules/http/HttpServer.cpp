@@ -4,24 +4,175 @@
 
 #include "HttpServer.h"
 #include "RequestParser.h"
+#include "Network.h"
+#include "Network.cpp.h"
 #include "core/Assert.h"
 #include "core/ArrayLength.h"
+#include "core/Common.h"
 #include "core/Log.h"
-#include "Network.cpp.h"
+#include "core/Trace.h"
 #include "app/App.h"
+#include <uv.h>
 #include <string.h>
 #include <SDL_stdinc.h>
 
 namespace http {
 
+/**
+ * The amount of responses of a client that are not yet written to the socket - pipelined requests
+ * are not handled (and the client is not read from) until some of them were written
+ */
+static constexpr int MaxPendingWrites = 64;
+/** the min free space of the receive buffer for the next read */
+static constexpr size_t MinReceiveSpace = 4096u;
+static constexpr size_t MaxHeaderSize = 4096u;
+
+struct HttpServer::Client {
+	uv_tcp_t handle;
+	HttpServer *server = nullptr;
+	/**
+	 * The receive buffer is reused for all requests of the connection - [start, end) are the received
+	 * bytes that are not yet handled. There is always one byte left after @c end to terminate the request.
+	 */
+	uint8_t *buf = nullptr;
+	size_t capacity = 0u;
+	size_t start = 0u;
+	size_t end = 0u;
+	/** the bytes after @c start that were already searched for the end of the header */
+	size_t scanned = 0u;
+	int pendingWrites = 0;
+	bool reading = false;
+	bool closeAfterWrite = false;
+	bool closing = false;
+};
+
+struct HttpServer::WriteRequest {
+	uv_write_t req;
+	Client *client = nullptr;
+	/** the body is written from the memory of the route handler - see @c HttpResponse::freeBody */
+	const char *body = nullptr;
+	bool freeBody = false;
+	char header[MaxHeaderSize];
+};
+
+struct HttpServer::Callbacks {
+	static void onConnection(uv_stream_t* server, int status) {
+		HttpServer* self = (HttpServer*)server->data;
+		if (status < 0) {
+			Log::debug("Failed to accept a connection: %s", uv_strerror(status));
+			return;
+		}
+		Client* client = new Client();
+		client->server = self;
+		uv_tcp_init(self->_loop, &client->handle);
+		client->handle.data = client;
+		if (uv_accept(server, (uv_stream_t*)&client->handle) != 0) {
+			self->closeClient(client);
+			return;
+		}
+		uv_tcp_nodelay(&client->handle, 1);
+		client->reading = uv_read_start((uv_stream_t*)&client->handle, onAlloc, onRead) == 0;
+		if (!client->reading) {
+			self->closeClient(client);
+		}
+	}
+
+	static void onAlloc(uv_handle_t* handle, size_t suggestedSize, uv_buf_t* buf) {
+		Client* client = (Client*)handle->data;
+		if (client->start == client->end) {
+			client->start = client->end = client->scanned = 0u;
+		}
+		if (client->capacity - client->end < MinReceiveSpace + 1u) {
+			// move the not yet handled bytes of a partial request to the front before growing the buffer
+			if (client->start > 0u) {
+				memmove(client->buf, client->buf + client->start, client->end - client->start);
+				client->end -= client->start;
+				client->start = 0u;
+			}
+			if (client->capacity - client->end < MinReceiveSpace + 1u) {
+				const size_t capacity = core_max(client->capacity * 2u, client->end + MinReceiveSpace + 1u);
+				uint8_t *newBuf = (uint8_t*)SDL_realloc(client->buf, capacity);
+				if (newBuf == nullptr) {
+					// libuv reports UV_ENOBUFS to onRead() - and the client is closed there
+					Log::error("Failed to allocate %u bytes for the receive buffer", (unsigned int)capacity);
+					*buf = uv_buf_init(nullptr, 0);
+					return;
+				}
+				client->buf = newBuf;
+				client->capacity = capacity;
+			}
+		}
+		*buf = uv_buf_init((char*)client->buf + client->end, (unsigned int)(client->capacity - client->end - 1u));
+	}
+
+	static void onRead(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+		Client* client = (Client*)stream->data;
+		if (nread < 0) {
+			// UV_EOF or error
+			client->server->closeClient(client);
+			return;
+		}
+		client->end += (size_t)nread;
+		client->server->handleRequests(client);
+	}
+
+	static void onWrite(uv_write_t* req, int status) {
+		WriteRequest* writeRequest = (WriteRequest*)req;
+		Client* client = writeRequest->client;
+		HttpServer* self = client->server;
+		if (writeRequest->freeBody) {
+			SDL_free((char*)writeRequest->body);
+		}
+		writeRequest->body = nullptr;
+		self->_freeWriteRequests.push_back(writeRequest);
+		--client->pendingWrites;
+		if (status < 0) {
+			Log::debug("Failed to send to the client: %s", uv_strerror(status));
+			self->closeClient(client);
+			return;
+		}
+		if (client->closeAfterWrite) {
+			if (client->pendingWrites == 0) {
+				self->closeClient(client);
+			}
+			return;
+		}
+		if (!client->reading && client->pendingWrites <= MaxPendingWrites / 2) {
+			self->handleRequests(client);
+			if (!client->closing && !client->closeAfterWrite && client->pendingWrites < MaxPendingWrites) {
+				client->reading = uv_read_start((uv_stream_t*)&client->handle, onAlloc, onRead) == 0;
+			}
+		}
+	}
+
+	static void onCloseClient(uv_handle_t* handle) {
+		Client* client = (Client*)handle->data;
+		SDL_free(client->buf);
+		delete client;
+	}
+
+	static void onCloseServer(uv_handle_t* handle) {
+		delete (uv_tcp_t*)handle;
+	}
+
+	static void onWalk(uv_handle_t* handle, void* arg) {
+		HttpServer* self = (HttpServer*)arg;
+		if (handle == (uv_handle_t*)self->_server) {
+			if (!uv_is_closing(handle)) {
+				uv_close(handle, onCloseServer);
+			}
+			return;
+		}
+		self->closeClient((Client*)handle->data);
+	}
+};
+
 HttpServer::HttpServer(const metric::MetricPtr& metric) :
-		_socketFD(INVALID_SOCKET), _metric(metric) {
-	FD_ZERO(&_readFDSet);
-	FD_ZERO(&_writeFDSet);
+		_metric(metric) {
 }
 
 HttpServer::~HttpServer() {
-	core_assert(_socketFD == INVALID_SOCKET);
+	core_assert(_loop == nullptr);
 }
 
 void HttpServer::setErrorText(HttpStatus status, const char *body) {
@@ -32,7 +183,7 @@ void HttpServer::setErrorText(HttpStatus status, const char *body) {
 	_errorPages.put((int)status, SDL_strdup(body));
 }
 
-HttpServer::Routes* HttpServer::getRoutes(HttpMethod method) {
+Router* HttpServer::getRoutes(HttpMethod method) {
 	if (method == HttpMethod::GET) {
 		return &_routes[0];
 	} else /* if (method == HttpMethod::POST) */ {
@@ -42,244 +193,273 @@ HttpServer::Routes* HttpServer::getRoutes(HttpMethod method) {
 }
 
 void HttpServer::registerRoute(HttpMethod method, const char *path, const RouteCallback& callback) {
-	Routes* routes = getRoutes(method);
+	Router* routes = getRoutes(method);
 	Log::info("Register callback for %s", path);
 	routes->put(path, callback);
 }
 
 bool HttpServer::unregisterRoute(HttpMethod method, const char *path) {
-	Routes* routes = getRoutes(method);
+	Router* routes = getRoutes(method);
 	return routes->remove(path);
 }
 
 bool HttpServer::init(int16_t port) {
-	_socketFD = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
-	if (_socketFD == INVALID_SOCKET) {
-		network_cleanup();
+	// ignore SIGPIPE - a client might close the connection while we are still writing to it
+	if (!networkInit()) {
 		return false;
 	}
-	struct sockaddr_in sin;
-	SDL_memset(&sin, 0, sizeof(sin));
-	sin.sin_family = AF_INET;
-	sin.sin_addr.s_addr = INADDR_ANY;
-	sin.sin_port = htons(port);
-
-	FD_ZERO(&_readFDSet);
-	FD_ZERO(&_writeFDSet);
-
-	int t = 1;
-#ifdef _WIN32
-	if (setsockopt(_socketFD, SOL_SOCKET, SO_REUSEADDR, (char*) &t, sizeof(t)) != 0) {
-#else
-	if (setsockopt(_socketFD, SOL_SOCKET, SO_REUSEADDR, &t, sizeof(t)) != 0) {
-#endif
-		network_cleanup();
-		closesocket(_socketFD);
-		_socketFD = INVALID_SOCKET;
+	_loop = new uv_loop_t;
+	if (uv_loop_init(_loop) != 0) {
+		delete _loop;
+		_loop = nullptr;
 		return false;
 	}
-
-	if (bind(_socketFD, (struct sockaddr *) &sin, sizeof(sin)) < 0) {
-		network_cleanup();
-		closesocket(_socketFD);
-		_socketFD = INVALID_SOCKET;
-		return false;
+	_server = new uv_tcp_t;
+	uv_tcp_init(_loop, _server);
+	_server->data = this;
+
+	struct sockaddr_in addr;
+	uv_ip4_addr("0.0.0.0", port, &addr);
+	int err = uv_tcp_bind(_server, (const struct sockaddr*)&addr, 0);
+	if (err == 0) {
+		err = uv_listen((uv_stream_t*)_server, SOMAXCONN, Callbacks::onConnection);
 	}
-
-	if (listen(_socketFD, 5) < 0) {
-		network_cleanup();
-		closesocket(_socketFD);
-		_socketFD = INVALID_SOCKET;
+	if (err != 0) {
+		Log::error("Failed to listen on port %i: %s", (int)port, uv_strerror(err));
+		shutdown();
 		return false;
 	}
-
-	networkNonBlocking(_socketFD);
-
-	FD_SET(_socketFD, &_readFDSet);
-
 	return true;
 }
 
-HttpServer::ClientSocketsIter HttpServer::closeClient(ClientSocketsIter& iter) {
-	Client& client = *iter;
-	const SOCKET clientSocket = client.socket;
-	FD_CLR(clientSocket, &_readFDSet);
-	FD_CLR(clientSocket, &_writeFDSet);
-	closesocket(clientSocket);
-	client.socket = INVALID_SOCKET;
-	SDL_free(client.request);
-	SDL_free(client.response);
-	return _clientSockets.erase(iter);
+void HttpServer::closeClient(Client* client) {
+	if (client->closing) {
+		return;
+	}
+	client->closing = true;
+	uv_close((uv_handle_t*)&client->handle, Callbacks::onCloseClient);
 }
 
 bool HttpServer::update() {
 	core_trace_scoped(HttpServerUpdate);
-	fd_set readFDsOut;
-	fd_set writeFDsOut;
-
-	SDL_memcpy(&readFDsOut, &_readFDSet, sizeof(readFDsOut));
-	SDL_memcpy(&writeFDsOut, &_writeFDSet, sizeof(writeFDsOut));
-
-	struct timeval tv;
-	tv.tv_sec = 0;
-	tv.tv_usec = 0;
-	const int ready = select(FD_SETSIZE, &readFDsOut, &writeFDsOut, nullptr, &tv);
-	if (ready < 0) {
+	if (_loop == nullptr) {
 		return false;
 	}
-	if (_socketFD != INVALID_SOCKET && FD_ISSET(_socketFD, &readFDsOut)) {
-		const SOCKET clientSocket = accept(_socketFD, nullptr, nullptr);
-		if (clientSocket != INVALID_SOCKET) {
-			FD_SET(clientSocket, &_readFDSet);
-			Client c;
-			c.socket = clientSocket;
-			_clientSockets.insert(c);
-			networkNonBlocking(clientSocket);
+	uv_run(_loop, UV_RUN_NOWAIT);
+	return true;
+}
+
+int64_t HttpServer::requestSize(Client* client) {
+	const char *data = (const char*)client->buf + client->start;
+	const size_t len = client->end - client->start;
+	// continue the search for the end of the header where the last read stopped
+	size_t headerSize = 0u;
+	for (size_t i = client->scanned >= 3u ? client->scanned - 3u : 0u; i + 4u <= len; ++i) {
+		if (data[i] == '\r' && data[i + 1] == '\n' && data[i + 2] == '\r' && data[i + 3] == '\n') {
+			headerSize = i + 4u;
+			break;
 		}
 	}
+	if (headerSize == 0u) {
+		client->scanned = len;
+		return len > _maxRequestBytes ? -1 : 0;
+	}
 
-	for (ClientSocketsIter i = _clientSockets.begin(); i != _clientSockets.end();) {
-		Client& client = *i;
-		const SOCKET clientSocket = client.socket;
-		if (clientSocket == INVALID_SOCKET) {
-			i = closeClient(i);
-			continue;
+	size_t contentLength = 0u;
+	const size_t contentLengthHeaderSize = SDL_strlen(header::CONTENT_LENGTH);
+	for (const char *line = data; line < data + headerSize;) {
+		const char *lineEnd = (const char*)memchr(line, '\n', data + headerSize - line);
+		if (lineEnd == nullptr) {
+			break;
 		}
-
-		if (FD_ISSET(clientSocket, &writeFDsOut)) {
-			if (!sendMessage(client) || client.finished()) {
-				i = closeClient(i);
-			} else {
-				++i;
+		if ((size_t)(lineEnd - line) > contentLengthHeaderSize && line[contentLengthHeaderSize] == ':'
+				&& SDL_strncasecmp(line, header::CONTENT_LENGTH, contentLengthHeaderSize) == 0) {
+			const char *c = line + contentLengthHeaderSize + 1;
+			const char *valueEnd = lineEnd;
+			while (c < valueEnd && (*c == ' ' || *c == '\t')) {
+				++c;
 			}
-			continue;
-		}
-
-		if (!FD_ISSET(clientSocket, &readFDsOut)) {
-			++i;
-			continue;
+			while (valueEnd > c && (valueEnd[-1] == '\r' || valueEnd[-1] == ' ' || valueEnd[-1] == '\t')) {
+				--valueEnd;
+			}
+			if (c == valueEnd) {
+				return -2;
+			}
+			for (; c < valueEnd; ++c) {
+				if (*c < '0' || *c > '9') {
+					return -2;
+				}
+				contentLength = contentLength * 10u + (size_t)(*c - '0');
+				if (contentLength > _maxRequestBytes) {
+					return -1;
+				}
+			}
+			break;
 		}
+		line = lineEnd + 1;
+	}
+	const size_t requestSize = headerSize + contentLength;
+	if (requestSize > _maxRequestBytes) {
+		return -1;
+	}
+	if (len < requestSize) {
+		return 0;
+	}
+	return (int64_t)requestSize;
+}
 
-		constexpr const int BUFFERSIZE = 2048;
-		uint8_t recvBuf[BUFFERSIZE];
-		const network_return len = recv(clientSocket, (char*)recvBuf, BUFFERSIZE - 1, 0);
-		if (len < 0) {
-			i = closeClient(i);
-			continue;
+static bool isKeepAlive(const RequestParser& request) {
+	const char *connection = request.headerValue(header::CONNECTION);
+	if (connection != nullptr) {
+		if (SDL_strncasecmp(connection, "close", 5) == 0) {
+			return false;
 		}
-		if (len == 0) {
-			++i;
-			continue;
-		}
-
-		client.request = (uint8_t*)SDL_realloc(client.request, client.requestLength + len);
-		SDL_memcpy(client.request + client.requestLength, recvBuf, len);
-		client.requestLength += len;
-
-		if (client.requestLength == 0) {
-			++i;
-			continue;
+		if (SDL_strncasecmp(connection, "keep-alive", 10) == 0) {
+			return true;
 		}
+	}
+	// keep-alive is the default since HTTP/1.1
+	return request.protocolVersion != nullptr && SDL_strcmp(request.protocolVersion, "HTTP/1.0") != 0;
+}
 
-		// GET / HTTP/1.1\r\n\r\n
-		if (client.requestLength < 18) {
-			++i;
-			continue;
+void HttpServer::handleRequests(Client* client) {
+	core_trace_scoped(HttpServerHandleRequests);
+	while (!client->closing && !client->closeAfterWrite && client->start < client->end) {
+		if (client->pendingWrites >= MaxPendingWrites) {
+			if (client->reading) {
+				uv_read_stop((uv_stream_t*)&client->handle);
+				client->reading = false;
+			}
+			return;
 		}
-
-		if (SDL_memcmp(client.request, "GET", 3) != 0 && SDL_memcmp(client.request, "POST", 4) != 0) {
-			FD_CLR(clientSocket, &_readFDSet);
-			FD_CLR(clientSocket, &readFDsOut);
-			assembleError(client, HttpStatus::NotImplemented);
-			++i;
-			continue;
+		const int64_t size = requestSize(client);
+		if (size == 0) {
+			return;
 		}
-
-		if (client.requestLength > _maxRequestBytes) {
-			FD_CLR(clientSocket, &_readFDSet);
-			FD_CLR(clientSocket, &readFDsOut);
-			assembleError(client, HttpStatus::InternalServerError);
-			++i;
-			continue;
+		if (size < 0) {
+			assembleError(client, size == -1 ? HttpStatus::PayloadTooLarge : HttpStatus::BadRequest);
+			return;
 		}
-
-		uint8_t *mem = (uint8_t *)SDL_malloc(client.requestLength);
-		SDL_memcpy(mem, client.request, client.requestLength);
-		const RequestParser request(mem, client.requestLength);
-		if (!request.valid()) {
-			++i;
-			continue;
+		uint8_t *data = client->buf + client->start;
+		// the request is parsed in place - terminate it, the byte behind it belongs to the next
+		// pipelined request (or is the spare byte of the buffer)
+		const uint8_t next = data[size];
+		data[size] = '\0';
+		{
+			const RequestParser request(data, (size_t)size, false);
+			if (request.method == HttpMethod::NOT_SUPPORTED) {
+				assembleError(client, HttpStatus::NotImplemented);
+			} else if (!request.valid()) {
+				assembleError(client, HttpStatus::BadRequest);
+			} else {
+				const bool keepAlive = isKeepAlive(request);
+				HttpResponse response;
+				if (!route(request, response, keepAlive)) {
+					assembleError(client, HttpStatus::NotFound, keepAlive);
+				} else {
+					assembleResponse(client, response);
+				}
+			}
 		}
+		data[size] = next;
+		client->start += (size_t)size;
+		client->scanned = 0u;
+	}
+}
 
-		FD_CLR(clientSocket, &_readFDSet);
-		FD_CLR(clientSocket, &readFDsOut);
+HttpServer::WriteRequest* HttpServer::writeRequest() {
+	if (_freeWriteRequests.empty()) {
+		return new WriteRequest();
+	}
+	WriteRequest* writeRequest = _freeWriteRequests.back();
+	_freeWriteRequests.pop();
+	return writeRequest;
+}
 
-		HttpResponse response;
-		if (!route(request, response)) {
-			assembleError(client, HttpStatus::NotFound);
-			++i;
-			continue;
-		}
-		assembleResponse(client, response);
-		if (response.freeBody) {
-			SDL_free((char*)response.body);
+void HttpServer::send(Client* client, WriteRequest* writeRequest, int headerSize, const char *body, size_t bodySize, bool freeBody) {
+	writeRequest->client = client;
+	writeRequest->body = body;
+	writeRequest->freeBody = freeBody;
+	uv_buf_t bufs[2];
+	unsigned int nbufs = 1u;
+	bufs[0] = uv_buf_init(writeRequest->header, (unsigned int)headerSize);
+	if (bodySize > 0u) {
+		bufs[nbufs++] = uv_buf_init((char*)body, (unsigned int)bodySize);
+	}
+	++client->pendingWrites;
+	const int err = uv_write(&writeRequest->req, (uv_stream_t*)&client->handle, bufs, nbufs, Callbacks::onWrite);
+	if (err != 0) {
+		Log::debug("Failed to send to the client: %s", uv_strerror(err));
+		--client->pendingWrites;
+		if (freeBody) {
+			SDL_free((char*)body);
 		}
+		writeRequest->body = nullptr;
+		_freeWriteRequests.push_back(writeRequest);
+		closeClient(client);
+		return;
+	}
+	if (client->closeAfterWrite && client->reading) {
+		uv_read_stop((uv_stream_t*)&client->handle);
+		client->reading = false;
 	}
-	return true;
 }
 
-void HttpServer::assembleError(Client& client, HttpStatus status) {
-	char buf[512];
-	SDL_snprintf(buf, sizeof(buf),
+void HttpServer::assembleError(Client* client, HttpStatus status, bool keepAlive) {
+	const char *errorPage = "";
+	_errorPages.get((int)status, errorPage);
+	const size_t errorPageSize = SDL_strlen(errorPage);
+
+	WriteRequest* writeRequest = this->writeRequest();
+	const int headerSize = SDL_snprintf(writeRequest->header, sizeof(writeRequest->header),
 			"HTTP/1.1 %i %s\r\n"
-			"Connection: close\r\n"
+			"Connection: %s\r\n"
+			"Content-length: %u\r\n"
 			"Server: %s\r\n"
 			"\r\n",
 			(int)status,
 			toStatusString(status),
+			keepAlive ? "keep-alive" : "close",
+			(unsigned int)errorPageSize,
 			app::App::getInstance()->appname().c_str());
-
-	const char *errorPage = "";
-	_errorPages.get((int)status, errorPage);
-
-	const size_t responseSize = SDL_strlen(errorPage) + SDL_strlen(buf);
-	char *responseBuf = (char*)SDL_malloc(responseSize + 1);
-	SDL_snprintf(responseBuf, responseSize + 1, "%s%s", buf, errorPage);
-	client.setResponse(responseBuf, responseSize);
+	if (!keepAlive) {
+		client->closeAfterWrite = true;
+	}
 	metric(status);
-	FD_SET(client.socket, &_writeFDSet);
+	// the error pages are owned by the server
+	send(client, writeRequest, core_min(headerSize, (int)sizeof(writeRequest->header) - 1), errorPage, errorPageSize, false);
 }
 
-void HttpServer::assembleResponse(Client& client, const HttpResponse& response) {
-	char headers[2048];
-	if (!buildHeaderBuffer(headers, lengthof(headers), response.headers)) {
-		assembleError(client, HttpStatus::InternalServerError);
-		return;
-	}
-
-	char buf[4096];
-	const int headerSize = SDL_snprintf(buf, sizeof(buf),
+void HttpServer::assembleResponse(Client* client, const HttpResponse& response) {
+	WriteRequest* writeRequest = this->writeRequest();
+	char *header = writeRequest->header;
+	const int maxHeaderSize = (int)sizeof(writeRequest->header);
+	int headerSize = SDL_snprintf(header, maxHeaderSize,
 			"HTTP/1.1 %i %s\r\n"
-			"Content-length: %u\r\n"
-			"%s"
-			"\r\n",
+			"Content-length: %u\r\n",
 			(int)response.status,
 			toStatusString(response.status),
-			(unsigned int)response.bodySize,
-			headers);
-	if (headerSize >= lengthof(buf)) {
+			(unsigned int)response.bodySize);
+	// keep two bytes for the empty line that terminates the header
+	if (headerSize >= maxHeaderSize - 2 || !buildHeaderBuffer(header + headerSize, maxHeaderSize - headerSize - 2, response.headers)) {
+		_freeWriteRequests.push_back(writeRequest);
+		if (response.freeBody) {
+			SDL_free((char*)response.body);
+		}
 		assembleError(client, HttpStatus::InternalServerError);
 		return;
 	}
+	headerSize += (int)SDL_strlen(header + headerSize);
+	header[headerSize++] = '\r';
+	header[headerSize++] = '\n';
 
-	const size_t responseSize = response.bodySize + SDL_strlen(buf);
-	char *responseBuf = (char*)SDL_malloc(responseSize);
-	SDL_memcpy(responseBuf, buf, headerSize);
-	SDL_memcpy(responseBuf + headerSize, response.body, response.bodySize);
-	client.setResponse(responseBuf, responseSize);
-	Log::trace("Response buffer of size %i", (int)responseSize);
+	const char *connection = nullptr;
+	if (response.headers.get(header::CONNECTION, connection) && SDL_strcasecmp(connection, "close") == 0) {
+		client->closeAfterWrite = true;
+	}
+	Log::trace("Response of size %i", (int)(headerSize + response.bodySize));
 	metric(response.status);
-	FD_SET(client.socket, &_writeFDSet);
+	send(client, writeRequest, headerSize, response.body, response.bodySize, response.freeBody);
 }
 
 void HttpServer::metric(HttpStatus status) const {
@@ -288,63 +468,20 @@ void HttpServer::metric(HttpStatus status) const {
 	_metric->count("http.request", 1, {{"status", buf}});
 }
 
-bool HttpServer::sendMessage(Client& client) {
-	core_assert(client.response != nullptr);
-	int remaining = (int)client.responseLength - (int)client.alreadySent;
-	if (remaining <= 0) {
-		return false;
-	}
-	const char* p = client.response + client.alreadySent;
-	const network_return sent = ::send(client.socket, p, remaining, 0);
-	if (sent < 0) {
-		Log::debug("Failed to send to the client");
-		return false;
-	}
-	if (sent == 0) {
-		return true;
-	}
-	remaining -= sent;
-	client.alreadySent += sent;
-	return remaining > 0;
-}
-
-bool HttpServer::route(const RequestParser& request, HttpResponse& response) {
-	Routes* routes = getRoutes(request.method);
+bool HttpServer::route(const RequestParser& request, HttpResponse& response, bool keepAlive) {
+	Router* routes = getRoutes(request.method);
 	Log::trace("lookup for %s", request.path);
-	auto i = routes->find(request.path);
-	if (i == routes->end()) {
-		// check if there is at least one other /
-		if (SDL_strchr(&request.path[1], '/')) {
-			char *path = SDL_strdup(request.path);
-			char *cut;
-			for (;;) {
-				cut = SDL_strrchr(path, '/');
-				if (cut == path) {
-					break;
-				}
-				*cut = '\0';
-				Log::trace("lookup for %s", path);
-				i = routes->find(path);
-				if (i != routes->end()) {
-					break;
-				}
-			}
-			SDL_free(path);
-		} else {
-			Log::debug("No route found for '%s'", request.path);
-			return false;
-		}
-	}
-	if (i == routes->end()) {
+	const RouteCallback* callback = routes->find(request.path);
+	if (callback == nullptr) {
 		Log::debug("No route found for '%s'", request.path);
 		return false;
 	}
 	response.headers.put(header::CONTENT_TYPE, http::mimetype::TEXT_PLAIN);
-	response.headers.put(header::CONNECTION, "close");
+	response.headers.put(header::CONNECTION, keepAlive ? "keep-alive" : "close");
 	response.headers.put(header::SERVER, app::App::getInstance()->appname().c_str());
 	// TODO urldecode of request data
 	//core::string::urlDecode(request.query);
-	i->value(request, &response);
+	(*callback)(request, &response);
 	return true;
 }
 
@@ -353,38 +490,24 @@ void HttpServer::shutdown() {
 	for (size_t i = 0; i < l; ++i) {
 		_routes[i].clear();
 	}
-	for (ClientSocketsIter i = _clientSockets.begin(); i != _clientSockets.end();) {
-		i = closeClient(i);
+	if (_loop != nullptr) {
+		// close the server and all connections - the pending writes are cancelled
+		uv_walk(_loop, Callbacks::onWalk, this);
+		uv_run(_loop, UV_RUN_DEFAULT);
+		uv_loop_close(_loop);
+		delete _loop;
+		_loop = nullptr;
+		_server = nullptr;
+	}
+	for (WriteRequest* writeRequest : _freeWriteRequests) {
+		delete writeRequest;
 	}
+	_freeWriteRequests.clear();
 
 	for (auto i : _errorPages) {
-		SDL_free((char*)i->second);
+		SDL_free((char*)i->value);
 	}
 	_errorPages.clear();
-
-	FD_ZERO(&_readFDSet);
-	FD_ZERO(&_writeFDSet);
-	closesocket(_socketFD);
-	_socketFD = INVALID_SOCKET;
-	network_cleanup();
-}
-
-HttpServer::Client::Client() :
-		socket(INVALID_SOCKET) {
-}
-
-void HttpServer::Client::setResponse(char* responseBuf, size_t responseBufLength) {
-	core_assert(response == nullptr);
-	response = responseBuf;
-	responseLength = responseBufLength;
-	alreadySent = 0u;
-}
-
-bool HttpServer::Client::finished() const {
-	if (response == nullptr) {
-		return false;
-	}
-	return responseLength == alreadySent;
 }
 
 }
@@ -8,62 +8,72 @@
 #include "HttpResponse.h"
 #include "HttpStatus.h"
 #include "RequestParser.h"
-#include "Network.h"
 #include "HttpHeader.h"
 #include "HttpQuery.h"
+#include "Router.h"
 #include "core/collection/Map.h"
-#include "core/collection/List.h"
+#include "core/collection/DynamicArray.h"
 #include "metric/Metric.h"
 #include <stdint.h>
 #include <functional>
 #include <memory>
 
+struct uv_loop_s;
+typedef struct uv_loop_s uv_loop_t;
+struct uv_tcp_s;
+typedef struct uv_tcp_s uv_tcp_t;
+
 namespace http {
 
 class RequestParser;
 
+/**
+ * @brief HTTP/1.1 server on top of the libuv event loop (epoll, kqueue or IOCP - depending on the platform)
+ *
+ * The connections are kept alive and pipelined requests are answered in order. Every connection has a
+ * receive buffer that is reused for all of its requests and the requests are parsed in place. The response
+ * bodies are handed to the socket without copying them into the response buffer.
+ *
+ * @note @c update() must be called regularly - it handles all pending socket events without blocking.
+ */
 class HttpServer {
 public:
-	using RouteCallback = std::function<void(const RequestParser& query, HttpResponse* response)>;
+	using RouteCallback = http::RouteCallback;
 private:
-	SOCKET _socketFD;
-	fd_set _readFDSet;
-	fd_set _writeFDSet;
-	using Routes = core::Map<const char*, RouteCallback, 8, core::hashCharPtr, core::hashCharCompare>;
+	struct Client;
+	struct WriteRequest;
+	/** the libuv callbacks */
+	struct Callbacks;
+
+	uv_loop_t *_loop = nullptr;
+	uv_tcp_t *_server = nullptr;
 	core::Map<int, const char*, 8, std::hash<int>> _errorPages;
-	Routes _routes[2];
+	Router _routes[2];
 	size_t _maxRequestBytes = 1 * 1024 * 1024;
 	metric::MetricPtr _metric;
+	/** the write requests are reused for the following responses */
+	core::DynamicArray<WriteRequest*> _freeWriteRequests;
 
-	struct Client {
-		Client();
-		SOCKET socket;
-
-		uint8_t *request = nullptr;
-		size_t requestLength = 0u;
-
-		char* response = nullptr;
-		size_t responseLength = 0u;
-		size_t alreadySent = 0u;
-
-		void setResponse(char* responseBuf, size_t responseBufLength);
-		bool finished() const;
-	};
-
-	using ClientSockets = core::List<Client>;
-	using ClientSocketsIter = ClientSockets::iterator;
-	ClientSockets _clientSockets { 1024 };
-
-	ClientSocketsIter closeClient (ClientSocketsIter& i);
+	/**
+	 * @brief Handles all complete requests that are in the receive buffer of the client
+	 */
+	void handleRequests(Client* client);
+	/**
+	 * @return The size of the request including the body or @c 0 if the request is not yet complete. @c -1 if
+	 * the request exceeds the max request size, @c -2 if the content length is malformed
+	 */
+	int64_t requestSize(Client* client);
+	void closeClient(Client* client);
 
 	void metric(HttpStatus status) const;
 
-	bool route(const RequestParser& request, HttpResponse& response);
-	void assembleResponse(Client& client, const HttpResponse& response);
-	void assembleError(Client& client, HttpStatus status);
-	bool sendMessage(Client& client);
+	bool route(const RequestParser& request, HttpResponse& response, bool keepAlive);
+	void assembleResponse(Client* client, const HttpResponse& response);
+	void assembleError(Client* client, HttpStatus status, bool keepAlive = false);
+	void send(Client* client, WriteRequest* writeRequest, int headerSize, const char *body, size_t bodySize, bool freeBody);
+	WriteRequest* writeRequest();
 
-	Routes* getRoutes(HttpMethod method);
+	Router* getRoutes(HttpMethod method);
 
 public:
 	HttpServer(const metric::MetricPtr& metric);
@@ -80,6 +90,9 @@ public:
 	bool update();
 	void shutdown();
 
+	/**
+	 * @note The path is copied
+	 */
 	void registerRoute(HttpMethod method, const char *path, const RouteCallback& callback);
 	bool unregisterRoute(HttpMethod method, const char *path);
 };
@@ -17,6 +17,7 @@ enum class HttpStatus : uint16_t {
 	Unauthorized = 401,
 	Forbidden = 403,
 	NotFound = 404,
+	PayloadTooLarge = 413,
 	RequestUriTooLong = 414,
 	InternalServerError = 500,
 	NotImplemented = 501,
@@ -5,6 +5,7 @@
 #include "RequestParser.h"
 #include "core/StringUtil.h"
 #include "HttpHeader.h"
+#include <utility>
 
 namespace http {
 
@@ -44,8 +45,8 @@ RequestParser::RequestParser(const RequestParser &other) :
 	path = HTTP_PARSER_NEW_BASE(other.path);
 }
 
-RequestParser::RequestParser(uint8_t* requestBuffer, size_t requestBufferSize)
-		: Super(requestBuffer, requestBufferSize) {
+RequestParser::RequestParser(uint8_t* requestBuffer, size_t requestBufferSize, bool freeBuffer)
+		: Super(requestBuffer, requestBufferSize, freeBuffer) {
 	if (buf == nullptr || bufSize == 0) {
 		return;
 	}
@@ -14,7 +14,10 @@ class RequestParser : public HttpParser {
 private:
 	using Super = HttpParser;
 public:
-	RequestParser(uint8_t* requestBuffer, size_t requestBufferSize);
+	/**
+	 * @param[in] freeBuffer @c false to parse the request in place - see @c HttpParser
+	 */
+	RequestParser(uint8_t* requestBuffer, size_t requestBufferSize, bool freeBuffer = true);
 
 	// arrays are not supported as query parameters - but
 	// that's fine for our use case
@@ -5,6 +5,7 @@
 #include "ResponseParser.h"
 #include "core/StringUtil.h"
 #include "core/Log.h"
+#include <utility>
 
 namespace http {
 
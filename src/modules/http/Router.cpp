@@ -0,0 +1,141 @@
+/**
+ * @file
+ */
+
+#include "Router.h"
+#include "core/Common.h"
+#include <SDL_stdinc.h>
+
+namespace http {
+
+Router::Node* Router::Node::child(char c) const {
+	// the edges of the children start with different characters
+	for (const std::unique_ptr<Node>& n : children) {
+		if (n->prefix[0] == c) {
+			return n.get();
+		}
+	}
+	return nullptr;
+}
+
+void Router::put(const char *path, const RouteCallback& callback) {
+	Node* node = &_root;
+	const char *rest = path;
+	for (;;) {
+		if (*rest == '\0') {
+			if (!node->callback) {
+				++_size;
+			}
+			node->callback = callback;
+			return;
+		}
+		Node* c = node->child(*rest);
+		if (c == nullptr) {
+			std::unique_ptr<Node> n(new Node());
+			n->prefix = rest;
+			n->callback = callback;
+			node->children.push_back(core::move(n));
+			++_size;
+			return;
+		}
+		size_t common = 0u;
+		while (common < c->prefix.size() && rest[common] == c->prefix[common]) {
+			++common;
+		}
+		if (common < c->prefix.size()) {
+			// split the edge - the node keeps the common part and gets the rest as only child
+			std::unique_ptr<Node> tail(new Node());
+			tail->prefix = c->prefix.substr(common);
+			tail->callback = core::move(c->callback);
+			tail->children = core::move(c->children);
+			c->callback = nullptr;
+			c->children.clear();
+			c->children.push_back(core::move(tail));
+			c->prefix = c->prefix.substr(0, common);
+		}
+		node = c;
+		rest += common;
+	}
+}
+
+bool Router::remove(Node* node, const char *path) {
+	if (*path == '\0') {
+		if (!node->callback) {
+			return false;
+		}
+		node->callback = nullptr;
+		return true;
+	}
+	for (size_t i = 0; i < node->children.size(); ++i) {
+		Node* c = node->children[i].get();
+		if (c->prefix[0] != *path) {
+			continue;
+		}
+		const size_t len = c->prefix.size();
+		if (SDL_strncmp(path, c->prefix.c_str(), len) != 0) {
+			return false;
+		}
+		if (!remove(c, path + len)) {
+			return false;
+		}
+		if (!c->callback) {
+			if (c->children.empty()) {
+				node->children.erase(node->children.begin() + i);
+			} else if (c->children.size() == 1u) {
+				// merge the edge with the only child again
+				std::unique_ptr<Node> grandChild = core::move(c->children[0]);
+				grandChild->prefix = c->prefix + grandChild->prefix;
+				node->children[i] = core::move(grandChild);
+			}
+		}
+		return true;
+	}
+	return false;
+}
+
+bool Router::remove(const char *path) {
+	if (!remove(&_root, path)) {
+		return false;
+	}
+	--_size;
+	return true;
+}
+
+const RouteCallback* Router::find(const char *path) const {
+	const RouteCallback* parent = nullptr;
+	const Node* node = &_root;
+	const char *p = path;
+	for (;;) {
+		if (node->callback) {
+			if (*p == '\0') {
+				return &node->callback;
+			}
+			// only whole path segments of the parent routes match - and never the root route
+			if (*p == '/' && p - path > 1) {
+				parent = &node->callback;
+			}
+		}
+		if (*p == '\0') {
+			break;
+		}
+		const Node* c = node->child(*p);
+		if (c == nullptr) {
+			break;
+		}
+		const size_t len = c->prefix.size();
+		if (SDL_strncmp(p, c->prefix.c_str(), len) != 0) {
+			break;
+		}
+		p += len;
+		node = c;
+	}
+	return parent;
+}
+
+void Router::clear() {
+	_root.children.clear();
+	_root.callback = nullptr;
+	_size = 0u;
+}
+
+}
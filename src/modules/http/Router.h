@@ -0,0 +1,56 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/String.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace http {
+
+class RequestParser;
+struct HttpResponse;
+
+using RouteCallback = std::function<void(const RequestParser& request, HttpResponse* response)>;
+
+/**
+ * @brief Radix tree that maps the request paths to the route callbacks
+ *
+ * The registered paths are stored as edges of a compressed prefix tree - a lookup only compares every
+ * character of the requested path once and doesn't allocate. If there is no route for the complete path, the
+ * route of the longest parent path is used (e.g. @c /foo for @c /foo/bar) - but never the root route @c /.
+ */
+class Router {
+private:
+	struct Node {
+		core::String prefix;
+		RouteCallback callback;
+		std::vector<std::unique_ptr<Node>> children;
+
+		Node* child(char c) const;
+	};
+	Node _root;
+	size_t _size = 0u;
+
+	bool remove(Node* node, const char *path);
+public:
+	/**
+	 * @note The path is copied
+	 */
+	void put(const char *path, const RouteCallback& callback);
+	bool remove(const char *path);
+	/**
+	 * @return The callback for the given path or its longest registered parent path - @c nullptr if no route was found
+	 */
+	const RouteCallback* find(const char *path) const;
+	void clear();
+
+	inline size_t size() const {
+		return _size;
+	}
+};
+
+}
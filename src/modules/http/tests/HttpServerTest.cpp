@@ -4,10 +4,54 @@
 
 #include "app/tests/AbstractTest.h"
 #include "http/HttpServer.h"
+#include "http/Network.h"
+#include "http/Network.cpp.h"
+#include "core/String.h"
+#include <string.h>
+#include <SDL_timer.h>
 
 namespace http {
 
 class HttpServerTest : public app::AbstractTest {
+protected:
+	/**
+	 * @brief Sends the given requests at once and receives until the server closed the connection
+	 */
+	core::String request(HttpServer& server, int port, const char *requests, bool& closed) {
+		core::String received;
+		closed = false;
+		SOCKET s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		EXPECT_NE(INVALID_SOCKET, s);
+		if (s == INVALID_SOCKET) {
+			return received;
+		}
+		struct sockaddr_in addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(port);
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		EXPECT_EQ(0, connect(s, (struct sockaddr*)&addr, sizeof(addr)));
+		networkNonBlocking(s);
+
+		const int len = (int)strlen(requests);
+		EXPECT_EQ(len, (int)send(s, requests, len, 0));
+
+		for (int i = 0; i < 10000 && !closed; ++i) {
+			server.update();
+			char buf[1024];
+			const network_return n = recv(s, buf, sizeof(buf) - 1, 0);
+			if (n > 0) {
+				buf[n] = '\0';
+				received.append(buf, (size_t)n);
+			} else if (n == 0) {
+				closed = true;
+			} else {
+				SDL_Delay(1);
+			}
+		}
+		closesocket(s);
+		return received;
+	}
 };
 
 TEST_F(HttpServerTest, testSimple) {
@@ -19,4 +63,55 @@ TEST_F(HttpServerTest, testSimple) {
 	server.shutdown();
 }
 
+TEST_F(HttpServerTest, testKeepAlivePipelined) {
+	HttpServer server(_testApp->metric());
+	ASSERT_TRUE(server.init(10102));
+	int called = 0;
+	server.registerRoute(HttpMethod::GET, "/ping", [&] (const http::RequestParser& request, HttpResponse* response) {
+		++called;
+		response->setText("pong");
+	});
+
+	// all requests are sent at once - the last one closes the connection
+	const char *requests =
+		"GET /ping HTTP/1.1\r\nHost: localhost\r\n\r\n"
+		"GET /ping HTTP/1.1\r\nHost: localhost\r\n\r\n"
+		"GET /unknown HTTP/1.1\r\nHost: localhost\r\n\r\n"
+		"GET /ping HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n";
+	bool closed = false;
+	const core::String& received = request(server, 10102, requests, closed);
+	server.shutdown();
+
+	EXPECT_TRUE(closed) << "The server should close the connection after the last request";
+	EXPECT_EQ(3, called);
+	int pongs = 0;
+	for (size_t pos = received.find("pong"); pos != core::String::npos; pos = received.find("pong", pos + 1)) {
+		++pongs;
+	}
+	EXPECT_EQ(3, pongs) << received;
+	EXPECT_NE(core::String::npos, received.find("404")) << received;
+}
+
+TEST_F(HttpServerTest, testInvalidContentLength) {
+	HttpServer server(_testApp->metric());
+	server.setMaxRequestSize(1024);
+	ASSERT_TRUE(server.init(10103));
+	bool called = false;
+	server.registerRoute(HttpMethod::POST, "/data", [&] (const http::RequestParser& request, HttpResponse* response) {
+		called = true;
+	});
+
+	bool closed = false;
+	core::String received = request(server, 10103, "POST /data HTTP/1.1\r\nContent-Length: 1x2\r\n\r\n", closed);
+	EXPECT_TRUE(closed);
+	EXPECT_EQ(0u, received.find("HTTP/1.1 400")) << received;
+
+	received = request(server, 10103, "POST /data HTTP/1.1\r\nContent-Length: 4096\r\n\r\n", closed);
+	EXPECT_TRUE(closed);
+	EXPECT_EQ(0u, received.find("HTTP/1.1 413")) << received;
+
+	server.shutdown();
+	EXPECT_FALSE(called);
+}
+
 }
@@ -0,0 +1,92 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "http/Router.h"
+#include "http/RequestParser.h"
+
+namespace http {
+
+class RouterTest : public app::AbstractTest {
+protected:
+	int _called = 0;
+
+	RouteCallback callback(int id) {
+		return [this, id] (const RequestParser& request, HttpResponse* response) {
+			_called = id;
+		};
+	}
+
+	int call(const Router& router, const char *path) {
+		_called = 0;
+		const RouteCallback* cb = router.find(path);
+		if (cb == nullptr) {
+			return -1;
+		}
+		const RequestParser request(nullptr, 0u);
+		(*cb)(request, nullptr);
+		return _called;
+	}
+};
+
+TEST_F(RouterTest, testExactMatch) {
+	Router router;
+	router.put("/", callback(1));
+	router.put("/info", callback(2));
+	router.put("/health", callback(3));
+	router.put("/healthz", callback(4));
+	EXPECT_EQ(4u, router.size());
+	EXPECT_EQ(1, call(router, "/"));
+	EXPECT_EQ(2, call(router, "/info"));
+	EXPECT_EQ(3, call(router, "/health"));
+	EXPECT_EQ(4, call(router, "/healthz"));
+	EXPECT_EQ(-1, call(router, "/heal"));
+	EXPECT_EQ(-1, call(router, "/infos"));
+	EXPECT_EQ(-1, call(router, ""));
+}
+
+TEST_F(RouterTest, testParentPath) {
+	Router router;
+	router.put("/", callback(1));
+	router.put("/api", callback(2));
+	router.put("/api/v1/users", callback(3));
+	EXPECT_EQ(2, call(router, "/api/"));
+	EXPECT_EQ(2, call(router, "/api/v1"));
+	EXPECT_EQ(3, call(router, "/api/v1/users"));
+	EXPECT_EQ(3, call(router, "/api/v1/users/42"));
+	EXPECT_EQ(2, call(router, "/api/v1/usersx/42")) << "Only whole path segments of the parent route should match";
+	EXPECT_EQ(-1, call(router, "/other")) << "The root route must not be used as parent route";
+	EXPECT_EQ(-1, call(router, "/other/path")) << "The root route must not be used as parent route";
+}
+
+TEST_F(RouterTest, testOverwrite) {
+	Router router;
+	router.put("/info", callback(1));
+	router.put("/info", callback(2));
+	EXPECT_EQ(1u, router.size());
+	EXPECT_EQ(2, call(router, "/info"));
+}
+
+TEST_F(RouterTest, testRemove) {
+	Router router;
+	router.put("/health", callback(1));
+	router.put("/healthz", callback(2));
+	router.put("/help", callback(3));
+	EXPECT_FALSE(router.remove("/heal")) << "Only the registered paths can be removed";
+	EXPECT_TRUE(router.remove("/health"));
+	EXPECT_FALSE(router.remove("/health"));
+	EXPECT_EQ(2u, router.size());
+	EXPECT_EQ(-1, call(router, "/health"));
+	EXPECT_EQ(2, call(router, "/healthz"));
+	EXPECT_EQ(3, call(router, "/help"));
+	EXPECT_TRUE(router.remove("/healthz"));
+	EXPECT_EQ(3, call(router, "/help"));
+	router.put("/health", callback(4));
+	EXPECT_EQ(4, call(router, "/health"));
+	router.clear();
+	EXPECT_EQ(0u, router.size());
+	EXPECT_EQ(-1, call(router, "/help"));
+}
+
+}
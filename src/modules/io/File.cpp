@@ -3,6 +3,7 @@
  */
 
 #include "File.h"
+#include "FileStream.h"
 #include "core/Log.h"
 #include "core/StringUtil.h"
 #include <SDL.h>
@@ -195,6 +196,16 @@ int File::read(void *buf, size_t size, size_t maxnum) {
 }
 
 void File::close() {
+	while (_streams != nullptr) {
+		FileStream* stream = _streams;
+		_streams = stream->_nextStream;
+		if (!stream->flush()) {
+			Log::error("Failed to write the buffered data of %s", _rawPath.c_str());
+		}
+		stream->_rwops = nullptr;
+		stream->_file = nullptr;
+		stream->_nextStream = nullptr;
+	}
 	if (_file != nullptr) {
 		SDL_RWclose(_file);
 		_file = nullptr;
@@ -13,6 +13,7 @@ struct SDL_RWops;
 namespace io {
 
 class Filesystem;
+class FileStream;
 
 enum class FileMode {
 	Read,		/**< reading from the virtual file system */
@@ -36,6 +37,8 @@ protected:
 	SDL_RWops* _file;
 	core::String _rawPath;
 	FileMode _mode;
+	// the streams that operate on the handle - they are flushed and detached on close()
+	FileStream* _streams = nullptr;
 
 	File(const core::String& rawPath, FileMode mode);
 public:
@@ -48,6 +51,10 @@ public:
 	 * @c true otherwise
 	 */
 	bool open(FileMode mode);
+	/**
+	 * @brief Closes the file handle - the pending writes of the attached streams are flushed before
+	 * @note The attached streams can't be used anymore
+	 */
 	void close();
 	int read(void *buf, size_t size, size_t maxnum);
 	long tell() const;
@@ -7,21 +7,175 @@
 #include "io/File.h"
 #include "core/Assert.h"
 #include "core/Log.h"
+#include "core/StandardLib.h"
 #include <stdarg.h>
+#include <string.h>
 
 namespace io {
 
-FileStream::FileStream(File* file) :
-		FileStream(file->_file) {
+FileStream::FileStream(File* file, size_t bufferSize) :
+		FileStream(file->_file, bufferSize) {
+	// the file flushes and detaches the stream if it's closed first
+	_file = file;
+	_nextStream = file->_streams;
+	file->_streams = this;
 }
 
-FileStream::FileStream(SDL_RWops* rwops) :
-		_rwops(rwops) {
+FileStream::FileStream(SDL_RWops* rwops, size_t bufferSize) :
+		_rwops(rwops), _bufferSize(bufferSize) {
 	core_assert(rwops != nullptr);
 	_size = SDL_RWsize(_rwops);
+	if (_bufferSize > 0u) {
+		_readBuf = (uint8_t*)core_malloc(_bufferSize);
+		_writeBuf = (uint8_t*)core_malloc(_bufferSize);
+	}
+}
+
+FileStream::FileStream() :
+		_bufferSize(0u) {
+}
+
+FileStream::FileStream(const uint8_t *data, int64_t size) :
+		_bufferSize(0u) {
+	setMemory(data, size);
 }
 
 FileStream::~FileStream() {
+	if (!flush()) {
+		Log::error("Failed to write %i buffered bytes", (int)_writeBufLen);
+	}
+	if (_file != nullptr) {
+		for (FileStream** i = &_file->_streams; *i != nullptr; i = &(*i)->_nextStream) {
+			if (*i == this) {
+				*i = _nextStream;
+				break;
+			}
+		}
+	}
+	core_free(_readBuf);
+	core_free(_writeBuf);
+}
+
+void FileStream::setMemory(const uint8_t *data, int64_t size) {
+	core_assert(_rwops == nullptr);
+	_mem = data;
+	_size = size;
+	_pos = 0;
+}
+
+bool FileStream::rawRead(int64_t position, void *buf, size_t size) const {
+	if (_rwops == nullptr) {
+		return false;
+	}
+	if (SDL_RWseek(_rwops, position, RW_SEEK_SET) < 0) {
+		return false;
+	}
+	uint8_t *b = (uint8_t*)buf;
+	size_t completeBytesRead = 0;
+	size_t bytesRead = 1;
+	while (completeBytesRead < size && bytesRead != 0) {
+		bytesRead = SDL_RWread(_rwops, b, 1, (size - completeBytesRead));
+		b += bytesRead;
+		completeBytesRead += bytesRead;
+	}
+	return completeBytesRead == size;
+}
+
+bool FileStream::rawWrite(int64_t position, const void *buf, size_t size) const {
+	if (_rwops == nullptr) {
+		return false;
+	}
+	if (SDL_RWseek(_rwops, position, RW_SEEK_SET) < 0) {
+		return false;
+	}
+	const uint8_t *b = (const uint8_t*)buf;
+	size_t completeBytesWritten = 0;
+	size_t bytesWritten = 1;
+	while (completeBytesWritten < size && bytesWritten != 0) {
+		bytesWritten = SDL_RWwrite(_rwops, b, 1, (size - completeBytesWritten));
+		b += bytesWritten;
+		completeBytesWritten += bytesWritten;
+	}
+	return completeBytesWritten == size;
+}
+
+bool FileStream::flush() const {
+	if (_writeBufLen <= 0) {
+		return true;
+	}
+	const bool success = rawWrite(_writeBufStart, _writeBuf, (size_t)_writeBufLen);
+	_writeBufLen = 0;
+	return success;
+}
+
+int FileStream::peekBytes(void *buf, size_t size) const {
+	if (remaining() < (int64_t)size) {
+		return -1;
+	}
+	if (size == 0u) {
+		return 0;
+	}
+	if (_mem != nullptr) {
+		memcpy(buf, _mem + _pos, size);
+		return 0;
+	}
+	if (_pos >= _readBufStart && _pos + (int64_t)size <= _readBufStart + _readBufLen) {
+		memcpy(buf, _readBuf + (_pos - _readBufStart), size);
+		return 0;
+	}
+	// the buffered writes must end up in the file before we read it
+	if (!flush()) {
+		return -1;
+	}
+	if (size >= _bufferSize) {
+		return rawRead(_pos, buf, size) ? 0 : -1;
+	}
+	const int64_t len = core_min((int64_t)_bufferSize, _size - _pos);
+	_readBufLen = 0;
+	if (!rawRead(_pos, _readBuf, (size_t)len)) {
+		return -1;
+	}
+	_readBufStart = _pos;
+	_readBufLen = len;
+	memcpy(buf, _readBuf, size);
+	return 0;
+}
+
+int FileStream::read(void *buf, size_t size) {
+	const int retVal = peekBytes(buf, size);
+	if (retVal == 0) {
+		_pos += (int64_t)size;
+	}
+	return retVal;
+}
+
+bool FileStream::write(const void *buf, size_t size) {
+	if (_rwops == nullptr) {
+		return false;
+	}
+	_readBufLen = 0;
+	if (size >= _bufferSize) {
+		if (!flush() || !rawWrite(_pos, buf, size)) {
+			return false;
+		}
+	} else {
+		// continue the buffered block - or overwrite a part of it
+		const bool inBlock = _writeBufLen > 0 && _pos >= _writeBufStart && _pos <= _writeBufStart + _writeBufLen
+				&& _pos + (int64_t)size <= _writeBufStart + (int64_t)_bufferSize;
+		if (!inBlock) {
+			if (!flush()) {
+				return false;
+			}
+			_writeBufStart = _pos;
+		}
+		memcpy(_writeBuf + (_pos - _writeBufStart), buf, size);
+		_writeBufLen = core_max(_writeBufLen, _pos + (int64_t)size - _writeBufStart);
+	}
+	_pos += (int64_t)size;
+	if (_pos > _size) {
+		_size = _pos;
+	}
+	return true;
 }
 
 int FileStream::peekInt(uint32_t& val) const {
@@ -57,15 +211,7 @@ bool FileStream::addStringFormat(bool terminate, const char *fmt, ...) {
 	text[sizeof(text) - 1] = '\0';
 	va_end(ap);
 	const size_t length = SDL_strlen(text);
-	for (size_t i = 0u; i < length; i++) {
-		if (!addByte(uint8_t(text[i]))) {
-			return false;
-		}
-	}
-	if (!terminate) {
-		return true;
-	}
-	return addByte(uint8_t('\0'));
+	return write(text, terminate ? length + 1u : length);
 }
 
 bool FileStream::addFormat(const char *fmt, ...) {
@@ -161,6 +307,13 @@ bool FileStream::readFormat(const char *fmt, ...) {
 }
 
 bool FileStream::readString(int length, char *strbuff, bool terminated) {
+	if (!terminated) {
+		if (read(strbuff, (size_t)length) != 0) {
+			Log::error("Max stream length exceeded while reading string of length: %i", length);
+			return false;
+		}
+		return true;
+	}
 	for (int i = 0; i < length; ++i) {
 		if (_pos >= _size) {
 			Log::error("Max stream length exceeded while reading string of length: %i (read: %i)", length, i);
@@ -250,15 +403,6 @@ int FileStream::readInt(uint32_t& val) {
 	return retVal;
 }
 
-int FileStream::readBuf(uint8_t *buf, size_t bufSize) {
-	for (size_t i = 0; i < bufSize; ++i) {
-		if (readByte(buf[i]) != 0) {
-			return -1;
-		}
-	}
-	return 0;
-}
-
 int FileStream::readLong(uint64_t& val) {
 	const int retVal = peek(val);
 	if (retVal == 0) {
@@ -270,48 +414,12 @@ int FileStream::readLong(uint64_t& val) {
 }
 
 bool FileStream::addByte(uint8_t val) {
-	SDL_RWseek(_rwops, _pos, RW_SEEK_SET);
-	if (SDL_RWwrite(_rwops, &val, 1, 1) != 1) {
-		return false;
-	}
-	if (_pos >= _size) {
-		++_size;
-	}
-	++_pos;
-	return true;
-}
-
-bool FileStream::append(const uint8_t *buf, size_t size) {
-	SDL_RWseek(_rwops, _pos, RW_SEEK_SET);
-	size_t completeBytesWritten = 0;
-	int32_t bytesWritten = 1;
-	const uint8_t* b = buf;
-	while (completeBytesWritten < size && bytesWritten > 0) {
-		bytesWritten = (int32_t)SDL_RWwrite(_rwops, b, 1, (size - completeBytesWritten));
-		b += bytesWritten;
-		completeBytesWritten += bytesWritten;
-	}
-	if (completeBytesWritten != size) {
-		return false;
-	}
-	if (_pos >= _size) {
-		_size += size;
-	}
-	_pos += size;
-	return true;
+	return write(&val, 1u);
 }
 
 bool FileStream::addString(const core::String& string, bool terminate) {
-	const size_t length = string.size();
-	for (size_t i = 0u; i < length; i++) {
-		if (!addByte(uint8_t(string[i]))) {
-			return false;
-		}
-	}
-	if (!terminate) {
-		return true;
-	}
-	return addByte(uint8_t('\0'));
+	// the terminating zero of the string is part of the c string
+	return write(string.c_str(), terminate ? string.size() + 1u : string.size());
 }
 
 bool FileStream::addShort(uint16_t word) {
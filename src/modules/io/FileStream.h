@@ -19,23 +19,72 @@ typedef core::SharedPtr<File> FilePtr;
 
 /**
  * @brief Little endian file stream
+ *
+ * Reads and writes are buffered in blocks of the given buffer size - so reading or writing the primitives
+ * doesn't end up in one @c SDL_RWops call each. Pending writes are flushed on destruction, before reading
+ * and with @c flush().
+ *
+ * @note Closing the @c File flushes the stream - the stream can't be used anymore afterwards.
+ * @sa MappedFileStream
  */
 class FileStream {
-private:
+	friend class File;
+public:
+	static constexpr size_t DefaultBufferSize = 64u * 1024u;
+protected:
 	int64_t _pos = 0;
 	int64_t _size = 0;
-	mutable SDL_RWops *_rwops;
+	mutable SDL_RWops *_rwops = nullptr;
+	// the file the rwops belong to - see File::close()
+	File *_file = nullptr;
+	FileStream *_nextStream = nullptr;
+	// read-only memory the stream operates on instead of the rwops
+	const uint8_t *_mem = nullptr;
+
+	const size_t _bufferSize;
+	// the block of the file that starts at _readBufStart
+	mutable uint8_t *_readBuf = nullptr;
+	mutable int64_t _readBufStart = 0;
+	mutable int64_t _readBufLen = 0;
+	// the not yet written data that belongs to the file at _writeBufStart
+	mutable uint8_t *_writeBuf = nullptr;
+	mutable int64_t _writeBufStart = 0;
+	mutable int64_t _writeBufLen = 0;
+
+	/**
+	 * @brief Read-only stream - see @c setMemory()
+	 */
+	FileStream();
+	void setMemory(const uint8_t *data, int64_t size);
+
+	bool rawRead(int64_t position, void *buf, size_t size) const;
+	bool rawWrite(int64_t position, const void *buf, size_t size) const;
+	int peekBytes(void *buf, size_t size) const;
 
 public:
-	FileStream(File* file);
-	FileStream(const FilePtr& file) : FileStream(file.get()) {}
-	FileStream(SDL_RWops* rwops);
+	/**
+	 * @param[in] bufferSize The size of the read and the write buffer - @c 0 disables the buffering
+	 */
+	FileStream(File* file, size_t bufferSize = DefaultBufferSize);
+	FileStream(const FilePtr& file, size_t bufferSize = DefaultBufferSize) : FileStream(file.get(), bufferSize) {}
+	FileStream(SDL_RWops* rwops, size_t bufferSize = DefaultBufferSize);
+	/**
+	 * @brief Read-only stream for the given memory - the memory must outlive the stream
+	 */
+	FileStream(const uint8_t *data, int64_t size);
+	FileStream(const FileStream&) = delete;
+	FileStream& operator=(const FileStream&) = delete;
 	virtual ~FileStream();
 
 	inline int64_t remaining() const {
 		return _size - _pos;
 	}
 
+	/**
+	 * @brief Write the buffered data to the file
+	 */
+	bool flush() const;
+
 	bool addBool(bool value);
 	bool addByte(uint8_t val);
 	bool addShort(uint16_t word);
@@ -53,57 +102,25 @@ public:
 	 * @note This does not handle the endianness
 	 */
 	template<class Ret>
-	int peek(Ret& val) const {
-		const size_t bufSize = sizeof(Ret);
-		if (remaining() < (int64_t)bufSize) {
-			return -1;
-		}
-		uint8_t buf[bufSize];
-		SDL_RWseek(_rwops, _pos, RW_SEEK_SET);
-		uint8_t *b = buf;
-
-		size_t completeBytesRead = 0;
-		size_t bytesRead = 1;
-		while (completeBytesRead < bufSize && bytesRead != 0) {
-			bytesRead = SDL_RWread(_rwops, b, 1, (bufSize - completeBytesRead));
-			b += bytesRead;
-			completeBytesRead += bytesRead;
-		}
-		if (completeBytesRead != bufSize) {
-			return -1;
-		}
-		const Ret *word = (const Ret*) (void*) buf;
-		val = *word;
-		return 0;
+	inline int peek(Ret& val) const {
+		return peekBytes(&val, sizeof(Ret));
 	}
 
 	template<class Type>
 	inline bool write(Type val) {
-		SDL_RWseek(_rwops, _pos, RW_SEEK_SET);
 		const size_t bufSize = sizeof(Type);
 		uint8_t buf[bufSize];
 		for (size_t i = 0; i < bufSize; ++i) {
 			buf[i] = uint8_t(val >> (i * CHAR_BIT));
 		}
-
-		uint8_t *b = buf;
-		size_t completeBytesWritten = 0;
-		int32_t bytesWritten = 1;
-		while (completeBytesWritten < bufSize && bytesWritten > 0) {
-			bytesWritten = (int32_t)SDL_RWwrite(_rwops, b, 1, (bufSize - completeBytesWritten));
-			b += bytesWritten;
-			completeBytesWritten += bytesWritten;
-		}
-		if (completeBytesWritten != bufSize) {
-			return false;
-		}
-		if (_pos >= _size) {
-			_size += sizeof(val);
-		}
-		_pos += sizeof(val);
-		return true;
+		return write(buf, bufSize);
 	}
 
+	/**
+	 * @brief Write the given amount of bytes at the current position
+	 */
+	bool write(const void *buf, size_t size);
+
 	template<class Ret>
 	inline int read(Ret& val) {
 		const int retVal = peek<Ret>(val);
@@ -113,7 +130,15 @@ public:
 		return retVal;
 	}
 
-	int readBuf(uint8_t *buf, size_t bufSize);
+	/**
+	 * @brief Read the given amount of bytes from the current position
+	 * @return A value of @c 0 indicates no error - the position is not changed on errors
+	 */
+	int read(void *buf, size_t size);
+
+	inline int readBuf(uint8_t *buf, size_t bufSize) {
+		return read(buf, bufSize);
+	}
 
 	bool readBool();
 	int readByte(uint8_t& val);
@@ -137,7 +162,9 @@ public:
 	int peekShort(uint16_t& val) const;
 	int peekByte(uint8_t& val) const;
 
-	bool append(const uint8_t *buf, size_t size);
+	inline bool append(const uint8_t *buf, size_t size) {
+		return write(buf, size);
+	}
 
 	bool empty() const;
 
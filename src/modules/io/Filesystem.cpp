@@ -137,6 +137,10 @@ bool Filesystem::createDir(const core::String& dir, bool recursive) const {
 	return lastResult;
 }
 
+static inline uint64_t toMillis(const uv_timespec_t& time) {
+	return (uint64_t)time.tv_sec * 1000u + (uint64_t)time.tv_nsec / 1000000u;
+}
+
 bool Filesystem::_list(const core::String& directory, core::DynamicArray<DirEntry>& entities, const core::String& filter) {
 	uv_fs_t req;
 	const int amount = uv_fs_scandir(nullptr, &req, directory.c_str(), 0, nullptr);
@@ -179,7 +183,7 @@ bool Filesystem::_list(const core::String& directory, core::DynamicArray<DirEntr
 				continue;
 			}
 			const bool dir = (uv_fs_get_statbuf(&statsReq)->st_mode & S_IFDIR) != 0;
-			entities.push_back(DirEntry{ent.name, dir ? DirEntry::Type::dir : DirEntry::Type::file, statsReq.statbuf.st_size});
+			entities.push_back(DirEntry{ent.name, dir ? DirEntry::Type::dir : DirEntry::Type::file, statsReq.statbuf.st_size, toMillis(statsReq.statbuf.st_mtim)});
 			uv_fs_req_cleanup(&statsReq);
 		} else {
 			Log::debug("Unknown directory entry found: %s", ent.name);
@@ -195,7 +199,7 @@ bool Filesystem::_list(const core::String& directory, core::DynamicArray<DirEntr
 		if (uv_fs_stat(nullptr, &statsReq, fullPath.c_str(), nullptr) != 0) {
 			Log::warn("Could not stat file %s", fullPath.c_str());
 		}
-		entities.push_back(DirEntry{ent.name, type, statsReq.statbuf.st_size});
+		entities.push_back(DirEntry{ent.name, type, statsReq.statbuf.st_size, toMillis(statsReq.statbuf.st_mtim)});
 		uv_fs_req_cleanup(&statsReq);
 	}
 	uv_fs_req_cleanup(&req);
@@ -265,6 +269,17 @@ bool Filesystem::isReadableDir(const core::String& name) {
 	return dir;
 }
 
+uint64_t Filesystem::modificationTime(const core::String& name) {
+	uv_fs_t req;
+	if (uv_fs_stat(nullptr, &req, name.c_str(), nullptr) != 0) {
+		uv_fs_req_cleanup(&req);
+		return 0u;
+	}
+	const uint64_t mtime = toMillis(uv_fs_get_statbuf(&req)->st_mtim);
+	uv_fs_req_cleanup(&req);
+	return mtime;
+}
+
 bool Filesystem::isRelativePath(const core::String& name) {
 	const size_t size = name.size();
 #ifdef __WINDOWS__
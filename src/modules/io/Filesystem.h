@@ -99,11 +99,17 @@ public:
 		};
 		Type type;
 		uint64_t size;
+		/** modification time in millis since the epoch */
+		uint64_t mtime = 0u;
 	};
 
 	bool list(const core::String& directory, core::DynamicArray<DirEntry>& entities, const core::String& filter = "") const;
 
 	static bool isReadableDir(const core::String& name);
+	/**
+	 * @return The modification time of the given file in millis since the epoch or @c 0 if the file doesn't exist
+	 */
+	static uint64_t modificationTime(const core::String& name);
 	static bool isRelativePath(const core::String& name);
 
 	static core::String absolutePath(const core::String& path);
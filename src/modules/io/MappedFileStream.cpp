@@ -0,0 +1,91 @@
+/**
+ * @file
+ */
+
+#include "MappedFileStream.h"
+#include "io/File.h"
+#include "core/Log.h"
+#include <SDL_platform.h>
+#ifdef __WINDOWS__
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace io {
+
+MappedFileStream::MappedFileStream(const File* file) :
+		MappedFileStream(file->name()) {
+}
+
+MappedFileStream::MappedFileStream(const core::String& path) {
+#ifdef __WINDOWS__
+	HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (handle == INVALID_HANDLE_VALUE) {
+		Log::error("Failed to open %s for mapping", path.c_str());
+		return;
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(handle, &size)) {
+		CloseHandle(handle);
+		Log::error("Failed to get the size of %s", path.c_str());
+		return;
+	}
+	_mappingSize = (size_t)size.QuadPart;
+	if (_mappingSize > 0u) {
+		HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping != nullptr) {
+			_mapping = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(mapping);
+		}
+	}
+	CloseHandle(handle);
+#else
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd == -1) {
+		Log::error("Failed to open %s for mapping", path.c_str());
+		return;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		::close(fd);
+		Log::error("Failed to get the size of %s", path.c_str());
+		return;
+	}
+	_mappingSize = (size_t)st.st_size;
+	if (_mappingSize > 0u) {
+		void *mapping = mmap(nullptr, _mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping != MAP_FAILED) {
+			_mapping = mapping;
+			// the loaders read the files front to back
+			madvise(_mapping, _mappingSize, MADV_SEQUENTIAL);
+		}
+	}
+	// the mapping keeps its own reference to the file
+	::close(fd);
+#endif
+	if (_mappingSize > 0u && _mapping == nullptr) {
+		Log::error("Failed to map %s", path.c_str());
+		_mappingSize = 0u;
+		return;
+	}
+	_valid = true;
+	setMemory((const uint8_t*)_mapping, (int64_t)_mappingSize);
+}
+
+MappedFileStream::~MappedFileStream() {
+	if (_mapping == nullptr) {
+		return;
+	}
+#ifdef __WINDOWS__
+	UnmapViewOfFile(_mapping);
+#else
+	munmap(_mapping, _mappingSize);
+#endif
+}
+
+}
@@ -0,0 +1,42 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "io/FileStream.h"
+
+namespace io {
+
+/**
+ * @brief Read-only @c FileStream for a memory mapped file
+ *
+ * The reads are plain copies out of the mapping - there are no @c SDL_RWops calls and no read buffer
+ * involved. The operating system pages in the file on demand, which makes this a good fit for large files.
+ *
+ * @note All writes fail
+ * @sa FileStream
+ */
+class MappedFileStream : public FileStream {
+private:
+	void *_mapping = nullptr;
+	size_t _mappingSize = 0u;
+	bool _valid = false;
+public:
+	/**
+	 * @param[in] path The path of the file in the filesystem - see @c File::name()
+	 */
+	MappedFileStream(const core::String& path);
+	MappedFileStream(const File* file);
+	MappedFileStream(const FilePtr& file) : MappedFileStream(file.get()) {}
+	~MappedFileStream();
+
+	/**
+	 * @return @c false if the file couldn't get mapped
+	 */
+	inline bool valid() const {
+		return _valid;
+	}
+};
+
+}
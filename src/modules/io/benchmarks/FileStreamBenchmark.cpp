@@ -0,0 +1,105 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "io/FileStream.h"
+#include "io/MappedFileStream.h"
+#include "io/File.h"
+#include "io/Filesystem.h"
+#include "app/App.h"
+
+/**
+ * @brief Writes and reads a file of the given size in MB with the int helpers of the streams
+ *
+ * The unbuffered streams (buffer size @c 0) issue one @c SDL_RWops call per value.
+ */
+class FileStreamBenchmark : public app::AbstractBenchmark {
+public:
+	static core::String path() {
+		return io::filesystem()->homePath() + "filestreambenchmark.bin";
+	}
+
+	static inline uint32_t values(const benchmark::State &state) {
+		return (uint32_t)state.range(0) * 1024u * 1024u / sizeof(uint32_t);
+	}
+
+	static bool writeFile(benchmark::State &state, size_t bufferSize) {
+		const io::FilePtr& file = io::filesystem()->open(path(), io::FileMode::SysWrite);
+		io::FileStream stream(file, bufferSize);
+		const uint32_t n = values(state);
+		for (uint32_t i = 0u; i < n; ++i) {
+			if (!stream.addInt(i)) {
+				state.SkipWithError("Failed to write");
+				return false;
+			}
+		}
+		return stream.flush();
+	}
+
+	static void readStream(benchmark::State &state, io::FileStream& stream) {
+		const uint32_t n = values(state);
+		uint32_t val;
+		for (uint32_t i = 0u; i < n; ++i) {
+			if (stream.readInt(val) != 0 || val != i) {
+				state.SkipWithError("Failed to read");
+				return;
+			}
+		}
+	}
+};
+
+BENCHMARK_DEFINE_F(FileStreamBenchmark, WriteUnbuffered)(benchmark::State &state) {
+	for (auto _ : state) {
+		writeFile(state, 0u);
+	}
+	state.SetBytesProcessed(state.iterations() * values(state) * sizeof(uint32_t));
+}
+
+BENCHMARK_DEFINE_F(FileStreamBenchmark, WriteBuffered)(benchmark::State &state) {
+	for (auto _ : state) {
+		writeFile(state, io::FileStream::DefaultBufferSize);
+	}
+	state.SetBytesProcessed(state.iterations() * values(state) * sizeof(uint32_t));
+}
+
+BENCHMARK_DEFINE_F(FileStreamBenchmark, ReadUnbuffered)(benchmark::State &state) {
+	writeFile(state, io::FileStream::DefaultBufferSize);
+	for (auto _ : state) {
+		const io::FilePtr& file = io::filesystem()->open(path(), io::FileMode::SysRead);
+		io::FileStream stream(file, 0u);
+		readStream(state, stream);
+	}
+	state.SetBytesProcessed(state.iterations() * values(state) * sizeof(uint32_t));
+}
+
+BENCHMARK_DEFINE_F(FileStreamBenchmark, ReadBuffered)(benchmark::State &state) {
+	writeFile(state, io::FileStream::DefaultBufferSize);
+	for (auto _ : state) {
+		const io::FilePtr& file = io::filesystem()->open(path(), io::FileMode::SysRead);
+		io::FileStream stream(file);
+		readStream(state, stream);
+	}
+	state.SetBytesProcessed(state.iterations() * values(state) * sizeof(uint32_t));
+}
+
+BENCHMARK_DEFINE_F(FileStreamBenchmark, ReadMapped)(benchmark::State &state) {
+	writeFile(state, io::FileStream::DefaultBufferSize);
+	for (auto _ : state) {
+		io::MappedFileStream stream(path());
+		if (!stream.valid()) {
+			state.SkipWithError("Failed to map the file");
+			break;
+		}
+		readStream(state, stream);
+	}
+	state.SetBytesProcessed(state.iterations() * values(state) * sizeof(uint32_t));
+}
+
+BENCHMARK_REGISTER_F(FileStreamBenchmark, WriteUnbuffered)->Arg(4)->Arg(32)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(FileStreamBenchmark, WriteBuffered)->Arg(4)->Arg(32)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(FileStreamBenchmark, ReadUnbuffered)->Arg(4)->Arg(32)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(FileStreamBenchmark, ReadBuffered)->Arg(4)->Arg(32)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(FileStreamBenchmark, ReadMapped)->Arg(4)->Arg(32)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -4,6 +4,7 @@
 
 #include <gtest/gtest.h>
 #include "io/FileStream.h"
+#include "io/MappedFileStream.h"
 #include "io/Filesystem.h"
 #include "core/FourCC.h"
 
@@ -73,4 +74,76 @@ TEST_F(FileStreamTest, testFileStreamWrite) {
 	EXPECT_EQ(8l, file->length());
 }
 
+TEST_F(FileStreamTest, testFileStreamPatchAndReadBack) {
+	io::Filesystem fs;
+	EXPECT_TRUE(fs.init("test", "test")) << "Failed to initialize the filesystem";
+	const size_t bufferSizes[] = {0u, 16u, FileStream::DefaultBufferSize};
+	for (size_t bufferSize : bufferSizes) {
+		const FilePtr& file = fs.open("filestream-patchtest", io::FileMode::SysWrite);
+		ASSERT_TRUE(file->validHandle());
+		{
+			FileStream stream(file, bufferSize);
+			// placeholder for the size of the chunk
+			EXPECT_TRUE(stream.addInt(0));
+			for (uint32_t i = 0u; i < 100u; ++i) {
+				EXPECT_TRUE(stream.addInt(i));
+			}
+			EXPECT_TRUE(stream.addString("foobar"));
+			const int64_t end = stream.pos();
+			EXPECT_EQ(0, stream.seek(0));
+			EXPECT_TRUE(stream.addInt((uint32_t)end));
+			EXPECT_EQ(0, stream.seek(end));
+		}
+		file->close();
+		file->open(io::FileMode::Read);
+		FileStream stream(file, bufferSize);
+		EXPECT_EQ(4 + 100 * 4 + 7, stream.size()) << "buffer size " << bufferSize;
+		uint32_t val;
+		EXPECT_EQ(0, stream.readInt(val));
+		EXPECT_EQ((uint32_t)stream.size(), val);
+		for (uint32_t i = 0u; i < 100u; ++i) {
+			EXPECT_EQ(0, stream.readInt(val));
+			EXPECT_EQ(i, val);
+		}
+		char buf[7];
+		EXPECT_TRUE(stream.readString(sizeof(buf), buf));
+		EXPECT_STREQ("foobar", buf);
+		EXPECT_EQ(-1, stream.readInt(val));
+	}
+}
+
+TEST_F(FileStreamTest, testMemoryStream) {
+	const uint8_t data[] = {1, 0, 2, 0, 0, 0, 'a', 'b'};
+	FileStream stream(data, sizeof(data));
+	uint16_t s;
+	uint32_t i;
+	EXPECT_EQ(0, stream.readShort(s));
+	EXPECT_EQ(1u, s);
+	EXPECT_EQ(0, stream.readInt(i));
+	EXPECT_EQ(2u, i);
+	char buf[2];
+	EXPECT_EQ(0, stream.read(buf, sizeof(buf)));
+	EXPECT_EQ('a', buf[0]);
+	EXPECT_EQ('b', buf[1]);
+	EXPECT_EQ(-1, stream.readShort(s));
+	EXPECT_FALSE(stream.addByte(1)) << "Memory streams are read-only";
+}
+
+TEST_F(FileStreamTest, testMappedFileStream) {
+	io::Filesystem fs;
+	EXPECT_TRUE(fs.init("test", "test")) << "Failed to initialize the filesystem";
+	const FilePtr& file = fs.open("iotest.txt");
+	ASSERT_TRUE(file->exists());
+	MappedFileStream stream(file);
+	ASSERT_TRUE(stream.valid());
+	EXPECT_EQ((int64_t)file->length(), stream.size());
+	uint32_t magic;
+	EXPECT_EQ(0, stream.readInt(magic));
+	EXPECT_EQ(FourCC('W', 'i', 'n', 'd'), magic);
+	char buf[7];
+	EXPECT_TRUE(stream.readString(6, buf));
+	buf[6] = '\0';
+	EXPECT_STREQ("owInfo", buf);
+}
+
 }
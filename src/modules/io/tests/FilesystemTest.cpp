@@ -74,6 +74,20 @@ TEST_F(FilesystemTest, testIsReadableDir) {
 	fs.shutdown();
 }
 
+TEST_F(FilesystemTest, testModificationTime) {
+	io::Filesystem fs;
+	EXPECT_TRUE(fs.init("test", "test")) << "Failed to initialize the filesystem";
+	EXPECT_EQ(0u, io::Filesystem::modificationTime("mtimetestdoesnotexist"));
+	EXPECT_TRUE(fs.syswrite("mtimetest", "1"));
+	const uint64_t mtime = io::Filesystem::modificationTime("mtimetest");
+	EXPECT_GT(mtime, 0u);
+	core::DynamicArray<io::Filesystem::DirEntry> entities;
+	fs.list(fs.absolutePath("."), entities, "mtimetest");
+	ASSERT_EQ(1u, entities.size()) << entities;
+	EXPECT_EQ(mtime, entities[0].mtime);
+	fs.shutdown();
+}
+
 TEST_F(FilesystemTest, testListFilter) {
 	io::Filesystem fs;
 	EXPECT_TRUE(fs.init("test", "test")) << "Failed to initialize the filesystem";
@@ -0,0 +1,260 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Rect.h"
+#include "core/Assert.h"
+#include "core/Trace.h"
+#include <glm/common.hpp>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+namespace math {
+
+/**
+ * @brief Uniform grid for moving objects that are queried by area.
+ *
+ * Every item is put into the cell that contains the center of its rect. The cells are stored in a hash map
+ * and keep their items in a flat array - an item that moves only has to be touched if it crosses a cell
+ * border (see @c update()). Removing an item is a swap with the last item of the cell.
+ *
+ * The @c NODE type must provide a @c getRect() method (like for @c QuadTree) and must be usable as key for
+ * a hash map with the given @c HASH functor.
+ *
+ * @note Queries don't allocate memory - use @c visit() or hand in a reused vector to @c query()
+ * @sa QuadTree
+ */
+template<class NODE, typename TYPE = float, class HASH = std::hash<NODE> >
+class SpatialHashGrid {
+public:
+	typedef std::vector<NODE> Contents;
+private:
+	struct Entry {
+		NODE node;
+		Rect<TYPE> rect;
+	};
+	typedef std::vector<Entry> Cell;
+
+	struct Location {
+		uint64_t cell;
+		int index;
+	};
+
+	const TYPE _cellSize;
+	std::unordered_map<uint64_t, Cell> _cells;
+	std::unordered_map<NODE, Location, HASH> _locations;
+	/**
+	 * the biggest half extent of all items in the grid - queries have to look into the
+	 * neighbouring cells by this amount, because the items are only put into the cell of their center.
+	 */
+	TYPE _maxHalfExtent = (TYPE)0;
+	/**
+	 * the amount of items with the biggest half extent - it's only recalculated if the last of them is
+	 * removed or shrinks
+	 */
+	int _maxHalfExtentCount = 0;
+
+	inline int32_t cellCoord(TYPE v) const {
+		// clamped to not overflow for huge query areas like Rect::getMaxRect()
+		const TYPE limit = (TYPE)(1 << 30);
+		return (int32_t)glm::clamp((TYPE)glm::floor(v / _cellSize), -limit, limit);
+	}
+
+	static inline uint64_t cellKey(int32_t x, int32_t z) {
+		return ((uint64_t)(uint32_t)x << 32) | (uint64_t)(uint32_t)z;
+	}
+
+	inline uint64_t cellKey(const Rect<TYPE>& rect) const {
+		const TYPE centerX = rect.getMinX() + (rect.getMaxX() - rect.getMinX()) / (TYPE)2;
+		const TYPE centerZ = rect.getMinZ() + (rect.getMaxZ() - rect.getMinZ()) / (TYPE)2;
+		return cellKey(cellCoord(centerX), cellCoord(centerZ));
+	}
+
+	static inline TYPE halfExtent(const Rect<TYPE>& rect) {
+		return glm::max(rect.getMaxX() - rect.getMinX(), rect.getMaxZ() - rect.getMinZ()) / (TYPE)2;
+	}
+
+	inline void addHalfExtent(const Rect<TYPE>& rect) {
+		const TYPE extent = halfExtent(rect);
+		if (extent > _maxHalfExtent) {
+			_maxHalfExtent = extent;
+			_maxHalfExtentCount = 1;
+		} else if (extent == _maxHalfExtent) {
+			++_maxHalfExtentCount;
+		}
+	}
+
+	/**
+	 * @note The item must already be removed from the cells (or have its new rect) - otherwise the
+	 * recalculation would find it again.
+	 */
+	void removeHalfExtent(const Rect<TYPE>& rect) {
+		if (halfExtent(rect) != _maxHalfExtent || --_maxHalfExtentCount > 0) {
+			return;
+		}
+		_maxHalfExtent = (TYPE)0;
+		_maxHalfExtentCount = 0;
+		for (const auto& e : _cells) {
+			for (const Entry& entry : e.second) {
+				addHalfExtent(entry.rect);
+			}
+		}
+	}
+
+	void add(const NODE& item, const Rect<TYPE>& rect, uint64_t key) {
+		Cell& cell = _cells[key];
+		_locations[item] = Location{key, (int)cell.size()};
+		cell.push_back(Entry{item, rect});
+		addHalfExtent(rect);
+	}
+
+	void erase(const Location& location) {
+		auto i = _cells.find(location.cell);
+		core_assert(i != _cells.end());
+		Cell& cell = i->second;
+		core_assert(location.index < (int)cell.size());
+		const Rect<TYPE> rect = cell[location.index].rect;
+		if (location.index != (int)cell.size() - 1) {
+			cell[location.index] = std::move(cell.back());
+			_locations[cell[location.index].node].index = location.index;
+		}
+		cell.pop_back();
+		if (cell.empty()) {
+			_cells.erase(i);
+		}
+		removeHalfExtent(rect);
+	}
+
+	template<class FUNC>
+	static inline void visitCell(const Cell& cell, const Rect<TYPE>& area, FUNC& func) {
+		for (const Entry& entry : cell) {
+			if (area.intersectsWith(entry.rect)) {
+				func(entry.node);
+			}
+		}
+	}
+
+public:
+	/**
+	 * @param[in] cellSize The side length of one cell. Should be in the order of the usual query size.
+	 */
+	SpatialHashGrid(TYPE cellSize) :
+			_cellSize(cellSize) {
+		core_assert(cellSize > (TYPE)0);
+	}
+
+	inline int count() const {
+		return (int)_locations.size();
+	}
+
+	/**
+	 * @return The amount of cells that contain at least one item
+	 */
+	inline int cellCount() const {
+		return (int)_cells.size();
+	}
+
+	inline TYPE maxHalfExtent() const {
+		return _maxHalfExtent;
+	}
+
+	/**
+	 * @return @c false if the item is already part of the grid
+	 */
+	bool insert(const NODE& item) {
+		if (_locations.find(item) != _locations.end()) {
+			return false;
+		}
+		const Rect<TYPE>& rect = item.getRect();
+		add(item, rect, cellKey(rect));
+		return true;
+	}
+
+	bool remove(const NODE& item) {
+		auto i = _locations.find(item);
+		if (i == _locations.end()) {
+			return false;
+		}
+		const Location location = i->second;
+		_locations.erase(i);
+		erase(location);
+		return true;
+	}
+
+	/**
+	 * @brief Must be called after the rect of the item changed. The item is only moved if
+	 * it crossed a cell border.
+	 * @return @c false if the item is not part of the grid
+	 */
+	bool update(const NODE& item) {
+		auto i = _locations.find(item);
+		if (i == _locations.end()) {
+			return false;
+		}
+		const Rect<TYPE>& rect = item.getRect();
+		const uint64_t key = cellKey(rect);
+		const Location location = i->second;
+		if (location.cell == key) {
+			Entry& entry = _cells[key][location.index];
+			const Rect<TYPE> oldRect = entry.rect;
+			entry.rect = rect;
+			addHalfExtent(rect);
+			removeHalfExtent(oldRect);
+			return true;
+		}
+		erase(location);
+		add(item, rect, key);
+		return true;
+	}
+
+	/**
+	 * @brief Calls the given functor for every item whose rect intersects with the given area
+	 */
+	template<class FUNC>
+	void visit(const Rect<TYPE>& area, FUNC&& func) const {
+		core_trace_scoped(SpatialHashGridVisit);
+		const int32_t minX = cellCoord(area.getMinX() - _maxHalfExtent);
+		const int32_t minZ = cellCoord(area.getMinZ() - _maxHalfExtent);
+		const int32_t maxX = cellCoord(area.getMaxX() + _maxHalfExtent);
+		const int32_t maxZ = cellCoord(area.getMaxZ() + _maxHalfExtent);
+		const uint64_t cellsX = (uint64_t)((int64_t)maxX - (int64_t)minX + 1);
+		const uint64_t cellsZ = (uint64_t)((int64_t)maxZ - (int64_t)minZ + 1);
+		if (cellsX * cellsZ > (uint64_t)_cells.size()) {
+			// the area covers more cells than there are - just check all of them
+			for (const auto& e : _cells) {
+				visitCell(e.second, area, func);
+			}
+			return;
+		}
+		for (int32_t x = minX; x <= maxX; ++x) {
+			for (int32_t z = minZ; z <= maxZ; ++z) {
+				auto i = _cells.find(cellKey(x, z));
+				if (i == _cells.end()) {
+					continue;
+				}
+				visitCell(i->second, area, func);
+			}
+		}
+	}
+
+	/**
+	 * @brief Appends all items whose rect intersects with the given area to the given @c Contents
+	 */
+	inline void query(const Rect<TYPE>& area, Contents& results) const {
+		visit(area, [&] (const NODE& node) {
+			results.push_back(node);
+		});
+	}
+
+	void clear() {
+		_cells.clear();
+		_locations.clear();
+		_maxHalfExtent = (TYPE)0;
+		_maxHalfExtentCount = 0;
+	}
+};
+
+}
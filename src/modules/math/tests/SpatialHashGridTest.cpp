@@ -0,0 +1,160 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "math/SpatialHashGrid.h"
+#include <algorithm>
+
+namespace math {
+
+namespace grid {
+class Item {
+private:
+	RectFloat _bounds;
+	int _id;
+public:
+	Item(const RectFloat& rect, int id) :
+			_bounds(rect), _id(id) {
+	}
+
+	RectFloat getRect() const {
+		return _bounds;
+	}
+
+	void setRect(const RectFloat& rect) {
+		_bounds = rect;
+	}
+
+	int id() const {
+		return _id;
+	}
+
+	bool operator==(const Item& rhs) const {
+		return rhs._id == _id;
+	}
+};
+
+struct ItemHash {
+	size_t operator()(const Item& item) const {
+		return (size_t)item.id();
+	}
+};
+
+typedef SpatialHashGrid<Item, float, ItemHash> Grid;
+
+static std::vector<int> ids(const Grid& grid, const RectFloat& area) {
+	Grid::Contents contents;
+	grid.query(area, contents);
+	std::vector<int> result;
+	for (const Item& item : contents) {
+		result.push_back(item.id());
+	}
+	std::sort(result.begin(), result.end());
+	return result;
+}
+}
+
+TEST(SpatialHashGridTest, testInsertRemove) {
+	grid::Grid grid(10.0f);
+	const grid::Item item1(RectFloat(51, 51, 53, 53), 1);
+	const grid::Item item2(RectFloat(-15, -15, -12, -12), 2);
+	EXPECT_TRUE(grid.insert(item1));
+	EXPECT_FALSE(grid.insert(item1));
+	EXPECT_TRUE(grid.insert(item2));
+	EXPECT_EQ(2, grid.count());
+	EXPECT_TRUE(grid.remove(item1));
+	EXPECT_FALSE(grid.remove(item1));
+	EXPECT_EQ(1, grid.count());
+	EXPECT_EQ(std::vector<int>{2}, grid::ids(grid, RectFloat(-100, -100, 100, 100)));
+}
+
+TEST(SpatialHashGridTest, testQuery) {
+	grid::Grid grid(10.0f);
+	grid.insert(grid::Item(RectFloat(1, 1, 2, 2), 1));
+	grid.insert(grid::Item(RectFloat(15, 15, 16, 16), 2));
+	grid.insert(grid::Item(RectFloat(-25, 5, -24, 6), 3));
+	grid.insert(grid::Item(RectFloat(95, 95, 96, 96), 4));
+	EXPECT_EQ((std::vector<int>{1, 2}), grid::ids(grid, RectFloat(0, 0, 20, 20)));
+	EXPECT_EQ((std::vector<int>{1, 3}), grid::ids(grid, RectFloat(-30, 0, 5, 10)));
+	EXPECT_EQ((std::vector<int>{1, 2, 3, 4}), grid::ids(grid, RectFloat(-1000, -1000, 1000, 1000)));
+	EXPECT_TRUE(grid::ids(grid, RectFloat(40, 40, 50, 50)).empty());
+}
+
+TEST(SpatialHashGridTest, testItemOverlappingCellBorder) {
+	grid::Grid grid(10.0f);
+	// the center is in cell 1/1 - but the rect reaches into cell 0/0
+	grid.insert(grid::Item(RectFloat(5, 5, 15, 15), 1));
+	EXPECT_EQ(std::vector<int>{1}, grid::ids(grid, RectFloat(6, 6, 7, 7)));
+}
+
+TEST(SpatialHashGridTest, testUpdate) {
+	grid::Grid grid(10.0f);
+	grid::Item item1(RectFloat(1, 1, 2, 2), 1);
+	grid::Item item2(RectFloat(3, 3, 4, 4), 2);
+	grid::Item item3(RectFloat(5, 5, 6, 6), 3);
+	grid.insert(item1);
+	grid.insert(item2);
+	grid.insert(item3);
+
+	// same cell
+	item1.setRect(RectFloat(7, 7, 8, 8));
+	EXPECT_TRUE(grid.update(item1));
+	EXPECT_EQ(std::vector<int>{1}, grid::ids(grid, RectFloat(6.5f, 6.5f, 9, 9)));
+
+	// crosses the cell border - the last item of the old cell takes its place
+	item1.setRect(RectFloat(51, 51, 52, 52));
+	EXPECT_TRUE(grid.update(item1));
+	EXPECT_EQ((std::vector<int>{2, 3}), grid::ids(grid, RectFloat(0, 0, 10, 10)));
+	EXPECT_EQ(std::vector<int>{1}, grid::ids(grid, RectFloat(50, 50, 60, 60)));
+
+	EXPECT_TRUE(grid.remove(item2));
+	EXPECT_EQ(std::vector<int>{3}, grid::ids(grid, RectFloat(0, 0, 10, 10)));
+	EXPECT_EQ(2, grid.count());
+
+	EXPECT_FALSE(grid.update(item2));
+}
+
+TEST(SpatialHashGridTest, testEmptyCellsAreRemoved) {
+	grid::Grid grid(10.0f);
+	grid::Item item1(RectFloat(1, 1, 2, 2), 1);
+	const grid::Item item2(RectFloat(21, 21, 22, 22), 2);
+	grid.insert(item1);
+	grid.insert(item2);
+	EXPECT_EQ(2, grid.cellCount());
+
+	item1.setRect(RectFloat(51, 51, 52, 52));
+	EXPECT_TRUE(grid.update(item1));
+	EXPECT_EQ(2, grid.cellCount());
+
+	EXPECT_TRUE(grid.remove(item2));
+	EXPECT_EQ(1, grid.cellCount());
+	EXPECT_TRUE(grid.remove(item1));
+	EXPECT_EQ(0, grid.cellCount());
+}
+
+TEST(SpatialHashGridTest, testMaxHalfExtent) {
+	grid::Grid grid(10.0f);
+	grid::Item big(RectFloat(0, 0, 40, 40), 1);
+	const grid::Item small1(RectFloat(1, 1, 3, 3), 2);
+	const grid::Item small2(RectFloat(5, 5, 7, 7), 3);
+	grid.insert(big);
+	grid.insert(small1);
+	grid.insert(small2);
+	EXPECT_FLOAT_EQ(20.0f, grid.maxHalfExtent());
+
+	// shrinks in the same cell
+	big.setRect(RectFloat(16, 16, 24, 24));
+	EXPECT_TRUE(grid.update(big));
+	EXPECT_FLOAT_EQ(4.0f, grid.maxHalfExtent());
+
+	EXPECT_TRUE(grid.remove(big));
+	EXPECT_FLOAT_EQ(1.0f, grid.maxHalfExtent());
+	// one of the items with the biggest extent is still there
+	EXPECT_TRUE(grid.remove(small1));
+	EXPECT_FLOAT_EQ(1.0f, grid.maxHalfExtent());
+	EXPECT_TRUE(grid.remove(small2));
+	EXPECT_FLOAT_EQ(0.0f, grid.maxHalfExtent());
+}
+
+}
@@ -31,7 +31,7 @@ enum class Flavor {
 /**
  * @brief If the configured Flavor supports tags, they are just a key-value pair of strings
  */
-using TagMap = core::StringMap<core::String, 4>;
+using TagMap = core::StringMap<core::String>;
 
 /**
  * @brief The Metric class generates and publishes metrics
@@ -21,7 +21,7 @@ enum class MetricEventType {
 	Meter
 };
 
-using TagMap = core::StringMap<core::String, 4>;
+using TagMap = core::StringMap<core::String>;
 
 class MetricEvent: public core::IEventBusEvent {
 private:
@@ -58,6 +58,7 @@ bool AbstractServerNetwork::broadcast(ENetPacket* packet, int channel) {
 		return false;
 	}
 	Log::debug("Broadcasting a message on channel %i", channel);
+	core::ScopedLock<core::Lock> lock(_hostLock);
 	enet_host_broadcast(_server, channel, packet);
 	return true;
 }
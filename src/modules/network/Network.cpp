@@ -41,9 +41,14 @@ bool Network::disconnectPeer(ENetPeer *peer, DisconnectReason reason) {
 	if (peer == nullptr) {
 		return false;
 	}
-	Log::info("trying to disconnect peer: %u", peer->connectID);
-	enet_peer_disconnect(peer, core::enumVal(reason));
-	if (peer->state == ENET_PEER_STATE_DISCONNECTED) {
+	bool disconnected;
+	{
+		core::ScopedLock<core::Lock> lock(_hostLock);
+		Log::info("trying to disconnect peer: %u", peer->connectID);
+		enet_peer_disconnect(peer, core::enumVal(reason));
+		disconnected = peer->state == ENET_PEER_STATE_DISCONNECTED;
+	}
+	if (disconnected) {
 		_eventBus->publish(DisconnectEvent(peer, reason));
 	}
 	return true;
@@ -53,9 +58,17 @@ void Network::updateHost(ENetHost* host) {
 	if (host == nullptr) {
 		return;
 	}
-	enet_host_flush(host);
-	ENetEvent event;
-	while (enet_host_service(host, &event, 0) > 0) {
+	_events.clear();
+	{
+		core::ScopedLock<core::Lock> lock(_hostLock);
+		enet_host_flush(host);
+		ENetEvent event;
+		while (enet_host_service(host, &event, 0) > 0) {
+			_events.push_back(event);
+		}
+	}
+	// the handlers are sending messages - and the map threads shouldn't wait for them
+	for (ENetEvent& event : _events) {
 		core_trace_scoped(NetworkEventHandling);
 		switch (event.type) {
 		case ENET_EVENT_TYPE_CONNECT: {
@@ -13,8 +13,11 @@
 #include "core/EventBus.h"
 #include "core/IComponent.h"
 #include "core/String.h"
+#include "core/Trace.h"
+#include "core/concurrent/Lock.h"
 #include <stdint.h>
 #include <memory>
+#include <vector>
 
 namespace network {
 
@@ -33,6 +36,15 @@ private:
 protected:
 	ProtocolHandlerRegistryPtr _protocolHandlerRegistry;
 	core::EventBusPtr _eventBus;
+	/**
+	 * enet is not thread safe - but messages are sent from the threads that tick the maps, too.
+	 * @note The lock is only held for the enet calls - the received events are handled without it.
+	 */
+	core_trace_mutex(core::Lock, _hostLock, "NetworkHost");
+	/**
+	 * the events of the last host service - only used by updateHost()
+	 */
+	std::vector<ENetEvent> _events;
 
 	/**
 	 * @brief Package deserialization
@@ -55,6 +67,7 @@ public:
 };
 
 inline bool Network::sendMessage(ENetPeer* peer, ENetPacket* packet, int channel) {
+	core::ScopedLock<core::Lock> lock(_hostLock);
 	if (packet->dataLength >= peer->host->maximumPacketSize) {
 		Log::error("Packet is too big: %i - max allowed is %i", (int)packet->dataLength, (int)peer->host->maximumPacketSize);
 		enet_packet_destroy(packet);
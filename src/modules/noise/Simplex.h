@@ -30,6 +30,7 @@
 #include <random>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 #include <glm/common.hpp>
 #include <glm/geometric.hpp>
 #include <glm/vec2.hpp>
@@ -119,6 +120,15 @@ inline float fBm(const glm::vec3 &v, uint8_t octaves = 4, float lacunarity = 2.0
 //! Returns a 4D simplex noise fractal brownian motion sum
 inline float fBm(const glm::vec4 &v, uint8_t octaves = 4, float lacunarity = 2.0f, float gain = 0.5f);
 
+//! Calculates the 2D simplex noise for @c amount positions given as structure of arrays
+inline void noise(const float *x, const float *y, float *out, int amount);
+//! Calculates the 3D simplex noise for @c amount positions given as structure of arrays
+inline void noise(const float *x, const float *y, const float *z, float *out, int amount);
+//! Calculates the 2D simplex noise fractal brownian motion sum for @c amount positions given as structure of arrays
+inline void fBm(const float *x, const float *y, float *out, int amount, uint8_t octaves = 4, float lacunarity = 2.0f, float gain = 0.5f);
+//! Calculates the 3D simplex noise fractal brownian motion sum for @c amount positions given as structure of arrays
+inline void fBm(const float *x, const float *y, const float *z, float *out, int amount, uint8_t octaves = 4, float lacunarity = 2.0f, float gain = 0.5f);
+
 //! Returns a 2D simplex cellular/worley noise fractal brownian motion sum
 inline float worleyfBm(const glm::vec2 &v, uint8_t octaves = 4, float lacunarity = 2.0f, float gain = 0.5f);
 //! Returns a 3D simplex cellular/worley noise fractal brownian motion sum
@@ -2037,6 +2047,242 @@ float fBm(const glm::vec4 &v, uint8_t octaves, float lacunarity, float gain) {
 	return details::fBm_t(v, octaves, lacunarity, gain);
 }
 
+/*
+ * Batched noise. The positions are processed in blocks of SimplexLanes. Every step of the
+ * noise is done for all lanes of a block before the next step is done - and the branches of
+ * the scalar implementation are replaced by selects. This allows the compiler to vectorize
+ * the arithmetic. The permutation table lookups remain scalar. The results match the ones
+ * of the scalar functions.
+ */
+namespace details {
+static constexpr int SimplexLanes = 8;
+
+/*
+ * Branch free select - the compilers turn multiplications with 0.0 and 1.0 or the ternary
+ * operator into branches which prevents the vectorization of the lane loops.
+ */
+inline float selectLanes(bool condition, float a, float b) {
+	uint32_t ai, bi;
+	memcpy(&ai, &a, sizeof(ai));
+	memcpy(&bi, &b, sizeof(bi));
+	const uint32_t mask = 0u - (uint32_t)condition;
+	const uint32_t ri = (ai & mask) | (bi & ~mask);
+	float r;
+	memcpy(&r, &ri, sizeof(r));
+	return r;
+}
+
+inline float cornerContribution(float t, float grad) {
+	t = selectLanes(t > 0.0f, t, 0.0f);
+	t *= t;
+	return t * t * grad;
+}
+
+// The same as grad(hash, x, y) - but without branches
+inline float gradLanes(int hash, float x, float y) {
+	const int h = hash & 7;
+	const float u = selectLanes(h < 4, x, y);
+	const float v = selectLanes(h < 4, y, x);
+	return selectLanes(h & 1, -u, u) + selectLanes(h & 2, -2.0f * v, 2.0f * v);
+}
+
+// The same as grad(hash, x, y, z) - but without branches
+inline float gradLanes(int hash, float x, float y, float z) {
+	const int h = hash & 15;
+	const float u = selectLanes(h < 8, x, y);
+	const float v = selectLanes(h < 4, y, selectLanes((h | 2) == 14, x, z));
+	return selectLanes(h & 1, -u, u) + selectLanes(h & 2, -v, v);
+}
+
+inline void noiseLanes(const float *x, const float *y, float *out) {
+	int ii[SimplexLanes], jj[SimplexLanes], i1[SimplexLanes], j1[SimplexLanes];
+	float x0[SimplexLanes], y0[SimplexLanes], x1[SimplexLanes], y1[SimplexLanes], x2[SimplexLanes], y2[SimplexLanes];
+	for (int l = 0; l < SimplexLanes; ++l) {
+		const float s = (x[l] + y[l]) * F2;
+		const float xs = x[l] + s;
+		const float ys = y[l] + s;
+		const int i = FASTFLOOR(xs);
+		const int j = FASTFLOOR(ys);
+		const float t = (float) (i + j) * G2;
+		const float X0 = i - t;
+		const float Y0 = j - t;
+		x0[l] = x[l] - X0;
+		y0[l] = y[l] - Y0;
+		i1[l] = x0[l] > y0[l] ? 1 : 0;
+		j1[l] = 1 - i1[l];
+		x1[l] = x0[l] - i1[l] + G2;
+		y1[l] = y0[l] - j1[l] + G2;
+		x2[l] = x0[l] - 1.0f + 2.0f * G2;
+		y2[l] = y0[l] - 1.0f + 2.0f * G2;
+		ii[l] = i & 0xff;
+		jj[l] = j & 0xff;
+	}
+	// perm is thread local - resolve its address only once
+	const LutType *p = perm;
+	int h0[SimplexLanes], h1[SimplexLanes], h2[SimplexLanes];
+	for (int l = 0; l < SimplexLanes; ++l) {
+		h0[l] = p[ii[l] + p[jj[l]]];
+		h1[l] = p[ii[l] + i1[l] + p[jj[l] + j1[l]]];
+		h2[l] = p[ii[l] + 1 + p[jj[l] + 1]];
+	}
+	for (int l = 0; l < SimplexLanes; ++l) {
+		const float n0 = cornerContribution(0.5f - x0[l] * x0[l] - y0[l] * y0[l], gradLanes(h0[l], x0[l], y0[l]));
+		const float n1 = cornerContribution(0.5f - x1[l] * x1[l] - y1[l] * y1[l], gradLanes(h1[l], x1[l], y1[l]));
+		const float n2 = cornerContribution(0.5f - x2[l] * x2[l] - y2[l] * y2[l], gradLanes(h2[l], x2[l], y2[l]));
+		out[l] = 40.0f * (n0 + n1 + n2);
+	}
+}
+
+inline void noiseLanes(const float *x, const float *y, const float *z, float *out) {
+	int ii[SimplexLanes], jj[SimplexLanes], kk[SimplexLanes];
+	int i1[SimplexLanes], j1[SimplexLanes], k1[SimplexLanes];
+	int i2[SimplexLanes], j2[SimplexLanes], k2[SimplexLanes];
+	float x0[SimplexLanes], y0[SimplexLanes], z0[SimplexLanes];
+	for (int l = 0; l < SimplexLanes; ++l) {
+		const float s = (x[l] + y[l] + z[l]) * F3;
+		const float xs = x[l] + s;
+		const float ys = y[l] + s;
+		const float zs = z[l] + s;
+		const int i = FASTFLOOR(xs);
+		const int j = FASTFLOOR(ys);
+		const int k = FASTFLOOR(zs);
+		const float t = (float) (i + j + k) * G3;
+		const float X0 = i - t;
+		const float Y0 = j - t;
+		const float Z0 = k - t;
+		x0[l] = x[l] - X0;
+		y0[l] = y[l] - Y0;
+		z0[l] = z[l] - Z0;
+		ii[l] = i & 0xff;
+		jj[l] = j & 0xff;
+		kk[l] = k & 0xff;
+	}
+	// the simplex corner offsets - the same as the branches in the scalar implementation
+	for (int l = 0; l < SimplexLanes; ++l) {
+		const int xy = x0[l] >= y0[l];
+		const int yz = y0[l] >= z0[l];
+		const int xz = x0[l] >= z0[l];
+		i1[l] = xy & xz;
+		j1[l] = (1 - xy) & yz;
+		k1[l] = 1 - i1[l] - j1[l];
+		i2[l] = xy | xz;
+		j2[l] = (1 - xy) | yz;
+		k2[l] = 2 - i2[l] - j2[l];
+	}
+	const LutType *p = perm;
+	int h0[SimplexLanes], h1[SimplexLanes], h2[SimplexLanes], h3[SimplexLanes];
+	for (int l = 0; l < SimplexLanes; ++l) {
+		h0[l] = p[ii[l] + p[jj[l] + p[kk[l]]]];
+		h1[l] = p[ii[l] + i1[l] + p[jj[l] + j1[l] + p[kk[l] + k1[l]]]];
+		h2[l] = p[ii[l] + i2[l] + p[jj[l] + j2[l] + p[kk[l] + k2[l]]]];
+		h3[l] = p[ii[l] + 1 + p[jj[l] + 1 + p[kk[l] + 1]]];
+	}
+	for (int l = 0; l < SimplexLanes; ++l) {
+		const float x1 = x0[l] - i1[l] + G3;
+		const float y1 = y0[l] - j1[l] + G3;
+		const float z1 = z0[l] - k1[l] + G3;
+		const float x2 = x0[l] - i2[l] + 2.0f * G3;
+		const float y2 = y0[l] - j2[l] + 2.0f * G3;
+		const float z2 = z0[l] - k2[l] + 2.0f * G3;
+		const float x3 = x0[l] - 1.0f + 3.0f * G3;
+		const float y3 = y0[l] - 1.0f + 3.0f * G3;
+		const float z3 = z0[l] - 1.0f + 3.0f * G3;
+		const float n0 = cornerContribution(0.6f - x0[l] * x0[l] - y0[l] * y0[l] - z0[l] * z0[l], gradLanes(h0[l], x0[l], y0[l], z0[l]));
+		const float n1 = cornerContribution(0.6f - x1 * x1 - y1 * y1 - z1 * z1, gradLanes(h1[l], x1, y1, z1));
+		const float n2 = cornerContribution(0.6f - x2 * x2 - y2 * y2 - z2 * z2, gradLanes(h2[l], x2, y2, z2));
+		const float n3 = cornerContribution(0.6f - x3 * x3 - y3 * y3 - z3 * z3, gradLanes(h3[l], x3, y3, z3));
+		out[l] = 32.0f * (n0 + n1 + n2 + n3);
+	}
+}
+
+/**
+ * Calls the lane function for full blocks directly on the given arrays - the last block is
+ * padded with zeros.
+ */
+template<int COMPONENTS, class FUNC>
+inline void forEachBlock(const float* const (&in)[COMPONENTS], float *out, int amount, FUNC&& func) {
+	int start = 0;
+	for (; start + SimplexLanes <= amount; start += SimplexLanes) {
+		func(start, in, out + start);
+	}
+	if (start < amount) {
+		const int left = amount - start;
+		float padded[COMPONENTS][SimplexLanes] = {};
+		const float* paddedIn[COMPONENTS];
+		for (int c = 0; c < COMPONENTS; ++c) {
+			for (int l = 0; l < left; ++l) {
+				padded[c][l] = in[c][start + l];
+			}
+			paddedIn[c] = padded[c];
+		}
+		float paddedOut[SimplexLanes];
+		func(0, paddedIn, paddedOut);
+		for (int l = 0; l < left; ++l) {
+			out[start + l] = paddedOut[l];
+		}
+	}
+}
+
+template<int COMPONENTS>
+inline void fBmLanes(const float* const (&in)[COMPONENTS], float *out, uint8_t octaves, float lacunarity, float gain) {
+	float sum[SimplexLanes] = {};
+	float scaled[COMPONENTS][SimplexLanes];
+	float n[SimplexLanes];
+	float freq = 1.0f;
+	float amp = 0.5f;
+	for (uint8_t i = 0; i < octaves; ++i) {
+		for (int c = 0; c < COMPONENTS; ++c) {
+			for (int l = 0; l < SimplexLanes; ++l) {
+				scaled[c][l] = in[c][l] * freq;
+			}
+		}
+		if (COMPONENTS == 2) {
+			noiseLanes(scaled[0], scaled[1], n);
+		} else {
+			noiseLanes(scaled[0], scaled[1], scaled[COMPONENTS - 1], n);
+		}
+		for (int l = 0; l < SimplexLanes; ++l) {
+			sum[l] += n[l] * amp;
+		}
+		freq *= lacunarity;
+		amp *= gain;
+	}
+	for (int l = 0; l < SimplexLanes; ++l) {
+		out[l] = sum[l];
+	}
+}
+}
+
+void noise(const float *x, const float *y, float *out, int amount) {
+	const float* const in[] = {x, y};
+	details::forEachBlock<2>(in, out, amount, [] (int start, const float* const (&block)[2], float *blockOut) {
+		details::noiseLanes(block[0] + start, block[1] + start, blockOut);
+	});
+}
+
+void noise(const float *x, const float *y, const float *z, float *out, int amount) {
+	const float* const in[] = {x, y, z};
+	details::forEachBlock<3>(in, out, amount, [] (int start, const float* const (&block)[3], float *blockOut) {
+		details::noiseLanes(block[0] + start, block[1] + start, block[2] + start, blockOut);
+	});
+}
+
+void fBm(const float *x, const float *y, float *out, int amount, uint8_t octaves, float lacunarity, float gain) {
+	const float* const in[] = {x, y};
+	details::forEachBlock<2>(in, out, amount, [=] (int start, const float* const (&block)[2], float *blockOut) {
+		const float* const lanes[] = {block[0] + start, block[1] + start};
+		details::fBmLanes<2>(lanes, blockOut, octaves, lacunarity, gain);
+	});
+}
+
+void fBm(const float *x, const float *y, const float *z, float *out, int amount, uint8_t octaves, float lacunarity, float gain) {
+	const float* const in[] = {x, y, z};
+	details::forEachBlock<3>(in, out, amount, [=] (int start, const float* const (&block)[3], float *blockOut) {
+		const float* const lanes[] = {block[0] + start, block[1] + start, block[2] + start};
+		details::fBmLanes<3>(lanes, blockOut, octaves, lacunarity, gain);
+	});
+}
+
 namespace details {
 template<typename T>
 float worleyfBm_t(const T &input, uint8_t octaves, float lacunarity, float gain) {
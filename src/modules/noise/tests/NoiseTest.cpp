@@ -5,6 +5,7 @@
 #include "app/tests/AbstractTest.h"
 #include "compute/Compute.h"
 #include "noise/Noise.h"
+#include "noise/Simplex.h"
 #include "image/Image.h"
 #include "core/GLM.h"
 #include "core/StringUtil.h"
@@ -52,4 +53,26 @@ TEST_F(NoiseTest, testSeamlessNoiseCPU) {
 	seamlessNoise(false);
 }
 
+TEST_F(NoiseTest, testBatchedNoiseMatchesScalar) {
+	// not a multiple of the lanes to also cover the padded last block
+	const int amount = 77;
+	float x[amount], y[amount], z[amount];
+	for (int i = 0; i < amount; ++i) {
+		x[i] = -20.3f + (float)i * 0.731f;
+		y[i] = (float)(i % 13) * -1.17f;
+		z[i] = 100.5f - (float)i * 0.313f;
+	}
+	float noise2d[amount], noise3d[amount], fBm2d[amount], fBm3d[amount];
+	noise::noise(x, y, noise2d, amount);
+	noise::noise(x, y, z, noise3d, amount);
+	noise::fBm(x, z, fBm2d, amount, 3, 2.1f, 0.4f);
+	noise::fBm(x, y, z, fBm3d, amount, 5, 1.9f, 0.6f);
+	for (int i = 0; i < amount; ++i) {
+		EXPECT_FLOAT_EQ(noise::noise(glm::vec2(x[i], y[i])), noise2d[i]) << "index " << i;
+		EXPECT_FLOAT_EQ(noise::noise(glm::vec3(x[i], y[i], z[i])), noise3d[i]) << "index " << i;
+		EXPECT_FLOAT_EQ(noise::fBm(glm::vec2(x[i], z[i]), 3, 2.1f, 0.4f), fBm2d[i]) << "index " << i;
+		EXPECT_FLOAT_EQ(noise::fBm(glm::vec3(x[i], y[i], z[i]), 5, 1.9f, 0.6f), fBm3d[i]) << "index " << i;
+	}
+}
+
 }
@@ -0,0 +1,52 @@
+/**
+ * @file
+ *
+ * Quantization of the entity state that is replicated from the server to the clients
+ */
+
+#pragma once
+
+#include "core/GLM.h"
+#include <glm/vec3.hpp>
+#include <glm/gtc/constants.hpp>
+#include <stdint.h>
+
+namespace shared {
+
+/**
+ * @brief The amount of steps per world unit for quantized positions
+ */
+static constexpr float PositionQuantizationSteps = 16.0f;
+/**
+ * @brief The amount of steps for a full circle for quantized orientations
+ */
+static constexpr float OrientationQuantizationSteps = 65536.0f;
+
+inline glm::ivec3 quantizePosition(const glm::vec3& pos) {
+	return glm::ivec3(glm::round(pos * PositionQuantizationSteps));
+}
+
+inline glm::vec3 dequantizePosition(const glm::ivec3& pos) {
+	return glm::vec3(pos) / PositionQuantizationSteps;
+}
+
+/**
+ * @param[in] orientation The orientation in radians - this is wrapped into [0,2pi)
+ */
+inline uint16_t quantizeOrientation(float orientation) {
+	const float twoPi = glm::two_pi<float>();
+	float wrapped = glm::mod(orientation, twoPi);
+	if (wrapped < 0.0f) {
+		wrapped += twoPi;
+	}
+	return (uint16_t)((uint32_t)glm::round(wrapped / twoPi * OrientationQuantizationSteps) & 0xFFFFu);
+}
+
+/**
+ * @return The orientation in radians in the range [0,2pi)
+ */
+inline float dequantizeOrientation(uint16_t orientation) {
+	return (float)orientation / OrientationQuantizationSteps * glm::two_pi<float>();
+}
+
+}
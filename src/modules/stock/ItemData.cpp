@@ -23,7 +23,7 @@ const char *ItemData::label(const char *key) const {
 	if (it == _labels.end()) {
 		return nullptr;
 	}
-	return it->second.c_str();
+	return it->value.c_str();
 }
 
 void ItemData::setSize(uint8_t width, uint8_t height) {
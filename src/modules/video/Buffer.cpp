@@ -196,6 +196,37 @@ bool Buffer::update(int32_t idx, const void* data, size_t size) {
 	return true;
 }
 
+bool Buffer::update(int32_t idx, size_t offset, const void* data, size_t size) {
+	if (!isValid(idx)) {
+		return false;
+	}
+	if (offset + size > _size[idx]) {
+		Log::error("Buffer range update exceeds the buffer size (offset: %i, size: %i, buffer size: %i)",
+				(int)offset, (int)size, (int)_size[idx]);
+		return false;
+	}
+	core_assert(video::boundVertexArray() == InvalidId);
+	video::bufferSubData(_handles[idx], _targets[idx], (intptr_t)offset, data, size);
+	return true;
+}
+
+bool Buffer::reserve(int32_t idx, size_t size) {
+	if (!isValid(idx)) {
+		return false;
+	}
+	core_assert(video::boundVertexArray() == InvalidId);
+	// the index buffer is only attached to the vertex array object if it has a size
+	if (_size[idx] == 0u && size > 0u) {
+		_dirtyAttributes = true;
+	}
+	_size[idx] = size;
+#if VIDEO_BUFFER_HASH_COMPARE
+	_hash[idx] = 0u;
+#endif
+	video::bufferData(_handles[idx], _targets[idx], _modes[idx], nullptr, size);
+	return true;
+}
+
 int32_t Buffer::create(const void* data, size_t size, BufferType target) {
 	if (_handleIdx >= MAX_HANDLES) {
 		return -1;
@@ -70,6 +70,18 @@ public:
 	void unmapData(int32_t idx) const;
 
 	bool update(int32_t idx, const void* data, size_t size);
+	/**
+	 * @brief Updates a sub range of the buffer in place
+	 * @note The range must fit into the size that was given to @c reserve() or @c update() before
+	 * @sa reserve()
+	 */
+	bool update(int32_t idx, size_t offset, const void* data, size_t size);
+	/**
+	 * @brief Allocates the gpu memory for the given buffer without uploading any data
+	 * @note The previous content of the buffer is lost
+	 * @sa update(int32_t, size_t, const void*, size_t)
+	 */
+	bool reserve(int32_t idx, size_t size);
 
 	/**
 	 * @return -1 on error - otherwise the index [0,n) of the created buffer (not the Id)
@@ -0,0 +1,94 @@
+/**
+ * @file
+ */
+
+#include "BufferAllocator.h"
+#include "core/Assert.h"
+#include <algorithm>
+
+namespace video {
+
+BufferAllocator::BufferAllocator(uint32_t capacity) {
+	reset(capacity);
+}
+
+void BufferAllocator::reset(uint32_t capacity) {
+	_free.clear();
+	_capacity = capacity;
+	_used = 0u;
+	if (capacity > 0u) {
+		_free.push_back(BufferRange{0u, capacity});
+	}
+}
+
+void BufferAllocator::grow(uint32_t capacity) {
+	if (capacity <= _capacity) {
+		return;
+	}
+	const BufferRange range{_capacity, capacity - _capacity};
+	_capacity = capacity;
+	insertFree(range);
+}
+
+void BufferAllocator::insertFree(const BufferRange& range) {
+	auto i = std::lower_bound(_free.begin(), _free.end(), range.offset, [] (const BufferRange& r, uint32_t offset) {
+		return r.offset < offset;
+	});
+	// merge with the following free range
+	if (i != _free.end() && range.offset + range.size == i->offset) {
+		i->offset = range.offset;
+		i->size += range.size;
+	} else {
+		i = _free.insert(i, range);
+	}
+	// merge with the preceding free range
+	if (i != _free.begin()) {
+		auto prev = i - 1;
+		if (prev->offset + prev->size == i->offset) {
+			prev->size += i->size;
+			_free.erase(i);
+		}
+	}
+}
+
+BufferRange BufferAllocator::alloc(uint32_t size) {
+	if (size == 0u) {
+		return BufferRange();
+	}
+	for (auto i = _free.begin(); i != _free.end(); ++i) {
+		if (i->size < size) {
+			continue;
+		}
+		const BufferRange range{i->offset, size};
+		if (i->size == size) {
+			_free.erase(i);
+		} else {
+			i->offset += size;
+			i->size -= size;
+		}
+		_used += size;
+		return range;
+	}
+	return BufferRange();
+}
+
+void BufferAllocator::free(BufferRange& range) {
+	if (!range.valid()) {
+		return;
+	}
+	core_assert(range.offset + range.size <= _capacity);
+	core_assert(_used >= range.size);
+	_used -= range.size;
+	insertFree(range);
+	range = BufferRange();
+}
+
+uint32_t BufferAllocator::largestFree() const {
+	uint32_t largest = 0u;
+	for (const BufferRange& range : _free) {
+		largest = std::max(largest, range.size);
+	}
+	return largest;
+}
+
+}
@@ -0,0 +1,85 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+namespace video {
+
+/**
+ * @brief A range of elements inside a gpu buffer that is managed by the @c BufferAllocator
+ */
+struct BufferRange {
+	uint32_t offset = 0u;
+	uint32_t size = 0u;
+
+	inline bool valid() const {
+		return size > 0u;
+	}
+};
+
+/**
+ * @brief First-fit free list allocator for sub ranges of one big gpu buffer.
+ *
+ * The allocator doesn't touch the gpu memory - it only hands out element offsets. This allows
+ * to update the data of one sub range (e.g. a mesh tile) in place with @c Buffer::update(idx, offset, data, size)
+ * and draw all ranges with base vertex (multi) draw calls.
+ *
+ * Freed ranges are merged with their neighbours to keep the fragmentation low.
+ * @ingroup Video
+ */
+class BufferAllocator {
+private:
+	/** sorted by offset - there are never two adjacent free ranges */
+	std::vector<BufferRange> _free;
+	uint32_t _capacity = 0u;
+	uint32_t _used = 0u;
+
+	void insertFree(const BufferRange& range);
+public:
+	BufferAllocator(uint32_t capacity = 0u);
+
+	/**
+	 * @brief Forget about all allocations and start over with the given capacity
+	 */
+	void reset(uint32_t capacity);
+	/**
+	 * @brief Enlarge the managed buffer. All existing allocations stay valid.
+	 */
+	void grow(uint32_t capacity);
+
+	/**
+	 * @return An invalid range if there is no free range that is big enough
+	 * @sa BufferRange::valid()
+	 */
+	BufferRange alloc(uint32_t size);
+	void free(BufferRange& range);
+
+	uint32_t capacity() const;
+	uint32_t used() const;
+	/**
+	 * @return The size of the biggest range that can be allocated without growing the buffer
+	 */
+	uint32_t largestFree() const;
+	/**
+	 * @return The amount of free ranges - 1 means no fragmentation
+	 */
+	int freeRanges() const;
+};
+
+inline uint32_t BufferAllocator::capacity() const {
+	return _capacity;
+}
+
+inline uint32_t BufferAllocator::used() const {
+	return _used;
+}
+
+inline int BufferAllocator::freeRanges() const {
+	return (int)_free.size();
+}
+
+}
@@ -321,7 +321,7 @@ extern void drawElements(Primitive mode, size_t numIndices, DataType type, void*
 extern void drawElementsInstanced(Primitive mode, size_t numIndices, DataType type, size_t amount);
 extern void drawElementsBaseVertex(Primitive mode, size_t numIndices, DataType type, size_t indexSize, int baseIndex, int baseVertex);
 extern void drawElementsIndirect(Primitive mode, DataType type, void* offset);
-inline void drawMultiElementsIndirect(Primitive mode, DataType type, void* offset, size_t commandSize, size_t stride = 0u);
+extern void drawMultiElementsIndirect(Primitive mode, DataType type, void* offset, size_t commandSize, size_t stride = 0u);
 extern void drawArraysIndirect(Primitive mode, void* offset);
 inline void drawMultiArraysIndirect(Primitive mode, void* offset, size_t commandSize, size_t stride = 0u);
 extern void drawArrays(Primitive mode, size_t count);
@@ -364,8 +364,8 @@ inline void drawElementsIndirect(Primitive mode, void* offset) {
 }
 
 template<class IndexType>
-inline void drawMultiElementsIndirect(Primitive mode, void* offset, size_t commandSize) {
-	drawMultiElementsIndirect(mode, mapType<IndexType>(), offset, commandSize);
+inline void drawMultiElementsIndirect(Primitive mode, void* offset, size_t commandSize, size_t stride = 0u) {
+	drawMultiElementsIndirect(mode, mapType<IndexType>(), offset, commandSize, stride);
 }
 
 template<class IndexType>
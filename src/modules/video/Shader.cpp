@@ -106,7 +106,7 @@ bool Shader::isUniformBlock(const core::String& name) const {
 	if (i == _uniforms.end()) {
 		return false;
 	}
-	return i->second.block;
+	return i->value.block;
 }
 
 void Shader::checkAttribute(const core::String& attribute) {
@@ -151,7 +151,7 @@ int Shader::getUniformArraySize(const core::String& name) const {
 		Log::trace("can't find uniform %s in shader %s - unknown array size", name.c_str(), _name.c_str());
 		return -1;
 	}
-	return i->second;
+	return i->value;
 }
 
 void Shader::shutdown() {
@@ -309,7 +309,7 @@ int Shader::checkAttributeLocation(const core::String& name) const {
 	if (i == _attributes.end()) {
 		return -1;
 	}
-	return i->second;
+	return i->value;
 }
 
 bool Shader::checkUniformCache(int location, const void* value, size_t length) const {
@@ -344,7 +344,7 @@ const Uniform* Shader::getUniform(const core::String& name) const {
 		}
 		return nullptr;
 	}
-	return &i->second;
+	return &i->value;
 }
 
 int Shader::fetchUniforms() {
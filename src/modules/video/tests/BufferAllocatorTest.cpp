@@ -0,0 +1,70 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "video/BufferAllocator.h"
+
+namespace video {
+
+TEST(BufferAllocatorTest, testAlloc) {
+	BufferAllocator allocator(100u);
+	BufferRange a = allocator.alloc(10u);
+	BufferRange b = allocator.alloc(20u);
+	ASSERT_TRUE(a.valid());
+	ASSERT_TRUE(b.valid());
+	EXPECT_EQ(0u, a.offset);
+	EXPECT_EQ(10u, b.offset);
+	EXPECT_EQ(30u, allocator.used());
+	EXPECT_EQ(70u, allocator.largestFree());
+	EXPECT_FALSE(allocator.alloc(71u).valid());
+	EXPECT_FALSE(allocator.alloc(0u).valid());
+}
+
+TEST(BufferAllocatorTest, testFreeCoalesce) {
+	BufferAllocator allocator(100u);
+	BufferRange a = allocator.alloc(10u);
+	BufferRange b = allocator.alloc(10u);
+	BufferRange c = allocator.alloc(10u);
+	allocator.free(a);
+	EXPECT_FALSE(a.valid());
+	allocator.free(c);
+	EXPECT_EQ(2, allocator.freeRanges());
+	allocator.free(b);
+	EXPECT_EQ(1, allocator.freeRanges());
+	EXPECT_EQ(0u, allocator.used());
+	EXPECT_EQ(100u, allocator.largestFree());
+}
+
+TEST(BufferAllocatorTest, testReuseFreedRange) {
+	BufferAllocator allocator(100u);
+	BufferRange a = allocator.alloc(10u);
+	BufferRange b = allocator.alloc(10u);
+	allocator.free(a);
+	// first fit - the hole at the beginning is reused
+	const BufferRange c = allocator.alloc(5u);
+	EXPECT_EQ(0u, c.offset);
+	const BufferRange d = allocator.alloc(10u);
+	EXPECT_EQ(20u, d.offset);
+	EXPECT_EQ(10u, b.offset);
+}
+
+TEST(BufferAllocatorTest, testGrow) {
+	BufferAllocator allocator(16u);
+	const BufferRange a = allocator.alloc(8u);
+	BufferRange b = allocator.alloc(8u);
+	EXPECT_FALSE(allocator.alloc(8u).valid());
+	allocator.grow(32u);
+	const BufferRange c = allocator.alloc(16u);
+	ASSERT_TRUE(c.valid());
+	EXPECT_EQ(16u, c.offset);
+	EXPECT_EQ(0u, a.offset);
+	allocator.free(b);
+	// the freed range and the remaining free space are not adjacent
+	EXPECT_EQ(1, allocator.freeRanges());
+	allocator.grow(40u);
+	EXPECT_EQ(2, allocator.freeRanges());
+	EXPECT_EQ(8u, allocator.largestFree());
+}
+
+}
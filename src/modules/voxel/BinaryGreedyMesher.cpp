@@ -0,0 +1,295 @@
+/**
+ * @file
+ */
+
+#include "BinaryGreedyMesher.h"
+#include "CubicSurfaceExtractor.h"
+#include "core/Common.h"
+#include "core/Assert.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace voxel {
+
+namespace {
+
+/**
+ * @brief Describes one of the six face directions. The faces of a plane are stored in rows of bits - the bits
+ * are along the axis @c bitAxis and the rows along the axis @c rowAxis.
+ */
+struct FaceDirection {
+	int axis;
+	int rowAxis;
+	int bitAxis;
+	/** @c true if the solid voxel of the face is on the lower side of the plane */
+	bool positive;
+	/** the winding of the quad vertices - see the quad creation of @c extractCubicMesh() */
+	bool reverse;
+};
+
+// the winding matches the quads of extractCubicMesh() - the order is given in (row, bit) coordinates
+static const FaceDirection FaceDirections[] = {
+	{0, 1, 2, true,  true},  // PositiveX
+	{1, 2, 0, true,  true},  // PositiveY
+	{2, 1, 0, true,  false}, // PositiveZ
+	{0, 1, 2, false, false}, // NegativeX
+	{1, 2, 0, false, false}, // NegativeY
+	{2, 1, 0, false, true}   // NegativeZ
+};
+
+inline int words(int bits) {
+	return (bits + 63) / 64;
+}
+
+inline int countTrailingZeros(uint64_t v) {
+	core_assert(v != 0u);
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, v);
+	return (int)index;
+#else
+	return __builtin_ctzll(v);
+#endif
+}
+
+inline bool isBitSet(const uint64_t* row, int bit) {
+	return (row[bit >> 6] >> (bit & 63)) & 1u;
+}
+
+inline void clearBit(uint64_t* row, int bit) {
+	row[bit >> 6] &= ~(uint64_t(1) << (bit & 63));
+}
+
+inline bool isSolid(const Voxel& voxel) {
+	const VoxelType material = voxel.getMaterial();
+	return !isAir(material) && !isWater(material);
+}
+
+class PlaneMesher {
+private:
+	const BinaryGreedyScratch& _scratch;
+	const FaceDirection& _dir;
+	Mesh* _result;
+	const glm::ivec3& _translate;
+	const int _plane;
+	const int _frontPlane;
+
+	inline const Voxel& voxel(int plane, int row, int bit) const {
+		glm::ivec3 pos;
+		pos[_dir.axis] = plane;
+		pos[_dir.rowAxis] = row;
+		pos[_dir.bitAxis] = bit;
+		return _scratch.voxels[_scratch.index(pos.x, pos.y, pos.z)];
+	}
+
+	inline bool isFrontSolid(int row, int bit) const {
+		return isSolid(voxel(_frontPlane, row, bit));
+	}
+
+public:
+	PlaneMesher(const BinaryGreedyScratch& scratch, const FaceDirection& dir, Mesh* result, const glm::ivec3& translate, int plane) :
+			_scratch(scratch), _dir(dir), _result(result), _translate(translate), _plane(plane),
+			_frontPlane(dir.positive ? plane : plane - 1) {
+	}
+
+	/**
+	 * @return The color of the solid voxel of the face
+	 */
+	inline uint8_t color(int row, int bit) const {
+		return voxel(_dir.positive ? _plane - 1 : _plane, row, bit).getColor();
+	}
+
+	/**
+	 * @brief The ambient occlusion of the face corner in the given directions of the given cell. The occluders are
+	 * looked up in the (non solid) layer of voxels in front of the face.
+	 */
+	inline uint8_t ambientOcclusion(int row, int bit, int rowDir, int bitDir) const {
+		return vertexAmbientOcclusion(isFrontSolid(row + rowDir, bit), isFrontSolid(row, bit + bitDir),
+				isFrontSolid(row + rowDir, bit + bitDir));
+	}
+
+	/**
+	 * @brief Faces are only merged if they have the same key - that is the color and the ambient occlusion of all
+	 * four corners.
+	 */
+	inline uint32_t key(int row, int bit, bool ao) const {
+		uint32_t k = color(row, bit);
+		if (ao) {
+			k |= (uint32_t)ambientOcclusion(row, bit, -1, -1) << 8;
+			k |= (uint32_t)ambientOcclusion(row, bit, 1, -1) << 10;
+			k |= (uint32_t)ambientOcclusion(row, bit, -1, 1) << 12;
+			k |= (uint32_t)ambientOcclusion(row, bit, 1, 1) << 14;
+		}
+		return k;
+	}
+
+	void addQuad(int row, int bit, int height, int width) {
+		const uint8_t colorIndex = color(row, bit);
+		// the corners in (row, bit) order
+		static const int corners[4][2] = { {0, 0}, {0, 1}, {1, 1}, {1, 0} };
+		IndexType indices[4];
+		for (int i = 0; i < 4; ++i) {
+			// the reverse winding swaps the row and bit direction of the corners
+			const int cr = corners[i][_dir.reverse ? 1 : 0];
+			const int cb = corners[i][_dir.reverse ? 0 : 1];
+			const int cellRow = cr ? row + height - 1 : row;
+			const int cellBit = cb ? bit + width - 1 : bit;
+			glm::ivec3 pos;
+			pos[_dir.axis] = _plane;
+			pos[_dir.rowAxis] = cr ? row + height : row;
+			pos[_dir.bitAxis] = cb ? bit + width : bit;
+			VoxelVertex vertex;
+			// remove the one voxel border of the scratch buffers
+			vertex.position = pos - 1 + _translate;
+			vertex.colorIndex = colorIndex;
+			vertex.ambientOcclusion = ambientOcclusion(cellRow, cellBit, cr ? 1 : -1, cb ? 1 : -1);
+			indices[i] = _result->addVertex(vertex);
+		}
+		const VoxelVertex& v00 = _result->getVertex(indices[3]);
+		const VoxelVertex& v01 = _result->getVertex(indices[0]);
+		const VoxelVertex& v10 = _result->getVertex(indices[2]);
+		const VoxelVertex& v11 = _result->getVertex(indices[1]);
+		if (isQuadFlipped(v00, v01, v10, v11)) {
+			_result->addTriangle(indices[1], indices[2], indices[3]);
+			_result->addTriangle(indices[1], indices[3], indices[0]);
+		} else {
+			_result->addTriangle(indices[0], indices[1], indices[2]);
+			_result->addTriangle(indices[0], indices[2], indices[3]);
+		}
+	}
+};
+
+}
+
+BinaryGreedyScratch& binaryGreedyScratch() {
+	static thread_local BinaryGreedyScratch scratch;
+	return scratch;
+}
+
+void BinaryGreedyScratch::prepare(const Region& region) {
+	dim = region.getDimensionsInVoxels() + 2;
+	voxels.resize(dim.x * dim.y * dim.z);
+	xRows.assign(dim.y * dim.z * words(dim.x), 0u);
+	zRows.assign(dim.x * dim.y * words(dim.z), 0u);
+}
+
+void binaryGreedyMeshify(BinaryGreedyScratch& scratch, Mesh* result, const glm::ivec3& translate, bool ambientOcclusion) {
+	const glm::ivec3& dim = scratch.dim;
+	const int xWords = words(dim.x);
+	const int zWords = words(dim.z);
+
+	{
+		core_trace_scoped(BuildOccupancy);
+		for (int z = 0; z < dim.z; ++z) {
+			for (int y = 0; y < dim.y; ++y) {
+				uint64_t* xRow = &scratch.xRows[(z * dim.y + y) * xWords];
+				const Voxel* voxels = &scratch.voxels[scratch.index(0, y, z)];
+				for (int x = 0; x < dim.x; ++x) {
+					if (!isSolid(voxels[x])) {
+						continue;
+					}
+					xRow[x >> 6] |= uint64_t(1) << (x & 63);
+					scratch.zRows[(y * dim.x + x) * zWords + (z >> 6)] |= uint64_t(1) << (z & 63);
+				}
+			}
+		}
+	}
+
+	core_trace_scoped(GreedyMeshing);
+	for (const FaceDirection& dir : FaceDirections) {
+		const int rows = dim[dir.rowAxis];
+		const int bits = dim[dir.bitAxis];
+		const int rowWords = words(bits);
+		// the border bits are only needed to decide the faces of the region - they don't get faces on their own
+		std::vector<uint64_t> innerBits(rowWords, ~uint64_t(0));
+		clearBit(innerBits.data(), 0);
+		for (int bit = bits - 1; bit < rowWords * 64; ++bit) {
+			clearBit(innerBits.data(), bit);
+		}
+		auto occupancy = [&] (int plane, int row) -> const uint64_t* {
+			if (dir.bitAxis == 2) {
+				// x planes
+				return &scratch.zRows[(row * dim.x + plane) * zWords];
+			}
+			if (dir.axis == 1) {
+				return &scratch.xRows[(row * dim.y + plane) * xWords];
+			}
+			return &scratch.xRows[(plane * dim.y + row) * xWords];
+		};
+		scratch.faces.resize(rows * rowWords);
+		scratch.keys.resize(rows * bits);
+
+		for (int plane = 1; plane < dim[dir.axis] - 1; ++plane) {
+			const int solidPlane = dir.positive ? plane - 1 : plane;
+			const int frontPlane = dir.positive ? plane : plane - 1;
+			uint64_t any = 0u;
+			for (int row = 0; row < rows; ++row) {
+				uint64_t* faces = &scratch.faces[row * rowWords];
+				if (row == 0 || row == rows - 1) {
+					for (int w = 0; w < rowWords; ++w) {
+						faces[w] = 0u;
+					}
+					continue;
+				}
+				const uint64_t* solid = occupancy(solidPlane, row);
+				const uint64_t* front = occupancy(frontPlane, row);
+				for (int w = 0; w < rowWords; ++w) {
+					faces[w] = solid[w] & ~front[w] & innerBits[w];
+					any |= faces[w];
+				}
+			}
+			if (any == 0u) {
+				continue;
+			}
+
+			PlaneMesher mesher(scratch, dir, result, translate, plane);
+			for (int row = 1; row < rows - 1; ++row) {
+				const uint64_t* faces = &scratch.faces[row * rowWords];
+				for (int w = 0; w < rowWords; ++w) {
+					uint64_t word = faces[w];
+					while (word != 0u) {
+						const int bit = w * 64 + countTrailingZeros(word);
+						word &= word - 1u;
+						scratch.keys[row * bits + bit] = mesher.key(row, bit, ambientOcclusion);
+					}
+				}
+			}
+
+			for (int row = 1; row < rows - 1; ++row) {
+				uint64_t* faces = &scratch.faces[row * rowWords];
+				for (int w = 0; w < rowWords; ++w) {
+					while (faces[w] != 0u) {
+						const int bit = w * 64 + countTrailingZeros(faces[w]);
+						const uint32_t key = scratch.keys[row * bits + bit];
+						int width = 1;
+						while (bit + width < bits && isBitSet(faces, bit + width) && scratch.keys[row * bits + bit + width] == key) {
+							++width;
+						}
+						int height = 1;
+						for (; row + height < rows - 1; ++height) {
+							const uint64_t* nextFaces = &scratch.faces[(row + height) * rowWords];
+							const uint32_t* nextKeys = &scratch.keys[(row + height) * bits];
+							int i = 0;
+							while (i < width && isBitSet(nextFaces, bit + i) && nextKeys[bit + i] == key) {
+								++i;
+							}
+							if (i != width) {
+								break;
+							}
+						}
+						for (int r = row; r < row + height; ++r) {
+							uint64_t* clearFaces = &scratch.faces[r * rowWords];
+							for (int i = 0; i < width; ++i) {
+								clearBit(clearFaces, bit + i);
+							}
+						}
+						mesher.addQuad(row, bit, height, width);
+					}
+				}
+			}
+		}
+	}
+}
+
+}
@@ -0,0 +1,95 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Mesh.h"
+#include "Voxel.h"
+#include "Region.h"
+#include "core/Trace.h"
+#include <glm/vec3.hpp>
+#include <vector>
+#include <stdint.h>
+
+namespace voxel {
+
+/**
+ * @brief Buffers of the binary greedy mesher that are kept per thread to not allocate them for every extraction again.
+ *
+ * All buffers cover the extraction region plus a border of one voxel on each side.
+ */
+struct BinaryGreedyScratch {
+	glm::ivec3 dim { 0 };
+	/** the voxels of the padded region, x is the fastest changing index, followed by y and z */
+	std::vector<Voxel> voxels;
+	/** occupancy bits along x - one row of words for each y and z */
+	std::vector<uint64_t> xRows;
+	/** occupancy bits along z - one row of words for each x and y */
+	std::vector<uint64_t> zRows;
+	/** the visible faces of the plane that is currently meshed */
+	std::vector<uint64_t> faces;
+	/** the merge keys of the visible faces of the plane that is currently meshed */
+	std::vector<uint32_t> keys;
+
+	/**
+	 * @brief Sizes the buffers for the given region - but keeps the allocated memory
+	 */
+	void prepare(const Region& region);
+
+	inline int index(int x, int y, int z) const {
+		return (z * dim.y + y) * dim.x + x;
+	}
+};
+
+/**
+ * @return The binary greedy mesher buffers of the calling thread
+ */
+extern BinaryGreedyScratch& binaryGreedyScratch();
+
+/**
+ * @brief Generates the faces from the voxels that were filled into the scratch buffers. See @c extractBinaryGreedyMesh()
+ */
+extern void binaryGreedyMeshify(BinaryGreedyScratch& scratch, Mesh* result, const glm::ivec3& translate, bool ambientOcclusion);
+
+/**
+ * @brief Creates the same cubic mesh as @c extractCubicMesh() with @c IsQuadNeeded - but decides the visible faces
+ * of 64 voxels at once with bitwise operations on occupancy masks and greedily merges them into quads.
+ *
+ * The volume is only sampled once per voxel to build the occupancy bitmasks of the region (and its one voxel border).
+ * The faces of each plane are then merged into rectangles of the same color and ambient occlusion values. This is
+ * linear in the amount of faces - in opposite to the quad merging of @c extractCubicMesh().
+ *
+ * @note Each quad gets its own four vertices - vertices are not shared between quads.
+ * @note Like with @c IsQuadNeeded, air and water are not solid and don't get any faces.
+ * @note The indices are not compressed - this is done once for the final mesh (see @c BrickMeshCache::concatenate())
+ */
+template<typename VolumeType>
+void extractBinaryGreedyMesh(VolumeType* volData, const Region& region, Mesh* result, const glm::ivec3& translate, bool ambientOcclusion = true) {
+	core_trace_scoped(ExtractBinaryGreedyMesh);
+
+	result->clear();
+	result->setOffset(region.getLowerCorner());
+
+	BinaryGreedyScratch& scratch = binaryGreedyScratch();
+	scratch.prepare(region);
+
+	{
+		core_trace_scoped(SampleVoxels);
+		const glm::ivec3 mins = region.getLowerCorner() - 1;
+		typename VolumeType::Sampler volumeSampler(volData);
+		for (int z = 0; z < scratch.dim.z; ++z) {
+			for (int x = 0; x < scratch.dim.x; ++x) {
+				volumeSampler.setPosition(mins.x + x, mins.y, mins.z + z);
+				for (int y = 0; y < scratch.dim.y; ++y) {
+					scratch.voxels[scratch.index(x, y, z)] = volumeSampler.voxel();
+					volumeSampler.movePositiveY();
+				}
+			}
+		}
+	}
+
+	binaryGreedyMeshify(scratch, result, translate, ambientOcclusion);
+}
+
+}
@@ -0,0 +1,89 @@
+/**
+ * @file
+ */
+
+#include "BrickMeshCache.h"
+#include "core/Common.h"
+#include <glm/common.hpp>
+
+namespace voxel {
+
+BrickMeshCache::BrickMeshCache(const Region& region) :
+		_region(region), _bricks((region.getDimensionsInVoxels() + BrickSize - 1) / BrickSize) {
+	const int amount = _bricks.x * _bricks.y * _bricks.z;
+	_meshes.resize(amount);
+	_dirty.resize(amount, true);
+}
+
+Region BrickMeshCache::brickRegion(int index) const {
+	const int x = index % _bricks.x;
+	const int y = (index / _bricks.x) % _bricks.y;
+	const int z = index / (_bricks.x * _bricks.y);
+	const glm::ivec3 mins = _region.getLowerCorner() + glm::ivec3(x, y, z) * BrickSize;
+	const glm::ivec3 maxs = glm::min(mins + (BrickSize - 1), _region.getUpperCorner());
+	return Region(mins, maxs);
+}
+
+bool BrickMeshCache::markDirty(const glm::ivec3& pos) {
+	// the faces of a brick depend on the voxels in a one voxel border around the brick
+	Region affected(_region);
+	affected.grow(1);
+	if (!affected.containsPoint(pos.x, pos.y, pos.z)) {
+		return false;
+	}
+	const glm::ivec3 rel = pos - _region.getLowerCorner();
+	const glm::ivec3 mins = glm::max(rel - 1, 0) / BrickSize;
+	const glm::ivec3 maxs = glm::min(glm::max(rel + 1, 0) / BrickSize, _bricks - 1);
+	core::ScopedLock lock(_dirtyLock);
+	for (int z = mins.z; z <= maxs.z; ++z) {
+		for (int y = mins.y; y <= maxs.y; ++y) {
+			for (int x = mins.x; x <= maxs.x; ++x) {
+				_dirty[brickIndex(x, y, z)] = true;
+			}
+		}
+	}
+	return true;
+}
+
+void BrickMeshCache::markAllDirty() {
+	core::ScopedLock lock(_dirtyLock);
+	_dirty.assign(_dirty.size(), true);
+}
+
+int BrickMeshCache::dirtyBricks() const {
+	core::ScopedLock lock(_dirtyLock);
+	int amount = 0;
+	for (bool dirty : _dirty) {
+		amount += dirty;
+	}
+	return amount;
+}
+
+std::vector<int> BrickMeshCache::takeDirtyBricks() {
+	std::vector<int> dirty;
+	core::ScopedLock lock(_dirtyLock);
+	for (size_t i = 0; i < _dirty.size(); ++i) {
+		if (!_dirty[i]) {
+			continue;
+		}
+		dirty.push_back((int)i);
+		_dirty[i] = false;
+	}
+	return dirty;
+}
+
+bool BrickMeshCache::concatenate(Mesh* result) {
+	core_trace_scoped(BrickMeshCacheConcatenate);
+	core::ScopedLock lock(_updateLock);
+	result->clear();
+	result->setOffset(_region.getLowerCorner());
+	for (const Mesh& mesh : _meshes) {
+		result->append(mesh);
+	}
+	result->compressIndices();
+	const bool wasEmpty = _empty;
+	_empty = result->isEmpty();
+	return !(wasEmpty && _empty);
+}
+
+}
@@ -0,0 +1,119 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Mesh.h"
+#include "Region.h"
+#include "core/NonCopyable.h"
+#include "core/SharedPtr.h"
+#include "core/Trace.h"
+#include "core/concurrent/Lock.h"
+#include <glm/vec3.hpp>
+#include <vector>
+
+namespace voxel {
+
+/**
+ * @brief Splits a mesh tile into bricks of @c BrickSize voxels and caches the mesh of each brick.
+ *
+ * If a voxel is modified, only the bricks whose faces might change are marked dirty and extracted again. The mesh
+ * of the tile is then put together from the cached brick meshes. This way a single voxel modification only needs
+ * to extract a few thousand voxels instead of the whole tile.
+ *
+ * @note Quads are not merged across the brick borders.
+ */
+class BrickMeshCache : public core::NonCopyable {
+public:
+	static constexpr int BrickSize = 16;
+private:
+	const Region _region;
+	const glm::ivec3 _bricks;
+	std::vector<Mesh> _meshes;
+	std::vector<bool> _dirty;
+	mutable core_trace_mutex(core::Lock, _dirtyLock, "BrickMeshCacheDirty");
+	// serializes the extraction of the bricks of this tile
+	core_trace_mutex(core::Lock, _updateLock, "BrickMeshCacheUpdate");
+	// guarded by the update lock
+	bool _empty = true;
+
+	inline int brickIndex(int x, int y, int z) const {
+		return (z * _bricks.y + y) * _bricks.x + x;
+	}
+
+	/**
+	 * @return The indices of the dirty bricks - they are no longer marked dirty afterwards.
+	 */
+	std::vector<int> takeDirtyBricks();
+
+public:
+	/**
+	 * @param[in] region The region of the mesh tile - it doesn't have to be a multiple of the brick size.
+	 */
+	BrickMeshCache(const Region& region);
+
+	const Region& region() const;
+
+	/**
+	 * @return The amount of bricks of the tile
+	 */
+	int bricks() const;
+
+	/**
+	 * @return The region of the brick with the given index - clipped to the tile region.
+	 */
+	Region brickRegion(int index) const;
+
+	/**
+	 * @brief Marks all bricks dirty that have faces that depend on the given voxel - these are the bricks that
+	 * contain the voxel or one of its neighbours.
+	 * @return @c false if the voxel doesn't have any influence on the mesh of this tile.
+	 */
+	bool markDirty(const glm::ivec3& pos);
+
+	void markAllDirty();
+
+	/**
+	 * @return The amount of bricks that are marked dirty
+	 */
+	int dirtyBricks() const;
+
+	/**
+	 * @brief Extracts the meshes of all dirty bricks.
+	 *
+	 * @param[in] extract Called as @c extract(const Region& brickRegion, Mesh* mesh) for each dirty brick. The
+	 * vertex positions must be in the same space for all bricks - e.g. translated by the brick lower corner.
+	 * @return The amount of extracted bricks.
+	 */
+	template<class FUNC>
+	int update(FUNC&& extract) {
+		core_trace_scoped(BrickMeshCacheUpdate);
+		core::ScopedLock lock(_updateLock);
+		const std::vector<int>& dirty = takeDirtyBricks();
+		for (int index : dirty) {
+			extract(brickRegion(index), &_meshes[index]);
+		}
+		return (int)dirty.size();
+	}
+
+	/**
+	 * @brief Puts the mesh of the tile together from the cached brick meshes. The offset of the mesh is set to
+	 * the lower corner of the tile region.
+	 * @return @c false if the mesh is empty and the previously concatenated mesh was empty, too. Otherwise the
+	 * result replaces the geometry of the tile - even if it is empty because all faces were removed.
+	 */
+	bool concatenate(Mesh* result);
+};
+
+typedef core::SharedPtr<BrickMeshCache> BrickMeshCachePtr;
+
+inline const Region& BrickMeshCache::region() const {
+	return _region;
+}
+
+inline int BrickMeshCache::bricks() const {
+	return (int)_meshes.size();
+}
+
+}
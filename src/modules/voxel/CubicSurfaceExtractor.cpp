@@ -4,6 +4,9 @@
 
 #include "CubicSurfaceExtractor.h"
 #include "core/Common.h"
+#include "core/ArrayLength.h"
+#include <algorithm>
+#include <limits>
 
 namespace voxel {
 
@@ -67,6 +70,9 @@ static bool mergeQuads(Quad& q1, Quad& q2, Mesh* meshCurrent, FUNC&& equal) {
 	return false;
 }
 
+// marks a quad that was merged into another quad
+static constexpr IndexType MergedQuad = (std::numeric_limits<IndexType>::max)();
+
 static bool performQuadMerging(QuadList& quads, Mesh* meshCurrent, bool ambientOcclusion) {
 	core_trace_scoped(PerformQuadMerging);
 	bool didMerge = false;
@@ -76,46 +82,65 @@ static bool performQuadMerging(QuadList& quads, Mesh* meshCurrent, bool ambientO
 		equal = isSameColor;
 	}
 
-	for (QuadList::iterator outerIter = quads.begin(); outerIter != quads.end(); ++outerIter) {
-		QuadList::iterator innerIter = outerIter;
-		++innerIter;
-		while (innerIter != quads.end()) {
-			Quad& q1 = *outerIter;
-			Quad& q2 = *innerIter;
-
-			const bool result = mergeQuads(q1, q2, meshCurrent, equal);
-
-			if (result) {
+	const size_t n = quads.size();
+	for (size_t outer = 0; outer < n; ++outer) {
+		Quad& q1 = quads[outer];
+		if (q1.vertices[0] == MergedQuad) {
+			continue;
+		}
+		for (size_t inner = outer + 1; inner < n; ++inner) {
+			Quad& q2 = quads[inner];
+			if (q2.vertices[0] == MergedQuad) {
+				continue;
+			}
+			if (mergeQuads(q1, q2, meshCurrent, equal)) {
 				didMerge = true;
-				innerIter = quads.erase(innerIter);
-			} else {
-				++innerIter;
+				q2.vertices[0] = MergedQuad;
 			}
 		}
 	}
 
+	if (didMerge) {
+		// keep the order of the remaining quads
+		quads.erase(std::remove_if(quads.begin(), quads.end(), [] (const Quad& q) {
+			return q.vertices[0] == MergedQuad;
+		}), quads.end());
+	}
+
 	return didMerge;
 }
 
-/**
- * @brief We are checking the voxels above us. There are four possible ambient occlusion values
- * for a vertex.
- */
-SDL_FORCE_INLINE uint8_t vertexAmbientOcclusion(bool side1, bool side2, bool corner) {
-	if (side1 && side2) {
-		return 0;
-	}
-	return 3 - (side1 + side2 + corner);
+CubicExtractionScratch& cubicExtractionScratch() {
+	static thread_local CubicExtractionScratch scratch;
+	return scratch;
 }
 
-/**
- * @note Notice that the ambient occlusion is different for the vertices on the side than it is for the
- * vertices on the top and bottom. To fix this, we just need to pick a consistent orientation for
- * the quads. This can be done by comparing the ambient occlusion values for each quad and selecting
- * an appropriate orientation. Quad vertices must be sorted in clockwise order.
- */
-SDL_FORCE_INLINE bool isQuadFlipped(const VoxelVertex& v00, const VoxelVertex& v01, const VoxelVertex& v10, const VoxelVertex& v11) {
-	return v00.ambientOcclusion + v11.ambientOcclusion > v01.ambientOcclusion + v10.ambientOcclusion;
+void CubicExtractionScratch::prepare(const Region& region) {
+	const glm::ivec3& offset = region.getLowerCorner();
+	const glm::ivec3& upper = region.getUpperCorner();
+	const int widthInCells = upper.x - offset.x;
+	const int heightInCells = upper.y - offset.y;
+	previousSliceVertices.resize(widthInCells + 2, heightInCells + 2, MaxVerticesPerPosition);
+	currentSliceVertices.resize(widthInCells + 2, heightInCells + 2, MaxVerticesPerPosition);
+
+	const int xSize = upper.x - offset.x + 2;
+	const int ySize = upper.y - offset.y + 2;
+	const int zSize = upper.z - offset.z + 2;
+	int sizes[core::enumVal(FaceNames::Max)];
+	sizes[core::enumVal(FaceNames::NegativeX)] = xSize;
+	sizes[core::enumVal(FaceNames::PositiveX)] = xSize;
+	sizes[core::enumVal(FaceNames::NegativeY)] = ySize;
+	sizes[core::enumVal(FaceNames::PositiveY)] = ySize;
+	sizes[core::enumVal(FaceNames::NegativeZ)] = zSize;
+	sizes[core::enumVal(FaceNames::PositiveZ)] = zSize;
+	for (int i = 0; i < lengthof(sizes); ++i) {
+		QuadListVector& quads = vecQuads[i];
+		// clearing the lists keeps their capacity for the next extraction
+		for (QuadList& list : quads) {
+			list.clear();
+		}
+		quads.resize(sizes[i]);
+	}
 }
 
 void meshify(Mesh* result, bool mergeQuads, bool ambientOcclusion, QuadListVector& vecListQuads) {
@@ -14,11 +14,12 @@
 #include "core/NonCopyable.h"
 #include "Region.h"
 #include "core/Trace.h"
+#include "core/concurrent/ThreadPool.h"
 #include "Face.h"
 #include <glm/fwd.hpp>
 #include <glm/vec3.hpp>
-#include <list>
 #include <vector>
+#include <future>
 
 namespace voxel {
 
@@ -56,21 +57,39 @@ static_assert(sizeof(VertexData) == 8, "Unexpected size of VertexData");
 
 class Array : public core::NonCopyable {
 private:
-	uint32_t _width;
-	uint32_t _height;
-	uint32_t _depth;
-	VertexData* _elements;
+	uint32_t _width = 0u;
+	uint32_t _height = 0u;
+	uint32_t _depth = 0u;
+	uint32_t _capacity = 0u;
+	VertexData* _elements = nullptr;
 public:
-	Array(uint32_t width, uint32_t height, uint32_t depth) :
-			_width(width), _height(height), _depth(depth) {
-		_elements = (VertexData*)core_malloc(width * height * depth * sizeof(VertexData));
-		clear();
+	Array() {
+	}
+
+	Array(uint32_t width, uint32_t height, uint32_t depth) {
+		resize(width, height, depth);
 	}
 
 	~Array() {
 		core_free(_elements);
 	}
 
+	/**
+	 * @brief Changes the dimensions and clears the array. The memory is only reallocated if the array has to grow.
+	 */
+	void resize(uint32_t width, uint32_t height, uint32_t depth) {
+		const uint32_t size = width * height * depth;
+		if (size > _capacity) {
+			core_free(_elements);
+			_elements = (VertexData*)core_malloc(size * sizeof(VertexData));
+			_capacity = size;
+		}
+		_width = width;
+		_height = height;
+		_depth = depth;
+		clear();
+	}
+
 	void clear() {
 		core_memset(_elements, 0x0, _width * _height * _depth * sizeof(VertexData));
 	}
@@ -82,19 +101,61 @@ public:
 
 	void swap(Array& other) {
 		core::exchange(_elements, other._elements);
+		core::exchange(_capacity, other._capacity);
 	}
 };
 
 /**
- * @brief Should be a list because random inserts which we need in @c performQuadMerging are O(1)
+ * @brief A contiguous array of quads - merged quads are only flagged in @c performQuadMerging and removed
+ * after each merge pass.
  */
-typedef std::list<Quad> QuadList;
+typedef std::vector<Quad> QuadList;
 typedef std::vector<QuadList> QuadListVector;
 
+/**
+ * @brief Buffers of the extraction that are kept per thread to not allocate them for every extraction again.
+ */
+struct CubicExtractionScratch {
+	Array previousSliceVertices;
+	Array currentSliceVertices;
+	QuadListVector vecQuads[core::enumVal(FaceNames::Max)];
+
+	/**
+	 * @brief Clears the buffers and sizes them for the given region - but keeps the allocated memory
+	 */
+	void prepare(const Region& region);
+};
+
+/**
+ * @return The extraction buffers of the calling thread
+ */
+extern CubicExtractionScratch& cubicExtractionScratch();
+
 /**
  * @section Surface extraction
  */
 
+/**
+ * @brief We are checking the voxels above us. There are four possible ambient occlusion values
+ * for a vertex.
+ */
+SDL_FORCE_INLINE uint8_t vertexAmbientOcclusion(bool side1, bool side2, bool corner) {
+	if (side1 && side2) {
+		return 0;
+	}
+	return 3 - (side1 + side2 + corner);
+}
+
+/**
+ * @note Notice that the ambient occlusion is different for the vertices on the side than it is for the
+ * vertices on the top and bottom. To fix this, we just need to pick a consistent orientation for
+ * the quads. This can be done by comparing the ambient occlusion values for each quad and selecting
+ * an appropriate orientation. Quad vertices must be sorted in clockwise order.
+ */
+SDL_FORCE_INLINE bool isQuadFlipped(const VoxelVertex& v00, const VoxelVertex& v01, const VoxelVertex& v10, const VoxelVertex& v11) {
+	return v00.ambientOcclusion + v11.ambientOcclusion > v01.ambientOcclusion + v10.ambientOcclusion;
+}
+
 extern IndexType addVertex(bool reuseVertices, uint32_t x, uint32_t y, uint32_t z, const Voxel& materialIn, Array& existingVertices,
 		Mesh* meshCurrent, const VoxelType face1, const VoxelType face2, const VoxelType corner, const glm::ivec3& offset);
 
@@ -195,27 +256,15 @@ void extractCubicMesh(VolumeType* volData, const Region& region, Mesh* result, I
 	const glm::ivec3& upper = region.getUpperCorner();
 	result->setOffset(offset);
 
+	CubicExtractionScratch& scratch = cubicExtractionScratch();
+	scratch.prepare(region);
 	// Used to avoid creating duplicate vertices.
-	const int widthInCells = upper.x - offset.x;
-	const int heightInCells = upper.y - offset.y;
-	Array previousSliceVertices(widthInCells + 2, heightInCells + 2, MaxVerticesPerPosition);
-	Array currentSliceVertices(widthInCells + 2, heightInCells + 2, MaxVerticesPerPosition);
+	Array& previousSliceVertices = scratch.previousSliceVertices;
+	Array& currentSliceVertices = scratch.currentSliceVertices;
 
 	// During extraction we create a number of different lists of quads. All the
 	// quads in a given list are in the same plane and facing in the same direction.
-	QuadListVector vecQuads[core::enumVal(FaceNames::Max)];
-
-	const int xSize = upper.x - offset.x + 2;
-	const int ySize = upper.y - offset.y + 2;
-	const int zSize = upper.z - offset.z + 2;
-	vecQuads[core::enumVal(FaceNames::NegativeX)].resize(xSize);
-	vecQuads[core::enumVal(FaceNames::PositiveX)].resize(xSize);
-
-	vecQuads[core::enumVal(FaceNames::NegativeY)].resize(ySize);
-	vecQuads[core::enumVal(FaceNames::PositiveY)].resize(ySize);
-
-	vecQuads[core::enumVal(FaceNames::NegativeZ)].resize(zSize);
-	vecQuads[core::enumVal(FaceNames::PositiveZ)].resize(zSize);
+	QuadListVector* vecQuads = scratch.vecQuads;
 
 	typename VolumeType::Sampler volumeSampler(volData);
 
@@ -407,8 +456,8 @@ void extractCubicMesh(VolumeType* volData, const Region& region, Mesh* result, I
 
 	{
 		core_trace_scoped(GenerateMesh);
-		for (QuadListVector& vecListQuads : vecQuads) {
-			meshify(result, mergeQuads, ambientOcclusion, vecListQuads);
+		for (int i = 0; i < core::enumVal(FaceNames::Max); ++i) {
+			meshify(result, mergeQuads, ambientOcclusion, vecQuads[i]);
 		}
 	}
 
@@ -416,6 +465,50 @@ void extractCubicMesh(VolumeType* volData, const Region& region, Mesh* result, I
 	result->compressIndices();
 }
 
+/**
+ * @brief Splits the region into slabs along the z axis, extracts them in parallel on the given thread pool and
+ * stitches the slab meshes together. See @c extractCubicMesh() for the parameters.
+ * @note Quads are not merged and vertices are not shared across the slab borders - the mesh might contain a few
+ * more vertices and quads than the mesh of @c extractCubicMesh() for the same region.
+ * @note Must not be called from a task of the given thread pool - this would dead lock if all threads of the pool
+ * are waiting for their slabs.
+ */
+template<typename VolumeType, typename IsQuadNeeded>
+void extractCubicMeshParallel(core::ThreadPool& threadPool, VolumeType* volData, const Region& region, Mesh* result, IsQuadNeeded isQuadNeeded, const glm::ivec3& translate, bool mergeQuads = true, bool reuseVertices = true, bool ambientOcclusion = true) {
+	const int depth = region.getDepthInVoxels();
+	const int slabs = core_min((int)threadPool.size(), depth);
+	if (slabs <= 1) {
+		extractCubicMesh(volData, region, result, isQuadNeeded, translate, mergeQuads, reuseVertices, ambientOcclusion);
+		return;
+	}
+	core_trace_scoped(ExtractCubicMeshParallel);
+
+	const glm::ivec3& mins = region.getLowerCorner();
+	const glm::ivec3& maxs = region.getUpperCorner();
+	std::vector<Mesh> slabMeshes(slabs);
+	std::vector<std::future<void>> futures;
+	futures.reserve(slabs);
+	for (int i = 0; i < slabs; ++i) {
+		const int lowerZ = mins.z + depth * i / slabs;
+		const int upperZ = mins.z + depth * (i + 1) / slabs - 1;
+		const Region slabRegion(mins.x, mins.y, lowerZ, maxs.x, maxs.y, upperZ);
+		// the vertex positions are relative to the lower corner of the extracted region
+		const glm::ivec3 slabTranslate = translate + glm::ivec3(0, 0, lowerZ - mins.z);
+		Mesh* slabMesh = &slabMeshes[i];
+		futures.emplace_back(threadPool.enqueue([=] () {
+			extractCubicMesh(volData, slabRegion, slabMesh, isQuadNeeded, slabTranslate, mergeQuads, reuseVertices, ambientOcclusion);
+		}));
+	}
+
+	result->clear();
+	result->setOffset(mins);
+	for (int i = 0; i < slabs; ++i) {
+		futures[i].wait();
+		result->append(slabMeshes[i]);
+	}
+	result->compressIndices();
+}
+
 }
 
 #undef BUFFERED_SAMPLER
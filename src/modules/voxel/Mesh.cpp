@@ -148,6 +148,9 @@ void Mesh::addTriangle(IndexType index0, IndexType index1, IndexType index2) {
 	core_assert_msg(index2 < _vecVertices.size(), "Index points at an invalid vertex.");
 	if (!_mayGetResized) {
 		core_assert_msg(_vecIndices.size() + 3 < _vecIndices.capacity(), "addTriangle() call exceeds the capacity of the indices vector and will trigger a realloc (%i vs %i)", (int)_vecIndices.size(), (int)_vecIndices.capacity());
+	} else if (_vecIndices.size() + 3 > _vecIndices.capacity()) {
+		// the array only grows by a fixed amount of slots - grow geometrically to keep large extractions linear
+		_vecIndices.reserve(core_max((size_t)128, _vecIndices.capacity() * 2));
 	}
 
 	_vecIndices.push_back(index0);
@@ -155,11 +158,22 @@ void Mesh::addTriangle(IndexType index0, IndexType index1, IndexType index2) {
 	_vecIndices.push_back(index2);
 }
 
+void Mesh::append(const Mesh& mesh) {
+	const IndexType indexOffset = (IndexType)_vecVertices.size();
+	_vecVertices.append(mesh._vecVertices.data(), mesh._vecVertices.size());
+	_vecIndices.reserve(_vecIndices.size() + mesh._vecIndices.size());
+	for (IndexType index : mesh._vecIndices) {
+		_vecIndices.push_back(index + indexOffset);
+	}
+}
+
 IndexType Mesh::addVertex(const VoxelVertex& vertex) {
 	// We should not add more vertices than our chosen index type will let us index.
 	core_assert_msg(_vecVertices.size() < (std::numeric_limits<IndexType>::max)(), "Mesh has more vertices that the chosen index type allows.");
 	if (!_mayGetResized) {
 		core_assert_msg(_vecVertices.size() + 1 < _vecVertices.capacity(), "addVertex() call exceeds the capacity of the vertices vector and will trigger a realloc (%i vs %i)", (int)_vecVertices.size(), (int)_vecVertices.capacity());
+	} else if (_vecVertices.size() == _vecVertices.capacity()) {
+		_vecVertices.reserve(core_max((size_t)128, _vecVertices.capacity() * 2));
 	}
 
 	_vecVertices.push_back(vertex);
@@ -49,6 +49,11 @@ public:
 
 	IndexType addVertex(const VoxelVertex& vertex);
 	void addTriangle(IndexType index0, IndexType index1, IndexType index2);
+	/**
+	 * @brief Adds the vertices and triangles of the given mesh. The vertex positions are taken as they are - the
+	 * offset of the given mesh is not applied.
+	 */
+	void append(const Mesh& mesh);
 
 	void clear();
 	bool isEmpty() const;
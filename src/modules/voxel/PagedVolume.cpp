@@ -10,6 +10,7 @@
 #include "math/Functions.h"
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtc/round.hpp>
+#include <vector>
 
 namespace voxel {
 
@@ -18,7 +19,8 @@ namespace voxel {
  * but you can override this if desired. If you do wish to enable
  * paging then you are required to provide the call back function (see the other PagedVolume constructor).
  * @param pager Called by PolyVox to load and unload data on demand.
- * @param targetMemoryUsageInBytes The upper limit to how much memory this PagedVolume should aim to use.
+ * @param targetMemoryUsageInBytes The upper limit to how much memory this PagedVolume should aim to use. Least recently
+ * used chunks are evicted if the resident chunk data exceeds this budget. See @c stats() to size this value.
  * @param chunkSideLength The size of the chunks making up the volume. Small chunks will compress/decompress faster, but there will also be
  * more of them meaning voxel access could be slower.
  */
@@ -36,21 +38,17 @@ PagedVolume::PagedVolume(Pager* pager, uint32_t targetMemoryUsageInBytes, uint16
 	// Use to perform modulo by bit operations
 	_chunkMask = _chunkSideLength - 1;
 
-	// Calculate the number of chunks based on the memory limit and the size of each chunk.
-	uint32_t chunkSizeInBytes = PagedVolume::Chunk::calculateSizeInBytes(_chunkSideLength);
-	_chunkCountLimit = targetMemoryUsageInBytes / chunkSizeInBytes;
-
-	// Enforce sensible limits on the number of chunks.
-	const uint32_t minPracticalNoOfChunks = 32; // Enough to make sure a chunks and it's neighbours can be loaded, with a few to spare.
-	if (_chunkCountLimit < minPracticalNoOfChunks) {
-		Log::warn("Requested memory usage limit of %uMb is too low and cannot be adhered to. Chunk limit is at %i, Chunk size: %uKb",
-				targetMemoryUsageInBytes / (1024 * 1024), _chunkCountLimit, chunkSizeInBytes / 1024);
+	_memoryLimitInBytes = targetMemoryUsageInBytes;
+	const uint32_t chunkSizeInBytes = PagedVolume::Chunk::calculateSizeInBytes(_chunkSideLength);
+	const uint64_t minPracticalMemory = (uint64_t)MinPracticalNoOfChunks * chunkSizeInBytes;
+	if (_memoryLimitInBytes < minPracticalMemory) {
+		Log::warn("Requested memory usage limit of %uMb is too low and cannot be adhered to. Chunk limit is at %u, Chunk size: %uKb",
+				targetMemoryUsageInBytes / (1024 * 1024), MinPracticalNoOfChunks, chunkSizeInBytes / 1024);
 	}
-	_chunkCountLimit = core_max(_chunkCountLimit, minPracticalNoOfChunks);
 
 	// Inform the user about the chosen memory configuration.
-	Log::info("Memory usage limit for volume now set to %uMb (%u chunks of %uKb each).",
-			(_chunkCountLimit * chunkSizeInBytes) / (1024 * 1024), _chunkCountLimit, chunkSizeInBytes / 1024);
+	Log::info("Memory usage limit for volume now set to %uMb (chunks of %uKb each).",
+			(uint32_t)(_memoryLimitInBytes / (1024 * 1024)), chunkSizeInBytes / 1024);
 }
 
 /**
@@ -58,7 +56,49 @@ PagedVolume::PagedVolume(Pager* pager, uint32_t targetMemoryUsageInBytes, uint16
  * data via the dataOverflowHandler() if desired.
  */
 PagedVolume::~PagedVolume() {
+	{
+		// drop the queued prefetches - but wait for the ones that are currently paged in
+		core::ScopedLock lock(_tasksLock);
+		_shutdown = true;
+		_tasksCondition.wait(_tasksLock, [this] () { return _pendingTasks == 0; });
+	}
 	flushAll();
+	// let the pager persist the chunks that were evicted before
+	core::ScopedLock lock(_tasksLock);
+	_tasksCondition.wait(_tasksLock, [this] () { return _pendingTasks == 0; });
+	_pendingPageOuts.clear();
+}
+
+core::ThreadPool& PagedVolume::threadPool() {
+	struct SharedThreadPool {
+		core::ThreadPool pool { core_max(2u, core::halfcpus()), "PagedVolume" };
+		SharedThreadPool() {
+			pool.init();
+		}
+	};
+	static SharedThreadPool shared;
+	return shared.pool;
+}
+
+void PagedVolume::enqueue(std::function<void()>&& task, bool dropOnShutdown) const {
+	{
+		core::ScopedLock lock(_tasksLock);
+		++_pendingTasks;
+	}
+	threadPool().enqueue([this, dropOnShutdown, task = core::move(task)] () {
+		bool drop;
+		{
+			core::ScopedLock lock(_tasksLock);
+			drop = dropOnShutdown && _shutdown;
+		}
+		if (!drop) {
+			task();
+		}
+		// the volume might be destroyed as soon as the counter reaches zero
+		core::ScopedLock lock(_tasksLock);
+		--_pendingTasks;
+		_tasksCondition.notify_all();
+	});
 }
 
 /**
@@ -69,7 +109,7 @@ PagedVolume::~PagedVolume() {
  * @param uZPos The @c z position of the voxel
  * @return The voxel value
  */
-const Voxel& PagedVolume::voxel(int32_t uXPos, int32_t uYPos, int32_t uZPos) const {
+Voxel PagedVolume::voxel(int32_t uXPos, int32_t uYPos, int32_t uZPos) const {
 	return voxel(glm::ivec3(uXPos, uYPos, uZPos));
 }
 
@@ -86,7 +126,7 @@ PagedVolume::ChunkPtr PagedVolume::chunk(const glm::ivec3& pos) const {
  * @param v3dPos The 3D position of the voxel
  * @return The voxel value
  */
-const Voxel& PagedVolume::voxel(const glm::ivec3& v3dPos) const {
+Voxel PagedVolume::voxel(const glm::ivec3& v3dPos) const {
 	const uint32_t xOffset = static_cast<uint32_t>(v3dPos.x & _chunkMask);
 	const uint32_t yOffset = static_cast<uint32_t>(v3dPos.y & _chunkMask);
 	const uint32_t zOffset = static_cast<uint32_t>(v3dPos.z & _chunkMask);
@@ -166,46 +206,270 @@ void PagedVolume::setVoxels(int32_t uXPos, int32_t uYPos, int32_t uZPos, int nx,
 }
 
 /**
- * Removes all voxels from memory by removing all chunks. The application has the chance to persist the data via @c Pager::pageOut
+ * Removes all voxels from memory by removing all chunks. The modified chunks are persisted via @c Pager::pageOut
  */
 void PagedVolume::flushAll() {
-	core::ScopedWriteLock writeLock(_volumeLock);
-	_chunks.clear();
+	std::vector<ChunkPtr> modified;
+	{
+		core::ScopedLock lock(_evictionLock);
+		for (int i = 0; i < ChunkShardCount; ++i) {
+			ChunkShard& s = _shards[i];
+			core::ScopedWriteLock writeLock(s.lock);
+			for (auto c = s.chunks.begin(); c != s.chunks.end(); ++c) {
+				if (c->value->_dataModified) {
+					modified.push_back(c->value);
+				}
+			}
+			_chunkCount.decrement((int)s.chunks.size());
+			s.chunks.clear();
+		}
+		_clockHand = nullptr;
+		_residentBytes = 0u;
+	}
+	// the chunks are persisted by the page out task - the pager is never called concurrently
+	for (const ChunkPtr& chunk : modified) {
+		schedulePageOut(chunk);
+	}
+	core::ScopedLock lock(_pendingPageOutsLock);
+	_pageOutCondition.wait(_pendingPageOutsLock, [this] () { return !_pageOutActive; });
+}
+
+PagedVolume::Stats PagedVolume::stats() const {
+	Stats stats;
+	stats.hits = (uint32_t)(int)_hits;
+	stats.misses = (uint32_t)(int)_misses;
+	stats.evictions = (uint32_t)(int)_evictions;
+	stats.prefetches = (uint32_t)(int)_prefetches;
+	stats.compressions = (uint32_t)(int)_compressions;
+	stats.chunks = (uint32_t)(int)_chunkCount;
+	stats.memoryLimitInBytes = _memoryLimitInBytes;
+	core::ScopedLock lock(_evictionLock);
+	stats.residentBytes = _residentBytes;
+	return stats;
+}
+
+PagedVolume::ChunkShard& PagedVolume::shard(const glm::ivec3& chunkPos) const {
+	// large primes to distribute neighbouring chunks over different shards
+	const uint32_t hash = ((uint32_t)chunkPos.x * 73856093u) ^ ((uint32_t)chunkPos.y * 19349663u) ^ ((uint32_t)chunkPos.z * 83492791u);
+	return _shards[hash % ChunkShardCount];
+}
+
+void PagedVolume::trackChunk(Chunk* chunk) const {
+	core::ScopedLock lock(_evictionLock);
+	{
+		// the volume might have been flushed in the meantime
+		ChunkShard& s = shard(chunk->chunkPos());
+		core::ScopedReadLock readLock(s.lock);
+		ChunkPtr current;
+		if (!s.chunks.get(chunk->chunkPos(), current) || current.get() != chunk) {
+			return;
+		}
+	}
+	// insert the new chunk right behind the clock hand - this way it's the last one to get checked
+	if (_clockHand == nullptr) {
+		chunk->_clockPrev = chunk;
+		chunk->_clockNext = chunk;
+		_clockHand = chunk;
+	} else {
+		chunk->_clockNext = _clockHand;
+		chunk->_clockPrev = _clockHand->_clockPrev;
+		_clockHand->_clockPrev->_clockNext = chunk;
+		_clockHand->_clockPrev = chunk;
+	}
+	chunk->_accountedBytes = chunk->residentSizeInBytes();
+	_residentBytes += chunk->_accountedBytes;
+}
+
+void PagedVolume::updateAccounting(Chunk* chunk) const {
+	// evicted chunks are no longer part of the budget
+	if (chunk->_clockNext == nullptr) {
+		return;
+	}
+	_residentBytes -= chunk->_accountedBytes;
+	chunk->_accountedBytes = chunk->residentSizeInBytes();
+	_residentBytes += chunk->_accountedBytes;
+}
+
+void PagedVolume::decompressChunk(const ChunkPtr& chunk) const {
+	{
+		core::ScopedLock lock(_compressionLock);
+		if (!chunk->compressed()) {
+			return;
+		}
+		chunk->decompress();
+	}
+	core::ScopedLock lock(_evictionLock);
+	updateAccounting(chunk.get());
+}
+
+void PagedVolume::unlinkClock(Chunk* chunk) const {
+	if (chunk->_clockNext == chunk) {
+		_clockHand = nullptr;
+	} else {
+		chunk->_clockPrev->_clockNext = chunk->_clockNext;
+		chunk->_clockNext->_clockPrev = chunk->_clockPrev;
+		if (_clockHand == chunk) {
+			_clockHand = chunk->_clockNext;
+		}
+	}
+	chunk->_clockPrev = chunk->_clockNext = nullptr;
+	_residentBytes -= chunk->_accountedBytes;
+	chunk->_accountedBytes = 0u;
+}
+
+/**
+ * Second chance (clock) replacement: chunks that were accessed since the hand passed them the last time
+ * are skipped once. Chunks that are still paged in by another thread are never evicted.
+ */
+PagedVolume::Chunk* PagedVolume::nextClockVictim(bool skipCompressed) const {
+	if (_clockHand == nullptr) {
+		return nullptr;
+	}
+	// at most two full rounds - after the first one all reference bits are cleared
+	const int maxSteps = 2 * (int)_chunkCount + 1;
+	for (int i = 0; i < maxSteps; ++i) {
+		Chunk* chunk = _clockHand;
+		_clockHand = chunk->_clockNext;
+		if (!chunk->_loaded) {
+			continue;
+		}
+		if (skipCompressed && chunk->compressed()) {
+			continue;
+		}
+		if (chunk->_referenced.exchange(false)) {
+			continue;
+		}
+		return chunk;
+	}
+	return nullptr;
 }
 
 /**
- * As we have added a chunk we may have exceeded our target chunk limit. Search through the array to
- * determine how many chunks we have, as well as finding the oldest timestamp. Note that this is potentially
- * wasteful and we may instead wish to track how many chunks we have and/or delete a chunk at random (or
- * just check e.g. 10 and delete the oldest of those) but we'll see if this is a bottleneck first. Paging
- * the data in is probably more expensive.
+ * As we have added a chunk we may have exceeded our memory budget. Advance the clock hand until enough
+ * chunks were compressed or removed. Chunks are only evicted if compressing the chunks that weren't
+ * accessed for a while isn't enough to stay within the budget. Modified chunks are handed over to the
+ * page out thread to not stall the caller with the persisting.
  */
-void PagedVolume::deleteOldestChunkIfNeeded() const {
+void PagedVolume::deleteOldestChunksIfNeeded() const {
 	core_trace_scoped(DeleteOldestChunk);
-	ChunkMap::iterator oldestChunk = _chunks.end();
-	uint32_t oldestChunkTimestamp = _timestamper;
-	for (ChunkMap::iterator i = _chunks.begin(); i != _chunks.end(); ++i) {
-		const ChunkPtr& chunk = i->second;
-		if (chunk->_chunkLastAccessed < oldestChunkTimestamp) {
-			oldestChunkTimestamp = chunk->_chunkLastAccessed;
-			oldestChunk = i;
+	core::ScopedLock lock(_evictionLock);
+	for (int pass = 0; pass < 2; ++pass) {
+		const bool compressPass = pass == 0;
+		// chunks that are in use by other threads are skipped - so limit the amount of tries
+		int attempts = (int)_chunkCount;
+		while (attempts-- > 0 && _residentBytes > _memoryLimitInBytes) {
+			Chunk* victim = nextClockVictim(compressPass);
+			if (victim == nullptr) {
+				break;
+			}
+			const glm::ivec3 pos = victim->chunkPos();
+			ChunkShard& s = shard(pos);
+			ChunkPtr removed;
+			{
+				core::ScopedWriteLock writeLock(s.lock);
+				if (!s.chunks.get(pos, removed) || removed.get() != victim) {
+					core_assert_msg(false, "Chunk in eviction clock is not part of the volume");
+					unlinkClock(victim);
+					continue;
+				}
+				// the volume and this function are holding a reference - everything above means that another
+				// thread is accessing the voxels. New references are only handed out with the shard lock.
+				if (removed.use_count() > 2) {
+					continue;
+				}
+				if (compressPass) {
+					bool compressed;
+					{
+						core::ScopedLock compressionLock(_compressionLock);
+						compressed = victim->compress();
+					}
+					if (compressed) {
+						_compressions.increment(1);
+						updateAccounting(victim);
+						continue;
+					}
+				}
+				if ((uint32_t)(int)_chunkCount <= MinPracticalNoOfChunks) {
+					continue;
+				}
+				s.chunks.remove(pos);
+			}
+			unlinkClock(victim);
+			_chunkCount.decrement(1);
+			_evictions.increment(1);
+			Log::debug("evicted chunk at %i:%i:%i", pos.x, pos.y, pos.z);
+			if (removed->_dataModified) {
+				schedulePageOut(removed);
+			}
 		}
 	}
-	if (oldestChunk != _chunks.end()) {
-		Log::debug("delete oldest chunk - reached %u", _chunkCountLimit);
-		_chunks.erase(oldestChunk);
+}
+
+void PagedVolume::schedulePageOut(const ChunkPtr& chunk) const {
+	const glm::ivec3 pos = chunk->chunkPos();
+	{
+		core::ScopedLock lock(_pendingPageOutsLock);
+		++chunk->_pageOutGeneration;
+		_pendingPageOuts.put(pos, chunk);
+		if (_pageOutActive) {
+			return;
+		}
+		_pageOutActive = true;
 	}
+	enqueue([this] () { pageOutPendingChunks(); }, false);
 }
 
-PagedVolume::ChunkPtr PagedVolume::createNewChunk(int32_t chunkX, int32_t chunkY, int32_t chunkZ) const {
+void PagedVolume::pageOutPendingChunks() const {
+	core_trace_scoped(PageOutChunk);
+	for (;;) {
+		ChunkPtr chunk;
+		uint32_t generation;
+		{
+			core::ScopedLock lock(_pendingPageOutsLock);
+			auto i = _pendingPageOuts.begin();
+			if (i == _pendingPageOuts.end()) {
+				_pageOutActive = false;
+				_pageOutCondition.notify_all();
+				return;
+			}
+			chunk = i->value;
+			generation = chunk->_pageOutGeneration;
+		}
+		const glm::ivec3 pos = chunk->chunkPos();
+		decompressChunk(chunk);
+		_pager->pageOut(chunk.get());
+		core::ScopedLock lock(_pendingPageOutsLock);
+		ChunkPtr pending;
+		// only forget about the chunk if it wasn't revived in the meantime - a chunk that was revived, modified
+		// and evicted again is queued with a new generation and persisted again
+		if (_pendingPageOuts.get(pos, pending) && pending.get() == chunk.get() && chunk->_pageOutGeneration == generation) {
+			_pendingPageOuts.remove(pos);
+			chunk->_dataModified = false;
+		}
+	}
+}
+
+bool PagedVolume::takePendingPageOut(const glm::ivec3& pos, ChunkPtr& chunk) const {
+	core::ScopedLock lock(_pendingPageOutsLock);
+	if (_pendingPageOuts.empty()) {
+		return false;
+	}
+	if (!_pendingPageOuts.get(pos, chunk)) {
+		return false;
+	}
+	_pendingPageOuts.remove(pos);
+	return true;
+}
+
+/**
+ * @brief Pass the chunk to the Pager to give it a chance to initialise it with any data. This is executed
+ * without holding any volume lock - other threads requesting the same chunk are waiting for the @c loaded state.
+ */
+void PagedVolume::pageInChunk(const ChunkPtr& chunk) const {
 	core_trace_scoped(CreateNewChunk);
-	// The chunk was not found so we will create a new one.
-	glm::ivec3 pos(chunkX, chunkY, chunkZ);
-	Log::debug("create new chunk at %i:%i:%i", chunkX, chunkY, chunkZ);
-	ChunkPtr chunk = core::make_shared<Chunk>(pos, _chunkSideLength, _pager);
-	chunk->_chunkLastAccessed = ++_timestamper; // Important, as we may soon delete the oldest chunk
+	const glm::ivec3& pos = chunk->chunkPos();
+	Log::debug("create new chunk at %i:%i:%i", pos.x, pos.y, pos.z);
 
-	// Pass the chunk to the Pager to give it a chance to initialise it with any data
 	// From the coordinates of the chunk we deduce the coordinates of the contained voxels.
 	PagerContext pctx;
 	const glm::ivec3& mins = pos * static_cast<int32_t>(_chunkSideLength);
@@ -216,27 +480,105 @@ PagedVolume::ChunkPtr PagedVolume::createNewChunk(int32_t chunkX, int32_t chunkY
 	// Page the data in
 	// We'll use this later to decide if data needs to be paged out again.
 	chunk->_dataModified = _pager->pageIn(pctx);
-	Log::debug("finished creating new chunk at %i:%i:%i", chunkX, chunkY, chunkZ);
+	Log::debug("finished creating new chunk at %i:%i:%i", pos.x, pos.y, pos.z);
+
+	chunk->_loaded = true;
+	core::ScopedLock lock(_loadingLock);
+	_loadingCondition.notify_all();
+}
+
+void PagedVolume::waitForChunk(const ChunkPtr& chunk) const {
+	if (chunk->_loaded) {
+		return;
+	}
+	core_trace_scoped(WaitForChunk);
+	core::ScopedLock lock(_loadingLock);
+	_loadingCondition.wait(_loadingLock, [&chunk] () { return (bool)chunk->_loaded; });
+}
 
+PagedVolume::ChunkPtr PagedVolume::findOrInsertChunk(const glm::ivec3& pos, bool& created) const {
+	ChunkShard& s = shard(pos);
+	ChunkPtr chunk;
+	created = false;
+	{
+		core::ScopedReadLock readLock(s.lock);
+		if (s.chunks.get(pos, chunk)) {
+			return chunk;
+		}
+	}
+
+	{
+		core::ScopedWriteLock writeLock(s.lock);
+		// another thread might have been faster
+		if (s.chunks.get(pos, chunk)) {
+			return chunk;
+		}
+		if (!takePendingPageOut(pos, chunk)) {
+			chunk = core::make_shared<Chunk>(pos, _chunkSideLength, _pager);
+		}
+		s.chunks.put(pos, chunk);
+		_chunkCount.increment(1);
+		created = true;
+	}
+	trackChunk(chunk.get());
 	return chunk;
 }
 
+bool PagedVolume::prefetch(const Region& region) const {
+	core_trace_scoped(PagedVolumePrefetch);
+	const glm::ivec3& mins = chunkPos(region.getLowerCorner());
+	const glm::ivec3& maxs = chunkPos(region.getUpperCorner());
+	bool available = true;
+	for (int32_t z = mins.z; z <= maxs.z; ++z) {
+		for (int32_t y = mins.y; y <= maxs.y; ++y) {
+			for (int32_t x = mins.x; x <= maxs.x; ++x) {
+				bool created;
+				ChunkPtr chunk = findOrInsertChunk(glm::ivec3(x, y, z), created);
+				if (chunk->_loaded) {
+					continue;
+				}
+				available = false;
+				if (!created) {
+					// already queued or paged in by another thread
+					continue;
+				}
+				enqueue([this, chunk] () {
+					if (chunk->_pageInClaimed.exchange(true)) {
+						return;
+					}
+					_prefetches.increment(1);
+					pageInChunk(chunk);
+					deleteOldestChunksIfNeeded();
+				}, true);
+			}
+		}
+	}
+	return available;
+}
+
 PagedVolume::ChunkPtr PagedVolume::chunk(int32_t chunkX, int32_t chunkY, int32_t chunkZ) const {
 	core_trace_scoped(PagedVolumeChunk);
-	core::ScopedWriteLock chunkWriteLock(_volumeLock);
-	const glm::ivec3 pos(chunkX, chunkY, chunkZ);
-	auto i = _chunks.find(pos);
-	if (i == _chunks.end()) {
-		const ChunkPtr& chunk = createNewChunk(chunkX, chunkY, chunkZ);
-		_chunks.put(pos, chunk);
-		const size_t chunkCount = _chunks.size();
-		if (chunkCount >= _chunkCountLimit) {
-			deleteOldestChunkIfNeeded();
-		}
+	bool created;
+	ChunkPtr chunk = findOrInsertChunk(glm::ivec3(chunkX, chunkY, chunkZ), created);
+	// revived chunks were already paged in - the claim is still set from that time
+	if (!chunk->_pageInClaimed.exchange(true)) {
+		_misses.increment(1);
+		pageInChunk(chunk);
+		deleteOldestChunksIfNeeded();
 		return chunk;
 	}
-	const ChunkPtr& chunk = i->second;
-	chunk->_chunkLastAccessed = ++_timestamper;
+
+	_hits.increment(1);
+	chunk->_referenced = true;
+	waitForChunk(chunk);
+	bool grown = created;
+	if (chunk->compressed()) {
+		decompressChunk(chunk);
+		grown = true;
+	}
+	if (grown) {
+		deleteOldestChunksIfNeeded();
+	}
 	return chunk;
 }
 
@@ -11,8 +11,15 @@
 #include "core/Assert.h"
 #include "core/concurrent/ReadWriteLock.h"
 #include "core/concurrent/Atomic.h"
-#include "core/collection/Map.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/concurrent/ThreadPool.h"
+#include "core/concurrent/Concurrency.h"
+#include "core/Common.h"
+#include "core/Trace.h"
+#include "core/collection/HashMap.h"
 #include "core/SharedPtr.h"
+#include <functional>
 
 namespace voxel {
 
@@ -40,6 +47,7 @@ public:
 	class Chunk {
 		friend class PagedVolume;
 		friend class PagedVolumeWrapper;
+		friend class PagedVolumeTest;
 
 	public:
 		Chunk(const glm::ivec3& pos, uint16_t sideLength, Pager* pager);
@@ -61,18 +69,65 @@ public:
 		const glm::ivec3& chunkPos() const;
 		int16_t sideLength() const;
 
+		/**
+		 * @return @c false as long as the pager is still filling the chunk
+		 */
+		bool loaded() const;
+
+		/**
+		 * @return @c true if the voxels are only available in the palette compressed form. The PagedVolume
+		 * decompresses the chunk before it is handed out by @c PagedVolume::chunk() or accessed by a Sampler.
+		 */
+		bool compressed() const;
+
+		/**
+		 * @return The amount of bytes the chunk is currently occupying - this is less than @c dataSizeInBytes()
+		 * for compressed chunks.
+		 */
+		uint32_t residentSizeInBytes() const;
+
 	private:
-		// This is updated by the PagedVolume and used to discard the least recently used chunks.
-		uint32_t _chunkLastAccessed = 0u;
+		/**
+		 * @brief Replaces the voxel array by a palette of the used voxels and bit packed indices into this palette.
+		 * Chunks that consist of only one voxel (e.g. all air above the terrain) don't need any indices at all.
+		 * @return @c false if the chunk uses too many different voxels to be compressed.
+		 */
+		bool compress();
+		void decompress();
+
+		// This is set by the PagedVolume on every access and cleared by the clock hand to discard the least recently used chunks.
+		core::AtomicBool _referenced { false };
+		// Set once the pager finished its work - other threads that requested the same chunk wait for this
+		core::AtomicBool _loaded { false };
+		// The thread that sets this first is the one that hands the chunk to the pager - this is either the
+		// prefetch thread or a thread that needs the chunk before the prefetch task was executed.
+		core::AtomicBool _pageInClaimed { false };
+
+		// Intrusive ring of the eviction clock - guarded by the eviction lock of the volume
+		Chunk* _clockPrev = nullptr;
+		Chunk* _clockNext = nullptr;
+		// The amount of bytes that were accounted for this chunk in the memory budget of the volume
+		uint32_t _accountedBytes = 0u;
 
 		static uint32_t calculateSizeInBytes(uint32_t sideLength);
 
 		Voxel* _data = nullptr;
 		uint16_t _sideLength = 0u;
 
+		core::AtomicBool _compressed { false };
+		// The palette compressed voxels - only valid if the chunk is compressed
+		Voxel* _palette = nullptr;
+		uint8_t* _indices = nullptr;
+		uint16_t _paletteSize = 0u;
+		uint8_t _bitsPerIndex = 0u;
+
 		// This is so we can tell whether a uncompressed chunk has to be recompressed and whether
 		// a compressed chunk has to be paged back to disk, or whether they can just be discarded.
 		bool _dataModified = false;
+		// Increased every time the chunk is queued for the page out - a page out only clears the modified
+		// flag if the chunk wasn't revived and queued again in the meantime. Guarded by the page out lock
+		// of the volume
+		uint32_t _pageOutGeneration = 0u;
 
 		uint8_t _sideLengthPower = 0b0;
 		Pager* _pager;
@@ -111,6 +166,26 @@ public:
 
 	typedef core::SharedPtr<Pager> PagerPtr;
 
+	/**
+	 * @brief Counters to be able to size the memory budget of the volume
+	 */
+	struct Stats {
+		/** chunk lookups that were answered from memory */
+		uint32_t hits = 0u;
+		/** chunk lookups that had to page in a chunk */
+		uint32_t misses = 0u;
+		/** chunks that were removed to stay within the memory budget */
+		uint32_t evictions = 0u;
+		/** chunks that were paged in by the prefetch threads */
+		uint32_t prefetches = 0u;
+		/** chunks that were compressed instead of evicted */
+		uint32_t compressions = 0u;
+		/** chunks that are currently held in memory */
+		uint32_t chunks = 0u;
+		uint64_t residentBytes = 0u;
+		uint64_t memoryLimitInBytes = 0u;
+	};
+
 	class Sampler {
 	public:
 		Sampler(const PagedVolume* volume);
@@ -219,10 +294,14 @@ public:
 	PagedVolume(Pager* pager, uint32_t targetMemoryUsageInBytes = 256 * 1024 * 1024, uint16_t chunkSideLength = 32);
 	~PagedVolume();
 
-	/** @brief Gets a voxel at the position given by <tt>x,y,z</tt> coordinates */
-	const Voxel& voxel(int32_t x, int32_t y, int32_t z) const;
+	/**
+	 * @brief Gets a voxel at the position given by <tt>x,y,z</tt> coordinates
+	 * @note The voxel is returned by value - the chunk might be compressed or evicted as soon as it isn't
+	 * referenced anymore
+	 */
+	Voxel voxel(int32_t x, int32_t y, int32_t z) const;
 	/** @brief Gets a voxel at the position given by a 3D vector */
-	const Voxel& voxel(const glm::ivec3& v3dPos) const;
+	Voxel voxel(const glm::ivec3& v3dPos) const;
 
 	const Region& region() const;
 
@@ -234,9 +313,23 @@ public:
 	void setVoxels(int32_t x, int32_t z, const Voxel* tArray, int amount);
 	void setVoxels(int32_t x, int32_t y, int32_t z, int nx, int nz, const Voxel* tArray, int amount);
 
-	/** @brief Removes all voxels from memory */
+	/**
+	 * @brief Removes all voxels from memory
+	 * @note Blocks until the modified chunks are handed over to @c Pager::pageOut()
+	 */
 	void flushAll();
 
+	Stats stats() const;
+
+	/**
+	 * @brief Schedules the page in of all chunks that are touched by the given region on the page in threads. This
+	 * does not block the caller. Chunks that are requested via @c chunk() or a Sampler while they are still queued
+	 * are paged in by the requesting thread.
+	 * @return @c true if all chunks of the region are already available, @c false if at least one chunk is not
+	 * yet paged in. Call this again at a later time to query the state.
+	 */
+	bool prefetch(const Region& region) const;
+
 	ChunkPtr chunk(const glm::ivec3& pos) const;
 
 	glm::ivec3 chunkPos(int x, int y, int z) const;
@@ -257,16 +350,86 @@ protected:
 	PagedVolume& operator=(const PagedVolume& rhs);
 
 private:
-	ChunkPtr chunk(int32_t uChunkX, int32_t uChunkY, int32_t uChunkZ) const;
-	ChunkPtr createNewChunk(int32_t uChunkX, int32_t uChunkY, int32_t uChunkZ) const;
-	void deleteOldestChunkIfNeeded() const;
+	typedef core::HashMap<glm::ivec3, ChunkPtr, glm::hash<glm::ivec3>> ChunkMap;
 
-	mutable int32_t _timestamper = 0;
+	/**
+	 * @brief The chunks are distributed over several shards by their chunk coordinates to reduce the
+	 * contention on the locks if several threads are accessing the volume. Lookups of chunks that are
+	 * already in the volume only take the shard lock for reading.
+	 */
+	struct ChunkShard {
+		core::SharedLock lock;
+		ChunkMap chunks;
+	};
+	static constexpr int ChunkShardCount = 16;
 
-	uint32_t _chunkCountLimit = 0u;
+	// Enough to make sure a chunks and it's neighbours can be loaded, with a few to spare.
+	static constexpr uint32_t MinPracticalNoOfChunks = 32u;
 
-	typedef core::Map<glm::ivec3, ChunkPtr, 64, glm::hash<glm::ivec3>> ChunkMap;
-	mutable ChunkMap _chunks;
+	ChunkPtr chunk(int32_t uChunkX, int32_t uChunkY, int32_t uChunkZ) const;
+	/**
+	 * @brief Returns the chunk of the volume or inserts a new (not yet loaded) chunk
+	 * @param[out] created @c true if the chunk wasn't part of the volume before
+	 */
+	ChunkPtr findOrInsertChunk(const glm::ivec3& pos, bool& created) const;
+	void pageInChunk(const ChunkPtr& chunk) const;
+	void waitForChunk(const ChunkPtr& chunk) const;
+	ChunkShard& shard(const glm::ivec3& chunkPos) const;
+
+	/**
+	 * @brief Adds the chunk to the eviction clock and to the memory budget - evicts chunks if the budget is exceeded
+	 */
+	void trackChunk(Chunk* chunk) const;
+	void deleteOldestChunksIfNeeded() const;
+	Chunk* nextClockVictim(bool skipCompressed) const;
+	void unlinkClock(Chunk* chunk) const;
+	void schedulePageOut(const ChunkPtr& chunk) const;
+	void decompressChunk(const ChunkPtr& chunk) const;
+	void updateAccounting(Chunk* chunk) const;
+	bool takePendingPageOut(const glm::ivec3& pos, ChunkPtr& chunk) const;
+	void pageOutPendingChunks() const;
+
+	/**
+	 * @brief The page in and page out tasks of all volumes are executed by one thread pool per process. The
+	 * threads are only started once the first task is scheduled.
+	 */
+	static core::ThreadPool& threadPool();
+	/**
+	 * @param[in] dropOnShutdown Don't execute the task if the volume is destroyed before the task is started
+	 */
+	void enqueue(std::function<void()>&& task, bool dropOnShutdown) const;
+
+	mutable core::AtomicInt _chunkCount { 0 };
+	mutable core::AtomicInt _hits { 0 };
+	mutable core::AtomicInt _misses { 0 };
+	mutable core::AtomicInt _evictions { 0 };
+	mutable core::AtomicInt _prefetches { 0 };
+	mutable core::AtomicInt _compressions { 0 };
+
+	uint64_t _memoryLimitInBytes = 0u;
+	// guarded by the eviction lock
+	mutable uint64_t _residentBytes = 0u;
+	// the clock hand of the eviction - the chunk that is checked next. Guarded by the eviction lock
+	mutable Chunk* _clockHand = nullptr;
+
+	mutable ChunkShard _shards[ChunkShardCount];
+
+	// modified chunks that were evicted but not yet handed over to Pager::pageOut(). They
+	// are revived if they are requested again before the pager persisted them.
+	mutable ChunkMap _pendingPageOuts;
+	mutable core_trace_mutex(core::Lock, _pendingPageOutsLock, "PagedVolumePageOut");
+	// there is only one page out task per volume - the pager is never called concurrently to persist the
+	// chunks. Guarded by the page out lock
+	mutable bool _pageOutActive = false;
+	// signaled once the page out task handed all pending chunks to the pager
+	mutable core::ConditionVariable _pageOutCondition;
+
+	// the tasks of this volume that are queued or executed by the shared thread pool
+	mutable int _pendingTasks = 0;
+	// queued prefetches are dropped once the volume is destroyed
+	mutable bool _shutdown = false;
+	mutable core_trace_mutex(core::Lock, _tasksLock, "PagedVolumeTasks");
+	mutable core::ConditionVariable _tasksCondition;
 
 	// The size of the chunks
 	uint16_t _chunkSideLength;
@@ -277,7 +440,13 @@ private:
 
 	Region _region;
 
-	mutable core::ReadWriteLock _volumeLock{"pagedvolume"};
+	// guards the eviction clock and the memory accounting
+	mutable core_trace_mutex(core::Lock, _evictionLock, "PagedVolumeEviction");
+	// serializes the decompression of chunks that are requested by several threads at once
+	mutable core_trace_mutex(core::Lock, _compressionLock, "PagedVolumeCompression");
+	// used to wait for chunks that are paged in by another thread
+	mutable core_trace_mutex(core::Lock, _loadingLock, "PagedVolumeLoading");
+	mutable core::ConditionVariable _loadingCondition;
 };
 
 inline const Voxel& PagedVolume::Sampler::voxel() const {
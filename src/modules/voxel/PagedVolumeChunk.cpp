@@ -7,6 +7,7 @@
 #include "math/Functions.h"
 #include "core/Common.h"
 #include "core/StandardLib.h"
+#include "core/Trace.h"
 
 namespace voxel {
 
@@ -26,12 +27,167 @@ PagedVolume::Chunk::Chunk(const glm::ivec3& pos, uint16_t sideLength, Pager* pag
 }
 
 PagedVolume::Chunk::~Chunk() {
-	if (_dataModified && _pager) {
-		_pager->pageOut(this);
+	// the modified chunks are handed over to the pager by the volume (eviction or flush) - a chunk
+	// might be destroyed on any thread that held the last reference
+	core_free(_data);
+	_data = nullptr;
+	core_free(_palette);
+	_palette = nullptr;
+	core_free(_indices);
+	_indices = nullptr;
+}
+
+namespace {
+
+template<int Bits>
+void unpackIndices(const uint8_t* indices, const Voxel* palette, Voxel* out, uint32_t amount) {
+	constexpr uint32_t perByte = 8u / Bits;
+	constexpr uint8_t mask = (uint8_t)((1u << Bits) - 1u);
+	for (uint32_t i = 0u; i < amount; ++i) {
+		const uint8_t shift = (uint8_t)((i % perByte) * Bits);
+		out[i] = palette[(indices[i / perByte] >> shift) & mask];
+	}
+}
+
+template<int Bits>
+void packIndices(uint8_t* indices, uint32_t amount) {
+	constexpr uint32_t perByte = 8u / Bits;
+	// the write position is never ahead of the read position - so this can be done in place
+	for (uint32_t i = 0u; i < amount; i += perByte) {
+		uint8_t packed = 0u;
+		for (uint32_t j = 0u; j < perByte; ++j) {
+			packed |= (uint8_t)(indices[i + j] << (j * Bits));
+		}
+		indices[i / perByte] = packed;
+	}
+}
+
+}
+
+bool PagedVolume::Chunk::compressed() const {
+	return _compressed;
+}
+
+uint32_t PagedVolume::Chunk::residentSizeInBytes() const {
+	if (!compressed()) {
+		return dataSizeInBytes();
+	}
+	uint32_t indicesSize = 0u;
+	if (_bitsPerIndex > 0u) {
+		indicesSize = voxels() / (8u / _bitsPerIndex);
+	}
+	return _paletteSize * sizeof(Voxel) + indicesSize;
+}
+
+bool PagedVolume::Chunk::compress() {
+	core_assert_msg(!compressed(), "Chunk is already compressed");
+	core_trace_scoped(CompressChunk);
+	const uint32_t amount = voxels();
+	if (amount < 8u) {
+		// not worth it - and the bit packing works on full bytes
+		return false;
+	}
+	// one byte per voxel first - this is packed down to the needed bits once the size of the palette is known
+	uint8_t* indices = (uint8_t*)core_malloc(amount);
+	Voxel palette[256];
+	uint32_t paletteSize = 0u;
+	uint8_t lastIndex = 0u;
+	for (uint32_t i = 0u; i < amount; ++i) {
+		const Voxel& voxel = _data[i];
+		// the voxels are usually organized in long runs of the same voxel
+		if (paletteSize > 0u && palette[lastIndex].isSame(voxel)) {
+			indices[i] = lastIndex;
+			continue;
+		}
+		uint32_t index = 0u;
+		while (index < paletteSize && !palette[index].isSame(voxel)) {
+			++index;
+		}
+		if (index == paletteSize) {
+			if (paletteSize == (uint32_t)lengthof(palette)) {
+				core_free(indices);
+				return false;
+			}
+			palette[paletteSize++] = voxel;
+		}
+		lastIndex = (uint8_t)index;
+		indices[i] = lastIndex;
+	}
+
+	if (paletteSize <= 1u) {
+		_bitsPerIndex = 0u;
+	} else if (paletteSize <= 2u) {
+		_bitsPerIndex = 1u;
+	} else if (paletteSize <= 4u) {
+		_bitsPerIndex = 2u;
+	} else if (paletteSize <= 16u) {
+		_bitsPerIndex = 4u;
+	} else {
+		_bitsPerIndex = 8u;
+	}
+
+	switch (_bitsPerIndex) {
+	case 0u:
+		core_free(indices);
+		indices = nullptr;
+		break;
+	case 1u:
+		packIndices<1>(indices, amount);
+		break;
+	case 2u:
+		packIndices<2>(indices, amount);
+		break;
+	case 4u:
+		packIndices<4>(indices, amount);
+		break;
+	default:
+		break;
+	}
+	if (indices != nullptr && _bitsPerIndex < 8u) {
+		indices = (uint8_t*)core_realloc(indices, amount / (8u / _bitsPerIndex));
 	}
 
+	_paletteSize = (uint16_t)paletteSize;
+	_palette = (Voxel*)core_malloc(paletteSize * sizeof(Voxel));
+	core_memcpy((uint8_t*)_palette, (const uint8_t*)palette, paletteSize * sizeof(Voxel));
+	_indices = indices;
 	core_free(_data);
 	_data = nullptr;
+	_compressed = true;
+	return true;
+}
+
+void PagedVolume::Chunk::decompress() {
+	core_assert_msg(compressed(), "Chunk is not compressed");
+	core_trace_scoped(DecompressChunk);
+	const uint32_t amount = voxels();
+	_data = (Voxel*)core_malloc(amount * sizeof(Voxel));
+	switch (_bitsPerIndex) {
+	case 0u:
+		for (uint32_t i = 0u; i < amount; ++i) {
+			_data[i] = _palette[0];
+		}
+		break;
+	case 1u:
+		unpackIndices<1>(_indices, _palette, _data, amount);
+		break;
+	case 2u:
+		unpackIndices<2>(_indices, _palette, _data, amount);
+		break;
+	case 4u:
+		unpackIndices<4>(_indices, _palette, _data, amount);
+		break;
+	default:
+		unpackIndices<8>(_indices, _palette, _data, amount);
+		break;
+	}
+	core_free(_palette);
+	_palette = nullptr;
+	core_free(_indices);
+	_indices = nullptr;
+	_paletteSize = 0u;
+	_bitsPerIndex = 0u;
+	_compressed = false;
 }
 
 bool PagedVolume::Chunk::setData(const Voxel* voxels, size_t sizeInBytes) {
@@ -112,6 +268,10 @@ const glm::ivec3& PagedVolume::Chunk::chunkPos() const {
 	return _chunkSpacePosition;
 }
 
+bool PagedVolume::Chunk::loaded() const {
+	return _loaded;
+}
+
 void PagedVolume::Chunk::setVoxel(const glm::i16vec3& pos, const Voxel& value) {
 	setVoxel(pos.x, pos.y, pos.z, value);
 }
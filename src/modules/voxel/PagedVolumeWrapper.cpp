@@ -53,7 +53,7 @@ PagedVolumeWrapper::PagedVolumeWrapper(PagedVolume* voxelStorage, const PagedVol
 	}
 }
 
-const Voxel& PagedVolumeWrapper::voxel(int x, int y, int z) const {
+Voxel PagedVolumeWrapper::voxel(int x, int y, int z) const {
 	if (_validRegion.containsPoint(x, y, z)) {
 		core_assert(_chunk != nullptr);
 		const int relX = x - _validRegion.getLowerX();
@@ -41,8 +41,8 @@ public:
 	PagedVolume* volume() const;
 	const Region& region() const;
 
-	const Voxel& voxel(const glm::ivec3& pos) const;
-	const Voxel& voxel(int x, int y, int z) const;
+	Voxel voxel(const glm::ivec3& pos) const;
+	Voxel voxel(int x, int y, int z) const;
 
 	bool setVoxel(const glm::ivec3& pos, const Voxel& voxel);
 	bool setVoxel(int x, int y, int z, const Voxel& voxel);
@@ -83,7 +83,7 @@ inline bool PagedVolumeWrapper::setVoxel(const glm::ivec3& pos, const Voxel& vox
 	return setVoxel(pos.x, pos.y, pos.z, voxel);
 }
 
-inline const Voxel& PagedVolumeWrapper::voxel(const glm::ivec3& pos) const {
+inline Voxel PagedVolumeWrapper::voxel(const glm::ivec3& pos) const {
 	return voxel(pos.x, pos.y, pos.z);
 }
 
@@ -5,7 +5,9 @@
 #include "RawVolume.h"
 #include "core/Assert.h"
 #include "core/StandardLib.h"
+#include "core/Common.h"
 #include <glm/common.hpp>
+#include <algorithm>
 #include <limits>
 
 namespace voxel {
@@ -42,9 +44,32 @@ RawVolume::RawVolume(const RawVolume& copy) :
 	core_memcpy((void*)_data, (void*)copy._data, size);
 }
 
+RawVolume::RawVolume(const RawVolume& copy, const Region& region) :
+		_region(region) {
+	_region.cropTo(copy.region());
+	core_assert_msg(_region.isValid(), "The region doesn't intersect the copied volume");
+	setBorderValue(copy.borderValue());
+	const size_t size = width() * height() * depth() * sizeof(Voxel);
+	_data = (Voxel*)core_malloc(size);
+	_mins = glm::ivec3((std::numeric_limits<int>::max)() / 2);
+	_maxs = glm::ivec3((std::numeric_limits<int>::min)() / 2);
+	_boundsValid = false;
+	// copy the rows along x - they are contiguous in both volumes
+	const glm::ivec3 offset = _region.getLowerCorner() - copy.region().getLowerCorner();
+	const size_t rowSize = width() * sizeof(Voxel);
+	for (int z = 0; z < depth(); ++z) {
+		for (int y = 0; y < height(); ++y) {
+			const Voxel* src = copy._data + offset.x + (offset.y + y) * copy.width() + (offset.z + z) * copy.width() * copy.height();
+			Voxel* dest = _data + y * width() + z * width() * height();
+			core_memcpy((void*)dest, (const void*)src, rowSize);
+		}
+	}
+}
+
 RawVolume::RawVolume(RawVolume&& move) noexcept {
 	_data = move._data;
 	move._data = nullptr;
+	_borderVoxel = move._borderVoxel;
 	_mins = move._mins;
 	_maxs = move._maxs;
 	_region = move._region;
@@ -144,6 +169,59 @@ bool RawVolume::setVoxel(const glm::ivec3& pos, const Voxel& voxel) {
 	return true;
 }
 
+bool RawVolume::setVoxels(int32_t x, int32_t y, int32_t z, const Voxel* voxels, int32_t amount) {
+	const bool inside = _region.containsPoint(x, y, z);
+	core_assert_msg(inside, "Position is outside valid region %i:%i:%i", x, y, z);
+	if (!inside) {
+		return false;
+	}
+	amount = core_min(amount, _region.getUpperX() - x + 1);
+	if (amount <= 0) {
+		return false;
+	}
+	const glm::ivec3& lowerCorner = _region.getLowerCorner();
+	const int index = (x - lowerCorner.x) + (y - lowerCorner.y) * width() + (z - lowerCorner.z) * width() * height();
+	core_memcpy((void*)(_data + index), (const void*)voxels, amount * sizeof(Voxel));
+	int32_t first = 0;
+	while (first < amount && isAir(voxels[first].getMaterial())) {
+		++first;
+	}
+	if (first == amount) {
+		return true;
+	}
+	int32_t last = amount - 1;
+	while (isAir(voxels[last].getMaterial())) {
+		--last;
+	}
+	_mins = (glm::min)(_mins, glm::ivec3(x + first, y, z));
+	_maxs = (glm::max)(_maxs, glm::ivec3(x + last, y, z));
+	_boundsValid = true;
+	return true;
+}
+
+bool RawVolume::fillVoxels(int32_t x, int32_t y, int32_t z, const Voxel& voxel, int32_t amount) {
+	const bool inside = _region.containsPoint(x, y, z);
+	core_assert_msg(inside, "Position is outside valid region %i:%i:%i", x, y, z);
+	if (!inside) {
+		return false;
+	}
+	amount = core_min(amount, _region.getUpperX() - x + 1);
+	if (amount <= 0) {
+		return false;
+	}
+	const glm::ivec3& lowerCorner = _region.getLowerCorner();
+	const int index = (x - lowerCorner.x) + (y - lowerCorner.y) * width() + (z - lowerCorner.z) * width() * height();
+	// a voxel is two bytes - no memset here
+	std::fill_n(_data + index, amount, voxel);
+	if (isAir(voxel.getMaterial())) {
+		return true;
+	}
+	_mins = (glm::min)(_mins, glm::ivec3(x, y, z));
+	_maxs = (glm::max)(_maxs, glm::ivec3(x + amount - 1, y, z));
+	_boundsValid = true;
+	return true;
+}
+
 /**
  * This function should probably be made internal...
  */
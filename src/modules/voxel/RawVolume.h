@@ -92,6 +92,12 @@ public:
 	RawVolume(const Region& region);
 	RawVolume(const RawVolume* copy);
 	RawVolume(const RawVolume& copy);
+	/**
+	 * @brief Copies only the voxels of the given region. The region is cropped to the region of the
+	 * copied volume - sampling outside of it returns the border value just like for the copied volume.
+	 * @note The given region must intersect the region of the copied volume
+	 */
+	RawVolume(const RawVolume& copy, const Region& region);
 	RawVolume(RawVolume&& move) noexcept;
 
 	static RawVolume* createRaw(const Voxel* data, const voxel::Region& region) {
@@ -137,6 +143,23 @@ public:
 	bool setVoxel(int32_t x, int32_t y, int32_t z, const Voxel& voxel);
 	/// Sets the voxel at the position given by a 3D vector
 	bool setVoxel(const glm::ivec3& pos, const Voxel& voxel);
+	/**
+	 * @brief Copies the given voxels into the row along the x axis that starts at the given position
+	 *
+	 * The rows along the x axis are contiguous in memory - this is the fast path for the loaders that
+	 * decode a whole row at once instead of doing the region checks of @c setVoxel() for every voxel.
+	 * @param[in] amount The amount of voxels to copy - the row is clipped to the region
+	 * @note The bounds (@c mins() and @c maxs()) are extended by the first and last non air voxel of the row
+	 * @return @c false if the start position is outside the region
+	 */
+	bool setVoxels(int32_t x, int32_t y, int32_t z, const Voxel* voxels, int32_t amount);
+	/**
+	 * @brief Sets @c amount voxels in the row along the x axis that starts at the given position to the same value
+	 *
+	 * Used to fill the runs of run length encoded formats.
+	 * @sa setVoxels()
+	 */
+	bool fillVoxels(int32_t x, int32_t y, int32_t z, const Voxel& voxel, int32_t amount);
 
 	void clear();
 
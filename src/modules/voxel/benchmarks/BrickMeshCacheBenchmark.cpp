@@ -0,0 +1,96 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "voxel/BrickMeshCache.h"
+#include "voxel/BinaryGreedyMesher.h"
+#include "voxel/MaterialColor.h"
+#include "voxel/Constants.h"
+#include "voxel/PagedVolume.h"
+
+class BrickMeshCacheBenchmark : public app::AbstractBenchmark {
+protected:
+	class TerrainPager: public voxel::PagedVolume::Pager {
+	public:
+		bool pageIn(voxel::PagedVolume::PagerContext& ctx) override {
+			const glm::ivec3& mins = ctx.region.getLowerCorner();
+			const int sideLength = ctx.chunk->sideLength();
+			for (int x = 0; x < sideLength; ++x) {
+				for (int z = 0; z < sideLength; ++z) {
+					const int wx = mins.x + x;
+					const int wz = mins.z + z;
+					const int height = 32 + (wx * 7 + wz * 13) % 17 + (wx / 8 + wz / 8) % 5;
+					for (int y = 0; y < sideLength && mins.y + y < height; ++y) {
+						ctx.chunk->setVoxel(x, y, z, voxel::createColorVoxel(voxel::VoxelType::Grass, wx + wz));
+					}
+				}
+			}
+			return false;
+		}
+
+		void pageOut(voxel::PagedVolume::Chunk* chunk) override {
+		}
+	};
+
+	TerrainPager _pager;
+
+	/**
+	 * @brief A mesh tile like the world renderer extracts it - see @c WorldMeshExtractor::extractionRegion()
+	 */
+	static voxel::Region tile(int size) {
+		return voxel::Region(glm::ivec3(0), glm::ivec3(size - 1, voxel::MAX_MESH_CHUNK_HEIGHT - 2, size - 1));
+	}
+
+	static void extract(voxel::PagedVolume* volume, const voxel::Region& region, voxel::Mesh* mesh) {
+		voxel::extractBinaryGreedyMesh(volume, region, mesh, region.getLowerCorner());
+	}
+
+public:
+	bool onInitApp() override {
+		return voxel::initDefaultMaterialColors();
+	}
+};
+
+/**
+ * @brief The latency of a voxel modification without the brick cache - the whole tile is extracted again
+ */
+BENCHMARK_DEFINE_F(BrickMeshCacheBenchmark, SingleVoxelEditFullTile)(benchmark::State &state) {
+	const voxel::Region& region = tile((int)state.range(0));
+	voxel::PagedVolume volume(&_pager, 1024 * 1024 * 1024, 64);
+	voxel::Mesh mesh(1024 * 1024, 1024 * 1024, true);
+	const glm::ivec3 pos(region.getCenter().x, 60, region.getCenter().z);
+	int i = 0;
+	for (auto _ : state) {
+		volume.setVoxel(pos, (++i & 1) ? voxel::createVoxel(voxel::VoxelType::Grass, 1) : voxel::Voxel());
+		extract(&volume, region, &mesh);
+	}
+}
+
+/**
+ * @brief The latency of a voxel modification with the brick cache - only the affected bricks are extracted
+ * and the tile mesh is put together from the cached brick meshes
+ */
+BENCHMARK_DEFINE_F(BrickMeshCacheBenchmark, SingleVoxelEditBricks)(benchmark::State &state) {
+	const voxel::Region& region = tile((int)state.range(0));
+	voxel::PagedVolume volume(&_pager, 1024 * 1024 * 1024, 64);
+	voxel::BrickMeshCache cache(region);
+	auto extractBrick = [&volume] (const voxel::Region& brickRegion, voxel::Mesh* brickMesh) {
+		extract(&volume, brickRegion, brickMesh);
+	};
+	cache.update(extractBrick);
+	voxel::Mesh mesh(1024 * 1024, 1024 * 1024, true);
+	const glm::ivec3 pos(region.getCenter().x, 60, region.getCenter().z);
+	int i = 0;
+	int64_t bricks = 0;
+	for (auto _ : state) {
+		volume.setVoxel(pos, (++i & 1) ? voxel::createVoxel(voxel::VoxelType::Grass, 1) : voxel::Voxel());
+		cache.markDirty(pos);
+		bricks += cache.update(extractBrick);
+		cache.concatenate(&mesh);
+	}
+	state.counters["bricks"] = benchmark::Counter((double)bricks, benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK_REGISTER_F(BrickMeshCacheBenchmark, SingleVoxelEditFullTile)->Arg(32)->Arg(64)->Unit(benchmark::kMicrosecond);
+BENCHMARK_REGISTER_F(BrickMeshCacheBenchmark, SingleVoxelEditBricks)->Arg(32)->Arg(64)->Unit(benchmark::kMicrosecond);
@@ -4,13 +4,16 @@
 
 #include "app/benchmark/AbstractBenchmark.h"
 #include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/BinaryGreedyMesher.h"
 #include "voxel/IsQuadNeeded.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/Constants.h"
 #include "voxel/RawVolume.h"
 #include "voxel/PagedVolume.h"
+#include "core/concurrent/ThreadPool.h"
 
 static constexpr int MAX_BENCHMARK_VOLUME_SIZE = 64;
+static constexpr int LARGE_BENCHMARK_REGION_SIZE = 256;
 static const int meshSize = voxel::MAX_MESH_CHUNK_HEIGHT;
 class CubicSurfaceExtractorBenchmark : public app::AbstractBenchmark {
 public:
@@ -40,6 +43,36 @@ public:
 		}
 	};
 
+	/**
+	 * @brief Creates some terrain with a surface that isn't flat to not get everything merged into a few quads
+	 */
+	class TerrainPager: public voxel::PagedVolume::Pager {
+	public:
+		bool pageIn(voxel::PagedVolume::PagerContext& ctx) override {
+			const glm::ivec3& mins = ctx.region.getLowerCorner();
+			const int sideLength = ctx.chunk->sideLength();
+			for (int x = 0; x < sideLength; ++x) {
+				for (int z = 0; z < sideLength; ++z) {
+					const int wx = mins.x + x;
+					const int wz = mins.z + z;
+					const int height = 32 + (wx * 7 + wz * 13) % 17 + (wx / 8 + wz / 8) % 5;
+					for (int y = 0; y < sideLength && mins.y + y < height; ++y) {
+						const voxel::VoxelType type = mins.y + y == height - 1 ? voxel::VoxelType::Grass : voxel::VoxelType::Rock;
+						ctx.chunk->setVoxel(x, y, z, voxel::createColorVoxel(type, wx + wz));
+					}
+				}
+			}
+			return false;
+		}
+
+		void pageOut(voxel::PagedVolume::Chunk* chunk) override {
+		}
+	};
+
+	static int quads(const voxel::Mesh& mesh) {
+		return (int)mesh.getNoOfIndices() / 6;
+	}
+
 	bool onInitApp() override {
 		if (!voxel::initDefaultMaterialColors()) {
 			return false;
@@ -132,6 +165,99 @@ BENCHMARK_DEFINE_F(CubicSurfaceExtractorBenchmark, PagedVolumeExtractEmpty)(benc
 	}
 }
 
+BENCHMARK_DEFINE_F(CubicSurfaceExtractorBenchmark, RawVolumeExtractBinaryGreedy)(benchmark::State &state) {
+	const voxel::Region region(glm::ivec3(0), glm::ivec3(state.range(0), meshSize, state.range(0)));
+	constexpr voxel::Region volumeRegion(0, MAX_BENCHMARK_VOLUME_SIZE);
+	voxel::RawVolume volume(volumeRegion);
+	fill(region, &volume);
+	voxel::Mesh mesh(1024 * 1024, 1024 * 1024, false);
+	for (auto _ : state) {
+		voxel::extractBinaryGreedyMesh(&volume, region, &mesh, region.getLowerCorner());
+	}
+}
+
+BENCHMARK_DEFINE_F(CubicSurfaceExtractorBenchmark, PagedVolumeExtractBinaryGreedy)(benchmark::State &state) {
+	const voxel::Region region(glm::ivec3(0), glm::ivec3(state.range(0), meshSize, state.range(0)));
+	BenchmarkPager pager;
+	voxel::PagedVolume volume(&pager, 1024 * 1024 * 1024, 256);
+	fill(region, &volume);
+	voxel::Mesh mesh(1024 * 1024, 1024 * 1024, false);
+	for (auto _ : state) {
+		voxel::extractBinaryGreedyMesh(&volume, region, &mesh, region.getLowerCorner());
+	}
+}
+
+/**
+ * @brief Extracts a mesh tile of terrain like the world renderer does - the reference for
+ * @c PagedVolumeTerrainExtractBinaryGreedy
+ */
+BENCHMARK_DEFINE_F(CubicSurfaceExtractorBenchmark, PagedVolumeTerrainExtractGreedy)(benchmark::State &state) {
+	const voxel::Region region(glm::ivec3(0), glm::ivec3(state.range(0) - 1, meshSize - 2, state.range(0) - 1));
+	TerrainPager pager;
+	voxel::PagedVolume volume(&pager, 1024 * 1024 * 1024, 64);
+	voxel::Mesh mesh(1024 * 1024, 1024 * 1024, true);
+	voxel::extractCubicMesh(&volume, region, &mesh, voxel::IsQuadNeeded(), region.getLowerCorner());
+	for (auto _ : state) {
+		voxel::extractCubicMesh(&volume, region, &mesh, voxel::IsQuadNeeded(), region.getLowerCorner());
+	}
+	state.counters["quads"] = quads(mesh);
+}
+
+BENCHMARK_DEFINE_F(CubicSurfaceExtractorBenchmark, PagedVolumeTerrainExtractBinaryGreedy)(benchmark::State &state) {
+	const voxel::Region region(glm::ivec3(0), glm::ivec3(state.range(0) - 1, meshSize - 2, state.range(0) - 1));
+	TerrainPager pager;
+	voxel::PagedVolume volume(&pager, 1024 * 1024 * 1024, 64);
+	voxel::Mesh mesh(1024 * 1024, 1024 * 1024, true);
+	voxel::extractBinaryGreedyMesh(&volume, region, &mesh, region.getLowerCorner());
+	for (auto _ : state) {
+		voxel::extractBinaryGreedyMesh(&volume, region, &mesh, region.getLowerCorner());
+	}
+	state.counters["quads"] = quads(mesh);
+}
+
+/**
+ * @brief Extracts a large region of terrain - the single threaded reference for @c PagedVolumeExtractParallel
+ * @note The quads are not merged here - the merging is quadratic in the amount of quads per plane and would
+ * dominate the measurement for regions of this size.
+ */
+BENCHMARK_DEFINE_F(CubicSurfaceExtractorBenchmark, PagedVolumeExtractLarge)(benchmark::State &state) {
+	const int size = (int)state.range(0);
+	const voxel::Region region(glm::ivec3(0), glm::ivec3(size - 1, meshSize - 1, size - 1));
+	TerrainPager pager;
+	voxel::PagedVolume volume(&pager, 1024 * 1024 * 1024, 64);
+	voxel::Mesh mesh(1024 * 1024, 1024 * 1024, true);
+	voxel::extractCubicMesh(&volume, region, &mesh, voxel::IsQuadNeeded(), region.getLowerCorner(), false);
+	int64_t quadCount = 0;
+	for (auto _ : state) {
+		voxel::extractCubicMesh(&volume, region, &mesh, voxel::IsQuadNeeded(), region.getLowerCorner(), false);
+		quadCount += quads(mesh);
+	}
+	state.SetItemsProcessed(quadCount);
+	state.SetLabel("items are quads");
+}
+
+/**
+ * @brief Extracts a large region of terrain with the given amount of threads (second argument)
+ */
+BENCHMARK_DEFINE_F(CubicSurfaceExtractorBenchmark, PagedVolumeExtractParallel)(benchmark::State &state) {
+	const int size = (int)state.range(0);
+	const int threads = (int)state.range(1);
+	const voxel::Region region(glm::ivec3(0), glm::ivec3(size - 1, meshSize - 1, size - 1));
+	TerrainPager pager;
+	voxel::PagedVolume volume(&pager, 1024 * 1024 * 1024, 64);
+	core::ThreadPool threadPool(threads, "Extractor");
+	threadPool.init();
+	voxel::Mesh mesh(1024 * 1024, 1024 * 1024, true);
+	voxel::extractCubicMeshParallel(threadPool, &volume, region, &mesh, voxel::IsQuadNeeded(), region.getLowerCorner(), false);
+	int64_t quadCount = 0;
+	for (auto _ : state) {
+		voxel::extractCubicMeshParallel(threadPool, &volume, region, &mesh, voxel::IsQuadNeeded(), region.getLowerCorner(), false);
+		quadCount += quads(mesh);
+	}
+	state.SetItemsProcessed(quadCount);
+	state.SetLabel("items are quads");
+}
+
 BENCHMARK_REGISTER_F(CubicSurfaceExtractorBenchmark, RawVolumeExtractGreedy)->RangeMultiplier(2)->Range(16, MAX_BENCHMARK_VOLUME_SIZE);
 BENCHMARK_REGISTER_F(CubicSurfaceExtractorBenchmark, RawVolumeExtract)->RangeMultiplier(2)->Range(16, MAX_BENCHMARK_VOLUME_SIZE);
 BENCHMARK_REGISTER_F(CubicSurfaceExtractorBenchmark, RawVolumeExtractGreedyEmpty)->RangeMultiplier(2)->Range(16, MAX_BENCHMARK_VOLUME_SIZE);
@@ -142,4 +268,18 @@ BENCHMARK_REGISTER_F(CubicSurfaceExtractorBenchmark, PagedVolumeExtract)->RangeM
 BENCHMARK_REGISTER_F(CubicSurfaceExtractorBenchmark, PagedVolumeExtractGreedyEmpty)->RangeMultiplier(2)->Range(16, MAX_BENCHMARK_VOLUME_SIZE);
 BENCHMARK_REGISTER_F(CubicSurfaceExtractorBenchmark, PagedVolumeExtractEmpty)->RangeMultiplier(2)->Range(16, MAX_BENCHMARK_VOLUME_SIZE);
 
+BENCHMARK_REGISTER_F(CubicSurfaceExtractorBenchmark, RawVolumeExtractBinaryGreedy)->RangeMultiplier(2)->Range(16, MAX_BENCHMARK_VOLUME_SIZE);
+BENCHMARK_REGISTER_F(CubicSurfaceExtractorBenchmark, PagedVolumeExtractBinaryGreedy)->RangeMultiplier(2)->Range(16, MAX_BENCHMARK_VOLUME_SIZE);
+BENCHMARK_REGISTER_F(CubicSurfaceExtractorBenchmark, PagedVolumeTerrainExtractGreedy)->RangeMultiplier(2)->Range(16, MAX_BENCHMARK_VOLUME_SIZE);
+BENCHMARK_REGISTER_F(CubicSurfaceExtractorBenchmark, PagedVolumeTerrainExtractBinaryGreedy)->RangeMultiplier(2)->Range(16, MAX_BENCHMARK_VOLUME_SIZE);
+
+BENCHMARK_REGISTER_F(CubicSurfaceExtractorBenchmark, PagedVolumeExtractLarge)->Arg(128)->Arg(LARGE_BENCHMARK_REGION_SIZE)->UseRealTime();
+BENCHMARK_REGISTER_F(CubicSurfaceExtractorBenchmark, PagedVolumeExtractParallel)->Apply([] (benchmark::internal::Benchmark* b) {
+	for (int size : {128, LARGE_BENCHMARK_REGION_SIZE}) {
+		for (int threads : {1, 2, 4, 8}) {
+			b->Args({size, threads});
+		}
+	}
+})->UseRealTime();
+
 BENCHMARK_MAIN();
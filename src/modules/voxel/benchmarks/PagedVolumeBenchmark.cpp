@@ -0,0 +1,145 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "voxel/MaterialColor.h"
+#include "voxel/PagedVolume.h"
+#include <thread>
+#include <vector>
+
+class PagedVolumeBenchmark : public app::AbstractBenchmark {
+public:
+	static constexpr int ChunkSideLength = 32;
+	static constexpr int SampleSize = 128;
+
+	class BenchmarkPager: public voxel::PagedVolume::Pager {
+	public:
+		bool pageIn(voxel::PagedVolume::PagerContext& ctx) override {
+			const voxel::Voxel voxel = voxel::createColorVoxel(voxel::VoxelType::Generic, 1);
+			for (int i = 0; i < ctx.chunk->sideLength(); ++i) {
+				ctx.chunk->setVoxel(i, i, i, voxel);
+			}
+			return false;
+		}
+
+		void pageOut(voxel::PagedVolume::Chunk* chunk) override {
+		}
+	};
+
+	/**
+	 * @brief Walks the sampler through a cube of the volume and crosses a lot of chunk borders
+	 * @return the amount of solid voxels
+	 */
+	static int sample(const voxel::PagedVolume* volume, int offset) {
+		voxel::PagedVolume::Sampler sampler(volume);
+		int solid = 0;
+		for (int z = 0; z < SampleSize; ++z) {
+			for (int y = 0; y < SampleSize; ++y) {
+				sampler.setPosition(offset, y, z);
+				for (int x = 0; x < SampleSize; ++x) {
+					if (!voxel::isAir(sampler.voxel().getMaterial())) {
+						++solid;
+					}
+					if (!voxel::isAir(sampler.peekVoxel0px1py0pz().getMaterial())) {
+						++solid;
+					}
+					sampler.movePositiveX();
+				}
+			}
+		}
+		return solid;
+	}
+
+	bool onInitApp() override {
+		return voxel::initDefaultMaterialColors();
+	}
+};
+
+/**
+ * @brief All threads are sampling the same area of the volume - the chunks are already paged in
+ */
+BENCHMARK_DEFINE_F(PagedVolumeBenchmark, SamplerSharedChunks)(benchmark::State &state) {
+	BenchmarkPager pager;
+	voxel::PagedVolume volume(&pager, 512 * 1024 * 1024, ChunkSideLength);
+	const int threadCount = (int)state.range(0);
+	sample(&volume, 0);
+	for (auto _ : state) {
+		std::vector<std::thread> threads;
+		threads.reserve(threadCount);
+		for (int i = 0; i < threadCount; ++i) {
+			threads.emplace_back([&volume] () {
+				benchmark::DoNotOptimize(sample(&volume, 0));
+			});
+		}
+		for (std::thread& t : threads) {
+			t.join();
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * threadCount * SampleSize * SampleSize * SampleSize);
+}
+
+/**
+ * @brief Every thread is sampling its own area of the volume - the chunks are paged in while sampling
+ */
+BENCHMARK_DEFINE_F(PagedVolumeBenchmark, SamplerPagingChunks)(benchmark::State &state) {
+	BenchmarkPager pager;
+	voxel::PagedVolume volume(&pager, 512 * 1024 * 1024, ChunkSideLength);
+	const int threadCount = (int)state.range(0);
+	for (auto _ : state) {
+		state.PauseTiming();
+		volume.flushAll();
+		state.ResumeTiming();
+		std::vector<std::thread> threads;
+		threads.reserve(threadCount);
+		for (int i = 0; i < threadCount; ++i) {
+			threads.emplace_back([&volume, i] () {
+				benchmark::DoNotOptimize(sample(&volume, i * SampleSize));
+			});
+		}
+		for (std::thread& t : threads) {
+			t.join();
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * threadCount * SampleSize * SampleSize * SampleSize);
+}
+
+/**
+ * @brief The budget only allows a fraction of the sampled chunks to be resident in their uncompressed form - the
+ * sampler is constantly hitting chunks that must get decompressed first
+ */
+BENCHMARK_DEFINE_F(PagedVolumeBenchmark, SamplerCompressedChunks)(benchmark::State &state) {
+	BenchmarkPager pager;
+	voxel::PagedVolume volume(&pager, 2 * 1024 * 1024, ChunkSideLength);
+	sample(&volume, 0);
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(sample(&volume, 0));
+	}
+	const voxel::PagedVolume::Stats& stats = volume.stats();
+	state.counters["compressions"] = stats.compressions;
+	state.counters["evictions"] = stats.evictions;
+	state.SetItemsProcessed(state.iterations() * SampleSize * SampleSize * SampleSize);
+}
+
+/**
+ * @brief Writes columns of voxels into already paged in chunks
+ */
+BENCHMARK_DEFINE_F(PagedVolumeBenchmark, SetVoxels)(benchmark::State &state) {
+	BenchmarkPager pager;
+	const int budget = (int)state.range(0) * 1024 * 1024;
+	voxel::PagedVolume volume(&pager, budget, ChunkSideLength);
+	voxel::Voxel column[SampleSize];
+	for (int y = 0; y < SampleSize; ++y) {
+		column[y] = voxel::createColorVoxel(y < SampleSize / 2 ? voxel::VoxelType::Rock : voxel::VoxelType::Grass, 1);
+	}
+	for (auto _ : state) {
+		volume.setVoxels(0, 0, 0, SampleSize, SampleSize, column, SampleSize);
+	}
+	state.counters["compressions"] = volume.stats().compressions;
+	state.SetItemsProcessed(state.iterations() * SampleSize * SampleSize * SampleSize);
+}
+
+BENCHMARK_REGISTER_F(PagedVolumeBenchmark, SamplerSharedChunks)->DenseRange(1, 8)->UseRealTime();
+BENCHMARK_REGISTER_F(PagedVolumeBenchmark, SamplerPagingChunks)->DenseRange(1, 8)->UseRealTime();
+BENCHMARK_REGISTER_F(PagedVolumeBenchmark, SamplerCompressedChunks);
+BENCHMARK_REGISTER_F(PagedVolumeBenchmark, SetVoxels)->Arg(1)->Arg(512);
@@ -0,0 +1,142 @@
+/**
+ * @file
+ */
+
+#include "AbstractVoxelTest.h"
+#include "voxel/BinaryGreedyMesher.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/IsQuadNeeded.h"
+#include <algorithm>
+#include <tuple>
+#include <limits>
+
+namespace voxel {
+
+class BinaryGreedyMesherTest: public AbstractVoxelTest {
+protected:
+	bool pageIn(const Region& region, const PagedVolume::ChunkPtr& chunk) override {
+		const glm::ivec3& mins = region.getLowerCorner();
+		for (int x = 0; x < chunk->sideLength(); ++x) {
+			for (int z = 0; z < chunk->sideLength(); ++z) {
+				const int wx = mins.x + x;
+				const int wz = mins.z + z;
+				// some hills with different colors, a lake and a few floating blocks
+				const int height = 8 + (wx / 3 + wz / 5) % 7;
+				for (int y = 0; y < chunk->sideLength(); ++y) {
+					const int wy = mins.y + y;
+					if (wy < height) {
+						const VoxelType type = wy == height - 1 ? VoxelType::Grass : VoxelType::Rock;
+						chunk->setVoxel(x, y, z, createVoxel(type, (uint8_t)(wx % 3)));
+					} else if (wy < 12 && wx > 20 && wx < 30) {
+						chunk->setVoxel(x, y, z, createVoxel(VoxelType::Water, 0));
+					} else if (wy == 20 && (wx % 7) < 3 && (wz % 5) < 2) {
+						chunk->setVoxel(x, y, z, createVoxel(VoxelType::Leaf, 1));
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @brief A face of the size of one voxel - given by the lower corner, the normal axis, the winding and the color
+	 */
+	typedef std::tuple<int, int, int, int, int, int> UnitFace;
+
+	/**
+	 * @brief Splits the quads of the mesh into faces of the size of one voxel
+	 */
+	static std::vector<UnitFace> unitFaces(const Mesh& mesh) {
+		std::vector<UnitFace> faces;
+		for (size_t i = 0; i + 6 <= mesh.getNoOfIndices(); i += 6) {
+			glm::ivec3 mins(std::numeric_limits<int>::max());
+			glm::ivec3 maxs(std::numeric_limits<int>::min());
+			for (size_t n = i; n < i + 6; ++n) {
+				const glm::ivec3 pos(mesh.getVertex(mesh.getIndex(n)).position);
+				mins = glm::min(mins, pos);
+				maxs = glm::max(maxs, pos);
+			}
+			const glm::ivec3 p0(mesh.getVertex(mesh.getIndex(i + 0)).position);
+			const glm::ivec3 p1(mesh.getVertex(mesh.getIndex(i + 1)).position);
+			const glm::ivec3 p2(mesh.getVertex(mesh.getIndex(i + 2)).position);
+			const glm::vec3 normal = glm::cross(glm::vec3(p1 - p0), glm::vec3(p2 - p0));
+			const int axis = mins.x == maxs.x ? 0 : (mins.y == maxs.y ? 1 : 2);
+			const int sign = normal[axis] > 0.0f ? 1 : -1;
+			const int color = mesh.getVertex(mesh.getIndex(i)).colorIndex;
+			const glm::ivec3 ends = glm::max(maxs, mins + 1);
+			for (int x = mins.x; x < ends.x; ++x) {
+				for (int y = mins.y; y < ends.y; ++y) {
+					for (int z = mins.z; z < ends.z; ++z) {
+						glm::ivec3 pos(x, y, z);
+						pos[axis] = mins[axis];
+						faces.emplace_back(pos.x, pos.y, pos.z, axis, sign, color);
+					}
+				}
+			}
+		}
+		std::sort(faces.begin(), faces.end());
+		return faces;
+	}
+
+	static bool containsVertex(const Mesh& mesh, const VoxelVertex& vertex) {
+		for (size_t i = 0; i < mesh.getNoOfVertices(); ++i) {
+			const VoxelVertex& v = mesh.getVertex(i);
+			if (v.position == vertex.position && v.colorIndex == vertex.colorIndex && v.ambientOcclusion == vertex.ambientOcclusion) {
+				return true;
+			}
+		}
+		return false;
+	}
+};
+
+TEST_F(BinaryGreedyMesherTest, testSameSurfaceAsCubicMesh) {
+	const Region region(0, 0, 0, 47, 31, 47);
+	Mesh cubic;
+	extractCubicMesh(&_volData, region, &cubic, IsQuadNeeded(), region.getLowerCorner(), false, false);
+	Mesh greedy;
+	extractBinaryGreedyMesh(&_volData, region, &greedy, region.getLowerCorner());
+
+	ASSERT_FALSE(greedy.isEmpty());
+	EXPECT_EQ(cubic.getOffset(), greedy.getOffset());
+	EXPECT_EQ(unitFaces(cubic), unitFaces(greedy));
+	EXPECT_LT(greedy.getNoOfIndices(), cubic.getNoOfIndices());
+}
+
+TEST_F(BinaryGreedyMesherTest, testSameSurfaceWithOffset) {
+	const Region region(-13, -2, 5, 50, 29, 21);
+	Mesh cubic;
+	extractCubicMesh(&_volData, region, &cubic, IsQuadNeeded(), region.getLowerCorner(), false, false);
+	Mesh greedy;
+	extractBinaryGreedyMesh(&_volData, region, &greedy, region.getLowerCorner());
+
+	ASSERT_FALSE(greedy.isEmpty());
+	EXPECT_EQ(unitFaces(cubic), unitFaces(greedy));
+}
+
+TEST_F(BinaryGreedyMesherTest, testAmbientOcclusion) {
+	const Region region(0, 0, 0, 31, 31, 31);
+	Mesh cubic;
+	extractCubicMesh(&_volData, region, &cubic, IsQuadNeeded(), region.getLowerCorner(), false, false);
+	Mesh greedy;
+	extractBinaryGreedyMesh(&_volData, region, &greedy, region.getLowerCorner());
+
+	ASSERT_FALSE(greedy.isEmpty());
+	// the corners of the merged quads are vertices of the unmerged quads
+	for (size_t i = 0; i < greedy.getNoOfVertices(); ++i) {
+		const VoxelVertex& vertex = greedy.getVertex(i);
+		ASSERT_TRUE(containsVertex(cubic, vertex)) << "vertex " << i << " at " << vertex.position.x << ":"
+				<< vertex.position.y << ":" << vertex.position.z << " with ao " << (int)vertex.ambientOcclusion;
+	}
+}
+
+TEST_F(BinaryGreedyMesherTest, testWithoutAmbientOcclusionMergesMore) {
+	const Region region(0, 0, 0, 31, 31, 31);
+	Mesh ao;
+	extractBinaryGreedyMesh(&_volData, region, &ao, region.getLowerCorner());
+	Mesh noAo;
+	extractBinaryGreedyMesh(&_volData, region, &noAo, region.getLowerCorner(), false);
+	EXPECT_LT(noAo.getNoOfIndices(), ao.getNoOfIndices());
+	EXPECT_EQ(unitFaces(ao), unitFaces(noAo));
+}
+
+}
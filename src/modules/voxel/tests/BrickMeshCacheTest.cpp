@@ -0,0 +1,146 @@
+/**
+ * @file
+ */
+
+#include "AbstractVoxelTest.h"
+#include "voxel/BrickMeshCache.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/IsQuadNeeded.h"
+
+namespace voxel {
+
+class BrickMeshCacheTest: public AbstractVoxelTest {
+protected:
+	bool pageIn(const Region& region, const PagedVolume::ChunkPtr& chunk) override {
+		const glm::ivec3& mins = region.getLowerCorner();
+		for (int x = 0; x < chunk->sideLength(); ++x) {
+			for (int z = 0; z < chunk->sideLength(); ++z) {
+				const int height = 8 + ((mins.x + x) / 3 + (mins.z + z) / 5) % 7;
+				for (int y = 0; y < chunk->sideLength() && mins.y + y < height; ++y) {
+					chunk->setVoxel(x, y, z, createVoxel(VoxelType::Grass, (uint8_t)((mins.x + x) % 3)));
+				}
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Extracts every face as its own quad - this makes the amount of indices comparable between the
+	 * brick meshes and the mesh of the whole tile.
+	 */
+	void extract(const Region& region, Mesh* mesh) {
+		extractCubicMesh(&_volData, region, mesh, IsQuadNeeded(), region.getLowerCorner(), false, false);
+	}
+
+	int update(BrickMeshCache& cache) {
+		return cache.update([this] (const Region& region, Mesh* mesh) {
+			extract(region, mesh);
+		});
+	}
+};
+
+TEST_F(BrickMeshCacheTest, testBrickRegions) {
+	const Region region(0, 0, 0, 31, 39, 31);
+	BrickMeshCache cache(region);
+	ASSERT_EQ(2 * 3 * 2, cache.bricks());
+	EXPECT_EQ(Region(0, 0, 0, 15, 15, 15), cache.brickRegion(0));
+	EXPECT_EQ(Region(16, 0, 0, 31, 15, 15), cache.brickRegion(1));
+	// the last brick in y is clipped to the tile region
+	EXPECT_EQ(Region(16, 32, 16, 31, 39, 31), cache.brickRegion(cache.bricks() - 1));
+}
+
+TEST_F(BrickMeshCacheTest, testMarkDirty) {
+	const Region region(0, 0, 0, 31, 31, 31);
+	BrickMeshCache cache(region);
+	EXPECT_EQ(cache.bricks(), cache.dirtyBricks());
+	update(cache);
+	EXPECT_EQ(0, cache.dirtyBricks());
+
+	EXPECT_TRUE(cache.markDirty(glm::ivec3(5, 5, 5)));
+	EXPECT_EQ(1, cache.dirtyBricks());
+	update(cache);
+
+	// on the border of a brick - the neighbour brick looks at this voxel, too
+	EXPECT_TRUE(cache.markDirty(glm::ivec3(15, 5, 5)));
+	EXPECT_EQ(2, cache.dirtyBricks());
+	update(cache);
+
+	EXPECT_TRUE(cache.markDirty(glm::ivec3(16, 16, 16)));
+	EXPECT_EQ(8, cache.dirtyBricks());
+	update(cache);
+
+	// outside of the tile - but still influences the faces and the ambient occlusion of the border
+	EXPECT_TRUE(cache.markDirty(glm::ivec3(32, 5, 5)));
+	EXPECT_EQ(1, cache.dirtyBricks());
+	update(cache);
+
+	EXPECT_FALSE(cache.markDirty(glm::ivec3(33, 5, 5)));
+	EXPECT_FALSE(cache.markDirty(glm::ivec3(-2, 5, 5)));
+	EXPECT_EQ(0, cache.dirtyBricks());
+}
+
+TEST_F(BrickMeshCacheTest, testConcatenate) {
+	const Region region(0, 0, 0, 47, 31, 31);
+	BrickMeshCache cache(region);
+	EXPECT_EQ(cache.bricks(), update(cache));
+	Mesh bricks;
+	cache.concatenate(&bricks);
+
+	Mesh tile;
+	extract(region, &tile);
+	ASSERT_FALSE(tile.isEmpty());
+	EXPECT_EQ(tile.getOffset(), bricks.getOffset());
+	EXPECT_EQ(tile.getNoOfIndices(), bricks.getNoOfIndices());
+	EXPECT_NE(nullptr, bricks.compressedIndices());
+}
+
+TEST_F(BrickMeshCacheTest, testSingleVoxelModification) {
+	const Region region(0, 0, 0, 47, 31, 31);
+	BrickMeshCache cache(region);
+	update(cache);
+
+	// a floating voxel adds six faces
+	const glm::ivec3 pos(20, 25, 20);
+	_volData.setVoxel(pos, createVoxel(VoxelType::Grass, 1));
+	ASSERT_TRUE(cache.markDirty(pos));
+	EXPECT_EQ(1, update(cache));
+	Mesh bricks;
+	cache.concatenate(&bricks);
+
+	Mesh tile;
+	extract(region, &tile);
+	EXPECT_EQ(tile.getNoOfIndices(), bricks.getNoOfIndices());
+
+	_volData.setVoxel(pos, Voxel());
+	ASSERT_TRUE(cache.markDirty(pos));
+	EXPECT_EQ(1, update(cache));
+	Mesh removed;
+	cache.concatenate(&removed);
+	EXPECT_EQ(tile.getNoOfIndices() - 6 * 6, removed.getNoOfIndices());
+}
+
+TEST_F(BrickMeshCacheTest, testRemoveAllFaces) {
+	const Region region(100, 32, 100, 131, 63, 131);
+	BrickMeshCache cache(region);
+	update(cache);
+	Mesh mesh;
+	EXPECT_FALSE(cache.concatenate(&mesh)) << "An empty tile doesn't have any geometry to replace";
+	EXPECT_TRUE(mesh.isEmpty());
+
+	const glm::ivec3 pos(110, 40, 110);
+	_volData.setVoxel(pos, createVoxel(VoxelType::Grass, 1));
+	ASSERT_TRUE(cache.markDirty(pos));
+	update(cache);
+	EXPECT_TRUE(cache.concatenate(&mesh));
+	EXPECT_FALSE(mesh.isEmpty());
+
+	_volData.setVoxel(pos, Voxel());
+	ASSERT_TRUE(cache.markDirty(pos));
+	update(cache);
+	EXPECT_TRUE(cache.concatenate(&mesh)) << "The empty mesh must replace the previous geometry of the tile";
+	EXPECT_TRUE(mesh.isEmpty());
+	EXPECT_EQ(region.getLowerCorner(), mesh.getOffset());
+	EXPECT_FALSE(cache.concatenate(&mesh));
+}
+
+}
@@ -0,0 +1,97 @@
+/**
+ * @file
+ */
+
+#include "AbstractVoxelTest.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/IsQuadNeeded.h"
+#include "core/concurrent/ThreadPool.h"
+#include <algorithm>
+
+namespace voxel {
+
+class CubicSurfaceExtractorTest: public AbstractVoxelTest {
+protected:
+	bool pageIn(const Region& region, const PagedVolume::ChunkPtr& chunk) override {
+		const glm::ivec3& mins = region.getLowerCorner();
+		for (int x = 0; x < chunk->sideLength(); ++x) {
+			for (int z = 0; z < chunk->sideLength(); ++z) {
+				// some hills with different materials
+				const int height = 8 + ((mins.x + x) / 3 + (mins.z + z) / 5) % 7;
+				for (int y = 0; y < chunk->sideLength() && mins.y + y < height; ++y) {
+					const VoxelType type = mins.y + y == height - 1 ? VoxelType::Grass : VoxelType::Rock;
+					chunk->setVoxel(x, y, z, createVoxel(type, (uint8_t)((mins.x + x) % 3)));
+				}
+			}
+		}
+		return true;
+	}
+
+	static std::vector<glm::ivec3> positions(const Mesh& mesh) {
+		std::vector<glm::ivec3> result;
+		for (size_t i = 0; i < mesh.getNoOfIndices(); ++i) {
+			result.push_back(mesh.getVertex(mesh.getIndex(i)).position);
+		}
+		std::sort(result.begin(), result.end(), [] (const glm::ivec3& a, const glm::ivec3& b) {
+			if (a.x != b.x) {
+				return a.x < b.x;
+			}
+			if (a.y != b.y) {
+				return a.y < b.y;
+			}
+			return a.z < b.z;
+		});
+		return result;
+	}
+};
+
+TEST_F(CubicSurfaceExtractorTest, testParallelExtractionMatchesSerial) {
+	const Region region(0, 0, 0, 47, 31, 47);
+	core::ThreadPool threadPool(4, "ExtractorTest");
+	threadPool.init();
+
+	Mesh serial;
+	extractCubicMesh(&_volData, region, &serial, IsQuadNeeded(), region.getLowerCorner(), false, false);
+	Mesh parallel;
+	extractCubicMeshParallel(threadPool, &_volData, region, &parallel, IsQuadNeeded(), region.getLowerCorner(), false, false);
+
+	ASSERT_FALSE(serial.isEmpty());
+	EXPECT_EQ(serial.getOffset(), parallel.getOffset());
+	EXPECT_EQ(serial.getNoOfIndices(), parallel.getNoOfIndices());
+	EXPECT_EQ(positions(serial), positions(parallel));
+}
+
+TEST_F(CubicSurfaceExtractorTest, testParallelExtractionMerged) {
+	const Region region(0, 0, 0, 47, 31, 47);
+	core::ThreadPool threadPool(4, "ExtractorTest");
+	threadPool.init();
+
+	Mesh serial;
+	extractCubicMesh(&_volData, region, &serial, IsQuadNeeded(), region.getLowerCorner());
+	Mesh parallel;
+	extractCubicMeshParallel(threadPool, &_volData, region, &parallel, IsQuadNeeded(), region.getLowerCorner());
+
+	Mesh unmerged;
+	extractCubicMesh(&_volData, region, &unmerged, IsQuadNeeded(), region.getLowerCorner(), false, false);
+
+	ASSERT_FALSE(parallel.isEmpty());
+	// quads are not merged across the slab borders
+	EXPECT_GE(parallel.getNoOfIndices(), serial.getNoOfIndices());
+	EXPECT_LT(parallel.getNoOfIndices(), unmerged.getNoOfIndices());
+}
+
+TEST_F(CubicSurfaceExtractorTest, testScratchBuffersAreReused) {
+	const Region region(0, 0, 0, 31, 31, 31);
+	Mesh first;
+	extractCubicMesh(&_volData, region, &first, IsQuadNeeded(), region.getLowerCorner());
+	// a smaller and a bigger region in between to resize the buffers of this thread
+	Mesh other;
+	extractCubicMesh(&_volData, Region(0, 0, 0, 7, 7, 7), &other, IsQuadNeeded(), glm::ivec3(0));
+	extractCubicMesh(&_volData, Region(0, 0, 0, 63, 31, 63), &other, IsQuadNeeded(), glm::ivec3(0));
+	Mesh second;
+	extractCubicMesh(&_volData, region, &second, IsQuadNeeded(), region.getLowerCorner());
+	EXPECT_EQ(first.getNoOfVertices(), second.getNoOfVertices());
+	EXPECT_EQ(first.getNoOfIndices(), second.getNoOfIndices());
+}
+
+}
@@ -0,0 +1,288 @@
+/**
+ * @file
+ */
+
+#include "AbstractVoxelTest.h"
+#include "core/concurrent/Atomic.h"
+#include <thread>
+#include <vector>
+
+namespace voxel {
+
+class PagedVolumeTest: public AbstractVoxelTest {
+protected:
+	core::AtomicInt _pageInCount { 0 };
+
+	bool pageIn(const voxel::Region& region, const PagedVolume::ChunkPtr& chunk) override {
+		_pageInCount.increment(1);
+		// give the other threads the chance to request the same chunk while it is loading
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		chunk->setVoxel(0, 0, 0, createVoxel(VoxelType::Grass, 0));
+		return true;
+	}
+
+	bool compress(PagedVolume::Chunk& chunk) const {
+		return chunk.compress();
+	}
+
+	void decompress(PagedVolume::Chunk& chunk) const {
+		chunk.decompress();
+	}
+};
+
+TEST_F(PagedVolumeTest, testSameChunkIsPagedInOnce) {
+	_volData.flushAll();
+	_pageInCount = 0;
+	std::vector<std::thread> threads;
+	for (int i = 0; i < 8; ++i) {
+		threads.emplace_back([this] () {
+			const PagedVolume::ChunkPtr& chunk = _volData.chunk(glm::ivec3(1000, 0, 1000));
+			EXPECT_TRUE(chunk->loaded());
+			EXPECT_EQ(VoxelType::Grass, chunk->voxel(0, 0, 0).getMaterial());
+		});
+	}
+	for (std::thread& t : threads) {
+		t.join();
+	}
+	EXPECT_EQ(1, (int)_pageInCount);
+}
+
+TEST_F(PagedVolumeTest, testDifferentChunksInParallel) {
+	_volData.flushAll();
+	_pageInCount = 0;
+	std::vector<std::thread> threads;
+	const int sideLength = _volData.chunkSideLength();
+	for (int i = 0; i < 8; ++i) {
+		threads.emplace_back([this, i, sideLength] () {
+			PagedVolume::Sampler sampler(&_volData);
+			sampler.setPosition(i * sideLength, 0, 0);
+			EXPECT_EQ(VoxelType::Grass, sampler.voxel().getMaterial());
+		});
+	}
+	for (std::thread& t : threads) {
+		t.join();
+	}
+	EXPECT_EQ(8, (int)_pageInCount);
+}
+
+TEST_F(PagedVolumeTest, testPrefetch) {
+	_volData.flushAll();
+	_pageInCount = 0;
+	const int sideLength = _volData.chunkSideLength();
+	const Region region(glm::ivec3(0), glm::ivec3(2 * sideLength - 1, sideLength - 1, sideLength - 1));
+	EXPECT_FALSE(_volData.prefetch(region)) << "The chunks should not be available right after the first request";
+	while (!_volData.prefetch(region)) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	EXPECT_EQ(2, (int)_pageInCount);
+	EXPECT_EQ(VoxelType::Grass, _volData.voxel(sideLength, 0, 0).getMaterial());
+	EXPECT_EQ(2, (int)_pageInCount) << "The prefetched chunk should not get paged in again";
+}
+
+TEST_F(PagedVolumeTest, testPrefetchedChunkIsPagedInOnce) {
+	_volData.flushAll();
+	_pageInCount = 0;
+	const Region region(glm::ivec3(0), glm::ivec3(_volData.chunkSideLength() * 8 - 1, 0, 0));
+	_volData.prefetch(region);
+	// request the chunks while they are still queued or paged in on the prefetch threads
+	for (int i = 7; i >= 0; --i) {
+		EXPECT_EQ(VoxelType::Grass, _volData.voxel(i * _volData.chunkSideLength(), 0, 0).getMaterial());
+	}
+	EXPECT_TRUE(_volData.prefetch(region));
+	EXPECT_EQ(8, (int)_pageInCount);
+}
+
+class CountingPager: public PagedVolume::Pager {
+public:
+	core::AtomicInt pageIns { 0 };
+	core::AtomicInt pageOuts { 0 };
+	// fill the chunks with too many different voxels to be compressed
+	bool incompressible = false;
+
+	bool pageIn(PagedVolume::PagerContext& ctx) override {
+		pageIns.increment(1);
+		if (incompressible) {
+			const PagedVolume::ChunkPtr& chunk = ctx.chunk;
+			const int sideLength = chunk->sideLength();
+			int n = 0;
+			for (int x = 0; x < sideLength; ++x) {
+				for (int y = 0; y < sideLength; ++y) {
+					for (int z = 0; z < sideLength; ++z, ++n) {
+						const VoxelType type = (n / 256) % 2 ? VoxelType::Grass : VoxelType::Wood;
+						chunk->setVoxel(x, y, z, createVoxel(type, n % 256));
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+	void pageOut(PagedVolume::Chunk* chunk) override {
+		pageOuts.increment(1);
+	}
+};
+
+TEST_F(PagedVolumeTest, testMemoryBudget) {
+	CountingPager pager;
+	pager.incompressible = true;
+	const int chunkSideLength = 16;
+	const uint32_t budget = 1024 * 1024;
+	const int chunks = 300;
+	{
+		PagedVolume volume(&pager, budget, chunkSideLength);
+		for (int i = 0; i < chunks; ++i) {
+			volume.chunk(glm::ivec3(i * chunkSideLength, 0, 0));
+			EXPECT_LE(volume.stats().residentBytes, budget);
+		}
+		const PagedVolume::Stats& stats = volume.stats();
+		EXPECT_EQ((uint32_t)chunks, stats.misses);
+		EXPECT_EQ(0u, stats.hits);
+		EXPECT_EQ(stats.chunks + stats.evictions, (uint32_t)chunks);
+		EXPECT_EQ(budget, stats.memoryLimitInBytes);
+		EXPECT_GT(stats.evictions, 0u);
+		EXPECT_EQ(0u, stats.compressions);
+	}
+	// the destructor waits for the pending page outs
+	EXPECT_EQ(chunks, (int)pager.pageOuts);
+}
+
+TEST_F(PagedVolumeTest, testRecentlyUsedChunksAreKept) {
+	CountingPager pager;
+	const int chunkSideLength = 16;
+	PagedVolume volume(&pager, 1024 * 1024, chunkSideLength);
+	const glm::ivec3 hotChunk(0);
+	volume.chunk(hotChunk);
+	for (int i = 1; i < 300; ++i) {
+		volume.chunk(glm::ivec3(i * chunkSideLength, 0, 0));
+		volume.chunk(hotChunk);
+	}
+	EXPECT_EQ(1 + 299, (int)pager.pageIns) << "The frequently accessed chunk should never be evicted";
+	EXPECT_EQ(299u, volume.stats().hits);
+}
+
+TEST_F(PagedVolumeTest, testCompressedChunksStayResident) {
+	CountingPager pager;
+	const int chunkSideLength = 16;
+	const uint32_t budget = 1024 * 1024;
+	const int chunks = 300;
+	PagedVolume volume(&pager, budget, chunkSideLength);
+	const Voxel voxel = createVoxel(VoxelType::Grass, 1);
+	for (int i = 0; i < chunks; ++i) {
+		// two different voxels per chunk
+		volume.setVoxel(i * chunkSideLength + i % chunkSideLength, 1, 2, voxel);
+		EXPECT_LE(volume.stats().residentBytes, budget);
+	}
+	const PagedVolume::Stats& stats = volume.stats();
+	EXPECT_GT(stats.compressions, 0u);
+	EXPECT_EQ(0u, stats.evictions) << "The compressed chunks should fit into the budget";
+	EXPECT_EQ(chunks, (int)pager.pageIns);
+	for (int i = 0; i < chunks; ++i) {
+		const int x = i * chunkSideLength + i % chunkSideLength;
+		EXPECT_TRUE(voxel.isSame(volume.voxel(x, 1, 2))) << "Failed to decompress chunk " << i;
+		EXPECT_TRUE(volume.voxel(x, 2, 2).getMaterial() == VoxelType::Air) << "Failed to decompress chunk " << i;
+	}
+	EXPECT_EQ(chunks, (int)pager.pageIns) << "The chunks should have been decompressed instead of paged in again";
+}
+
+TEST_F(PagedVolumeTest, testChunkCompression) {
+	CountingPager pager;
+	const int sideLength = 16;
+	for (int paletteSize : {1, 2, 3, 5, 17, 256}) {
+		PagedVolume::Chunk chunk(glm::ivec3(0), sideLength, &pager);
+		int n = 0;
+		for (int x = 0; x < sideLength; ++x) {
+			for (int y = 0; y < sideLength; ++y) {
+				for (int z = 0; z < sideLength; ++z, ++n) {
+					chunk.setVoxel(x, y, z, createVoxel(VoxelType::Grass, n % paletteSize));
+				}
+			}
+		}
+		const uint32_t size = chunk.residentSizeInBytes();
+		ASSERT_TRUE(compress(chunk)) << "Failed to compress a chunk with " << paletteSize << " voxels";
+		EXPECT_TRUE(chunk.compressed());
+		EXPECT_LT(chunk.residentSizeInBytes(), size);
+		decompress(chunk);
+		EXPECT_FALSE(chunk.compressed());
+		EXPECT_EQ(size, chunk.residentSizeInBytes());
+		n = 0;
+		for (int x = 0; x < sideLength; ++x) {
+			for (int y = 0; y < sideLength; ++y) {
+				for (int z = 0; z < sideLength; ++z, ++n) {
+					ASSERT_EQ(n % paletteSize, chunk.voxel(x, y, z).getColor()) << "Palette size: " << paletteSize;
+				}
+			}
+		}
+	}
+}
+
+TEST_F(PagedVolumeTest, testFlushAllPagesOutModifiedChunks) {
+	CountingPager pager;
+	const int chunkSideLength = 16;
+	PagedVolume volume(&pager, 1024 * 1024, chunkSideLength);
+	for (int i = 0; i < 10; ++i) {
+		volume.chunk(glm::ivec3(i * chunkSideLength, 0, 0));
+	}
+	volume.flushAll();
+	EXPECT_EQ(10, (int)pager.pageOuts) << "flushAll() should block until the chunks are persisted";
+	// a chunk that is not part of a volume is not persisted on destruction
+	{
+		PagedVolume::Chunk chunk(glm::ivec3(0), chunkSideLength, &pager);
+		chunk.setVoxel(1, 2, 3, createVoxel(VoxelType::Grass, 1));
+	}
+	EXPECT_EQ(10, (int)pager.pageOuts);
+}
+
+/**
+ * @brief Blocks the page out of one chunk until the test releases it
+ */
+class BlockingPager: public CountingPager {
+public:
+	glm::ivec3 blockedChunk { 0 };
+	core::AtomicBool blocked { false };
+	core::AtomicBool release { false };
+	core::AtomicInt blockedChunkPageOuts { 0 };
+	core::AtomicInt lastColor { -1 };
+
+	void pageOut(PagedVolume::Chunk* chunk) override {
+		CountingPager::pageOut(chunk);
+		if (chunk->chunkPos() != blockedChunk) {
+			return;
+		}
+		lastColor = chunk->voxel(1, 2, 3).getColor();
+		if (blockedChunkPageOuts.increment(1) == 0) {
+			blocked = true;
+			for (int i = 0; i < 10000 && !release; ++i) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		}
+	}
+};
+
+TEST_F(PagedVolumeTest, testRevivedChunkIsPagedOutAgain) {
+	BlockingPager pager;
+	pager.incompressible = true;
+	const int chunkSideLength = 16;
+	{
+		PagedVolume volume(&pager, 1024 * 1024, chunkSideLength);
+		volume.setVoxel(1, 2, 3, createVoxel(VoxelType::Grass, 1));
+		// evict the chunk - its page out blocks
+		for (int i = 1; i < 300 && !pager.blocked; ++i) {
+			volume.chunk(glm::ivec3(i * chunkSideLength, 0, 0));
+		}
+		for (int i = 0; i < 10000 && !pager.blocked; ++i) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		ASSERT_TRUE(pager.blocked);
+		// revive and modify the chunk while the pager is persisting the old state - it can't be evicted again
+		// before the page out finished, because the page out task holds a reference
+		volume.setVoxel(1, 2, 3, createVoxel(VoxelType::Grass, 2));
+		for (int i = 300; i < 600; ++i) {
+			volume.chunk(glm::ivec3(i * chunkSideLength, 0, 0));
+		}
+		pager.release = true;
+	}
+	EXPECT_EQ(2, (int)pager.blockedChunkPageOuts) << "The modifications of the revived chunk were not persisted";
+	EXPECT_EQ(2, (int)pager.lastColor);
+}
+
+}
@@ -0,0 +1,97 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxel/RawVolume.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/IsQuadNeeded.h"
+#include "voxel/Mesh.h"
+
+namespace voxel {
+
+class RawVolumeTest: public app::AbstractTest {
+protected:
+	static void fill(RawVolume& volume) {
+		const Region& region = volume.region();
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					if ((x * 7 + y * 3 + z * 5) % 4 == 0) {
+						volume.setVoxel(x, y, z, createVoxel(VoxelType::Generic, (uint8_t)(x + y + z)));
+					}
+				}
+			}
+		}
+	}
+};
+
+TEST_F(RawVolumeTest, testCopyRegion) {
+	RawVolume volume(Region(-4, 11));
+	volume.setBorderValue(createVoxel(VoxelType::Generic, 42));
+	fill(volume);
+	const Region region(glm::ivec3(-6, 0, 2), glm::ivec3(3, 4, 20));
+	RawVolume copy(volume, region);
+	// cropped to the region of the copied volume
+	EXPECT_EQ(Region(glm::ivec3(-4, 0, 2), glm::ivec3(3, 4, 11)), copy.region());
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				ASSERT_EQ(volume.voxel(x, y, z), copy.voxel(x, y, z)) << "Differs at " << x << ":" << y << ":" << z;
+			}
+		}
+	}
+}
+
+TEST_F(RawVolumeTest, testCopyRegionMesh) {
+	RawVolume volume(Region(0, 31));
+	fill(volume);
+	Region reg(glm::ivec3(8), glm::ivec3(16));
+	Mesh expected;
+	extractCubicMesh(&volume, reg, &expected, IsQuadNeeded(), reg.getLowerCorner());
+
+	// the extractor looks at the neighbours of the region, too
+	Region copyRegion = reg;
+	copyRegion.grow(1);
+	RawVolume copy(volume, copyRegion);
+	Mesh mesh;
+	extractCubicMesh(&copy, reg, &mesh, IsQuadNeeded(), reg.getLowerCorner());
+	ASSERT_FALSE(expected.isEmpty());
+	EXPECT_EQ(expected.getNoOfVertices(), mesh.getNoOfVertices());
+	ASSERT_EQ(expected.getNoOfIndices(), mesh.getNoOfIndices());
+	for (size_t i = 0; i < expected.getNoOfIndices(); ++i) {
+		ASSERT_EQ(expected.getIndex(i), mesh.getIndex(i));
+	}
+}
+
+TEST_F(RawVolumeTest, testSetVoxels) {
+	RawVolume volume(Region(-4, 11));
+	Voxel row[8];
+	for (int i = 2; i < 6; ++i) {
+		row[i] = createVoxel(VoxelType::Generic, (uint8_t)i);
+	}
+	ASSERT_TRUE(volume.setVoxels(-2, 3, 4, row, lengthof(row)));
+	for (int i = 0; i < lengthof(row); ++i) {
+		EXPECT_TRUE(row[i].isSame(volume.voxel(-2 + i, 3, 4))) << "Differs at " << i;
+	}
+	EXPECT_EQ(glm::ivec3(0, 3, 4), volume.mins());
+	EXPECT_EQ(glm::ivec3(3, 3, 4), volume.maxs());
+	// clipped to the region
+	ASSERT_TRUE(volume.setVoxels(8, 0, 0, row, lengthof(row)));
+	EXPECT_TRUE(row[3].isSame(volume.voxel(11, 0, 0)));
+	EXPECT_TRUE(volume.voxel(-4, 1, 0).isSame(Voxel()));
+}
+
+TEST_F(RawVolumeTest, testFillVoxels) {
+	RawVolume volume(Region(0, 15));
+	const Voxel voxel = createVoxel(VoxelType::Generic, 1);
+	ASSERT_TRUE(volume.fillVoxels(10, 2, 3, voxel, 100));
+	for (int x = 0; x < 16; ++x) {
+		EXPECT_EQ(x >= 10, volume.voxel(x, 2, 3).isSame(voxel)) << "Differs at " << x;
+	}
+	EXPECT_TRUE(volume.voxel(0, 3, 3).isSame(Voxel())) << "Run must not leak into the next row";
+	EXPECT_EQ(glm::ivec3(10, 2, 3), volume.mins());
+	EXPECT_EQ(glm::ivec3(15, 2, 3), volume.maxs());
+}
+
+}
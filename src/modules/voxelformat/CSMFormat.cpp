@@ -54,8 +54,6 @@ bool CSMFormat::loadGroups(const io::FilePtr &file, VoxelVolumes &volumes) {
 		return false;
 	}
 
-	const MaterialColorArray& materialColors = getMaterialColors();
-
 	io::FileStream stream(file.get());
 	uint32_t magic, version, blank, matrixCount;
 	wrap(stream.readInt(magic))
@@ -122,8 +120,7 @@ bool CSMFormat::loadGroups(const io::FilePtr &file, VoxelVolumes &volumes) {
 				matrixIndex += count;
 				continue;
 			}
-			const glm::vec4& color = core::Color::fromRGBA(r, g, b, 255);
-			const int index = core::Color::getClosestMatch(color, materialColors);
+			const uint8_t index = findClosestIndex(r, g, b);
 			const voxel::Voxel& voxel = voxel::createVoxel(voxel::VoxelType::Generic, index);
 
 			for (uint32_t v = matrixIndex; v < matrixIndex + count; ++v) {
@@ -7,6 +7,7 @@
 #include "core/StringUtil.h"
 #include "core/Log.h"
 #include "core/Color.h"
+#include <vector>
 
 namespace voxel {
 
@@ -43,25 +44,24 @@ bool CubFormat::loadGroups(const io::FilePtr& file, VoxelVolumes& volumes) {
 
 	// TODO: support loading own palette
 
-	const MaterialColorArray& materialColors = getMaterialColors();
-
+	// decode whole rows along the x axis - they are contiguous in the file and in the volume
+	std::vector<uint8_t> rgbRow(width * 3);
+	std::vector<voxel::Voxel> row(width);
 	for (uint32_t h = 0u; h < height; ++h) {
 		for (uint32_t d = 0u; d < depth; ++d) {
-			for (uint32_t w = 0u; w < width; ++w) {
-				uint8_t r, g, b;
-				wrap(stream.readByte(r))
-				wrap(stream.readByte(g))
-				wrap(stream.readByte(b))
-				if (r == 0u && g == 0u && b == 0u) {
+			wrap(stream.read(rgbRow.data(), rgbRow.size()))
+			const uint8_t *rgb = rgbRow.data();
+			for (uint32_t w = 0u; w < width; ++w, rgb += 3) {
+				if (rgb[0] == 0u && rgb[1] == 0u && rgb[2] == 0u) {
 					// empty voxel
+					row[w] = voxel::Voxel();
 					continue;
 				}
-				const glm::vec4& color = core::Color::fromRGBA(r, g, b, 255);
-				const int index = core::Color::getClosestMatch(color, materialColors);
-				const voxel::Voxel& voxel = voxel::createVoxel(voxel::VoxelType::Generic, index);
-				// we have to flip depth with height for our own coordinate system
-				volume->setVoxel(w, h, d, voxel);
+				const uint8_t index = findClosestIndex(rgb[0], rgb[1], rgb[2]);
+				row[w] = voxel::createVoxel(voxel::VoxelType::Generic, index);
 			}
+			// we have to flip depth with height for our own coordinate system
+			volume->setVoxels(0, h, d, row.data(), width);
 		}
 	}
 
@@ -112,8 +112,7 @@ bool KV6Format::loadGroups(const io::FilePtr& file, VoxelVolumes& volumes) {
 		wrap(stream.readByte(palg))
 		wrap(stream.readByte(palr))
 		wrap(stream.readByte(pala))
-		const glm::vec4& color = core::Color::fromRGBA(palr, palg, palb, pala);
-		voxdata[c].col = findClosestIndex(color);
+		voxdata[c].col = findClosestIndex(palr, palg, palb, pala);
 		uint16_t zpos;
 		wrap(stream.readShort(zpos))
 		voxdata[c].z = zpos;
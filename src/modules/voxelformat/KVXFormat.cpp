@@ -146,8 +146,15 @@ bool KVXFormat::loadGroups(const io::FilePtr& file, VoxelVolumes& volumes) {
 		uint8_t slabbackfacecullinfo;
 	};
 
+	// the voxels for the palette indices of the file
+	voxel::Voxel voxels[256];
+	for (int i = 0; i < lengthof(voxels); ++i) {
+		voxels[i] = voxel::createVoxel(voxel::VoxelType::Generic, convertPaletteIndex(i));
+	}
+
 	uint32_t lastZ = 0;
 	voxel::Voxel lastCol;
+	uint8_t cols[256];
 
 	for (uint32_t x = 0; x < xsiz; ++x) {
 		for (uint32_t y = 0; y < ysiz; ++y) {
@@ -160,10 +167,9 @@ bool KVXFormat::loadGroups(const io::FilePtr& file, VoxelVolumes& volumes) {
 				wrap(stream.readByte(header.slabztop))
 				wrap(stream.readByte(header.slabzleng))
 				wrap(stream.readByte(header.slabbackfacecullinfo))
+				wrap(stream.read(cols, header.slabzleng))
 				for (uint8_t i = 0u; i < header.slabzleng; ++i) {
-					uint8_t col;
-					wrap(stream.readByte(col))
-					lastCol = voxel::createVoxel(voxel::VoxelType::Generic, convertPaletteIndex(col));
+					lastCol = voxels[cols[i]];
 					volume->setVoxel(x, (zsiz - 1) - (header.slabztop + i), y, lastCol);
 				}
 
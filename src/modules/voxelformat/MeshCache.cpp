@@ -27,13 +27,13 @@ voxel::Mesh& MeshCache::cacheEntry(const char *fullPath) {
 		Log::debug("New mesh cache entry for path %s", fullPath);
 		return *mesh;
 	}
-	return *i->second;
+	return *i->value;
 }
 
 bool MeshCache::removeMesh(const char *fullPath) {
 	auto i = _meshes.find(fullPath);
 	if (i != _meshes.end()) {
-		delete i->second;
+		delete i->value;
 		_meshes.erase(i);
 		return true;
 	}
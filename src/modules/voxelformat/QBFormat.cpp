@@ -8,6 +8,8 @@
 #include "core/Color.h"
 #include "core/Assert.h"
 #include "core/Log.h"
+#include "core/Common.h"
+#include <vector>
 
 namespace voxel {
 
@@ -160,21 +162,17 @@ bool QBFormat::saveGroups(const VoxelVolumes& volumes, const io::FilePtr& file)
 	return true;
 }
 
-bool QBFormat::setVoxel(voxel::RawVolume* volume, uint32_t x, uint32_t y, uint32_t z, const glm::ivec3& offset, const voxel::Voxel& voxel) {
-	const int32_t fx = offset.x + x;
-	const int32_t fy = offset.y + y;
-	const int32_t fz = offset.z + z;
-	Log::trace("Set voxel %i to %i:%i:%i (z-axis: %i)", (int)voxel.getMaterial(), fx, fy, fz, (int)_zAxisOrientation);
-	const voxel::Region& region = volume->region();
-	if (!region.containsPoint(glm::ivec3(fx, fy, fz))) {
-		const glm::ivec3& mins = region.getLowerCorner();
-		const glm::ivec3& maxs = region.getUpperCorner();
-		Log::error("Could not set voxel at %i:%i:%i - outside the region [%i:%i:%i][%i:%i:%i]",
-				fx, fy, fz, mins.x, mins.y, mins.z, maxs.x, maxs.y, maxs.z);
-		return false;
+voxel::Voxel QBFormat::getVoxel(uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha) {
+	if (alpha == 0) {
+		return voxel::Voxel();
 	}
-	volume->setVoxel(fx, fy, fz, voxel);
-	return true;
+	uint8_t index;
+	if (_colorFormat == ColorFormat::RGBA) {
+		index = findClosestIndex(red, green, blue, alpha);
+	} else {
+		index = findClosestIndex(blue, green, red, alpha);
+	}
+	return voxel::createVoxel(voxel::VoxelType::Generic, index);
 }
 
 voxel::Voxel QBFormat::getVoxel(io::FileStream& stream) {
@@ -187,25 +185,7 @@ voxel::Voxel QBFormat::getVoxel(io::FileStream& stream) {
 	wrapColor(stream.readByte(blue))
 	wrapColor(stream.readByte(alpha))
 	Log::trace("Red: %i, Green: %i, Blue: %i, Alpha: %i", (int)red, (int)green, (int)blue, (int)alpha);
-	if (alpha == 0) {
-		return voxel::Voxel();
-	}
-	glm::vec4 color(0.0f);
-	if (_colorFormat == ColorFormat::RGBA) {
-		color.r = red / 255.0f;
-		color.b = blue / 255.0f;
-	} else {
-		color.r = blue / 255.0f;
-		color.b = red / 255.0f;
-	}
-	color.g = green / 255.0f;
-	color.a = alpha / 255.0f;
-	const uint8_t index = findClosestIndex(color);
-	voxel::VoxelType voxelType = voxel::VoxelType::Generic;
-	if (index == 0 && alpha == 0u) {
-		voxelType = voxel::VoxelType::Air;
-	}
-	return voxel::createVoxel(voxelType, index);
+	return getVoxel(red, green, blue, alpha);
 }
 
 bool QBFormat::loadMatrix(io::FileStream& stream, VoxelVolumes& volumes) {
@@ -258,14 +238,17 @@ bool QBFormat::loadMatrix(io::FileStream& stream, VoxelVolumes& volumes) {
 	volumes.push_back(VoxelVolume(v, name, true));
 	if (_compressed == Compression::None) {
 		Log::debug("qb matrix uncompressed");
+		// decode whole rows along the x axis - they are contiguous in the file and in the volume
+		std::vector<uint8_t> rgbaRow(size.x * 4);
+		std::vector<voxel::Voxel> row(size.x);
 		for (uint32_t z = 0; z < size.z; ++z) {
 			for (uint32_t y = 0; y < size.y; ++y) {
-				for (uint32_t x = 0; x < size.x; ++x) {
-					const voxel::Voxel& voxel = getVoxel(stream);
-					if (!setVoxel(v, x, y, z, offset, voxel)) {
-						return false;
-					}
+				wrap(stream.read(rgbaRow.data(), rgbaRow.size()))
+				const uint8_t *rgba = rgbaRow.data();
+				for (uint32_t x = 0; x < size.x; ++x, rgba += 4) {
+					row[x] = getVoxel(rgba[0], rgba[1], rgba[2], rgba[3]);
 				}
+				v->setVoxels(offset.x, offset.y + y, offset.z + z, row.data(), size.x);
 			}
 		}
 		return true;
@@ -275,7 +258,7 @@ bool QBFormat::loadMatrix(io::FileStream& stream, VoxelVolumes& volumes) {
 
 	uint32_t z = 0u;
 	while (z < size.z) {
-		int index = 0;
+		uint32_t index = 0;
 		for (;;) {
 			uint32_t data;
 			wrap(stream.peekInt(data))
@@ -296,14 +279,20 @@ bool QBFormat::loadMatrix(io::FileStream& stream, VoxelVolumes& volumes) {
 				return false;
 			}
 			const voxel::Voxel& voxel = getVoxel(stream);
-			for (uint32_t j = 0; j < count; ++j) {
-				const int x = (index + j) % size.x;
-				const int y = (index + j) / size.x;
-				if (!setVoxel(v, x, y, z, offset, voxel)) {
+			// a run might span several rows of the slice
+			while (count > 0u) {
+				const uint32_t x = index % size.x;
+				const uint32_t y = index / size.x;
+				if (y >= size.y) {
+					Log::error("Could not set voxel at %u:%u:%u - outside the matrix of size %u:%u:%u",
+							x, y, z, size.x, size.y, size.z);
 					return false;
 				}
+				const uint32_t n = core_min(count, size.x - x);
+				v->fillVoxels(offset.x + x, offset.y + y, offset.z + z, voxel, n);
+				index += n;
+				count -= n;
 			}
-			index += count;
 		}
 		++z;
 	}
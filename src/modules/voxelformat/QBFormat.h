@@ -52,7 +52,7 @@ private:
 		Back
 	};
 
-	bool setVoxel(voxel::RawVolume* volume, uint32_t x, uint32_t y, uint32_t z, const glm::ivec3& offset, const voxel::Voxel& voxel);
+	voxel::Voxel getVoxel(uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha);
 	voxel::Voxel getVoxel(io::FileStream& stream);
 	bool loadMatrix(io::FileStream& stream, VoxelVolumes& volumes);
 	bool loadFromStream(io::FileStream& stream, VoxelVolumes& volumes);
@@ -12,6 +12,7 @@
 #include "voxel/MaterialColor.h"
 #include "core/Log.h"
 #include <glm/common.hpp>
+#include <vector>
 
 namespace voxel {
 
@@ -353,28 +354,24 @@ bool QBTFormat::loadMatrix(io::FileStream& stream, VoxelVolumes& volumes) {
 		return false;
 	}
 	voxel::RawVolume* volume = new voxel::RawVolume(region);
-	uint32_t byteCounter = 0u;
-	for (uint32_t x = 0; x < size.x; x++) {
-		for (uint32_t z = 0; z < size.z; z++) {
-			for (uint32_t y = 0; y < size.y; y++) {
-				const uint32_t red   = ((uint32_t)voxelDataDecompressed[byteCounter++]) << 0;
-				const uint32_t green = ((uint32_t)voxelDataDecompressed[byteCounter++]) << 8;
-				const uint32_t blue  = ((uint32_t)voxelDataDecompressed[byteCounter++]) << 16;
-				const uint32_t alpha = ((uint32_t)255) << 24;
-				const uint8_t mask   = voxelDataDecompressed[byteCounter++];
+	// the data is stored column by column along the y axis - gather the rows along the x axis to write them at once
+	const uint32_t xStride = size.z * size.y * 4u;
+	std::vector<voxel::Voxel> row(size.x);
+	for (uint32_t z = 0; z < size.z; z++) {
+		for (uint32_t y = 0; y < size.y; y++) {
+			const uint8_t *rgbm = voxelDataDecompressed + (z * size.y + y) * 4u;
+			for (uint32_t x = 0; x < size.x; x++, rgbm += xStride) {
+				const uint8_t mask = rgbm[3];
 				if (mask == 0u) {
-					continue;
-				}
-				if (_paletteSize > 0) {
-					const voxel::Voxel& voxel = voxel::createVoxel(voxel::VoxelType::Generic, red);
-					volume->setVoxel(position.x + x, position.y + y, position.z + z, voxel);
+					row[x] = voxel::Voxel();
+				} else if (_paletteSize > 0) {
+					row[x] = voxel::createVoxel(voxel::VoxelType::Generic, rgbm[0]);
 				} else {
-					const glm::vec4& color = core::Color::fromRGBA(red | green | blue | alpha);
-					const uint8_t index = findClosestIndex(color);
-					const voxel::Voxel& voxel = voxel::createVoxel(voxel::VoxelType::Generic, index);
-					volume->setVoxel(position.x + x, position.y + y, position.z + z, voxel);
+					const uint8_t index = findClosestIndex(rgbm[0], rgbm[1], rgbm[2]);
+					row[x] = voxel::createVoxel(voxel::VoxelType::Generic, index);
 				}
 			}
+			volume->setVoxels(position.x, position.y + y, position.z + z, row.data(), size.x);
 		}
 	}
 	delete [] voxelDataDecompressed;
@@ -221,7 +221,8 @@ bool VXMFormat::loadGroups(const io::FilePtr& file, VoxelVolumes& volumes) {
 	wrap(stream.readByte(materialAmount));
 	Log::debug("Palette of size %i", (int)materialAmount);
 
-	uint8_t *palette = new uint8_t[materialAmount];
+	// the voxels for the material indices of the file
+	Voxel palette[256];
 	for (int i = 0; i < (int) materialAmount; ++i) {
 		uint8_t blue;
 		wrap(stream.readByte(blue));
@@ -234,7 +235,8 @@ bool VXMFormat::loadGroups(const io::FilePtr& file, VoxelVolumes& volumes) {
 		uint8_t emissive;
 		wrap(stream.readByte(emissive));
 		const glm::vec4& rgbaColor = core::Color::fromRGBA(red, green, blue, alpha);
-		palette[i] = findClosestIndex(rgbaColor);
+		const uint8_t index = findClosestIndex(rgbaColor);
+		palette[i] = createColorVoxel(index == 0 ? voxel::VoxelType::Air : voxel::VoxelType::Generic, index);
 	}
 
 	const Region region(glm::ivec3(0), glm::ivec3(size) - 1);
@@ -263,18 +265,17 @@ bool VXMFormat::loadGroups(const io::FilePtr& file, VoxelVolumes& volumes) {
 			idx += length;
 			continue;
 		}
+		const Voxel voxel = palette[matIdx];
+		if (isAir(voxel.getMaterial())) {
+			idx += length;
+			continue;
+		}
 
 		// left to right, bottom to top, front to back
 		for (int i = idx; i < idx + length; i++) {
 			const int xx = i / (size.y * size.z);
 			const int yy = (i / size.z) % size.y;
 			const int zz = i % size.z;
-			const uint8_t index = palette[matIdx];
-			voxel::VoxelType voxelType = voxel::VoxelType::Generic;
-			if (index == 0) {
-				voxelType = voxel::VoxelType::Air;
-			}
-			const Voxel voxel = createColorVoxel(voxelType, index);
 			volume->setVoxel(size.x - 1 - xx, yy, zz, voxel);
 		}
 		idx += length;
@@ -297,7 +298,6 @@ bool VXMFormat::loadGroups(const io::FilePtr& file, VoxelVolumes& volumes) {
 		}
 	}
 
-	delete[] palette;
 	volumes.push_back(VoxelVolume(volume, "", true, ipivot));
 	return true;
 }
@@ -22,7 +22,7 @@ voxel::RawVolume* VolumeCache::loadVolume(const char* fullPath) {
 		core::ScopedLock lock(_mutex);
 		auto i = _volumes.find(filename);
 		if (i != _volumes.end()) {
-			return i->second;
+			return i->value;
 		}
 	}
 	Log::info("Loading volume from %s", fullPath);
@@ -43,6 +43,17 @@ uint8_t VoxFileFormat::findClosestIndex(const glm::vec4& color) const {
 	return core::Color::getClosestMatch(color, materialColors);
 }
 
+uint8_t VoxFileFormat::findClosestIndex(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+	const uint32_t rgba = ((uint32_t)r << 24) | ((uint32_t)g << 16) | ((uint32_t)b << 8) | (uint32_t)a;
+	uint8_t index;
+	if (_closestIndexCache.get(rgba, index)) {
+		return index;
+	}
+	index = findClosestIndex(glm::vec4(r, g, b, a) / 255.0f);
+	_closestIndexCache.put(rgba, index);
+	return index;
+}
+
 RawVolume* VoxFileFormat::merge(const VoxelVolumes& volumes) const {
 	return volumes.merge();
 }
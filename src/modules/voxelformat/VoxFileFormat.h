@@ -5,6 +5,7 @@
 #pragma once
 
 #include "core/collection/Array.h"
+#include "core/collection/HashMap.h"
 #include "voxel/RawVolume.h"
 #include "io/File.h"
 #include "VoxelVolumes.h"
@@ -18,10 +19,19 @@ class VoxFileFormat {
 protected:
 	core::Array<uint8_t, 256> _palette;
 	size_t _paletteSize = 0;
+	// rgba to palette index
+	core::HashMap<uint32_t, uint8_t> _closestIndexCache;
 
 	const glm::vec4& getColor(const Voxel& voxel) const;
 	glm::vec4 findClosestMatch(const glm::vec4& color) const;
 	uint8_t findClosestIndex(const glm::vec4& color) const;
+	/**
+	 * @brief Cached version of the closest match for the given color components.
+	 *
+	 * The loaders have to map the color of every voxel to our palette - but the files only use a few distinct
+	 * colors, so the search over the whole palette is only done once per color.
+	 */
+	uint8_t findClosestIndex(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255u);
 	/**
 	 * @brief Maps a custum palette index to our own 256 color palette by a closest match
 	 */
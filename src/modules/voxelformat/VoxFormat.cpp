@@ -15,6 +15,7 @@
 #include "voxelutil/VolumeVisitor.h"
 #include <SDL_assert.h>
 #include <glm/gtc/matrix_access.hpp>
+#include <vector>
 
 namespace voxel {
 
@@ -225,8 +226,8 @@ bool VoxFormat::saveAttributes(const Attributes& attributes, io::FileStream& str
 	Log::debug("Save %i attributes", (int)attributes.size());
 	wrapBool(stream.addInt((uint32_t)attributes.size()))
 	for (const auto& e : attributes) {
-		const core::String& key = e->first;
-		const core::String& value = e->second;
+		const core::String& key = e->key;
+		const core::String& value = e->value;
 		Log::debug("Save attribute %s: %s", key.c_str(), value.c_str());
 		wrapBool(stream.addInt(core::utf8::length(key.c_str())))
 		wrapBool(stream.addString(key, false))
@@ -552,17 +553,25 @@ bool VoxFormat::loadChunk_XYZI(io::FileStream& stream, const ChunkHeader& header
 		translatedRegion = Region(rmins, rmaxs);
 		Log::warn("Invalid XYZI chunk region after transform was applied - trying without transformation");
 	}
+	// x, y, z and the color index for each voxel
+	if ((int64_t)numVoxels * 4 > stream.remaining()) {
+		Log::error("Could not load vox file: Not enough data for %u voxels", numVoxels);
+		return false;
+	}
+	std::vector<uint8_t> xyzi(numVoxels * 4);
+	wrap(stream.read(xyzi.data(), xyzi.size()))
 	RawVolume *volume = new RawVolume(translatedRegion);
 	int volumeVoxelSet = 0;
+	// the voxels for the palette indices of the file
+	voxel::Voxel voxels[256];
+	for (int i = 0; i < lengthof(voxels); ++i) {
+		voxels[i] = voxel::createVoxel(voxel::VoxelType::Generic, convertPaletteIndex(i));
+	}
 	for (uint32_t i = 0; i < numVoxels; ++i) {
-		uint8_t x, y, z, colorIndex;
-		wrap(stream.readByte(x))
-		wrap(stream.readByte(y))
-		wrap(stream.readByte(z))
-		wrap(stream.readByte(colorIndex))
-		const uint8_t index = convertPaletteIndex(colorIndex);
-		voxel::VoxelType voxelType = voxel::VoxelType::Generic;
-		const voxel::Voxel& voxel = voxel::createVoxel(voxelType, index);
+		const uint8_t x = xyzi[i * 4 + 0];
+		const uint8_t y = xyzi[i * 4 + 1];
+		const uint8_t z = xyzi[i * 4 + 2];
+		const voxel::Voxel& voxel = voxels[xyzi[i * 4 + 3]];
 		// we have to flip the axis here
 		if (applyTransformation) {
 			const glm::ivec3 pos = calcTransform(finalTransform, x, y, z, pivot);
@@ -706,7 +715,7 @@ bool VoxFormat::parseSceneGraphTranslation(VoxTransform& transform, const Attrib
 	if (trans == attributes.end()) {
 		return true;
 	}
-	const core::String& translations = trans->second;
+	const core::String& translations = trans->value;
 	glm::ivec3& v = transform.translation;
 	if (SDL_sscanf(translations.c_str(), "%d %d %d", &v.x, &v.y, &v.z) != 3) {
 		Log::error("Failed to parse translation");
@@ -740,7 +749,7 @@ bool VoxFormat::parseSceneGraphRotation(VoxTransform &transform, const Attribute
 		return true;
 	}
 
-	const uint8_t packed = core::string::toInt(rot->second);
+	const uint8_t packed = core::string::toInt(rot->value);
 	const RotationMatrixPacked *packedRot = (const RotationMatrixPacked *)&packed;
 	const uint8_t nonZeroEntryInThirdRow = 3u - (packedRot->nonZeroEntryInFirstRow + packedRot->nonZeroEntryInSecondRow);
 
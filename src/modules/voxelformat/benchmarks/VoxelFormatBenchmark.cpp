@@ -0,0 +1,161 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "app/App.h"
+#include "io/File.h"
+#include "io/Filesystem.h"
+#include "voxel/MaterialColor.h"
+#include "voxel/RawVolume.h"
+#include "voxelformat/CubFormat.h"
+#include "voxelformat/OBJFormat.h"
+#include "voxelformat/QBFormat.h"
+#include "voxelformat/QBTFormat.h"
+#include "voxelformat/VoxFormat.h"
+#include <memory>
+
+/**
+ * @brief Saves and loads a volume of the given edge length with the file formats
+ *
+ * The volume is a terrain with a different color for every voxel in a row - so there is
+ * nothing for the run length encodings to compress - or with one color per layer if the
+ * second argument is @c 1. 256 is the max size of a magicavoxel model.
+ *
+ * The @c MVoxels counter is the amount of voxels of the volume that are processed per second.
+ */
+class VoxelFormatBenchmark : public app::AbstractBenchmark {
+public:
+	std::unique_ptr<voxel::RawVolume> _volume;
+
+	bool onInitApp() override {
+		return voxel::initDefaultMaterialColors();
+	}
+
+	void onCleanupApp() override {
+		_volume.reset();
+	}
+
+	int _layered = -1;
+
+	void createVolume(int size, bool layered) {
+		if (_volume && _volume->region().getWidthInVoxels() == size && _layered == (int)layered) {
+			return;
+		}
+		_layered = (int)layered;
+		_volume = std::make_unique<voxel::RawVolume>(voxel::Region(0, size - 1));
+		for (int z = 0; z < size; ++z) {
+			for (int x = 0; x < size; ++x) {
+				const int height = size / 2 + (x * 7 + z * 3) % (size / 4);
+				for (int y = 0; y < height; ++y) {
+					const uint8_t color = (uint8_t)(1 + (layered ? y : x + y + z) % 254);
+					_volume->setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, color));
+				}
+			}
+		}
+	}
+
+	void setCounters(benchmark::State &state, int64_t bytes) {
+		const int size = (int)state.range(0);
+		const double voxels = (double)size * size * size * state.iterations();
+		state.counters["MVoxels"] = benchmark::Counter(voxels / 1000000.0, benchmark::Counter::kIsRate);
+		state.SetBytesProcessed(bytes);
+	}
+
+	static core::String path(const char *extension) {
+		return io::filesystem()->homePath() + "voxelformatbenchmark." + extension;
+	}
+
+	template<class FORMAT>
+	void save(benchmark::State &state, const char *extension) {
+		createVolume((int)state.range(0), state.range(1) != 0);
+		FORMAT format;
+		int64_t bytes = 0;
+		for (auto _ : state) {
+			const io::FilePtr& file = io::filesystem()->open(path(extension), io::FileMode::SysWrite);
+			if (!format.save(_volume.get(), file)) {
+				state.SkipWithError("Failed to save");
+				break;
+			}
+			bytes += file->length();
+		}
+		setCounters(state, bytes);
+	}
+
+	template<class FORMAT>
+	void load(benchmark::State &state, const char *extension) {
+		createVolume((int)state.range(0), state.range(1) != 0);
+		FORMAT format;
+		if (!format.save(_volume.get(), io::filesystem()->open(path(extension), io::FileMode::SysWrite))) {
+			state.SkipWithError("Failed to save");
+			return;
+		}
+		int64_t bytes = 0;
+		for (auto _ : state) {
+			const io::FilePtr& file = io::filesystem()->open(path(extension), io::FileMode::SysRead);
+			std::unique_ptr<voxel::RawVolume> v(format.load(file));
+			if (!v) {
+				state.SkipWithError("Failed to load");
+				break;
+			}
+			bytes += file->length();
+		}
+		setCounters(state, bytes);
+	}
+};
+
+BENCHMARK_DEFINE_F(VoxelFormatBenchmark, SaveVox)(benchmark::State &state) {
+	save<voxel::VoxFormat>(state, "vox");
+}
+
+BENCHMARK_DEFINE_F(VoxelFormatBenchmark, LoadVox)(benchmark::State &state) {
+	load<voxel::VoxFormat>(state, "vox");
+}
+
+BENCHMARK_DEFINE_F(VoxelFormatBenchmark, SaveQB)(benchmark::State &state) {
+	save<voxel::QBFormat>(state, "qb");
+}
+
+BENCHMARK_DEFINE_F(VoxelFormatBenchmark, LoadQB)(benchmark::State &state) {
+	load<voxel::QBFormat>(state, "qb");
+}
+
+BENCHMARK_DEFINE_F(VoxelFormatBenchmark, SaveQBT)(benchmark::State &state) {
+	save<voxel::QBTFormat>(state, "qbt");
+}
+
+BENCHMARK_DEFINE_F(VoxelFormatBenchmark, LoadQBT)(benchmark::State &state) {
+	load<voxel::QBTFormat>(state, "qbt");
+}
+
+BENCHMARK_DEFINE_F(VoxelFormatBenchmark, SaveCub)(benchmark::State &state) {
+	save<voxel::CubFormat>(state, "cub");
+}
+
+BENCHMARK_DEFINE_F(VoxelFormatBenchmark, LoadCub)(benchmark::State &state) {
+	load<voxel::CubFormat>(state, "cub");
+}
+
+BENCHMARK_DEFINE_F(VoxelFormatBenchmark, SaveOBJ)(benchmark::State &state) {
+	save<voxel::OBJFormat>(state, "obj");
+}
+
+static void volumeArguments(benchmark::internal::Benchmark* b) {
+	for (int size : {64, 256}) {
+		for (int layered : {0, 1}) {
+			b->Args({size, layered});
+		}
+	}
+}
+
+BENCHMARK_REGISTER_F(VoxelFormatBenchmark, SaveVox)->Apply(volumeArguments)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VoxelFormatBenchmark, LoadVox)->Apply(volumeArguments)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VoxelFormatBenchmark, SaveQB)->Apply(volumeArguments)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VoxelFormatBenchmark, LoadQB)->Apply(volumeArguments)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VoxelFormatBenchmark, SaveQBT)->Apply(volumeArguments)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VoxelFormatBenchmark, LoadQBT)->Apply(volumeArguments)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VoxelFormatBenchmark, SaveCub)->Apply(volumeArguments)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VoxelFormatBenchmark, LoadCub)->Apply(volumeArguments)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VoxelFormatBenchmark, SaveOBJ)->Args({64, 0})->Args({128, 0})->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
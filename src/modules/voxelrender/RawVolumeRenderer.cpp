@@ -84,6 +84,9 @@ bool RawVolumeRenderer::init() {
 			Log::error("Could not create the vertex buffer object for the indices");
 			return false;
 		}
+		// the mesh tiles are updated in place
+		_vertexBuffer[idx].setMode(_vertexBufferIndex[idx], video::BufferMode::Dynamic);
+		_vertexBuffer[idx].setMode(_indexBufferIndex[idx], video::BufferMode::Dynamic);
 	}
 
 	const int shaderMaterialColorsArraySize = lengthof(shader::VoxelData::MaterialblockData::materialcolor);
@@ -106,9 +109,10 @@ bool RawVolumeRenderer::init() {
 		_vertexBuffer[idx].addAttribute(attributeInfo);
 	}
 
-	if (!_indirectDrawBuffer.init()) {
-		Log::error("Failed to initialize the indirect draw buffer");
-		return false;
+	_multiDrawIndirect = video::hasFeature(video::Feature::MultiDrawIndirect);
+	if (_multiDrawIndirect && !_indirectDrawBuffer.init()) {
+		Log::warn("Failed to initialize the indirect draw buffer - draw the mesh tiles one by one");
+		_multiDrawIndirect = false;
 	}
 
 	render::ShadowParameters shadowParams;
@@ -136,7 +140,7 @@ void RawVolumeRenderer::update() {
 			delete meshes[result.idx];
 		}
 		meshes[result.idx] = new voxel::Mesh(core::move(result.mesh));
-		if (!update(result.idx)) {
+		if (!updateTile(result.idx, result.mins)) {
 			Log::error("Failed to update the mesh at index %i", result.idx);
 		}
 		++cnt;
@@ -146,12 +150,100 @@ void RawVolumeRenderer::update() {
 	}
 }
 
+bool RawVolumeRenderer::uploadTile(int idx, TileBuffer& tile, const voxel::VertexArray& vertices, const voxel::IndexArray& indices) {
+	LayerBuffer& layer = _layers[idx];
+	tile.vertices = layer.vertices.alloc((uint32_t)vertices.size());
+	tile.indices = layer.indices.alloc((uint32_t)indices.size());
+	if (!tile.vertices.valid() || !tile.indices.valid()) {
+		releaseTile(idx, tile);
+		return false;
+	}
+	// the indices stay relative to the tile - the base vertex of the draw command points to the tile vertices
+	const size_t vertexOffset = tile.vertices.offset * sizeof(voxel::VoxelVertex);
+	if (!_vertexBuffer[idx].update(_vertexBufferIndex[idx], vertexOffset, &vertices.front(), vertices.size() * sizeof(voxel::VoxelVertex))) {
+		Log::error("Failed to update the vertex buffer");
+		return false;
+	}
+	const size_t indexOffset = tile.indices.offset * sizeof(voxel::IndexType);
+	if (!_vertexBuffer[idx].update(_indexBufferIndex[idx], indexOffset, &indices.front(), indices.size() * sizeof(voxel::IndexType))) {
+		Log::error("Failed to update the index buffer");
+		return false;
+	}
+	_drawCommandsDirty = true;
+	return true;
+}
+
+void RawVolumeRenderer::releaseTile(int idx, TileBuffer& tile) {
+	LayerBuffer& layer = _layers[idx];
+	if (tile.vertices.valid() || tile.indices.valid()) {
+		_drawCommandsDirty = true;
+	}
+	layer.vertices.free(tile.vertices);
+	layer.indices.free(tile.indices);
+}
+
+void RawVolumeRenderer::releaseStaleTiles(int idx) {
+	LayerBuffer& layer = _layers[idx];
+	if (!layer.stale) {
+		return;
+	}
+	layer.stale = false;
+	for (auto i = layer.tiles.begin(); i != layer.tiles.end();) {
+		auto meshIter = _meshes.find(i->first);
+		if (meshIter != _meshes.end() && meshIter->second[idx] != nullptr) {
+			++i;
+			continue;
+		}
+		releaseTile(idx, i->second);
+		i = layer.tiles.erase(i);
+	}
+}
+
+bool RawVolumeRenderer::updateTile(int idx, const glm::ivec3& mins) {
+	if (idx < 0 || idx >= MAX_VOLUMES) {
+		return false;
+	}
+	core_trace_scoped(RawVolumeRendererUpdateTile);
+	LayerBuffer& layer = _layers[idx];
+	releaseStaleTiles(idx);
+	// the manually uploaded data is replaced by the extracted meshes
+	releaseTile(idx, layer.manual);
+
+	auto tileIter = layer.tiles.find(mins);
+	if (tileIter != layer.tiles.end()) {
+		releaseTile(idx, tileIter->second);
+		layer.tiles.erase(tileIter);
+	}
+
+	auto meshIter = _meshes.find(mins);
+	if (meshIter == _meshes.end()) {
+		return true;
+	}
+	const voxel::Mesh* mesh = meshIter->second[idx];
+	if (mesh == nullptr || mesh->getNoOfIndices() <= 0) {
+		return true;
+	}
+	TileBuffer tile;
+	if (uploadTile(idx, tile, mesh->getVertexVector(), mesh->getIndexVector())) {
+		layer.tiles.emplace(mins, tile);
+		return true;
+	}
+	// the layer buffers are exhausted or too fragmented - grow and compact them
+	return update(idx);
+}
+
 bool RawVolumeRenderer::update(int idx) {
 	if (idx < 0 || idx >= MAX_VOLUMES) {
 		return false;
 	}
 	core_trace_scoped(RawVolumeRendererUpdate);
 
+	LayerBuffer& layer = _layers[idx];
+	layer.tiles.clear();
+	layer.manual = TileBuffer();
+	layer.stale = false;
+	_drawCommandsDirty = true;
+
 	size_t vertCount = 0u;
 	size_t indCount = 0u;
 	for (auto& i : _meshes) {
@@ -160,60 +252,44 @@ bool RawVolumeRenderer::update(int idx) {
 		if (mesh == nullptr || mesh->getNoOfIndices() <= 0) {
 			continue;
 		}
-		const voxel::VertexArray& vertexVector = mesh->getVertexVector();
-		const voxel::IndexArray& indexVector = mesh->getIndexVector();
-		vertCount += vertexVector.size();
-		indCount += indexVector.size();
+		vertCount += mesh->getVertexVector().size();
+		indCount += mesh->getIndexVector().size();
 	}
 
 	if (indCount == 0u || vertCount == 0u) {
-		_vertexBuffer[idx].update(_vertexBufferIndex[idx], nullptr, 0);
-		_vertexBuffer[idx].update(_indexBufferIndex[idx], nullptr, 0);
+		layer.vertices.reset(0u);
+		layer.indices.reset(0u);
+		_vertexBuffer[idx].reserve(_vertexBufferIndex[idx], 0u);
+		_vertexBuffer[idx].reserve(_indexBufferIndex[idx], 0u);
 		return true;
 	}
 
-	const size_t verticesBufSize = vertCount * sizeof(voxel::VoxelVertex);
-	voxel::VoxelVertex* verticesBuf = (voxel::VoxelVertex*)core_malloc(verticesBufSize);
-	const size_t indicesBufSize = indCount * sizeof(voxel::IndexType);
-	voxel::IndexType* indicesBuf = (voxel::IndexType*)core_malloc(indicesBufSize);
-
-	voxel::VoxelVertex* verticesPos = verticesBuf;
-	voxel::IndexType* indicesPos = indicesBuf;
+	// leave some room to let the tiles grow without uploading the whole layer again
+	const uint32_t vertexCapacity = core_max((uint32_t)(vertCount + vertCount / 2u), layer.vertices.capacity());
+	const uint32_t indexCapacity = core_max((uint32_t)(indCount + indCount / 2u), layer.indices.capacity());
+	layer.vertices.reset(vertexCapacity);
+	layer.indices.reset(indexCapacity);
+	if (!_vertexBuffer[idx].reserve(_vertexBufferIndex[idx], vertexCapacity * sizeof(voxel::VoxelVertex))) {
+		Log::error("Failed to reserve the vertex buffer");
+		return false;
+	}
+	if (!_vertexBuffer[idx].reserve(_indexBufferIndex[idx], indexCapacity * sizeof(voxel::IndexType))) {
+		Log::error("Failed to reserve the index buffer");
+		return false;
+	}
 
-	voxel::IndexType offset = (voxel::IndexType)0;
 	for (auto& i : _meshes) {
 		const Meshes& meshes = i.second;
 		const voxel::Mesh* mesh = meshes[idx];
 		if (mesh == nullptr || mesh->getNoOfIndices() <= 0) {
 			continue;
 		}
-		const voxel::VertexArray& vertexVector = mesh->getVertexVector();
-		const voxel::IndexArray& indexVector = mesh->getIndexVector();
-		core_memcpy(verticesPos, &vertexVector[0], vertexVector.size() * sizeof(voxel::VoxelVertex));
-		core_memcpy(indicesPos, &indexVector[0], indexVector.size() * sizeof(voxel::IndexType));
-
-		for (size_t i = 0; i < indexVector.size(); ++i) {
-			*indicesPos++ += offset;
+		TileBuffer tile;
+		if (!uploadTile(idx, tile, mesh->getVertexVector(), mesh->getIndexVector())) {
+			return false;
 		}
-
-		verticesPos += vertexVector.size();
-		offset += vertexVector.size();
-	}
-
-	if (!_vertexBuffer[idx].update(_vertexBufferIndex[idx], verticesBuf, verticesBufSize)) {
-		Log::error("Failed to update the vertex buffer");
-		core_free(indicesBuf);
-		core_free(verticesBuf);
-		return false;
+		layer.tiles.emplace(i.first, tile);
 	}
-	core_free(verticesBuf);
-
-	if (!_vertexBuffer[idx].update(_indexBufferIndex[idx], indicesBuf, indicesBufSize)) {
-		Log::error("Failed to update the index buffer");
-		core_free(indicesBuf);
-		return false;
-	}
-	core_free(indicesBuf);
 	return true;
 }
 
@@ -223,21 +299,80 @@ bool RawVolumeRenderer::update(int idx, const voxel::VertexArray& vertices, cons
 	}
 	core_trace_scoped(RawVolumeRendererUpdate);
 
+	LayerBuffer& layer = _layers[idx];
+	layer.tiles.clear();
+	layer.manual = TileBuffer();
+	layer.stale = false;
+	layer.vertices.reset((uint32_t)vertices.size());
+	layer.indices.reset((uint32_t)indices.size());
+	_drawCommandsDirty = true;
+
 	if (indices.empty() || vertices.empty()) {
-		_vertexBuffer[idx].update(_vertexBufferIndex[idx], nullptr, 0);
-		_vertexBuffer[idx].update(_indexBufferIndex[idx], nullptr, 0);
+		_vertexBuffer[idx].reserve(_vertexBufferIndex[idx], 0u);
+		_vertexBuffer[idx].reserve(_indexBufferIndex[idx], 0u);
 		return true;
 	}
 
-	if (!_vertexBuffer[idx].update(_vertexBufferIndex[idx], &vertices.front(), vertices.size() * sizeof(voxel::VertexArray::value_type))) {
-		Log::error("Failed to update the vertex buffer");
+	if (!_vertexBuffer[idx].reserve(_vertexBufferIndex[idx], vertices.size() * sizeof(voxel::VertexArray::value_type))) {
+		Log::error("Failed to reserve the vertex buffer");
 		return false;
 	}
-	if (!_vertexBuffer[idx].update(_indexBufferIndex[idx], &indices.front(), indices.size() * sizeof(voxel::IndexArray::value_type))) {
-		Log::error("Failed to update the index buffer");
+	if (!_vertexBuffer[idx].reserve(_indexBufferIndex[idx], indices.size() * sizeof(voxel::IndexArray::value_type))) {
+		Log::error("Failed to reserve the index buffer");
 		return false;
 	}
-	return true;
+	return uploadTile(idx, layer.manual, vertices, indices);
+}
+
+void RawVolumeRenderer::updateDrawCommands() {
+	if (!_drawCommandsDirty) {
+		return;
+	}
+	core_trace_scoped(RawVolumeRendererUpdateDrawCommands);
+	_drawCommandsDirty = false;
+	_drawCommands.clear();
+	auto addCommand = [this] (const TileBuffer& tile) {
+		if (!tile.indices.valid()) {
+			return;
+		}
+		video::DrawElementsIndirectCommand cmd;
+		cmd.count = tile.indices.size;
+		cmd.instanceCount = 1;
+		cmd.firstIndex = tile.indices.offset;
+		cmd.baseVertex = tile.vertices.offset;
+		cmd.baseInstance = 0;
+		_drawCommands.push_back(cmd);
+	};
+	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+		const LayerBuffer& layer = _layers[idx];
+		_drawCommandOffset[idx] = (int)_drawCommands.size();
+		addCommand(layer.manual);
+		for (const auto& i : layer.tiles) {
+			addCommand(i.second);
+		}
+		_drawCommandCount[idx] = (int)_drawCommands.size() - _drawCommandOffset[idx];
+	}
+	if (!_multiDrawIndirect || _drawCommands.empty()) {
+		return;
+	}
+	if (!_indirectDrawBuffer.update(_drawCommands.data(), _drawCommands.size() * sizeof(video::DrawElementsIndirectCommand))) {
+		Log::warn("Failed to update the indirect draw buffer - draw the mesh tiles one by one");
+		_multiDrawIndirect = false;
+	}
+}
+
+void RawVolumeRenderer::drawLayer(int idx) const {
+	static_assert(sizeof(voxel::IndexType) == sizeof(uint32_t), "Index type doesn't match");
+	if (_multiDrawIndirect) {
+		void* bufferOffset = (void*)(intptr_t)(_drawCommandOffset[idx] * sizeof(video::DrawElementsIndirectCommand));
+		video::drawMultiElementsIndirect<voxel::IndexType>(video::Primitive::Triangles, bufferOffset,
+				_drawCommandCount[idx], sizeof(video::DrawElementsIndirectCommand));
+		return;
+	}
+	for (int i = _drawCommandOffset[idx]; i < _drawCommandOffset[idx] + _drawCommandCount[idx]; ++i) {
+		const video::DrawElementsIndirectCommand& cmd = _drawCommands[i];
+		video::drawElementsBaseVertex<voxel::IndexType>(video::Primitive::Triangles, cmd.count, (int)cmd.firstIndex, (int)cmd.baseVertex);
+	}
 }
 
 void RawVolumeRenderer::setAmbientColor(const glm::vec3& color) {
@@ -340,6 +475,7 @@ bool RawVolumeRenderer::translate(int idx, const glm::ivec3& m) {
 		delete meshes[idx];
 		meshes[idx] = nullptr;
 	}
+	_layers[idx].stale = true;
 	return true;
 }
 
@@ -382,14 +518,23 @@ bool RawVolumeRenderer::extractRegion(int idx, const voxel::Region& region) {
 						delete meshes[idx];
 						meshes[idx] = nullptr;
 					}
+					auto tile = _layers[idx].tiles.find(mins);
+					if (tile != _layers[idx].tiles.end()) {
+						releaseTile(idx, tile->second);
+						_layers[idx].tiles.erase(tile);
+					}
 					continue;
 				}
 
-				voxel::RawVolume copy(volume);
-				_threadPool.enqueue([movedCopy = core::move(copy), mins, idx, finalRegion, this] () {
+				voxel::Region reg = finalRegion;
+				reg.shiftUpperCorner(1, 1, 1);
+				// the extractor also looks at the neighbours of the voxels to decide about the faces and the
+				// ambient occlusion - the task only needs a snapshot of the region plus this border
+				voxel::Region copyRegion = reg;
+				copyRegion.grow(1);
+				voxel::RawVolume copy(*volume, copyRegion);
+				_threadPool.enqueue([movedCopy = core::move(copy), mins, idx, reg, this] () {
 					++_runningExtractorTasks;
-					voxel::Region reg = finalRegion;
-					reg.shiftUpperCorner(1, 1, 1);
 					voxel::Mesh mesh(65536, 65536, true);
 					voxel::extractCubicMesh(&movedCopy, reg, &mesh, raw::CustomIsQuadNeeded(), reg.getLowerCorner());
 					_pendingQueue.emplace(mins, idx, core::move(mesh));
@@ -448,31 +593,27 @@ void RawVolumeRenderer::render(const video::Camera& camera, bool shadow) {
 		voxel::materialColorMarkClean();
 	}
 
-	core_memset(_drawCommands, 0, sizeof(_drawCommands));
+	updateDrawCommands();
 
-	uint32_t numIndices = 0u;
+	bool visible = false;
 	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
-		if (_hidden[idx]) {
+		if (_hidden[idx] || _drawCommandCount[idx] <= 0) {
 			continue;
 		}
-		const uint32_t nIndices = _vertexBuffer[idx].elements(_indexBufferIndex[idx], 1, sizeof(voxel::IndexType));
-		if (nIndices <= 0) {
-			continue;
-		}
-		numIndices += nIndices;
-		_drawCommands[idx].count = nIndices;
-		_drawCommands[idx].instanceCount = 1;
+		visible = true;
+		break;
 	}
-	if (numIndices == 0u) {
+	if (!visible) {
 		return;
 	}
-	core_assert_always(_indirectDrawBuffer.update(_drawCommands, sizeof(_drawCommands)));
 
 	video::ScopedState scopedDepth(video::State::DepthTest);
 	video::depthFunc(video::CompareFunc::LessEqual);
 	video::ScopedState scopedCullFace(video::State::CullFace);
 	video::ScopedState scopedDepthMask(video::State::DepthMask);
-	_indirectDrawBuffer.bind();
+	if (_multiDrawIndirect) {
+		_indirectDrawBuffer.bind();
+	}
 	if (_shadowMap->boolVal()) {
 		_shadow.update(camera, true);
 		if (shadow) {
@@ -480,14 +621,12 @@ void RawVolumeRenderer::render(const video::Camera& camera, bool shadow) {
 			_shadow.render([this] (int i, const glm::mat4& lightViewProjection) {
 				_shadowMapShader.setLightviewprojection(lightViewProjection);
 				for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
-					if (_drawCommands[idx].count <= 0u) {
+					if (_hidden[idx] || _drawCommandCount[idx] <= 0) {
 						continue;
 					}
 					video::ScopedBuffer scopedBuf(_vertexBuffer[idx]);
 					_shadowMapShader.setModel(_model[idx]);
-					static_assert(sizeof(voxel::IndexType) == sizeof(uint32_t), "Index type doesn't match");
-					void* bufferOffset = (void*)(intptr_t)(idx * sizeof(_drawCommands[0]));
-					video::drawElementsIndirect<voxel::IndexType>(video::Primitive::Triangles, bufferOffset);
+					drawLayer(idx);
 				}
 				return true;
 			}, true);
@@ -519,17 +658,18 @@ void RawVolumeRenderer::render(const video::Camera& camera, bool shadow) {
 	}
 
 	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
-		if (_drawCommands[idx].count <= 0u) {
+		if (_hidden[idx] || _drawCommandCount[idx] <= 0) {
 			continue;
 		}
 		const glm::vec2 offset(-0.25f * idx, -0.5f * idx);
 		video::ScopedPolygonMode polygonMode(camera.polygonMode(), offset);
 		video::ScopedBuffer scopedBuf(_vertexBuffer[idx]);
 		_voxelShader.setModel(_model[idx]);
-		void* bufferOffset = (void*)(intptr_t)(idx * sizeof(_drawCommands[0]));
-		video::drawElementsIndirect<voxel::IndexType>(video::Primitive::Triangles, bufferOffset);
+		drawLayer(idx);
+	}
+	if (_multiDrawIndirect) {
+		_indirectDrawBuffer.unbind();
 	}
-	_indirectDrawBuffer.unbind();
 }
 
 bool RawVolumeRenderer::setModelMatrix(int idx, const glm::mat4& model) {
@@ -574,6 +714,7 @@ voxel::RawVolume* RawVolumeRenderer::setVolume(int idx, voxel::RawVolume* volume
 			delete meshes[idx];
 			meshes[idx] = nullptr;
 		}
+		_layers[idx].stale = true;
 	}
 	return old;
 }
@@ -594,8 +735,13 @@ core::DynamicArray<voxel::RawVolume*> RawVolumeRenderer::shutdown() {
 		}
 	}
 	_meshes.clear();
+	_drawCommands.clear();
+	_drawCommandsDirty = true;
 	core::DynamicArray<voxel::RawVolume*> old(MAX_VOLUMES);
 	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+		_layers[idx] = LayerBuffer();
+		_drawCommandOffset[idx] = 0;
+		_drawCommandCount[idx] = 0;
 		_vertexBuffer[idx].shutdown();
 		_vertexBufferIndex[idx] = -1;
 		_indexBufferIndex[idx] = -1;
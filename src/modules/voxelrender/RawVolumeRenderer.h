@@ -17,12 +17,14 @@
 #include "render/Shadow.h"
 #include "video/UniformBuffer.h"
 #include "video/IndirectDrawBuffer.h"
+#include "video/BufferAllocator.h"
 #include "video/Texture.h"
 #include "core/GLM.h"
 #include "core/Var.h"
 #include "core/collection/Array.h"
 #include "frontend/Colors.h"
 #include <unordered_map>
+#include <vector>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/hash.hpp>
 
@@ -53,8 +55,37 @@ protected:
 	typedef std::unordered_map<glm::ivec3, Meshes> MeshesMap;
 	MeshesMap _meshes;
 
+	/**
+	 * @brief The sub ranges of the vertex and index buffer of a layer that are owned by one mesh tile
+	 */
+	struct TileBuffer {
+		video::BufferRange vertices;
+		video::BufferRange indices;
+	};
+	typedef std::unordered_map<glm::ivec3, TileBuffer> TileBuffers;
+	/**
+	 * @brief Each mesh tile of a layer owns a sub range of the layer buffers. A finished extraction
+	 * only uploads the data of the affected tile - all tiles of a layer are rendered with one
+	 * multi draw indirect call - or with one draw call per tile if that isn't supported.
+	 */
+	struct LayerBuffer {
+		video::BufferAllocator vertices;
+		video::BufferAllocator indices;
+		TileBuffers tiles;
+		/** the data that was given to update(idx, vertices, indices) */
+		TileBuffer manual;
+		/** some meshes were deleted without releasing their tile buffers */
+		bool stale = false;
+	};
+	LayerBuffer _layers[MAX_VOLUMES];
+
 	video::IndirectDrawBuffer _indirectDrawBuffer;
-	video::DrawElementsIndirectCommand _drawCommands[MAX_VOLUMES];
+	std::vector<video::DrawElementsIndirectCommand> _drawCommands;
+	int _drawCommandOffset[MAX_VOLUMES] {};
+	int _drawCommandCount[MAX_VOLUMES] {};
+	bool _drawCommandsDirty = true;
+	/** the draw commands are in the indirect draw buffer and are executed with one call per layer */
+	bool _multiDrawIndirect = false;
 
 	video::Buffer _vertexBuffer[MAX_VOLUMES];
 	shader::VoxelData _materialBlock;
@@ -87,6 +118,20 @@ protected:
 	void extractVolumeRegionToMesh(voxel::RawVolume* volume, const voxel::Region& region, voxel::Mesh* mesh) const;
 	voxel::Region calculateExtractRegion(int x, int y, int z, const glm::ivec3& meshSize) const;
 
+	bool uploadTile(int idx, TileBuffer& tile, const voxel::VertexArray& vertices, const voxel::IndexArray& indices);
+	void releaseTile(int idx, TileBuffer& tile);
+	void releaseStaleTiles(int idx);
+	/**
+	 * @brief Uploads the mesh of the given tile into its own sub range of the layer buffers
+	 * @note Only if the layer buffers are exhausted, all tiles of the layer are uploaded again
+	 */
+	bool updateTile(int idx, const glm::ivec3& mins);
+	void updateDrawCommands();
+	/**
+	 * @brief Executes the draw commands of the given layer - the vertex buffer of the layer must be bound
+	 */
+	void drawLayer(int idx) const;
+
 public:
 	RawVolumeRenderer();
 
@@ -101,7 +146,8 @@ public:
 	const render::Shadow& shadow() const;
 
 	/**
-	 * @brief Updates the vertex buffers manually
+	 * @brief Uploads all mesh tiles of the given layer again
+	 * @note The layer buffers are compacted in this step
 	 * @sa extract()
 	 */
 	bool update(int idx);
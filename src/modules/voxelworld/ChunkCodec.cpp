@@ -0,0 +1,217 @@
+/**
+ * @file
+ */
+
+#include "ChunkCodec.h"
+#include "voxel/Morton.h"
+#include "core/Zip.h"
+#include "core/LZ4.h"
+#include "core/Trace.h"
+#include "core/Log.h"
+#include <SDL_endian.h>
+#include <vector>
+#include <string.h>
+
+namespace voxelworld {
+
+namespace {
+
+class ZipChunkCodec : public ChunkCodec {
+public:
+	ChunkCodecType type() const override {
+		return ChunkCodecType::Zip;
+	}
+
+	bool encode(const voxel::PagedVolume::ChunkPtr& chunk, core::ByteStream& out) const override {
+		core_trace_scoped(ZipChunkCodecEncode);
+		const uint32_t voxelSize = chunk->dataSizeInBytes();
+		std::vector<uint8_t> buf(core::zip::compressBound(voxelSize));
+		size_t finalBufferSize;
+		if (!core::zip::compress((const uint8_t*)chunk->data(), voxelSize, buf.data(), buf.size(), &finalBufferSize)) {
+			Log::error("Failed to compress the voxel data");
+			return false;
+		}
+		out.append(buf.data(), finalBufferSize);
+		return true;
+	}
+
+	bool decode(const uint8_t *buf, size_t len, const voxel::PagedVolume::ChunkPtr& chunk) const override {
+		core_trace_scoped(ZipChunkCodecDecode);
+		// TODO: doesn't work on big endian
+		return core::zip::uncompress(buf, len, (uint8_t*)chunk->data(), chunk->dataSizeInBytes());
+	}
+};
+
+class LZ4ChunkCodec : public ChunkCodec {
+public:
+	ChunkCodecType type() const override {
+		return ChunkCodecType::LZ4;
+	}
+
+	bool encode(const voxel::PagedVolume::ChunkPtr& chunk, core::ByteStream& out) const override {
+		core_trace_scoped(LZ4ChunkCodecEncode);
+		const uint32_t voxelSize = chunk->dataSizeInBytes();
+		std::vector<uint8_t> buf(core::lz4::compressBound(voxelSize));
+		size_t finalBufferSize;
+		if (!core::lz4::compress((const uint8_t*)chunk->data(), voxelSize, buf.data(), buf.size(), &finalBufferSize)) {
+			Log::error("Failed to compress the voxel data");
+			return false;
+		}
+		out.append(buf.data(), finalBufferSize);
+		return true;
+	}
+
+	bool decode(const uint8_t *buf, size_t len, const voxel::PagedVolume::ChunkPtr& chunk) const override {
+		core_trace_scoped(LZ4ChunkCodecDecode);
+		const size_t voxelSize = chunk->dataSizeInBytes();
+		size_t finalBufferSize = 0u;
+		if (!core::lz4::uncompress(buf, len, (uint8_t*)chunk->data(), voxelSize, &finalBufferSize)) {
+			return false;
+		}
+		return finalBufferSize == voxelSize;
+	}
+};
+
+/**
+ * @brief The voxels are stored in morton order in the chunk. This codec walks the voxels column by column
+ * along the y axis - where the terrain consists of a few long runs of the same voxel - and stores each run as
+ * its length and the voxel. The runs are then LZ4 compressed.
+ */
+class RLELZ4ChunkCodec : public ChunkCodec {
+private:
+	struct Run {
+		uint16_t length;
+		voxel::Voxel voxel;
+	};
+	/**
+	 * @brief The serialized size of a run: the little endian length, the material and the color index
+	 */
+	static constexpr size_t RunSize = 4u;
+
+	static void writeRun(const Run& run, uint8_t *out) {
+		out[0] = (uint8_t)(run.length & 0xFFu);
+		out[1] = (uint8_t)(run.length >> 8);
+		out[2] = (uint8_t)run.voxel.getMaterial();
+		out[3] = run.voxel.getColor();
+	}
+
+	static Run readRun(const uint8_t *in) {
+		const uint16_t length = (uint16_t)(in[0] | (in[1] << 8));
+		return Run { length, voxel::createVoxel((voxel::VoxelType)in[2], in[3]) };
+	}
+
+public:
+	ChunkCodecType type() const override {
+		return ChunkCodecType::RLELZ4;
+	}
+
+	bool encode(const voxel::PagedVolume::ChunkPtr& chunk, core::ByteStream& out) const override {
+		core_trace_scoped(RLELZ4ChunkCodecEncode);
+		const int sideLength = chunk->sideLength();
+		const voxel::Voxel *voxels = chunk->data();
+		std::vector<Run> runs;
+		runs.reserve(sideLength * sideLength * 4);
+		for (int z = 0; z < sideLength; ++z) {
+			for (int x = 0; x < sideLength; ++x) {
+				const uint32_t columnIndex = voxel::morton256_x[x] | voxel::morton256_z[z];
+				Run run { 0u, voxels[columnIndex] };
+				for (int y = 0; y < sideLength; ++y) {
+					const voxel::Voxel& v = voxels[columnIndex | voxel::morton256_y[y]];
+					if (v == run.voxel) {
+						++run.length;
+						continue;
+					}
+					runs.push_back(run);
+					run = Run { 1u, v };
+				}
+				runs.push_back(run);
+			}
+		}
+		const uint32_t runsSize = (uint32_t)(runs.size() * RunSize);
+		std::vector<uint8_t> runBuf(runsSize);
+		for (size_t i = 0u; i < runs.size(); ++i) {
+			writeRun(runs[i], &runBuf[i * RunSize]);
+		}
+		std::vector<uint8_t> buf(core::lz4::compressBound(runsSize));
+		size_t finalBufferSize;
+		if (!core::lz4::compress(runBuf.data(), runsSize, buf.data(), buf.size(), &finalBufferSize)) {
+			Log::error("Failed to compress the voxel runs");
+			return false;
+		}
+		out.addInt((int32_t)runs.size());
+		out.append(buf.data(), finalBufferSize);
+		return true;
+	}
+
+	bool decode(const uint8_t *buf, size_t len, const voxel::PagedVolume::ChunkPtr& chunk) const override {
+		core_trace_scoped(RLELZ4ChunkCodecDecode);
+		if (len < sizeof(int32_t)) {
+			return false;
+		}
+		int32_t runCount;
+		memcpy(&runCount, buf, sizeof(runCount));
+		runCount = SDL_SwapLE32(runCount);
+		const int sideLength = chunk->sideLength();
+		// every column has at least one run
+		if (runCount < sideLength * sideLength || runCount > (int32_t)chunk->voxels()) {
+			Log::error("Invalid amount of voxel runs: %i", runCount);
+			return false;
+		}
+		const size_t runsSize = (size_t)runCount * RunSize;
+		std::vector<uint8_t> runBuf(runsSize);
+		size_t finalBufferSize = 0u;
+		if (!core::lz4::uncompress(buf + sizeof(int32_t), len - sizeof(int32_t), runBuf.data(), runsSize, &finalBufferSize)
+				|| finalBufferSize != runsSize) {
+			return false;
+		}
+		std::vector<Run> runs(runCount);
+		for (size_t i = 0u; i < runs.size(); ++i) {
+			runs[i] = readRun(&runBuf[i * RunSize]);
+			if (runs[i].voxel.getMaterial() >= voxel::VoxelType::Max) {
+				return false;
+			}
+		}
+		voxel::Voxel *voxels = chunk->data();
+		size_t runIndex = 0u;
+		for (int z = 0; z < sideLength; ++z) {
+			for (int x = 0; x < sideLength; ++x) {
+				const uint32_t columnIndex = voxel::morton256_x[x] | voxel::morton256_z[z];
+				int y = 0;
+				while (y < sideLength) {
+					if (runIndex >= runs.size()) {
+						return false;
+					}
+					const Run& run = runs[runIndex++];
+					if (run.length == 0u || y + run.length > sideLength) {
+						return false;
+					}
+					for (int end = y + run.length; y < end; ++y) {
+						voxels[columnIndex | voxel::morton256_y[y]] = run.voxel;
+					}
+				}
+			}
+		}
+		return runIndex == runs.size();
+	}
+};
+
+}
+
+const ChunkCodec* chunkCodec(ChunkCodecType type) {
+	static const ZipChunkCodec zip;
+	static const LZ4ChunkCodec lz4;
+	static const RLELZ4ChunkCodec rleLZ4;
+	switch (type) {
+	case ChunkCodecType::Zip:
+		return &zip;
+	case ChunkCodecType::LZ4:
+		return &lz4;
+	case ChunkCodecType::RLELZ4:
+		return &rleLZ4;
+	default:
+		break;
+	}
+	return nullptr;
+}
+
+}
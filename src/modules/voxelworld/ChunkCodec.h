@@ -0,0 +1,52 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "voxel/PagedVolume.h"
+#include "core/ByteStream.h"
+#include <stdint.h>
+
+namespace voxelworld {
+
+/**
+ * @brief The id of a codec is stored with each chunk - never change the values.
+ */
+enum class ChunkCodecType : uint8_t {
+	/** zlib compressed voxels - the only codec of world file version 2 */
+	Zip = 0,
+	/** LZ4 compressed voxels */
+	LZ4 = 1,
+	/** the voxels are run length encoded along the y axis and then LZ4 compressed */
+	RLELZ4 = 2,
+
+	Max
+};
+
+/**
+ * @brief Converts the voxels of a chunk into their persisted form and back.
+ * @sa chunkCodec()
+ */
+class ChunkCodec {
+public:
+	virtual ~ChunkCodec() {}
+
+	virtual ChunkCodecType type() const = 0;
+	/**
+	 * @brief Appends the encoded voxels of the chunk to the given stream
+	 */
+	virtual bool encode(const voxel::PagedVolume::ChunkPtr& chunk, core::ByteStream& out) const = 0;
+	/**
+	 * @brief Fills the chunk with the voxels that were encoded by @c encode()
+	 * @return @c false if the data is corrupted or doesn't fit the chunk
+	 */
+	virtual bool decode(const uint8_t *buf, size_t len, const voxel::PagedVolume::ChunkPtr& chunk) const = 0;
+};
+
+/**
+ * @return The codec for the given type or @c nullptr if the type is unknown
+ */
+extern const ChunkCodec* chunkCodec(ChunkCodecType type);
+
+}
@@ -9,11 +9,14 @@
 #include "voxel/Region.h"
 #include "core/Zip.h"
 #include "core/ByteStream.h"
+#include "ChunkCodec.h"
 #include <memory>
 
 namespace voxelworld {
 
 class ChunkPersister : public core::IComponent {
+protected:
+	ChunkCodecType _codecType = ChunkCodecType::RLELZ4;
 public:
 	virtual ~ChunkPersister() {}
 
@@ -24,10 +27,24 @@ public:
 	virtual bool save(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int seed) { return false; }
 	virtual void erase(const voxel::Region& region, unsigned int seed) { }
 
+	/**
+	 * @brief The codec that is used to save chunks. Chunks that were saved with another codec can still be loaded.
+	 */
+	void setCodec(ChunkCodecType codecType);
+	ChunkCodecType codec() const;
+
 	bool loadCompressed(const voxel::PagedVolume::ChunkPtr& chunk, const uint8_t *fileBuf, size_t fileLen) const;
 	bool saveCompressed(const voxel::PagedVolume::ChunkPtr& chunk, core::ByteStream& outStream) const;
 };
 
+inline void ChunkPersister::setCodec(ChunkCodecType codecType) {
+	_codecType = codecType;
+}
+
+inline ChunkCodecType ChunkPersister::codec() const {
+	return _codecType;
+}
+
 typedef std::shared_ptr<ChunkPersister> ChunkPersisterPtr;
 
 }
@@ -4,15 +4,14 @@
 
 #include "FilePersister.h"
 #include "voxel/PagedVolumeWrapper.h"
-#include "voxel/Constants.h"
 #include "app/App.h"
 #include "io/Filesystem.h"
 #include "core/Common.h"
 #include "core/StringUtil.h"
 #include "core/Trace.h"
 #include "core/ByteStream.h"
-#include "core/Zip.h"
 #include "core/Log.h"
+#include <vector>
 
 namespace voxelworld {
 
@@ -20,19 +19,87 @@ static core::String getWorldName(const glm::ivec3& chunkPos, unsigned int seed)
 	return core::string::format("world_%u_%i_%i_%i.wld", seed, chunkPos.x, chunkPos.y, chunkPos.z);
 }
 
+static core::String getRegionName(const glm::ivec3& regionPos, unsigned int seed) {
+	return core::string::format("world_%u_%i_%i_%i.wrg", seed, regionPos.x, regionPos.y, regionPos.z);
+}
+
+void FilePersister::shutdown() {
+	core::ScopedLock lock(_regionsLock);
+	for (auto i = _regions.begin(); i != _regions.end(); ++i) {
+		i->value.file->close();
+	}
+	_regions.clear();
+}
+
+RegionFilePtr FilePersister::region(const glm::ivec3& chunkPos, unsigned int seed, bool create) {
+	const glm::ivec3& regionPos = RegionFile::regionPos(chunkPos);
+	const glm::ivec4 key(regionPos, (int)seed);
+	core::ScopedLock lock(_regionsLock);
+	auto i = _regions.find(key);
+	if (i != _regions.end()) {
+		const RegionFilePtr regionFile = i->value.file;
+		// the file is closed if it couldn't be reopened after a failed compaction - try again
+		if (!regionFile->open()) {
+			_regions.remove(key);
+			return RegionFilePtr();
+		}
+		i->value.lastUse = ++_regionUse;
+		return regionFile;
+	}
+	const io::FilesystemPtr& filesystem = io::filesystem();
+	const core::String& filename = getRegionName(regionPos, seed);
+	if (!create && !filesystem->open(filename)->exists()) {
+		return RegionFilePtr();
+	}
+	const RegionFilePtr regionFile = core::make_shared<RegionFile>(filesystem->writePath(filename.c_str()));
+	if (!regionFile->open()) {
+		return RegionFilePtr();
+	}
+	evictRegions();
+	_regions.put(key, Region{regionFile, ++_regionUse});
+	return regionFile;
+}
+
+void FilePersister::evictRegions() {
+	while (_regions.size() >= MaxOpenRegions) {
+		// only regions that are not in use by another thread are closed - there must never be two
+		// instances of the same region file. A new reference is only handed out with the lock held.
+		auto lru = _regions.end();
+		for (auto i = _regions.begin(); i != _regions.end(); ++i) {
+			if (i->value.file.use_count() > 1) {
+				continue;
+			}
+			if (lru == _regions.end() || i->value.lastUse < lru->value.lastUse) {
+				lru = i;
+			}
+		}
+		if (lru == _regions.end()) {
+			// all of them are in use - exceed the limit for now
+			return;
+		}
+		const glm::ivec4 key = lru->key;
+		lru->value.file->close();
+		_regions.remove(key);
+	}
+}
+
 void FilePersister::erase(const voxel::Region& region, unsigned int seed) {
 	core_trace_scoped(WorldPersisterErase);
-#if 0
-	voxel::PagedVolume::ChunkPtr chunk = ctx.getChunk();
+	// the region of a chunk is given - see WorldPager::erase()
+	const int sideLength = region.getWidthInVoxels();
+	const glm::ivec3 chunkPos = glm::ivec3(glm::floor(glm::vec3(region.getLowerCorner()) / (float)sideLength));
+	const RegionFilePtr& regionFile = this->region(chunkPos, seed, false);
+	if (regionFile) {
+		regionFile->erase(chunkPos);
+	}
 	const io::FilesystemPtr& filesystem = io::filesystem();
-	const voxel::Region& region = ctx.region;
-	const core::String& filename = getWorldName(region, seed);
-	// TODO: filesystem->remove(filename);
-#endif
+	const core::String& filename = getWorldName(chunkPos, seed);
+	if (filesystem->open(filename)->exists()) {
+		filesystem->removeFile(filesystem->writePath(filename.c_str()));
+	}
 }
 
-bool FilePersister::load(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int seed) {
-	core_trace_scoped(WorldPersisterLoad);
+bool FilePersister::loadLegacy(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int seed) const {
 	const io::FilesystemPtr& filesystem = io::filesystem();
 	const core::String& filename = getWorldName(chunk->chunkPos(), seed);
 	const io::FilePtr& f = filesystem->open(filename);
@@ -47,20 +114,40 @@ bool FilePersister::load(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int
 	return success;
 }
 
-bool FilePersister::save(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int seed) {
+bool FilePersister::load(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int seed) {
 	core_trace_scoped(WorldPersisterLoad);
+	const glm::ivec3& chunkPos = chunk->chunkPos();
+	const RegionFilePtr& regionFile = region(chunkPos, seed, false);
+	if (!regionFile) {
+		return loadLegacy(chunk, seed);
+	}
+	static thread_local std::vector<uint8_t> buf;
+	if (!regionFile->read(chunkPos, buf)) {
+		return loadLegacy(chunk, seed);
+	}
+	return loadCompressed(chunk, buf.data(), buf.size());
+}
+
+bool FilePersister::save(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int seed) {
+	core_trace_scoped(WorldPersisterSave);
 	core::ByteStream final;
 	if (!saveCompressed(chunk, final)) {
 		return false;
 	}
-	const core::String& filename = getWorldName(chunk->chunkPos(), seed);
-	const io::FilesystemPtr& filesystem = io::filesystem();
-
-	if (!filesystem->write(filename, final.getBuffer(), final.getSize())) {
-		Log::error("Failed to write file %s", filename.c_str());
+	const glm::ivec3& chunkPos = chunk->chunkPos();
+	const RegionFilePtr& regionFile = region(chunkPos, seed, true);
+	if (!regionFile) {
 		return false;
 	}
-	Log::debug("Wrote file %s (%i)", filename.c_str(), (int)final.getSize());
+	if (!regionFile->write(chunkPos, final.getBuffer(), final.getSize())) {
+		Log::error("Failed to write chunk %i:%i:%i to %s", chunkPos.x, chunkPos.y, chunkPos.z, regionFile->path().c_str());
+		return false;
+	}
+	const uint32_t garbage = regionFile->garbageBytes();
+	if (garbage >= _compactThreshold && garbage > regionFile->fileSize() - garbage) {
+		regionFile->compact();
+	}
+	Log::trace("Wrote chunk %i:%i:%i (%i)", chunkPos.x, chunkPos.y, chunkPos.z, (int)final.getSize());
 	return true;
 }
 
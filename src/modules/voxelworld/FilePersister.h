@@ -5,6 +5,12 @@
 #pragma once
 
 #include "ChunkPersister.h"
+#include "RegionFile.h"
+#include "core/GLM.h"
+#include "core/collection/Map.h"
+#include "core/concurrent/Lock.h"
+#include "core/Trace.h"
+#include <glm/vec4.hpp>
 
 namespace voxel {
 class PagedVolumeWrapper;
@@ -12,13 +18,50 @@ class PagedVolumeWrapper;
 
 namespace voxelworld {
 
+/**
+ * @brief Persists the chunks in region files - see @c RegionFile.
+ *
+ * Chunks that were saved as single files by previous versions are still loaded.
+ */
 class FilePersister : public ChunkPersister {
+private:
+	/**
+	 * @brief The maximum amount of region files that are kept open
+	 */
+	static constexpr size_t MaxOpenRegions = 32u;
+	struct Region {
+		RegionFilePtr file;
+		// the value of the use counter when the region was accessed the last time
+		uint64_t lastUse;
+	};
+	// the region position and the seed
+	typedef core::Map<glm::ivec4, Region, 64, glm::hash<glm::ivec4>> Regions;
+	Regions _regions;
+	uint64_t _regionUse = 0u;
+	core_trace_mutex(core::Lock, _regionsLock, "FilePersisterRegions");
+	uint32_t _compactThreshold = 1024u * 1024u;
+
+	RegionFilePtr region(const glm::ivec3& chunkPos, unsigned int seed, bool create);
+	void evictRegions();
+	bool loadLegacy(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int seed) const;
 public:
 	virtual ~FilePersister() {}
 
+	void shutdown() override;
+
 	bool load(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int seed) override;
 	bool save(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int seed) override;
 	void erase(const voxel::Region& region, unsigned int seed) override;
+
+	/**
+	 * @brief A region file is compacted after a save if it contains more garbage than chunk data and the
+	 * garbage exceeds the given amount of bytes.
+	 */
+	void setCompactThreshold(uint32_t bytes);
 };
 
+inline void FilePersister::setCompactThreshold(uint32_t bytes) {
+	_compactThreshold = bytes;
+}
+
 }
@@ -0,0 +1,327 @@
+/**
+ * @file
+ */
+
+#include "RegionFile.h"
+#include "core/Log.h"
+#include "core/Assert.h"
+#include <SDL_rwops.h>
+#include <SDL_endian.h>
+#include <SDL_platform.h>
+#include <stdio.h>
+#ifdef __WINDOWS__
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace voxelworld {
+
+#define REGION_FILE_MAGIC SDL_FOURCC('V', 'R', 'G', 'N')
+#define REGION_FILE_VERSION 1
+
+// magic, version, chunks per side and a reserved value
+static constexpr uint32_t HeaderSize = 4u * sizeof(uint32_t);
+static constexpr uint32_t EntrySize = 2u * sizeof(uint32_t);
+static constexpr uint32_t DataOffset = HeaderSize + RegionFile::Chunks * EntrySize;
+// the chunk data starts at aligned offsets
+static constexpr uint32_t DataAlignment = 16u;
+
+static inline uint32_t align(uint32_t offset) {
+	return (offset + DataAlignment - 1u) & ~(DataAlignment - 1u);
+}
+
+/**
+ * @brief Writes the content of the given file to the disk - so a rename can't replace the target with a
+ * file whose data didn't make it to the disk yet
+ */
+static bool syncFile(const char *path) {
+	FILE *f = fopen(path, "r+b");
+	if (f == nullptr) {
+		return false;
+	}
+	bool success = fflush(f) == 0;
+#ifdef __WINDOWS__
+	success &= _commit(_fileno(f)) == 0;
+#else
+	success &= fsync(fileno(f)) == 0;
+#endif
+	success &= fclose(f) == 0;
+	return success;
+}
+
+/**
+ * @brief Atomically replaces the target file - the target is either the old or the new file after a crash
+ */
+static bool replaceFile(const char *source, const char *target) {
+#ifdef __WINDOWS__
+	return MoveFileExA(source, target, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	return rename(source, target) == 0;
+#endif
+}
+
+RegionFile::RegionFile(const core::String& path) :
+		_path(path) {
+}
+
+RegionFile::~RegionFile() {
+	close();
+}
+
+glm::ivec3 RegionFile::regionPos(const glm::ivec3& chunkPos) {
+	// arithmetic shift - negative chunk positions are rounded towards negative infinity
+	return glm::ivec3(chunkPos.x >> 3, chunkPos.y >> 3, chunkPos.z >> 3);
+}
+
+int RegionFile::entryIndex(const glm::ivec3& chunkPos) {
+	static_assert(ChunksPerSide == 8, "regionPos() must match the amount of chunks per side");
+	const int x = chunkPos.x & (ChunksPerSide - 1);
+	const int y = chunkPos.y & (ChunksPerSide - 1);
+	const int z = chunkPos.z & (ChunksPerSide - 1);
+	return (z * ChunksPerSide + y) * ChunksPerSide + x;
+}
+
+bool RegionFile::open() {
+	core::ScopedLock lock(_lock);
+	if (_file != nullptr) {
+		return true;
+	}
+	_file = SDL_RWFromFile(_path.c_str(), "r+b");
+	if (_file == nullptr) {
+		return createFile();
+	}
+	if (!readHeader()) {
+		Log::error("Invalid region file %s", _path.c_str());
+		closeFile();
+		return false;
+	}
+	return true;
+}
+
+bool RegionFile::createFile() {
+	_file = SDL_RWFromFile(_path.c_str(), "w+b");
+	if (_file == nullptr) {
+		Log::error("Failed to create region file %s: %s", _path.c_str(), SDL_GetError());
+		return false;
+	}
+	SDL_WriteLE32(_file, REGION_FILE_MAGIC);
+	SDL_WriteLE32(_file, REGION_FILE_VERSION);
+	SDL_WriteLE32(_file, ChunksPerSide);
+	SDL_WriteLE32(_file, 0u);
+	for (int i = 0; i < Chunks; ++i) {
+		_entries[i] = Entry();
+		SDL_WriteLE32(_file, 0u);
+		SDL_WriteLE32(_file, 0u);
+	}
+	_fileSize = DataOffset;
+	_liveBytes = 0u;
+	if (SDL_RWtell(_file) != (Sint64)DataOffset) {
+		Log::error("Failed to write the header of region file %s", _path.c_str());
+		closeFile();
+		return false;
+	}
+	return true;
+}
+
+bool RegionFile::readHeader() {
+	const Sint64 size = SDL_RWsize(_file);
+	if (size < (Sint64)DataOffset) {
+		return false;
+	}
+	if (SDL_ReadLE32(_file) != REGION_FILE_MAGIC) {
+		return false;
+	}
+	const uint32_t version = SDL_ReadLE32(_file);
+	if (version != REGION_FILE_VERSION) {
+		Log::warn("Region file %s has a wrong version number %u (expected %i)", _path.c_str(), version, REGION_FILE_VERSION);
+		return false;
+	}
+	if (SDL_ReadLE32(_file) != (uint32_t)ChunksPerSide) {
+		return false;
+	}
+	SDL_ReadLE32(_file);
+	_fileSize = (uint32_t)size;
+	_liveBytes = 0u;
+	for (int i = 0; i < Chunks; ++i) {
+		Entry& entry = _entries[i];
+		entry.offset = SDL_ReadLE32(_file);
+		entry.size = SDL_ReadLE32(_file);
+		if (entry.size == 0u) {
+			continue;
+		}
+		if (entry.offset < DataOffset || (uint64_t)entry.offset + entry.size > _fileSize) {
+			Log::warn("Invalid chunk entry %i in region file %s", i, _path.c_str());
+			entry = Entry();
+			continue;
+		}
+		_liveBytes += align(entry.size);
+	}
+	return true;
+}
+
+void RegionFile::closeFile() {
+	if (_file != nullptr) {
+		SDL_RWclose(_file);
+		_file = nullptr;
+	}
+}
+
+void RegionFile::close() {
+	core::ScopedLock lock(_lock);
+	closeFile();
+}
+
+bool RegionFile::contains(const glm::ivec3& chunkPos) const {
+	core::ScopedLock lock(_lock);
+	return _entries[entryIndex(chunkPos)].size > 0u;
+}
+
+bool RegionFile::read(const glm::ivec3& chunkPos, std::vector<uint8_t>& buf) const {
+	core_trace_scoped(RegionFileRead);
+	core::ScopedLock lock(_lock);
+	if (_file == nullptr) {
+		return false;
+	}
+	const Entry& entry = _entries[entryIndex(chunkPos)];
+	if (entry.size == 0u) {
+		return false;
+	}
+	buf.resize(entry.size);
+	if (SDL_RWseek(_file, entry.offset, RW_SEEK_SET) < 0) {
+		return false;
+	}
+	if (SDL_RWread(_file, buf.data(), entry.size, 1) != 1) {
+		Log::error("Failed to read %u bytes at offset %u from region file %s", entry.size, entry.offset, _path.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool RegionFile::writeEntry(int index) {
+	const Entry& entry = _entries[index];
+	if (SDL_RWseek(_file, HeaderSize + index * EntrySize, RW_SEEK_SET) < 0) {
+		return false;
+	}
+	return SDL_WriteLE32(_file, entry.offset) == 1u && SDL_WriteLE32(_file, entry.size) == 1u;
+}
+
+bool RegionFile::write(const glm::ivec3& chunkPos, const uint8_t* buf, size_t len) {
+	core_trace_scoped(RegionFileWrite);
+	core_assert(len > 0u);
+	core::ScopedLock lock(_lock);
+	if (_file == nullptr) {
+		return false;
+	}
+	const uint32_t offset = align(_fileSize);
+	if (SDL_RWseek(_file, offset, RW_SEEK_SET) < 0) {
+		return false;
+	}
+	if (SDL_RWwrite(_file, buf, len, 1) != 1) {
+		Log::error("Failed to write %i bytes to region file %s", (int)len, _path.c_str());
+		return false;
+	}
+	_fileSize = offset + (uint32_t)len;
+	// the previous data of the chunk stays valid until the table entry was written
+	const int index = entryIndex(chunkPos);
+	Entry& entry = _entries[index];
+	_liveBytes -= align(entry.size);
+	entry.offset = offset;
+	entry.size = (uint32_t)len;
+	_liveBytes += align(entry.size);
+	return writeEntry(index);
+}
+
+bool RegionFile::erase(const glm::ivec3& chunkPos) {
+	core::ScopedLock lock(_lock);
+	if (_file == nullptr) {
+		return false;
+	}
+	const int index = entryIndex(chunkPos);
+	Entry& entry = _entries[index];
+	if (entry.size == 0u) {
+		return true;
+	}
+	_liveBytes -= align(entry.size);
+	entry = Entry();
+	return writeEntry(index);
+}
+
+uint32_t RegionFile::garbageBytes() const {
+	core::ScopedLock lock(_lock);
+	return align(_fileSize) - DataOffset - _liveBytes;
+}
+
+uint32_t RegionFile::fileSize() const {
+	core::ScopedLock lock(_lock);
+	return _fileSize;
+}
+
+bool RegionFile::compact() {
+	core_trace_scoped(RegionFileCompact);
+	core::ScopedLock lock(_lock);
+	if (_file == nullptr) {
+		return false;
+	}
+	const core::String tmpPath = _path + ".tmp";
+	RegionFile compacted(tmpPath);
+	if (!compacted.createFile()) {
+		return false;
+	}
+	std::vector<uint8_t> buf;
+	for (int i = 0; i < Chunks; ++i) {
+		const Entry& entry = _entries[i];
+		if (entry.size == 0u) {
+			continue;
+		}
+		buf.resize(entry.size);
+		if (SDL_RWseek(_file, entry.offset, RW_SEEK_SET) < 0 || SDL_RWread(_file, buf.data(), entry.size, 1) != 1) {
+			Log::error("Failed to read chunk %i from region file %s", i, _path.c_str());
+			compacted.closeFile();
+			remove(tmpPath.c_str());
+			return false;
+		}
+		const glm::ivec3 chunkPos(i % ChunksPerSide, (i / ChunksPerSide) % ChunksPerSide, i / (ChunksPerSide * ChunksPerSide));
+		if (!compacted.write(chunkPos, buf.data(), buf.size())) {
+			compacted.closeFile();
+			remove(tmpPath.c_str());
+			return false;
+		}
+	}
+	compacted.closeFile();
+	if (!syncFile(tmpPath.c_str())) {
+		Log::error("Failed to sync region file %s", tmpPath.c_str());
+		remove(tmpPath.c_str());
+		return false;
+	}
+#ifdef __WINDOWS__
+	// an open file can't be replaced
+	closeFile();
+#endif
+	if (!replaceFile(tmpPath.c_str(), _path.c_str())) {
+		Log::error("Failed to replace region file %s", _path.c_str());
+		remove(tmpPath.c_str());
+		// keep on using the original file
+		if (_file == nullptr) {
+			_file = SDL_RWFromFile(_path.c_str(), "r+b");
+			if (_file == nullptr || !readHeader()) {
+				Log::error("Failed to reopen region file %s", _path.c_str());
+				closeFile();
+			}
+		}
+		return false;
+	}
+	closeFile();
+	_file = SDL_RWFromFile(_path.c_str(), "r+b");
+	if (_file == nullptr || !readHeader()) {
+		Log::error("Failed to reopen region file %s", _path.c_str());
+		closeFile();
+		return false;
+	}
+	Log::debug("Compacted region file %s to %u bytes", _path.c_str(), _fileSize);
+	return true;
+}
+
+}
@@ -0,0 +1,108 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/String.h"
+#include "core/NonCopyable.h"
+#include "core/SharedPtr.h"
+#include "core/concurrent/Lock.h"
+#include "core/Trace.h"
+#include <glm/vec3.hpp>
+#include <vector>
+#include <stdint.h>
+
+struct SDL_RWops;
+
+namespace voxelworld {
+
+/**
+ * @brief Container for the persisted data of many chunks in one file.
+ *
+ * A region covers @c ChunksPerSide^3 chunks. The file starts with a header and a table with the offset and the
+ * size of each chunk of the region - followed by the chunk data. The data of a chunk is always appended to the
+ * end of the file and the table entry is updated afterwards. The previous data of the chunk becomes garbage
+ * that is removed by @c compact().
+ *
+ * All values are stored in little endian. The offsets in the table are absolute and the chunk data is aligned,
+ * so the file can also be memory mapped and the chunk data can be decoded in place.
+ */
+class RegionFile : public core::NonCopyable {
+public:
+	static constexpr int ChunksPerSide = 8;
+	static constexpr int Chunks = ChunksPerSide * ChunksPerSide * ChunksPerSide;
+private:
+	struct Entry {
+		uint32_t offset = 0u;
+		uint32_t size = 0u;
+	};
+
+	const core::String _path;
+	SDL_RWops* _file = nullptr;
+	Entry _entries[Chunks];
+	uint32_t _fileSize = 0u;
+	// the aligned size of the data of all chunks in the table
+	uint32_t _liveBytes = 0u;
+	mutable core_trace_mutex(core::Lock, _lock, "RegionFile");
+
+	static int entryIndex(const glm::ivec3& chunkPos);
+	bool createFile();
+	bool readHeader();
+	bool writeEntry(int index);
+	void closeFile();
+public:
+	/**
+	 * @param[in] path The absolute path of the file
+	 */
+	RegionFile(const core::String& path);
+	~RegionFile();
+
+	/**
+	 * @brief Opens the file or creates it if it doesn't exist yet
+	 */
+	bool open();
+	void close();
+
+	/**
+	 * @param[in] chunkPos The position of the chunk in chunk coordinates
+	 * @param[out] buf The persisted data of the chunk
+	 * @return @c false if the region doesn't contain the chunk
+	 */
+	bool read(const glm::ivec3& chunkPos, std::vector<uint8_t>& buf) const;
+	/**
+	 * @brief Persists the data of the chunk - replaces any previous data of the same chunk
+	 * @param[in] chunkPos The position of the chunk in chunk coordinates
+	 */
+	bool write(const glm::ivec3& chunkPos, const uint8_t* buf, size_t len);
+	/**
+	 * @brief Removes the chunk from the region - the data is removed by the next @c compact()
+	 */
+	bool erase(const glm::ivec3& chunkPos);
+	bool contains(const glm::ivec3& chunkPos) const;
+
+	/**
+	 * @brief Rewrites the file without the garbage of replaced or erased chunks
+	 */
+	bool compact();
+
+	/**
+	 * @return The amount of bytes of replaced or erased chunk data
+	 */
+	uint32_t garbageBytes() const;
+	uint32_t fileSize() const;
+	const core::String& path() const;
+
+	/**
+	 * @return The position of the region that contains the given chunk
+	 */
+	static glm::ivec3 regionPos(const glm::ivec3& chunkPos);
+};
+
+inline const core::String& RegionFile::path() const {
+	return _path;
+}
+
+typedef core::SharedPtr<RegionFile> RegionFilePtr;
+
+}
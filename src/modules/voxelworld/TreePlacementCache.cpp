@@ -0,0 +1,56 @@
+/**
+ * @file
+ */
+
+#include "TreePlacementCache.h"
+
+namespace voxelworld {
+
+TreePlacementCache::TreePlacementCache(size_t maxRegions) :
+		_maxRegions(maxRegions) {
+	_regions.reserve(_maxRegions + 1u);
+}
+
+RegionTreesPtr TreePlacementCache::get(int regionX, int regionZ) {
+	core::ScopedLock lock(_mutex);
+	auto i = _regions.find(key(regionX, regionZ));
+	if (i == _regions.end()) {
+		return RegionTreesPtr();
+	}
+	i->value.lastUse = ++_useCounter;
+	return i->value.trees;
+}
+
+void TreePlacementCache::put(int regionX, int regionZ, const RegionTreesPtr& trees) {
+	core::ScopedLock lock(_mutex);
+	_regions.put(key(regionX, regionZ), Entry{trees, ++_useCounter});
+	if (_regions.size() > _maxRegions) {
+		evict();
+	}
+}
+
+void TreePlacementCache::evict() {
+	core_trace_scoped(TreePlacementCacheEvict);
+	// the amount of regions is small - a linear search for the oldest entry is cheaper
+	// than keeping a list in use order up to date with every lookup
+	auto oldest = _regions.begin();
+	for (auto i = _regions.begin(); i != _regions.end(); ++i) {
+		if (i->value.lastUse < oldest->value.lastUse) {
+			oldest = i;
+		}
+	}
+	_regions.erase(oldest);
+}
+
+void TreePlacementCache::clear() {
+	core::ScopedLock lock(_mutex);
+	_regions.clear();
+	_useCounter = 0u;
+}
+
+size_t TreePlacementCache::size() const {
+	core::ScopedLock lock(_mutex);
+	return _regions.size();
+}
+
+}
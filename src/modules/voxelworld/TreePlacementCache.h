@@ -0,0 +1,87 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/collection/HashMap.h"
+#include "core/concurrent/Lock.h"
+#include "core/SharedPtr.h"
+#include "core/Trace.h"
+#include "math/Axis.h"
+#include "voxel/Region.h"
+#include <glm/vec3.hpp>
+#include <stdint.h>
+#include <vector>
+
+namespace voxelworld {
+
+/**
+ * @brief The trees of one region as placed by the @c WorldPager
+ *
+ * Only the placement is stored - the tree volumes are resolved with the @c TreeVolumeCache when the
+ * tree is copied into a chunk.
+ */
+struct RegionTrees {
+	struct Tree {
+		/** the world position the tree volume is placed at */
+		glm::ivec3 pos;
+		/** the world space bounds of the rotated tree volume */
+		voxel::Region region;
+		/** the tree type of the biome - see @c TreeVolumeCache::loadTree() */
+		const char *type;
+		math::Axis axis;
+	};
+	/** @c false if the biome of the region doesn't define any tree types */
+	bool hasTreeTypes = false;
+	std::vector<Tree> trees;
+};
+
+typedef core::SharedPtr<RegionTrees> RegionTreesPtr;
+
+/**
+ * @brief Thread safe cache for the tree placements of the regions around the paged chunks
+ *
+ * Every chunk copies the trees of its own and its eight neighbour regions - so without this cache the
+ * placement of every region would be computed nine times. The placement only depends on the seed and the
+ * region, so it's fine if two pager threads compute the same region at the same time - the last one wins.
+ *
+ * If more than @c maxRegions regions are cached, the least recently used one is removed.
+ */
+class TreePlacementCache {
+private:
+	struct Entry {
+		RegionTreesPtr trees;
+		uint64_t lastUse;
+	};
+	core::HashMap<uint64_t, Entry> _regions;
+	uint64_t _useCounter = 0u;
+	const size_t _maxRegions;
+	mutable core_trace_mutex(core::Lock, _mutex, "TreePlacementCache");
+
+	static inline uint64_t key(int regionX, int regionZ) {
+		return ((uint64_t)(uint32_t)regionX << 32) | (uint64_t)(uint32_t)regionZ;
+	}
+
+	void evict();
+public:
+	/**
+	 * @param[in] maxRegions The amount of regions to keep - a 3x3 neighbourhood per pager thread should fit
+	 */
+	explicit TreePlacementCache(size_t maxRegions = 256u);
+
+	/**
+	 * @param[in] regionX The lower x coordinate of the region
+	 * @param[in] regionZ The lower z coordinate of the region
+	 * @return The cached placement or an empty pointer if the region is not cached
+	 */
+	RegionTreesPtr get(int regionX, int regionZ);
+	void put(int regionX, int regionZ, const RegionTreesPtr& trees);
+	/**
+	 * @brief Must be called if any of the parameters of the tree placement (like the seed) changes
+	 */
+	void clear();
+	size_t size() const;
+};
+
+}
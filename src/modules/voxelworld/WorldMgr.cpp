@@ -57,10 +57,23 @@ bool WorldMgr::init(uint32_t volumeMemoryMegaBytes, uint16_t chunkSideLength) {
 }
 
 void WorldMgr::shutdown() {
+	if (_volumeData != nullptr) {
+		const voxel::PagedVolume::Stats& stats = _volumeData->stats();
+		Log::info("Volume stats: %u hits, %u misses, %u prefetches, %u evictions, %u chunks, %uMb of %uMb resident",
+				stats.hits, stats.misses, stats.prefetches, stats.evictions, stats.chunks,
+				(uint32_t)(stats.residentBytes / (1024 * 1024)), (uint32_t)(stats.memoryLimitInBytes / (1024 * 1024)));
+	}
 	delete _volumeData;
 	_volumeData = nullptr;
 }
 
+bool WorldMgr::prefetch(const glm::ivec3& position, int radius) const {
+	core_assert_msg(_volumeData != nullptr, "WorldMgr is not initialized");
+	const glm::ivec3 mins(position.x - radius, 0, position.z - radius);
+	const glm::ivec3 maxs(position.x + radius, voxel::MAX_HEIGHT, position.z + radius);
+	return _volumeData->prefetch(voxel::Region(mins, maxs));
+}
+
 voxelutil::FloorTraceResult WorldMgr::findWalkableFloor(const glm::ivec3& position, int maxDistanceUpwards) const {
 	core_assert_msg(_volumeData != nullptr, "WorldMgr is not initialized");
 	voxel::PagedVolume::Sampler sampler(_volumeData);
@@ -47,6 +47,14 @@ public:
 	 */
 	voxelutil::FloorTraceResult findWalkableFloor(const glm::ivec3& position, int maxDistanceUpwards = voxel::MAX_HEIGHT) const;
 
+	/**
+	 * @brief Schedules the page in of the chunks around the given position (over the whole world height) without
+	 * blocking the caller. Call this for positions that are likely to be accessed soon - e.g. the player positions.
+	 * @return @c true if the chunks around the given position are already available.
+	 * @sa voxel::PagedVolume::prefetch()
+	 */
+	bool prefetch(const glm::ivec3& position, int radius) const;
+
 	bool init(uint32_t volumeMemoryMegaBytes = 1024, uint16_t chunkSideLength = 256);
 	void shutdown();
 	void reset();
@@ -10,6 +10,9 @@
 #include "core/Common.h"
 #include "core/StringUtil.h"
 #include "core/collection/Array.h"
+#include "voxelutil/RawVolumeRotateWrapper.h"
+#include <glm/common.hpp>
+#include <glm/vector_relational.hpp>
 
 namespace voxelworld {
 
@@ -46,10 +49,12 @@ void WorldPager::pageOut(voxel::PagedVolume::Chunk* chunk) {
 
 void WorldPager::setSeed(unsigned int seed) {
 	_seed = seed;
+	_treePlacementCache.clear();
 }
 
 void WorldPager::setNoiseOffset(const glm::vec2& noiseOffset) {
 	_noiseSeedOffset = noiseOffset;
+	_treePlacementCache.clear();
 }
 
 bool WorldPager::init(voxel::PagedVolume *volumeData, const core::String& worldParamsLua, const core::String& biomesLua) {
@@ -66,6 +71,7 @@ bool WorldPager::init(voxel::PagedVolume *volumeData, const core::String& worldP
 	if (!_volumeCache.init()) {
 		return false;
 	}
+	_treePlacementCache.clear();
 	_volumeData = volumeData;
 	return _volumeData != nullptr;
 }
@@ -76,11 +82,33 @@ void WorldPager::shutdown() {
 	}
 	_noise.shutdown();
 	_volumeCache.shutdown();
+	_treePlacementCache.clear();
 	_volumeData = nullptr;
 	_biomeManager.shutdown();
 	_worldCtx = WorldContext();
 }
 
+namespace {
+/**
+ * @brief Buffers for the batched noise evaluation of a chunk - kept per thread to not allocate them for each chunk
+ */
+struct TerrainScratch {
+	/** the positions of the columns of the chunk */
+	std::vector<float> x;
+	std::vector<float> z;
+	std::vector<float> noise;
+	/** the scaled noise positions of the columns */
+	std::vector<float> noiseX;
+	std::vector<float> noiseZ;
+	std::vector<float> mountainNoise;
+};
+
+static TerrainScratch& terrainScratch() {
+	static thread_local TerrainScratch scratch;
+	return scratch;
+}
+}
+
 // use a 2d noise to switch between different noises - to generate steep mountains
 void WorldPager::createWorld(voxel::PagedVolumeWrapper& volume) const {
 	core_trace_scoped(WorldGeneration);
@@ -93,16 +121,29 @@ void WorldPager::createWorld(voxel::PagedVolumeWrapper& volume) const {
 	const int lowerZ = region.getLowerZ();
 	core_assert(region.getLowerY() >= 0);
 
-	// TODO: store voxel data in local buffer and transfer in one step into the volume to reduce locking
 	const int size = 2;
 	core_assert(depth % size == 0);
 	core_assert(width % size == 0);
-	for (int z = lowerZ; z < lowerZ + depth; z += size) {
-		for (int x = lowerX; x < lowerX + width; x += size) {
-			voxel::Voxel voxels[voxel::MAX_TERRAIN_HEIGHT];
-			const int ni = fillVoxels(x, minsY, z, voxels);
-			volume.setVoxels(x, minsY, z, size, size, voxels, ni);
-		}
+	const int columnsX = width / size;
+	const int columns = columnsX * (depth / size);
+
+	// the 2d noise of all columns of the chunk is evaluated in one batch
+	TerrainScratch& scratch = terrainScratch();
+	scratch.x.resize(columns);
+	scratch.z.resize(columns);
+	scratch.noise.resize(columns);
+	for (int i = 0; i < columns; ++i) {
+		scratch.x[i] = (float)(lowerX + (i % columnsX) * size);
+		scratch.z[i] = (float)(lowerZ + (i / columnsX) * size);
+	}
+	getNoiseValues(scratch.x.data(), scratch.z.data(), scratch.noise.data(), columns);
+
+	for (int i = 0; i < columns; ++i) {
+		const int x = lowerX + (i % columnsX) * size;
+		const int z = lowerZ + (i / columnsX) * size;
+		voxel::Voxel voxels[voxel::MAX_TERRAIN_HEIGHT];
+		const int ni = fillVoxels(x, minsY, z, scratch.noise[i], voxels);
+		volume.setVoxels(x, minsY, z, size, size, voxels, ni);
 	}
 }
 
@@ -112,15 +153,45 @@ float WorldPager::getNoiseValue(float x, float z) const {
 	// TODO: move the noise settings into the biome
 	const float landscapeNoise = noise::fBm(noisePos2d * _worldCtx.landscapeNoiseFrequency, _worldCtx.landscapeNoiseOctaves,
 			_worldCtx.landscapeNoiseLacunarity, _worldCtx.landscapeNoiseGain);
-	const float noiseNormalized = noise::norm(landscapeNoise);
 	const float mountainNoise = noise::fBm(noisePos2d * _worldCtx.mountainNoiseFrequency, _worldCtx.mountainNoiseOctaves,
 			_worldCtx.mountainNoiseLacunarity, _worldCtx.mountainNoiseGain);
+	return combineNoise(landscapeNoise, mountainNoise);
+}
+
+float WorldPager::combineNoise(float landscapeNoise, float mountainNoise) const {
+	const float noiseNormalized = noise::norm(landscapeNoise);
 	const float mountainNoiseNormalized = noise::norm(mountainNoise);
 	const float mountainMultiplier = mountainNoiseNormalized * (mountainNoiseNormalized + 0.5f);
 	const float n = glm::clamp(noiseNormalized * mountainMultiplier, 0.0f, 1.0f);
 	return n;
 }
 
+void WorldPager::getNoiseValues(const float* x, const float* z, float* out, int amount) const {
+	core_trace_scoped(NoiseValues);
+	TerrainScratch& scratch = terrainScratch();
+	scratch.noiseX.resize(amount);
+	scratch.noiseZ.resize(amount);
+	scratch.mountainNoise.resize(amount);
+	float* noiseX = scratch.noiseX.data();
+	float* noiseZ = scratch.noiseZ.data();
+	float* mountainNoise = scratch.mountainNoise.data();
+	for (int i = 0; i < amount; ++i) {
+		noiseX[i] = (_noiseSeedOffset.x + x[i]) * _worldCtx.landscapeNoiseFrequency;
+		noiseZ[i] = (_noiseSeedOffset.y + z[i]) * _worldCtx.landscapeNoiseFrequency;
+	}
+	noise::fBm(noiseX, noiseZ, out, amount, _worldCtx.landscapeNoiseOctaves,
+			_worldCtx.landscapeNoiseLacunarity, _worldCtx.landscapeNoiseGain);
+	for (int i = 0; i < amount; ++i) {
+		noiseX[i] = (_noiseSeedOffset.x + x[i]) * _worldCtx.mountainNoiseFrequency;
+		noiseZ[i] = (_noiseSeedOffset.y + z[i]) * _worldCtx.mountainNoiseFrequency;
+	}
+	noise::fBm(noiseX, noiseZ, mountainNoise, amount, _worldCtx.mountainNoiseOctaves,
+			_worldCtx.mountainNoiseLacunarity, _worldCtx.mountainNoiseGain);
+	for (int i = 0; i < amount; ++i) {
+		out[i] = combineNoise(out[i], mountainNoise[i]);
+	}
+}
+
 float WorldPager::getDensity(float x, float y, float z, float n) const {
 	core_trace_scoped(DensityValue);
 	const glm::vec3 noisePos3d(_noiseSeedOffset.x + x, y, _noiseSeedOffset.y + z);
@@ -131,24 +202,50 @@ float WorldPager::getDensity(float x, float y, float z, float n) const {
 	return finalDensity;
 }
 
+void WorldPager::getDensities(int x, int minY, int maxY, int z, float n, float* densities) const {
+	core_trace_scoped(DensityValues);
+	const int amount = maxY - minY;
+	if (amount <= 0) {
+		return;
+	}
+	core_assert(maxY <= voxel::MAX_TERRAIN_HEIGHT);
+	float noiseX[voxel::MAX_TERRAIN_HEIGHT];
+	float noiseY[voxel::MAX_TERRAIN_HEIGHT];
+	float noiseZ[voxel::MAX_TERRAIN_HEIGHT];
+	const float px = (_noiseSeedOffset.x + (float)x) * _worldCtx.caveNoiseFrequency;
+	const float pz = (_noiseSeedOffset.y + (float)z) * _worldCtx.caveNoiseFrequency;
+	for (int i = 0; i < amount; ++i) {
+		noiseX[i] = px;
+		noiseY[i] = (float)(minY + i) * _worldCtx.caveNoiseFrequency;
+		noiseZ[i] = pz;
+	}
+	float* out = densities + minY;
+	noise::fBm(noiseX, noiseY, noiseZ, out, amount, _worldCtx.caveNoiseOctaves, _worldCtx.caveNoiseLacunarity, _worldCtx.caveNoiseGain);
+	for (int i = 0; i < amount; ++i) {
+		out[i] = n + noise::norm(out[i]);
+	}
+}
+
 int WorldPager::terrainHeight(int x, int y, int z) const {
 	const float n = getNoiseValue(x, z);
 	return terrainHeight(x, y, z, n);
 }
 
-int WorldPager::terrainHeight(int x, int minsY, int z, float n) const {
-	core_trace_scoped(TerrainHeight);
+int WorldPager::surfaceHeight(int x, int z, float n) const {
 	const int maxHeight = voxel::MAX_TERRAIN_HEIGHT - 1;
 	int centerHeight;
 	// the center of a city should make the terrain more even
 	const float cityMultiplier = _biomeManager.getCityMultiplier(glm::ivec2(x, z), &centerHeight);
-	int ni;
 	if (cityMultiplier < 1.0f) {
 		const float revn = (1.0f - cityMultiplier);
-		ni = revn * centerHeight + (cityMultiplier * n * maxHeight);
-	} else {
-		ni = n * maxHeight;
+		return revn * centerHeight + (cityMultiplier * n * maxHeight);
 	}
+	return n * maxHeight;
+}
+
+int WorldPager::terrainHeight(int x, int minsY, int z, float n) const {
+	core_trace_scoped(TerrainHeight);
+	int ni = surfaceHeight(x, z, n);
 	for (int y = ni - 1; y >= minsY + 1; --y) {
 		const float density = getDensity(x, y, z, n);
 		if (density > _worldCtx.caveDensityThreshold) {
@@ -159,10 +256,19 @@ int WorldPager::terrainHeight(int x, int minsY, int z, float n) const {
 	return ni;
 }
 
-int WorldPager::fillVoxels(int x, int minsY, int z, voxel::Voxel* voxels) const {
+int WorldPager::fillVoxels(int x, int minsY, int z, float n, voxel::Voxel* voxels) const {
 	core_trace_scoped(FillVoxels);
-	const float n = getNoiseValue(x, z);
-	const int ni = terrainHeight(x, minsY, z, n);
+	// the densities are needed to find the terrain height as well as to fill the voxels - evaluate them
+	// only once for the whole column
+	int ni = surfaceHeight(x, z, n);
+	float densities[voxel::MAX_TERRAIN_HEIGHT];
+	getDensities(x, minsY + 1, ni, z, n, densities);
+	for (int y = ni - 1; y >= minsY + 1; --y) {
+		if (densities[y] > _worldCtx.caveDensityThreshold) {
+			break;
+		}
+		--ni;
+	}
 	if (ni < minsY) {
 		return 0;
 	}
@@ -174,8 +280,7 @@ int WorldPager::fillVoxels(int x, int minsY, int z, voxel::Voxel* voxels) const
 	voxels[0] = dirt;
 	glm::ivec3 pos(x, 0, z);
 	for (int y = ni - 1; y >= minsY + 1; --y) {
-		const float density = getDensity(x, y, z, n);
-		if (density > _worldCtx.caveDensityThreshold) {
+		if (densities[y] > _worldCtx.caveDensityThreshold) {
 			const bool cave = y < ni - 1;
 			pos.y = y;
 			const voxel::Voxel& voxel = _biomeManager.getVoxel(pos, cave);
@@ -197,6 +302,7 @@ int WorldPager::fillVoxels(int x, int minsY, int z, voxel::Voxel* voxels) const
 }
 
 void WorldPager::placeTrees(voxel::PagedVolume::PagerContext& pagerCtx) {
+	core_trace_scoped(PlaceTrees);
 	// expand region to all surrounding regions by half of the region size.
 	// we do this to be able to limit the generation on the current chunk. Otherwise
 	// we would endlessly generate new chunks just because the trees overlap to
@@ -226,17 +332,40 @@ void WorldPager::placeTrees(voxel::PagedVolume::PagerContext& pagerCtx) {
 	// would have to loop over more regions.
 	core_assert(pagerCtx.region.getLowerY() == 0);
 	core_assert(pagerCtx.region.getUpperY() == voxel::MAX_HEIGHT);
-	voxel::PagedVolumeWrapper chunkWrapper(_volumeData, pagerCtx.chunk, pagerCtx.region);
 
 	const size_t regionsSize = lengthof(regions);
 
 	for (size_t i = 0; i < regionsSize; ++i) {
 		const voxel::Region& region = regions[i];
-		const std::vector<const char*>& treeTypes = _biomeManager.getTreeTypes(region);
-		if (treeTypes.empty()) {
+		const RegionTreesPtr& regionTreesPtr = regionTrees(region);
+		if (!regionTreesPtr->hasTreeTypes) {
 			Log::debug("No tree types given for region %s", region.toString().c_str());
 			return;
 		}
+		for (const RegionTrees::Tree& tree : regionTreesPtr->trees) {
+			if (!voxel::intersects(pagerCtx.region, tree.region)) {
+				continue;
+			}
+			const voxel::RawVolume* v = _volumeCache.loadTree(tree.pos, tree.type);
+			if (v == nullptr) {
+				continue;
+			}
+			addVolumeToPosition(pagerCtx.chunk.get(), pagerCtx.region, v, tree.axis, tree.region);
+		}
+	}
+}
+
+RegionTreesPtr WorldPager::regionTrees(const voxel::Region& region) {
+	const glm::ivec3& mins = region.getLowerCorner();
+	RegionTreesPtr cached = _treePlacementCache.get(mins.x, mins.z);
+	if (cached) {
+		return cached;
+	}
+	core_trace_scoped(RegionTrees);
+	RegionTreesPtr regionTreesPtr = core::make_shared<RegionTrees>();
+	const std::vector<const char*>& treeTypes = _biomeManager.getTreeTypes(region);
+	regionTreesPtr->hasTreeTypes = !treeTypes.empty();
+	if (regionTreesPtr->hasTreeTypes) {
 		std::vector<glm::vec2> positions;
 		math::Random random(_seed);
 		_biomeManager.getTreePositions(region, positions, random, 0);
@@ -245,10 +374,11 @@ void WorldPager::placeTrees(voxel::PagedVolume::PagerContext& pagerCtx) {
 		const math::Axis axes[] = {math::Axis::None, math::Axis::Y, math::Axis::Y, math::Axis::None, math::Axis::Y};
 		constexpr size_t axesSize = lengthof(axes);
 		int positionIndex = 0;
+		regionTreesPtr->trees.reserve(positions.size());
 		for (const glm::vec2& position : positions) {
 			++positionIndex;
 			glm::ivec3 treePos(position.x, 0, position.y);
-			treePos.y = terrainHeight(position.x, pagerCtx.region.getLowerY(), position.y);
+			treePos.y = terrainHeight(position.x, region.getLowerY(), position.y);
 			if (treePos.y <= voxel::MAX_WATER_HEIGHT) {
 				continue;
 			}
@@ -258,31 +388,47 @@ void WorldPager::placeTrees(voxel::PagedVolume::PagerContext& pagerCtx) {
 			if (v == nullptr) {
 				continue;
 			}
-			const voxelutil::RawVolumeRotateWrapper rotateWrapper(v, axes[positionIndex % axesSize]);
-			addVolumeToPosition(chunkWrapper, rotateWrapper, treePos);
+			const math::Axis axis = axes[positionIndex % axesSize];
+			voxel::Region bounds = voxelutil::RawVolumeRotateWrapper(v, axis).region();
+			bounds.shift(treePos.x, treePos.y, treePos.z);
+			regionTreesPtr->trees.push_back(RegionTrees::Tree{treePos, bounds, treeType, axis});
 		}
 	}
+	_treePlacementCache.put(mins.x, mins.z, regionTreesPtr);
+	return regionTreesPtr;
 }
 
-void WorldPager::addVolumeToPosition(voxel::PagedVolumeWrapper& target, const voxelutil::RawVolumeRotateWrapper& source, const glm::ivec3& pos) {
-	const voxel::Region& region = source.region();
-	const glm::ivec3& mins = region.getLowerCorner();
-	const glm::ivec3& maxs = region.getUpperCorner();
-	const voxel::Region& targetRegion = target.region();
-	for (int x = mins.x; x <= maxs.x; ++x) {
-		const int nx = pos.x + x;
+void WorldPager::addVolumeToPosition(voxel::PagedVolume::Chunk* chunk, const voxel::Region& chunkRegion, const voxel::RawVolume* source,
+		math::Axis axis, const voxel::Region& bounds) const {
+	core_trace_scoped(AddVolumeToPosition);
+	// only loop over the part of the tree that overlaps the chunk
+	const glm::ivec3 mins = glm::max(bounds.getLowerCorner(), chunkRegion.getLowerCorner());
+	const glm::ivec3 maxs = glm::min(bounds.getUpperCorner(), chunkRegion.getUpperCorner());
+	if (glm::any(glm::greaterThan(mins, maxs))) {
+		return;
+	}
+	// the strides of the rotated axes in the voxel data of the source volume - see RawVolumeRotateWrapper
+	const int32_t w = source->width();
+	const int32_t wh = w * source->height();
+	glm::ivec3 stride(1, w, wh);
+	if (axis == math::Axis::X) {
+		stride = glm::ivec3(1, wh, w);
+	} else if (axis == math::Axis::Y) {
+		stride = glm::ivec3(wh, w, 1);
+	} else if (axis == math::Axis::Z) {
+		stride = glm::ivec3(w, 1, wh);
+	}
+	const voxel::Voxel* data = (const voxel::Voxel*)source->data();
+	const glm::ivec3& boundsMins = bounds.getLowerCorner();
+	const glm::ivec3& chunkMins = chunkRegion.getLowerCorner();
+	for (int z = mins.z; z <= maxs.z; ++z) {
 		for (int y = mins.y; y <= maxs.y; ++y) {
-			const int ny = pos.y + y;
-			for (int z = mins.z; z <= maxs.z; ++z) {
-				const int nz = pos.z + z;
-				if (!targetRegion.containsPoint(nx, ny, nz)) {
-					continue;
-				}
-				const voxel::Voxel& voxel = source.voxel(x, y, z);
-				if (voxel::isAir(voxel.getMaterial())) {
+			const voxel::Voxel* row = data + (mins.x - boundsMins.x) * stride.x + (y - boundsMins.y) * stride.y + (z - boundsMins.z) * stride.z;
+			for (int x = mins.x; x <= maxs.x; ++x, row += stride.x) {
+				if (voxel::isAir(row->getMaterial())) {
 					continue;
 				}
-				target.setVoxel(nx, ny, nz, voxel);
+				chunk->setVoxel(x - chunkMins.x, y - chunkMins.y, z - chunkMins.z, *row);
 			}
 		}
 	}
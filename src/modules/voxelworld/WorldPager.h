@@ -14,7 +14,8 @@
 #include "core/SharedPtr.h"
 #include "ChunkPersister.h"
 #include "TreeVolumeCache.h"
-#include "voxelutil/RawVolumeRotateWrapper.h"
+#include "TreePlacementCache.h"
+#include "math/Axis.h"
 
 namespace voxel {
 class PagedVolumeWrapper;
@@ -32,28 +33,55 @@ namespace voxelworld {
 class WorldPager: public voxel::PagedVolume::Pager {
 private:
 	unsigned int _seed = 0l;
-	glm::vec2 _noiseSeedOffset;
+	glm::vec2 _noiseSeedOffset { 0.0f };
 
 	voxel::PagedVolume *_volumeData = nullptr;
 	BiomeManager _biomeManager;
 	WorldContext _worldCtx;
 	noise::Noise _noise;
 	TreeVolumeCache _volumeCache;
+	TreePlacementCache _treePlacementCache;
 	ChunkPersisterPtr _chunkPersister;
 
 	void createWorld(voxel::PagedVolumeWrapper& volume) const;
 	void placeTrees(voxel::PagedVolume::PagerContext& pagerCtx);
-	void addVolumeToPosition(voxel::PagedVolumeWrapper& target, const voxelutil::RawVolumeRotateWrapper& source, const glm::ivec3& pos);
+	/**
+	 * @brief Computes the tree placement of the given region or returns the cached one
+	 */
+	RegionTreesPtr regionTrees(const voxel::Region& region);
+	/**
+	 * @brief Copies the non air voxels of the rotated tree volume into the part of the chunk that it overlaps
+	 * @param[in] bounds The region of the rotated volume shifted to the world position of the tree
+	 */
+	void addVolumeToPosition(voxel::PagedVolume::Chunk* chunk, const voxel::Region& chunkRegion, const voxel::RawVolume* source,
+			math::Axis axis, const voxel::Region& bounds) const;
 
 	int terrainHeight(int x, int minsY, int z) const;
 	int terrainHeight(int x, int minsY, int z, float n) const;
-	int fillVoxels(int x, int minsY, int z, voxel::Voxel* voxels) const;
+	/**
+	 * @return The height of the terrain before the caves are carved into it
+	 */
+	int surfaceHeight(int x, int z, float n) const;
+	/**
+	 * @param n The noise value of the column - see @c getNoiseValue()
+	 */
+	int fillVoxels(int x, int minsY, int z, float n, voxel::Voxel* voxels) const;
 
 	/**
 	 * @return A float value between [0.0-1.0]
 	 */
 	float getNoiseValue(float x, float z) const;
+	/**
+	 * @brief Batched version of @c getNoiseValue() for the given columns
+	 */
+	void getNoiseValues(const float* x, const float* z, float* out, int amount) const;
+	float combineNoise(float landscapeNoise, float mountainNoise) const;
 	float getDensity(float x, float y, float z, float n) const;
+	/**
+	 * @brief Batched version of @c getDensity() for the heights [minY, maxY) of the given column
+	 * @param[out] densities Indexed by the height - only the given height range is written
+	 */
+	void getDensities(int x, int minY, int maxY, int z, float n, float* densities) const;
 
 public:
 	WorldPager(const voxelformat::VolumeCachePtr& volumeCache, const ChunkPersisterPtr& chunkPersister);
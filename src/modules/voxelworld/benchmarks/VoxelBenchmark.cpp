@@ -8,6 +8,7 @@
 #include "voxelworld/BiomeManager.h"
 #include "voxel/Constants.h"
 #include "voxelformat/VolumeCache.h"
+#include "core/StringUtil.h"
 
 class PagedVolumeBenchmark: public app::AbstractBenchmark {
 protected:
@@ -45,4 +46,70 @@ BENCHMARK_DEFINE_F(PagedVolumeBenchmark, pageIn) (benchmark::State& state) {
 
 BENCHMARK_REGISTER_F(PagedVolumeBenchmark, pageIn);
 
+/**
+ * @brief Generates the chunks of a square area - the items per second are the generated chunks per second
+ */
+BENCHMARK_DEFINE_F(PagedVolumeBenchmark, pageInArea) (benchmark::State& state) {
+	voxelworld::WorldPager pager(_volumeCache, std::make_shared<voxelworld::ChunkPersister>());
+	pager.setSeed(0l);
+	const int chunkSize = 256;
+	const int areaSize = 4;
+	voxel::PagedVolume volumeData(&pager, 1024 * 1024 * 1024, chunkSize);
+	const io::FilesystemPtr& filesystem = io::filesystem();
+	const core::String& luaParameters = filesystem->load("worldparams.lua");
+	const core::String& luaBiomes = filesystem->load("biomes.lua");
+	pager.init(&volumeData, luaParameters, luaBiomes);
+	int offset = 0;
+	for (auto _ : state) {
+		for (int z = 0; z < areaSize; ++z) {
+			for (int x = 0; x < areaSize; ++x) {
+				volumeData.voxel(chunkSize * (offset + x), 0, chunkSize * z);
+			}
+		}
+		offset += areaSize;
+	}
+	state.SetItemsProcessed(state.iterations() * areaSize * areaSize);
+}
+
+BENCHMARK_REGISTER_F(PagedVolumeBenchmark, pageInArea)->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Generates the chunks of a square area that is completely covered by a dense forest - the items per
+ * second are the generated chunks per second. The tree distance is given as argument.
+ */
+BENCHMARK_DEFINE_F(PagedVolumeBenchmark, pageInDenseForest) (benchmark::State& state) {
+	voxelworld::WorldPager pager(_volumeCache, std::make_shared<voxelworld::ChunkPersister>());
+	pager.setSeed(0l);
+	const int chunkSize = 256;
+	const int areaSize = 2;
+	voxel::PagedVolume volumeData(&pager, 1024 * 1024 * 1024, chunkSize);
+	const io::FilesystemPtr& filesystem = io::filesystem();
+	const core::String& luaParameters = filesystem->load("worldparams.lua");
+	const core::String& luaBiomes = core::string::format(R"(
+function initBiomes()
+  local forest = biomeMgr.addBiome(0, %i, 0.5, 0.5, "Grass", false, %i)
+  forest:addTree("pine")
+  forest:addTree("fir")
+  forest:addTree("deciduous")
+  biomeMgr.setDefault(forest)
+end
+function initCities()
+end
+)", voxel::MAX_HEIGHT, (int)state.range(0));
+	pager.init(&volumeData, luaParameters, luaBiomes);
+	int offset = 0;
+	for (auto _ : state) {
+		for (int z = 0; z < areaSize; ++z) {
+			for (int x = 0; x < areaSize; ++x) {
+				volumeData.voxel(chunkSize * (offset + x), 0, chunkSize * z);
+			}
+		}
+		offset += areaSize;
+	}
+	state.SetItemsProcessed(state.iterations() * areaSize * areaSize);
+	pager.shutdown();
+}
+
+BENCHMARK_REGISTER_F(PagedVolumeBenchmark, pageInDenseForest)->Arg(12)->Arg(6)->Unit(benchmark::kMillisecond);
+
 BENCHMARK_MAIN();
@@ -3,20 +3,222 @@
  */
 
 #include "voxelworld/FilePersister.h"
+#include "voxelworld/RegionFile.h"
+#include "io/Filesystem.h"
+#include "core/StringUtil.h"
+#include "core/Log.h"
+#include "core/Enum.h"
+#include <SDL_timer.h>
+#include <vector>
 
 #include "AbstractVoxelTest.h"
 
 namespace voxelworld {
 
 class WorldPersisterTest: public AbstractVoxelTest {
+protected:
+	/**
+	 * @brief Removes the files of previous test runs
+	 */
+	void removeRegion(unsigned int seed, const glm::ivec3& regionPos = glm::ivec3(0)) {
+		const io::FilesystemPtr& filesystem = io::filesystem();
+		const core::String& name = core::string::format("world_%u_%i_%i_%i.wrg", seed, regionPos.x, regionPos.y, regionPos.z);
+		filesystem->removeFile(filesystem->writePath(name.c_str()));
+	}
+
+	voxel::PagedVolume::ChunkPtr chunk(const glm::ivec3& chunkPos) {
+		return _volData.chunk(chunkPos * 64);
+	}
+
+	voxel::PagedVolume::ChunkPtr emptyChunk(const glm::ivec3& chunkPos) {
+		return core::make_shared<voxel::PagedVolume::Chunk>(chunkPos, 64, &_pager);
+	}
+
+	static bool equal(const voxel::PagedVolume::ChunkPtr& a, const voxel::PagedVolume::ChunkPtr& b) {
+		return a->dataSizeInBytes() == b->dataSizeInBytes() && SDL_memcmp(a->data(), b->data(), a->dataSizeInBytes()) == 0;
+	}
+
+	void saveLoad(ChunkCodecType codecType) {
+		const unsigned int seed = 100u + core::enumVal(codecType);
+		removeRegion(seed);
+		FilePersister persister;
+		persister.setCodec(codecType);
+		const voxel::PagedVolume::ChunkPtr& original = _ctx.chunk();
+		ASSERT_TRUE(persister.save(original, seed)) << "Could not save volume chunk";
+		const voxel::PagedVolume::ChunkPtr& loaded = emptyChunk(original->chunkPos());
+		ASSERT_TRUE(persister.load(loaded, seed)) << "Could not load volume chunk";
+		EXPECT_TRUE(equal(original, loaded));
+		persister.shutdown();
+	}
 };
 
 TEST_F(WorldPersisterTest, testSaveLoad) {
+	removeRegion(_seed);
 	FilePersister persister;
 	ASSERT_TRUE(persister.save(_ctx.chunk(), _seed)) << "Could not save volume chunk";
 	_volData.flushAll();
 	ASSERT_TRUE(persister.load(_ctx.chunk(), _seed)) << "Could not load volume chunk";
 	ASSERT_EQ(voxel::VoxelType::Grass, _volData.voxel(32, 32, 32).getMaterial());
+	persister.shutdown();
+}
+
+TEST_F(WorldPersisterTest, testSaveLoadZip) {
+	saveLoad(ChunkCodecType::Zip);
+}
+
+TEST_F(WorldPersisterTest, testSaveLoadLZ4) {
+	saveLoad(ChunkCodecType::LZ4);
+}
+
+TEST_F(WorldPersisterTest, testSaveLoadRLELZ4) {
+	saveLoad(ChunkCodecType::RLELZ4);
+}
+
+TEST_F(WorldPersisterTest, testLoadVersion2) {
+	const voxel::PagedVolume::ChunkPtr& original = _ctx.chunk();
+	// the format that was written before the chunk codecs were introduced
+	core::ByteStream bs;
+	bs.addInt((int32_t)original->dataSizeInBytes());
+	bs.addByte(2);
+	const uint32_t bufSize = core::zip::compressBound(original->dataSizeInBytes());
+	uint8_t* buf = new uint8_t[bufSize];
+	size_t compressedSize = 0;
+	ASSERT_TRUE(core::zip::compress((const uint8_t*)original->data(), original->dataSizeInBytes(), buf, bufSize, &compressedSize));
+	bs.append(buf, compressedSize);
+	delete[] buf;
+
+	FilePersister persister;
+	const voxel::PagedVolume::ChunkPtr& loaded = emptyChunk(original->chunkPos());
+	ASSERT_TRUE(persister.loadCompressed(loaded, bs.getBuffer(), bs.getSize()));
+	EXPECT_TRUE(equal(original, loaded));
+}
+
+TEST_F(WorldPersisterTest, testRegion) {
+	const unsigned int seed = 200u;
+	removeRegion(seed);
+	removeRegion(seed, glm::ivec3(-1, 0, 0));
+	FilePersister persister;
+	for (int x = -2; x < 2; ++x) {
+		ASSERT_TRUE(persister.save(chunk(glm::ivec3(x, 0, 1)), seed));
+	}
+	persister.shutdown();
+
+	for (int x = -2; x < 2; ++x) {
+		const voxel::PagedVolume::ChunkPtr& original = chunk(glm::ivec3(x, 0, 1));
+		const voxel::PagedVolume::ChunkPtr& loaded = emptyChunk(original->chunkPos());
+		ASSERT_TRUE(persister.load(loaded, seed)) << "Could not load chunk " << x;
+		EXPECT_TRUE(equal(original, loaded));
+	}
+	// not saved
+	EXPECT_FALSE(persister.load(emptyChunk(glm::ivec3(3, 0, 1)), seed));
+
+	const voxel::Region region(glm::ivec3(0, 0, 64), glm::ivec3(63, 63, 127));
+	persister.erase(region, seed);
+	EXPECT_FALSE(persister.load(emptyChunk(glm::ivec3(0, 0, 1)), seed));
+	EXPECT_TRUE(persister.load(emptyChunk(glm::ivec3(1, 0, 1)), seed));
+	persister.shutdown();
+}
+
+TEST_F(WorldPersisterTest, testRegionEviction) {
+	// every seed has its own region file - more than the persister keeps open
+	const unsigned int seeds = 40u;
+	FilePersister persister;
+	const voxel::PagedVolume::ChunkPtr& original = _ctx.chunk();
+	for (unsigned int i = 0u; i < seeds; ++i) {
+		removeRegion(400u + i);
+		ASSERT_TRUE(persister.save(original, 400u + i)) << "Could not save chunk for seed " << 400u + i;
+	}
+	for (unsigned int i = 0u; i < seeds; ++i) {
+		const voxel::PagedVolume::ChunkPtr& loaded = emptyChunk(original->chunkPos());
+		ASSERT_TRUE(persister.load(loaded, 400u + i)) << "Could not load chunk for seed " << 400u + i;
+		EXPECT_TRUE(equal(original, loaded));
+	}
+	persister.shutdown();
+	for (unsigned int i = 0u; i < seeds; ++i) {
+		removeRegion(400u + i);
+	}
+}
+
+TEST_F(WorldPersisterTest, testRegionCompact) {
+	const core::String& path = io::filesystem()->writePath("regionfiletest.wrg");
+	io::filesystem()->removeFile(path);
+	RegionFile regionFile(path);
+	ASSERT_TRUE(regionFile.open());
+	// the chunk data is aligned to 16 bytes
+	uint8_t first[32];
+	uint8_t second[16];
+	for (int i = 0; i < (int)sizeof(first); ++i) {
+		first[i] = (uint8_t)i;
+	}
+	for (int i = 0; i < (int)sizeof(second); ++i) {
+		second[i] = (uint8_t)(255 - i);
+	}
+	ASSERT_TRUE(regionFile.write(glm::ivec3(1, 2, 3), first, sizeof(first)));
+	ASSERT_TRUE(regionFile.write(glm::ivec3(-1, -2, -3), second, sizeof(second)));
+	EXPECT_EQ(0u, regionFile.garbageBytes());
+	ASSERT_TRUE(regionFile.write(glm::ivec3(1, 2, 3), second, sizeof(second)));
+	EXPECT_EQ(sizeof(first), regionFile.garbageBytes());
+	ASSERT_TRUE(regionFile.erase(glm::ivec3(-1, -2, -3)));
+	EXPECT_EQ(sizeof(first) + sizeof(second), regionFile.garbageBytes());
+	const uint32_t fileSize = regionFile.fileSize();
+
+	ASSERT_TRUE(regionFile.compact());
+	EXPECT_EQ(0u, regionFile.garbageBytes());
+	EXPECT_LT(regionFile.fileSize(), fileSize);
+	std::vector<uint8_t> buf;
+	ASSERT_TRUE(regionFile.read(glm::ivec3(1, 2, 3), buf));
+	ASSERT_EQ(sizeof(second), buf.size());
+	EXPECT_EQ(0, SDL_memcmp(second, buf.data(), buf.size()));
+	EXPECT_FALSE(regionFile.read(glm::ivec3(-1, -2, -3), buf));
+	regionFile.close();
+
+	// reopen and check the persisted offset table
+	RegionFile reopened(path);
+	ASSERT_TRUE(reopened.open());
+	EXPECT_TRUE(reopened.contains(glm::ivec3(1, 2, 3)));
+	EXPECT_FALSE(reopened.contains(glm::ivec3(-1, -2, -3)));
+	ASSERT_TRUE(reopened.read(glm::ivec3(1, 2, 3), buf));
+	EXPECT_EQ(0, SDL_memcmp(second, buf.data(), buf.size()));
+	reopened.close();
+	io::filesystem()->removeFile(path);
+}
+
+/**
+ * @brief Logs the load and save throughput of the codecs for a full region.
+ */
+TEST_F(WorldPersisterTest, testThroughput) {
+	const int chunks = 16;
+	for (int c = 0; c < core::enumVal(ChunkCodecType::Max); ++c) {
+		const ChunkCodecType codecType = (ChunkCodecType)c;
+		const unsigned int seed = 300u + c;
+		removeRegion(seed);
+		FilePersister persister;
+		persister.setCodec(codecType);
+		const uint64_t saveStart = SDL_GetPerformanceCounter();
+		for (int i = 0; i < chunks; ++i) {
+			ASSERT_TRUE(persister.save(chunk(glm::ivec3(i % 4, 0, i / 4)), seed));
+		}
+		const uint64_t saveEnd = SDL_GetPerformanceCounter();
+		persister.shutdown();
+
+		std::vector<voxel::PagedVolume::ChunkPtr> loaded;
+		for (int i = 0; i < chunks; ++i) {
+			loaded.push_back(emptyChunk(glm::ivec3(i % 4, 0, i / 4)));
+		}
+		const uint64_t loadStart = SDL_GetPerformanceCounter();
+		for (int i = 0; i < chunks; ++i) {
+			ASSERT_TRUE(persister.load(loaded[i], seed));
+		}
+		const uint64_t loadEnd = SDL_GetPerformanceCounter();
+		persister.shutdown();
+
+		const double frequency = (double)SDL_GetPerformanceFrequency();
+		const double megaBytes = (double)chunks * loaded[0]->dataSizeInBytes() / (1024.0 * 1024.0);
+		const double saveSeconds = (double)(saveEnd - saveStart) / frequency;
+		const double loadSeconds = (double)(loadEnd - loadStart) / frequency;
+		Log::info("codec %i: save %.1f MB/s, load %.1f MB/s", c, megaBytes / saveSeconds, megaBytes / loadSeconds);
+		removeRegion(seed);
+	}
 }
 
 }
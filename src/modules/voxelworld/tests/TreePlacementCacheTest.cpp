@@ -0,0 +1,59 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxelworld/TreePlacementCache.h"
+
+namespace voxelworld {
+
+class TreePlacementCacheTest: public app::AbstractTest {
+protected:
+	RegionTreesPtr create(int amount) {
+		RegionTreesPtr trees = core::make_shared<RegionTrees>();
+		trees->hasTreeTypes = true;
+		for (int i = 0; i < amount; ++i) {
+			const glm::ivec3 pos(i, 0, i);
+			trees->trees.push_back(RegionTrees::Tree{pos, voxel::Region(pos, pos), "pine", math::Axis::None});
+		}
+		return trees;
+	}
+};
+
+TEST_F(TreePlacementCacheTest, testGetPut) {
+	TreePlacementCache cache;
+	EXPECT_FALSE(cache.get(0, 0));
+	cache.put(0, 0, create(1));
+	cache.put(-256, 256, create(2));
+	ASSERT_TRUE(cache.get(0, 0));
+	EXPECT_EQ(1u, cache.get(0, 0)->trees.size());
+	ASSERT_TRUE(cache.get(-256, 256));
+	EXPECT_EQ(2u, cache.get(-256, 256)->trees.size());
+	EXPECT_FALSE(cache.get(256, -256)) << "The region coordinates must not be mixed up";
+	EXPECT_EQ(2u, cache.size());
+}
+
+TEST_F(TreePlacementCacheTest, testEvictLeastRecentlyUsed) {
+	TreePlacementCache cache(2u);
+	cache.put(0, 0, create(1));
+	cache.put(0, 256, create(1));
+	// touch the first region - so the second one is the least recently used one
+	EXPECT_TRUE(cache.get(0, 0));
+	cache.put(0, 512, create(1));
+	EXPECT_EQ(2u, cache.size());
+	EXPECT_TRUE(cache.get(0, 0));
+	EXPECT_FALSE(cache.get(0, 256));
+	EXPECT_TRUE(cache.get(0, 512));
+}
+
+TEST_F(TreePlacementCacheTest, testClear) {
+	TreePlacementCache cache;
+	const RegionTreesPtr& trees = create(3);
+	cache.put(0, 0, trees);
+	cache.clear();
+	EXPECT_EQ(0u, cache.size());
+	EXPECT_FALSE(cache.get(0, 0));
+	EXPECT_EQ(3u, trees->trees.size()) << "Handed out placements must stay valid";
+}
+
+}
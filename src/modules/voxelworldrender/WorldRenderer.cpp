@@ -522,6 +522,13 @@ void WorldRenderer::extractMesh(const glm::ivec3 &pos) {
 	_worldChunkMgr.extractMesh(pos);
 }
 
+void WorldRenderer::markDirty(const glm::ivec3 &pos) {
+	if (_cancelThreads) {
+		return;
+	}
+	_worldChunkMgr.markDirty(pos);
+}
+
 void WorldRenderer::extractMeshes(const video::Camera &camera) {
 	if (_cancelThreads) {
 		return;
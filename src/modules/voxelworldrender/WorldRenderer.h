@@ -130,6 +130,10 @@ public:
 
 	void extractMesh(const glm::ivec3 &pos);
 	void extractMeshes(const video::Camera &camera);
+	/**
+	 * @brief Call this after a voxel was modified to update the extracted meshes around it
+	 */
+	void markDirty(const glm::ivec3 &pos);
 
 	float getViewDistance() const;
 	void setViewDistance(float viewDistance);
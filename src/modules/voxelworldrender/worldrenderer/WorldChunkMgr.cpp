@@ -70,12 +70,30 @@ void WorldChunkMgr::handleMeshQueue() {
 		}
 	}
 
+	if (mesh.isEmpty()) {
+		// all faces of the tile were removed - free the buffers of the old geometry
+		if (freeChunkBuffer != nullptr && freeChunkBuffer->inuse) {
+			_octree.remove(freeChunkBuffer);
+			freeChunkBuffer->reset();
+		}
+		return;
+	}
+
 	if (freeChunkBuffer == nullptr) {
 		Log::warn("Could not find free chunk buffer slot");
 		return;
 	}
 
 	video::Buffer& buffer = freeChunkBuffer->_buffer;
+	const voxel::VertexArray& vertices = mesh.getVertexVector();
+	const uint8_t* indices = mesh.compressedIndices();
+	if (freeChunkBuffer->inuse && freeChunkBuffer->_vbo != -1 && freeChunkBuffer->_ibo != -1) {
+		// a modified mesh - just replace the data of the existing buffers
+		freeChunkBuffer->_compressedIndexSize = mesh.compressedIndexSize();
+		buffer.update(freeChunkBuffer->_vbo, &vertices.front(), vertices.size() * sizeof(voxel::VertexArray::value_type));
+		buffer.update(freeChunkBuffer->_ibo, indices, mesh.getNoOfIndices() * freeChunkBuffer->_compressedIndexSize);
+		return;
+	}
 	freeChunkBuffer->_vbo = buffer.create();
 	if (freeChunkBuffer->_vbo == -1) {
 		Log::error("Failed to create vertex buffer");
@@ -100,8 +118,6 @@ void WorldChunkMgr::handleMeshQueue() {
 	}
 	freeChunkBuffer->_compressedIndexSize = mesh.compressedIndexSize();
 
-	const voxel::VertexArray& vertices = mesh.getVertexVector();
-	const uint8_t* indices = mesh.compressedIndices();
 	buffer.update(freeChunkBuffer->_vbo, &vertices.front(), vertices.size() * sizeof(voxel::VertexArray::value_type));
 	buffer.update(freeChunkBuffer->_ibo, indices, mesh.getNoOfIndices() * freeChunkBuffer->_compressedIndexSize);
 
@@ -120,6 +136,7 @@ void WorldChunkMgr::update(double deltaFrameSeconds, const video::Camera &camera
 	handleMeshQueue();
 
 	_meshExtractor.updateExtractionOrder(focusPos);
+	_meshExtractor.scheduleWaitingExtractions();
 	for (ChunkBuffer& chunkBuffer : _chunkBuffers) {
 		if (!chunkBuffer.inuse) {
 			continue;
@@ -193,6 +210,10 @@ void WorldChunkMgr::extractMesh(const glm::ivec3& pos) {
 	_meshExtractor.scheduleMeshExtraction(pos);
 }
 
+void WorldChunkMgr::markDirty(const glm::ivec3& pos) {
+	_meshExtractor.markDirty(pos);
+}
+
 int WorldChunkMgr::renderTerrain() {
 	video_trace_scoped(WorldChunkMgrRenderTerrain);
 	int drawCalls = 0;
@@ -76,6 +76,7 @@ public:
 
 	void extractMesh(const glm::ivec3 &pos);
 	void extractMeshes(const video::Camera &camera);
+	void markDirty(const glm::ivec3 &pos);
 	void extractScheduledMesh();
 
 	void update(double deltaFrameSeconds, const video::Camera &camera, const glm::vec3& focusPos);
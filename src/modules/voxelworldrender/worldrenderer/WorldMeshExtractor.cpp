@@ -4,9 +4,12 @@
 
 #include "WorldMeshExtractor.h"
 #include "core/concurrent/Concurrency.h"
+#include "voxel/BinaryGreedyMesher.h"
 #include "voxel/CubicSurfaceExtractor.h"
 #include "voxel/IsQuadNeeded.h"
 #include "voxel/Constants.h"
+#include "core/ArrayLength.h"
+#include <algorithm>
 
 namespace voxelworldrender {
 
@@ -16,16 +19,28 @@ WorldMeshExtractor::WorldMeshExtractor() {
 bool WorldMeshExtractor::init(voxel::PagedVolume *volume) {
 	_volume = volume;
 	_meshSize = core::Var::getSafe(cfg::VoxelMeshSize);
+	_binaryGreedy = core::Var::get(cfg::VoxelMeshBinaryGreedy, "true", -1, "Use the binary greedy mesher for the world meshes");
+	_abortExtraction = false;
+	_pendingExtraction.reset();
+	_pendingExtraction.setBucketFunc(DistanceRing(_pendingExtractionSortPosition, _meshSize->intVal()));
 	return true;
 }
 
 void WorldMeshExtractor::shutdown() {
+	_abortExtraction = true;
 	_pendingExtraction.clear();
 	_pendingExtraction.abortWait();
 	_extracted.clear();
-	_extracted.abortWait();
+	notifyExtracted();
 	_positionsExtracted.clear();
-	_extracted.clear();
+	{
+		core::ScopedLock lock(_waitingForChunksLock);
+		_waitingForChunks.clear();
+	}
+	{
+		core::ScopedLock lock(_brickMeshCachesLock);
+		_brickMeshCaches.clear();
+	}
 	_volume = nullptr;
 }
 
@@ -34,13 +49,32 @@ void WorldMeshExtractor::reset() {
 		_volume->flushAll();
 	}
 	_extracted.clear();
+	notifyExtracted();
 	_positionsExtracted.clear();
 	_pendingExtraction.clear();
+	{
+		core::ScopedLock lock(_brickMeshCachesLock);
+		_brickMeshCaches.clear();
+	}
+	core::ScopedLock lock(_waitingForChunksLock);
+	_waitingForChunks.clear();
 }
 
 bool WorldMeshExtractor::pop(voxel::Mesh& item) {
 	core_trace_value_scoped(QueryNewMesh, _positionsExtracted.size());
-	return _extracted.pop(item);
+	if (!_extracted.pop(item)) {
+		return false;
+	}
+	notifyExtracted();
+	return true;
+}
+
+void WorldMeshExtractor::notifyExtracted() {
+	// the waiting threads announce themselves before they try to push again
+	if (_waitingForSlot > 0) {
+		core::ScopedLock lock(_extractedLock);
+		_extractedCondition.notify_all();
+	}
 }
 
 glm::ivec3 WorldMeshExtractor::meshPos(const glm::ivec3& pos) const {
@@ -51,6 +85,20 @@ glm::ivec3 WorldMeshExtractor::meshPos(const glm::ivec3& pos) const {
 	return glm::ivec3(x * size.x, y * size.y, z * size.z);
 }
 
+voxel::Region WorldMeshExtractor::extractionRegion(const glm::ivec3& pos) const {
+	const glm::ivec3& size = meshSize();
+	const glm::ivec3 mins(pos);
+	const glm::ivec3 maxs(pos.x + size.x - 1, pos.y + size.y - 2, pos.z + size.z - 1);
+	return voxel::Region(mins, maxs);
+}
+
+bool WorldMeshExtractor::prefetch(const voxel::Region& region) const {
+	// the extractor also looks at the neighbouring voxels of the region
+	voxel::Region neededRegion(region);
+	neededRegion.grow(1);
+	return _volume->prefetch(neededRegion);
+}
+
 glm::ivec3 WorldMeshExtractor::meshSize() const {
 	const int s = _meshSize->intVal();
 	return glm::ivec3(s, voxel::MAX_MESH_CHUNK_HEIGHT, s);
@@ -64,14 +112,65 @@ void WorldMeshExtractor::updateExtractionOrder(const glm::ivec3& sortPos) {
 		return;
 	}
 	_pendingExtractionSortPosition = sortPos;
-	_pendingExtraction.setComparator(CloseToPoint(sortPos));
+	_pendingExtraction.setBucketFunc(DistanceRing(sortPos, _meshSize->intVal()));
+}
+
+void WorldMeshExtractor::scheduleWaitingExtractions() {
+	core::ScopedLock lock(_waitingForChunksLock);
+	if (_waitingForChunks.empty()) {
+		return;
+	}
+	core_trace_value_scoped(ScheduleWaitingExtractions, _waitingForChunks.size());
+	for (auto i = _waitingForChunks.begin(); i != _waitingForChunks.end();) {
+		if (!prefetch(extractionRegion(*i))) {
+			++i;
+			continue;
+		}
+		_pendingExtraction.push(*i);
+		i = _waitingForChunks.erase(i);
+	}
 }
 
 bool WorldMeshExtractor::allowReExtraction(const glm::ivec3& pos) {
 	const glm::ivec3& gridPos = meshPos(pos);
+	{
+		core::ScopedLock lock(_brickMeshCachesLock);
+		_brickMeshCaches.erase(gridPos);
+	}
 	return _positionsExtracted.erase(gridPos) != 0;
 }
 
+bool WorldMeshExtractor::markDirty(const glm::ivec3& pos) {
+	// a voxel on the border of a tile also influences the faces of the neighbouring tiles
+	glm::ivec3 tiles[8];
+	int tileCount = 0;
+	for (int i = 0; i < lengthof(tiles); ++i) {
+		const glm::ivec3 neighbour(pos.x + (i & 1 ? 1 : -1), pos.y + (i & 2 ? 1 : -1), pos.z + (i & 4 ? 1 : -1));
+		const glm::ivec3& tile = meshPos(neighbour);
+		if (std::find(tiles, tiles + tileCount, tile) == tiles + tileCount) {
+			tiles[tileCount++] = tile;
+		}
+	}
+	bool dirty = false;
+	for (int i = 0; i < tileCount; ++i) {
+		voxel::BrickMeshCachePtr cache;
+		{
+			core::ScopedLock lock(_brickMeshCachesLock);
+			auto iter = _brickMeshCaches.find(tiles[i]);
+			if (iter == _brickMeshCaches.end()) {
+				continue;
+			}
+			cache = iter->second;
+		}
+		if (!cache->markDirty(pos)) {
+			continue;
+		}
+		_pendingExtraction.push(tiles[i]);
+		dirty = true;
+	}
+	return dirty;
+}
+
 // Extract the surface for the specified region of the volume.
 // The surface extractor outputs the mesh in an efficient compressed format which
 // is not directly suitable for rendering.
@@ -83,29 +182,72 @@ bool WorldMeshExtractor::scheduleMeshExtraction(const glm::ivec3& p) {
 	}
 	Log::trace("mesh extraction for %i:%i:%i (%i:%i:%i)",
 			p.x, p.y, p.z, pos.x, pos.y, pos.z);
+	// start to page in the chunks while the extraction is still queued
+	prefetch(extractionRegion(pos));
 	_pendingExtraction.push(pos);
 	return true;
 }
 
+voxel::BrickMeshCachePtr WorldMeshExtractor::brickMeshCache(const glm::ivec3& pos) {
+	core::ScopedLock lock(_brickMeshCachesLock);
+	auto iter = _brickMeshCaches.find(pos);
+	if (iter != _brickMeshCaches.end()) {
+		return iter->second;
+	}
+	const voxel::BrickMeshCachePtr& cache = core::make_shared<voxel::BrickMeshCache>(extractionRegion(pos));
+	_brickMeshCaches.insert(std::make_pair(pos, cache));
+	return cache;
+}
+
+void WorldMeshExtractor::extractBrick(const voxel::Region& region, voxel::Mesh* mesh) {
+	if (_binaryGreedy->boolVal()) {
+		voxel::extractBinaryGreedyMesh(_volume, region, mesh, region.getLowerCorner());
+	} else {
+		voxel::extractCubicMesh(_volume, region, mesh, voxel::IsQuadNeeded(), region.getLowerCorner());
+	}
+}
+
 void WorldMeshExtractor::extractScheduledMesh() {
 	decltype(_pendingExtraction)::Key pos;
 	if (!_pendingExtraction.waitAndPop(pos)) {
 		return;
 	}
+	const voxel::Region& region = extractionRegion(pos);
+	if (!prefetch(region)) {
+		// don't block this thread until the chunks are paged in - try again once they are available
+		core::ScopedLock lock(_waitingForChunksLock);
+		_waitingForChunks.push_back(pos);
+		return;
+	}
 	core_trace_scoped(MeshExtraction);
-	const glm::ivec3& size = meshSize();
-	const glm::ivec3 mins(pos);
-	const glm::ivec3 maxs(pos.x + size.x - 1, pos.y + size.y - 2, pos.z + size.z - 1);
-	const voxel::Region region(mins, maxs);
+	const voxel::BrickMeshCachePtr& cache = brickMeshCache(pos);
+	const int extractedBricks = cache->update([this] (const voxel::Region& brickRegion, voxel::Mesh* brickMesh) {
+		extractBrick(brickRegion, brickMesh);
+	});
+	if (extractedBricks == 0) {
+		// nothing was modified since the last extraction
+		return;
+	}
 	// these numbers are made up mostly by try-and-error - we need to revisit them from time to time to prevent extra mem allocs
 	// they also heavily depend on the size of the mesh region we extract
 	const int factor = 64;
 	const int vertices = region.getWidthInVoxels() * region.getDepthInVoxels() * factor;
 	voxel::Mesh mesh(vertices, vertices);
-	voxel::extractCubicMesh(_volume, region, &mesh, voxel::IsQuadNeeded(), region.getLowerCorner());
-	if (!mesh.isEmpty()) {
-		_extracted.push(std::move(mesh));
+	if (!cache->concatenate(&mesh)) {
+		// the tile doesn't have any faces - and didn't have any before
+		return;
+	}
+	if (_extracted.push(std::move(mesh))) {
+		return;
 	}
+	// the main thread didn't catch up with uploading the meshes - wait for a free slot
+	core_trace_scoped(WaitForExtractedSlot);
+	core::ScopedLock lock(_extractedLock);
+	_waitingForSlot.increment();
+	_extractedCondition.wait(_extractedLock, [&] () {
+		return _abortExtraction || _extracted.push(std::move(mesh));
+	});
+	_waitingForSlot.decrement();
 }
 
 }
\ No newline at end of file
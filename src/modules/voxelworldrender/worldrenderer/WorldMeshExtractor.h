@@ -7,42 +7,80 @@
 #include "voxel/Mesh.h"
 #include "core/concurrent/ThreadPool.h"
 #include "core/Var.h"
-#include "core/collection/ConcurrentQueue.h"
+#include "core/collection/BucketedPriorityQueue.h"
+#include "core/collection/MPMCQueue.h"
 #include "voxel/PagedVolume.h"
+#include "voxel/BrickMeshCache.h"
 #include "core/concurrent/Atomic.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/concurrent/Lock.h"
+#include "core/Trace.h"
 
 #include <unordered_set>
+#include <unordered_map>
+#include <vector>
 #include <glm/vec3.hpp>
+#include <glm/common.hpp>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/hash.hpp>
 
 namespace voxelworldrender {
 
 typedef std::unordered_set<glm::ivec3, std::hash<glm::ivec3> > PositionSet;
+typedef std::unordered_map<glm::ivec3, voxel::BrickMeshCachePtr, std::hash<glm::ivec3> > BrickMeshCacheMap;
 
 class WorldMeshExtractor {
 private:
-	core::ConcurrentQueue<voxel::Mesh> _extracted;
+	// handoff of the extracted meshes from the extraction threads to the main thread
+	core::MPMCQueue<voxel::Mesh> _extracted { 64 };
+	// the extraction threads that wait for a free slot in the handoff queue
+	core::AtomicInt _waitingForSlot { 0 };
+	core_trace_mutex(core::Lock, _extractedLock, "ExtractedMeshes");
+	core::ConditionVariable _extractedCondition;
+	core::AtomicBool _abortExtraction { false };
 	glm::ivec3 _pendingExtractionSortPosition { 0, 0, 0 };
-	struct CloseToPoint {
+	/**
+	 * @brief Maps a mesh tile position to the ring of mesh tiles around the sort position it is part of
+	 */
+	struct DistanceRing {
 		glm::ivec2 _refPoint;
-		CloseToPoint(const glm::ivec3& refPoint) : _refPoint(refPoint.x, refPoint.z) {
+		int _ringSize;
+		DistanceRing(const glm::ivec3& refPoint = glm::ivec3(0), int ringSize = 1) :
+				_refPoint(refPoint.x, refPoint.z), _ringSize(ringSize) {
 		}
-		inline int distanceToSortPos(const glm::ivec3 &pos) const {
-			const glm::ivec2 d(_refPoint.x - pos.x, _refPoint.y - pos.z);
-			return d.x * d.x + d.y * d.y;
-		}
-		inline bool operator()(const glm::ivec3& lhs, const glm::ivec3& rhs) const {
-			return distanceToSortPos(lhs) > distanceToSortPos(rhs);
+		inline int operator()(const glm::ivec3& pos) const {
+			const int dx = glm::abs(_refPoint.x - pos.x);
+			const int dz = glm::abs(_refPoint.y - pos.z);
+			return glm::max(dx, dz) / _ringSize;
 		}
 	};
 
-	core::ConcurrentQueue<glm::ivec3, CloseToPoint> _pendingExtraction { CloseToPoint(_pendingExtractionSortPosition) };
+	core::BucketedPriorityQueue<glm::ivec3, DistanceRing> _pendingExtraction;
 	// fast lookup for positions that are already extracted
 	PositionSet _positionsExtracted;
+	// positions that are waiting for the volume to page in the needed chunks
+	std::vector<glm::ivec3> _waitingForChunks;
+	core_trace_mutex(core::Lock, _waitingForChunksLock, "WaitingForChunks");
+	// the brick meshes of the extracted tiles - a voxel modification only extracts the affected bricks again
+	BrickMeshCacheMap _brickMeshCaches;
+	core_trace_mutex(core::Lock, _brickMeshCachesLock, "BrickMeshCaches");
 	core::VarPtr _meshSize;
+	core::VarPtr _binaryGreedy;
 	voxel::PagedVolume *_volume = nullptr;
 
+	voxel::Region extractionRegion(const glm::ivec3& pos) const;
+	/**
+	 * @return @c true if all chunks that are needed to extract the given region are available, @c false
+	 * if they are still paged in by the volume.
+	 */
+	bool prefetch(const voxel::Region& region) const;
+	voxel::BrickMeshCachePtr brickMeshCache(const glm::ivec3& pos);
+	void extractBrick(const voxel::Region& region, voxel::Mesh* mesh);
+	/**
+	 * @brief Wakes up the extraction threads that wait for a free slot in the handoff queue
+	 */
+	void notifyExtracted();
+
 public:
 	WorldMeshExtractor();
 
@@ -54,6 +92,13 @@ public:
 	 */
 	bool pop(voxel::Mesh& item);
 
+	/**
+	 * @brief Schedules the re-extraction of the parts of the already extracted meshes that depend on the given voxel
+	 * @param[in] pos The world position of the modified voxel
+	 * @return @c true if at least one extracted mesh is affected by the modification
+	 */
+	bool markDirty(const glm::ivec3& pos);
+
 	/**
 	 * @brief If you don't need an extracted mesh anymore, make sure to allow the reextraction at a later time.
 	 * @param[in] pos A world position vector that is automatically converted into a mesh tile vector
@@ -66,6 +111,11 @@ public:
 	 */
 	void updateExtractionOrder(const glm::ivec3& sortPos);
 
+	/**
+	 * @brief Re-schedules the extractions that were postponed because the chunks of the volume weren't available yet
+	 */
+	void scheduleWaitingExtractions();
+
 	/**
 	 * @brief Performs async mesh extraction. You need to call @c pop in order to see if some extraction is ready.
 	 *
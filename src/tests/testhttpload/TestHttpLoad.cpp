@@ -0,0 +1,345 @@
+/**
+ * @file
+ */
+
+#include "TestHttpLoad.h"
+#include "testcore/TestAppMain.h"
+#include "http/Network.h"
+#include "http/Network.cpp.h"
+#include "core/Log.h"
+#include "core/StringUtil.h"
+#include <SDL_stdinc.h>
+#include <algorithm>
+#include <string.h>
+#ifndef __WINDOWS__
+#include <sys/resource.h>
+#endif
+
+/** the max amount of connections that are connecting at the same time - to not overflow the listen backlog */
+static constexpr int MaxPendingConnects = 256;
+static constexpr int MaxPipeline = 64;
+static constexpr size_t ReceiveSpace = 4096u;
+
+struct TestHttpLoad::Connection {
+	uv_tcp_t handle;
+	uv_connect_t connectReq;
+	TestHttpLoad *app = nullptr;
+	char *buf = nullptr;
+	size_t capacity = 0u;
+	size_t end = 0u;
+	/** ring buffer with the send timestamps of the requests that are not yet answered */
+	uint64_t sent[MaxPipeline];
+	uint32_t sentHead = 0u;
+	uint32_t sentTail = 0u;
+	bool initialized = false;
+	bool closing = false;
+};
+
+TestHttpLoad::TestHttpLoad(const metric::MetricPtr& metric, const io::FilesystemPtr& filesystem, const core::EventBusPtr& eventBus, const core::TimeProviderPtr& timeProvider) :
+		Super(metric, filesystem, eventBus, timeProvider), _server(metric) {
+	init(ORGANISATION, "testhttpload");
+}
+
+app::AppState TestHttpLoad::onConstruct() {
+	registerArg("--host").setDescription("The host to connect to").setDefaultValue("127.0.0.1");
+	registerArg("--port").setShort("-p").setDescription("The port to connect to").setDefaultValue("8088");
+	registerArg("--connections").setShort("-c").setDescription("The amount of keep-alive connections").setDefaultValue("10000");
+	registerArg("--duration").setShort("-d").setDescription("The duration of the test in seconds").setDefaultValue("10");
+	registerArg("--path").setDescription("The path to request").setDefaultValue("/");
+	registerArg("--pipeline").setDescription("The amount of pipelined requests per connection").setDefaultValue("1");
+	registerArg("--server").setDescription("Run the http server in the same process");
+	return Super::onConstruct();
+}
+
+/**
+ * @brief Every connection needs a file descriptor - and another one if the server runs in this process
+ */
+static void raiseOpenFileLimit(int needed) {
+#ifndef __WINDOWS__
+	struct rlimit limit;
+	if (getrlimit(RLIMIT_NOFILE, &limit) != 0) {
+		return;
+	}
+	if (limit.rlim_cur >= (rlim_t)needed) {
+		return;
+	}
+	limit.rlim_cur = core_min((rlim_t)needed, limit.rlim_max);
+	if (setrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur < (rlim_t)needed) {
+		Log::warn("Could not raise the open file limit to %i - some connections will fail", needed);
+	}
+#endif
+}
+
+void TestHttpLoad::onConnect(uv_connect_t* req, int status) {
+	Connection* connection = (Connection*)req->data;
+	TestHttpLoad* self = connection->app;
+	--self->_pendingConnects;
+	if (status < 0) {
+		if (self->_running) {
+			Log::debug("Failed to connect: %s", uv_strerror(status));
+			++self->_errors;
+		}
+		self->closeConnection(connection);
+	} else if (uv_read_start((uv_stream_t*)&connection->handle, onAlloc, onRead) != 0) {
+		++self->_errors;
+		self->closeConnection(connection);
+	} else {
+		++self->_connected;
+		if (self->_running) {
+			self->sendRequests(connection, self->_pipeline);
+		}
+	}
+	if (self->_running) {
+		self->connectNext();
+	}
+}
+
+void TestHttpLoad::onAlloc(uv_handle_t* handle, size_t suggestedSize, uv_buf_t* buf) {
+	Connection* connection = (Connection*)handle->data;
+	if (connection->capacity - connection->end < ReceiveSpace) {
+		connection->capacity = core_max(connection->capacity * 2u, connection->end + ReceiveSpace);
+		connection->buf = (char*)SDL_realloc(connection->buf, connection->capacity);
+	}
+	*buf = uv_buf_init(connection->buf + connection->end, (unsigned int)(connection->capacity - connection->end));
+}
+
+void TestHttpLoad::onRead(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+	Connection* connection = (Connection*)stream->data;
+	TestHttpLoad* self = connection->app;
+	if (nread < 0) {
+		if (self->_running) {
+			Log::debug("Connection was closed: %s", uv_strerror((int)nread));
+			++self->_errors;
+		}
+		self->closeConnection(connection);
+		return;
+	}
+	connection->end += (size_t)nread;
+	self->handleResponses(connection);
+}
+
+void TestHttpLoad::onWrite(uv_write_t* req, int status) {
+	Connection* connection = (Connection*)req->data;
+	delete req;
+	if (status < 0) {
+		TestHttpLoad* self = connection->app;
+		if (self->_running) {
+			++self->_errors;
+		}
+		self->closeConnection(connection);
+	}
+}
+
+void TestHttpLoad::onClose(uv_handle_t* handle) {
+	Connection* connection = (Connection*)handle->data;
+	SDL_free(connection->buf);
+	connection->buf = nullptr;
+	connection->capacity = connection->end = 0u;
+}
+
+void TestHttpLoad::connectNext() {
+	while (_pendingConnects < MaxPendingConnects && _nextConnection < _connections.size()) {
+		Connection* connection = _connections[_nextConnection++];
+		uv_tcp_init(_loop, &connection->handle);
+		connection->initialized = true;
+		connection->handle.data = connection;
+		connection->connectReq.data = connection;
+		uv_tcp_nodelay(&connection->handle, 1);
+		if (uv_tcp_connect(&connection->connectReq, &connection->handle, (const struct sockaddr*)&_addr, onConnect) != 0) {
+			++_errors;
+			closeConnection(connection);
+			continue;
+		}
+		++_pendingConnects;
+	}
+}
+
+void TestHttpLoad::sendRequests(Connection* connection, int amount) {
+	if (connection->closing || amount <= 0) {
+		return;
+	}
+	uv_buf_t bufs[MaxPipeline];
+	const uint64_t now = uv_hrtime();
+	for (int i = 0; i < amount; ++i) {
+		bufs[i] = uv_buf_init((char*)_request.c_str(), (unsigned int)_request.size());
+		connection->sent[connection->sentHead++ % MaxPipeline] = now;
+	}
+	uv_write_t* req = new uv_write_t;
+	req->data = connection;
+	if (uv_write(req, (uv_stream_t*)&connection->handle, bufs, amount, onWrite) != 0) {
+		delete req;
+		++_errors;
+		closeConnection(connection);
+	}
+}
+
+/**
+ * @return The position after the header terminating @c \\r\\n\\r\\n - or @c 0 if the header is not yet complete
+ */
+static size_t headerEnd(const char *data, size_t len) {
+	for (size_t i = 0u; i + 4u <= len; ++i) {
+		if (data[i] == '\r' && data[i + 1] == '\n' && data[i + 2] == '\r' && data[i + 3] == '\n') {
+			return i + 4u;
+		}
+	}
+	return 0u;
+}
+
+static size_t contentLength(const char *data, size_t headerSize) {
+	static const char *Key = "\r\ncontent-length:";
+	const size_t keyLen = SDL_strlen(Key);
+	for (size_t i = 0u; i + keyLen <= headerSize; ++i) {
+		if (SDL_strncasecmp(data + i, Key, keyLen) == 0) {
+			return (size_t)SDL_strtoul(data + i + keyLen, nullptr, 10);
+		}
+	}
+	return 0u;
+}
+
+void TestHttpLoad::handleResponses(Connection* connection) {
+	size_t start = 0u;
+	int answered = 0;
+	for (;;) {
+		const char *data = connection->buf + start;
+		const size_t len = connection->end - start;
+		const size_t headerSize = headerEnd(data, len);
+		if (headerSize == 0u) {
+			break;
+		}
+		const size_t responseSize = headerSize + contentLength(data, headerSize);
+		if (len < responseSize) {
+			break;
+		}
+		if (connection->sentTail == connection->sentHead) {
+			Log::warn("Got a response without a request");
+			break;
+		}
+		const uint64_t latency = uv_hrtime() - connection->sent[connection->sentTail++ % MaxPipeline];
+		_latencies.push_back((uint32_t)(latency / 1000u));
+		const int status = len > 12u ? SDL_atoi(data + 9) : 0;
+		if (status < 200 || status >= 300) {
+			++_failedResponses;
+		}
+		start += responseSize;
+		++answered;
+	}
+	if (start > 0u) {
+		memmove(connection->buf, connection->buf + start, connection->end - start);
+		connection->end -= start;
+	}
+	if (_running) {
+		sendRequests(connection, answered);
+	}
+}
+
+void TestHttpLoad::closeConnection(Connection* connection) {
+	if (connection->closing || !connection->initialized) {
+		return;
+	}
+	connection->closing = true;
+	uv_close((uv_handle_t*)&connection->handle, onClose);
+}
+
+void TestHttpLoad::report(double seconds) {
+	const size_t requests = _latencies.size();
+	Log::info("connections: %i/%i", _connected, (int)_connections.size());
+	Log::info("requests: %i in %.2fs (%.1f req/s)", (int)requests, seconds, seconds > 0.0 ? (double)requests / seconds : 0.0);
+	Log::info("non-2xx responses: %i, errors: %i", _failedResponses, _errors);
+	if (requests == 0u) {
+		return;
+	}
+	std::sort(_latencies.begin(), _latencies.end());
+	const uint32_t p50 = _latencies[requests * 50u / 100u];
+	const uint32_t p99 = _latencies[core_min(requests - 1u, requests * 99u / 100u)];
+	Log::info("latency: p50 %.3fms, p99 %.3fms, max %.3fms", (double)p50 / 1000.0, (double)p99 / 1000.0,
+			(double)_latencies.back() / 1000.0);
+}
+
+app::AppState TestHttpLoad::onRunning() {
+	const core::String& host = getArgVal("--host");
+	const int port = core::string::toInt(getArgVal("--port"));
+	const int connections = core_max(1, core::string::toInt(getArgVal("--connections")));
+	const int duration = core_max(1, core::string::toInt(getArgVal("--duration")));
+	const core::String& path = getArgVal("--path");
+	const bool runServer = hasArg("--server");
+	_pipeline = core_min(core_max(1, core::string::toInt(getArgVal("--pipeline"))), MaxPipeline);
+
+	if (!networkInit()) {
+		Log::error("Failed to initialize the network");
+		_exitCode = 1;
+		return app::AppState::Cleanup;
+	}
+	raiseOpenFileLimit(connections * (runServer ? 2 : 1) + 64);
+
+	if (uv_ip4_addr(host.c_str(), port, &_addr) != 0) {
+		Log::error("Invalid host %s", host.c_str());
+		_exitCode = 1;
+		return app::AppState::Cleanup;
+	}
+
+	if (runServer) {
+		if (!_server.init((int16_t)port)) {
+			Log::error("Failed to start the http server on port %i", port);
+			_exitCode = 1;
+			return app::AppState::Cleanup;
+		}
+		_server.registerRoute(http::HttpMethod::GET, path.c_str(), [] (const http::RequestParser& request, http::HttpResponse* response) {
+			response->setText("OK\n");
+		});
+	}
+
+	_loop = new uv_loop_t;
+	uv_loop_init(_loop);
+	_request = core::string::format("GET %s HTTP/1.1\r\nHost: %s\r\n\r\n", path.c_str(), host.c_str());
+	_connections.reserve(connections);
+	for (int i = 0; i < connections; ++i) {
+		Connection* connection = new Connection();
+		connection->app = this;
+		_connections.push_back(connection);
+	}
+	_latencies.reserve(1024 * 1024);
+
+	Log::info("Running %i connections with %i pipelined requests against http://%s:%i%s for %is", connections,
+			_pipeline, host.c_str(), port, path.c_str(), duration);
+
+	_running = true;
+	const uint64_t startTime = uv_hrtime();
+	const uint64_t endTime = startTime + (uint64_t)duration * 1000000000u;
+	connectNext();
+	while (uv_hrtime() < endTime) {
+		if (runServer) {
+			// both loops must be polled without blocking
+			_server.update();
+			uv_run(_loop, UV_RUN_NOWAIT);
+		} else {
+			uv_run(_loop, UV_RUN_ONCE);
+		}
+	}
+	_running = false;
+	const double seconds = (double)(uv_hrtime() - startTime) / 1000000000.0;
+
+	for (Connection* connection : _connections) {
+		closeConnection(connection);
+	}
+	// let the pending callbacks of the client and the server connections run
+	while (uv_run(_loop, UV_RUN_NOWAIT) != 0) {
+		if (runServer) {
+			_server.update();
+		}
+	}
+	uv_loop_close(_loop);
+	delete _loop;
+	_loop = nullptr;
+	if (runServer) {
+		_server.shutdown();
+	}
+	report(seconds);
+
+	for (Connection* connection : _connections) {
+		delete connection;
+	}
+	_connections.clear();
+	return app::AppState::Cleanup;
+}
+
+CONSOLE_APP(TestHttpLoad)
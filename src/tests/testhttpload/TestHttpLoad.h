@@ -0,0 +1,55 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "app/CommandlineApp.h"
+#include "http/HttpServer.h"
+#include "core/String.h"
+#include <uv.h>
+#include <vector>
+
+/**
+ * @brief Load test for the http server - keeps a lot of keep-alive connections busy and reports the
+ * requests per second and the latency percentiles
+ *
+ * Use @c --server to run the http server in the same process and event loop iteration.
+ */
+class TestHttpLoad: public app::CommandlineApp {
+private:
+	using Super = app::CommandlineApp;
+	struct Connection;
+
+	http::HttpServer _server;
+	uv_loop_t *_loop = nullptr;
+	struct sockaddr_in _addr;
+	core::String _request;
+	std::vector<Connection*> _connections;
+	/** the latencies of all answered requests in microseconds */
+	std::vector<uint32_t> _latencies;
+	size_t _nextConnection = 0u;
+	int _pendingConnects = 0;
+	int _pipeline = 1;
+	int _connected = 0;
+	int _errors = 0;
+	int _failedResponses = 0;
+	bool _running = false;
+
+	void connectNext();
+	void sendRequests(Connection* connection, int amount);
+	void handleResponses(Connection* connection);
+	void closeConnection(Connection* connection);
+	void report(double seconds);
+
+	static void onConnect(uv_connect_t* req, int status);
+	static void onAlloc(uv_handle_t* handle, size_t suggestedSize, uv_buf_t* buf);
+	static void onRead(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf);
+	static void onWrite(uv_write_t* req, int status);
+	static void onClose(uv_handle_t* handle);
+public:
+	TestHttpLoad(const metric::MetricPtr& metric, const io::FilesystemPtr& filesystem, const core::EventBusPtr& eventBus, const core::TimeProviderPtr& timeProvider);
+
+	virtual app::AppState onConstruct() override;
+	virtual app::AppState onRunning() override;
+};
@@ -167,7 +167,7 @@ bool generateSrc(const core::String& templateHeader, const core::String& templat
 		auto layoutIter = shaderStruct.layouts.find(v.name);
 		Layout layout;
 		if (layoutIter != shaderStruct.layouts.end()) {
-			layout = layoutIter->second;
+			layout = layoutIter->value;
 		}
 
 		if (v.arraySize > 0 && isInteger) {
@@ -5,6 +5,9 @@
 #include "VoxConvert.h"
 #include "core/Color.h"
 #include "core/Var.h"
+#include "core/StringUtil.h"
+#include "core/collection/StringMap.h"
+#include "core/concurrent/ThreadPool.h"
 #include "command/Command.h"
 #include "io/Filesystem.h"
 #include "metric/Metric.h"
@@ -14,6 +17,9 @@
 #include "voxelformat/VolumeFormat.h"
 #include "voxelformat/VoxFileFormat.h"
 #include "voxelutil/VolumeRescaler.h"
+#include <SDL_cpuinfo.h>
+#include <future>
+#include <vector>
 
 VoxConvert::VoxConvert(const metric::MetricPtr& metric, const io::FilesystemPtr& filesystem, const core::EventBusPtr& eventBus, const core::TimeProviderPtr& timeProvider) :
 		Super(metric, filesystem, eventBus, timeProvider) {
@@ -26,6 +32,9 @@ app::AppState VoxConvert::onConstruct() {
 	registerArg("--merge").setShort("-m").setDescription("Merge layers into one volume");
 	registerArg("--scale").setShort("-s").setDescription("Scale layer to 50% of its original size");
 	registerArg("--force").setShort("-f").setDescription("Overwrite existing files");
+	registerArg("--input").setShort("-i").setDescription("Batch mode: input file, directory or wildcard pattern - can be given multiple times");
+	registerArg("--output").setShort("-o").setDescription("Batch mode: output file pattern - {name} is replaced by the input file name without extension");
+	registerArg("--threads").setShort("-t").setDescription("Batch mode: amount of threads to convert the files in parallel - defaults to the amount of cores");
 
 	core::Var::get("voxformat_mergequads", "true", core::CV_NOPERSIST)->setHelp("Merge similar quads to optimize the mesh");
 	core::Var::get("voxformat_reusevertices", "true", core::CV_NOPERSIST)->setHelp("Reuse vertices or always create new ones");
@@ -60,48 +69,47 @@ app::AppState VoxConvert::onInit() {
 		return app::AppState::InitFailure;
 	}
 
-	const core::String infile = _argv[_argc - 2];
-	const core::String outfile = _argv[_argc - 1];
+	_mergeVolumes = hasArg("--merge") || hasArg("-m");
+	_scaleVolumes = hasArg("--scale") || hasArg("-s");
+	_force = hasArg("--force") || hasArg("-f");
 
-	Log::debug("infile: %s", infile.c_str());
-	Log::debug("outfile: %s", outfile.c_str());
-
-	const io::FilePtr inputFile = filesystem()->open(infile, io::FileMode::SysRead);
-	if (!inputFile->exists()) {
-		Log::error("Given input file '%s' does not exist", infile.c_str());
-		_exitCode = 127;
-		return app::AppState::InitFailure;
+	if (hasArg("--output") || hasArg("-o")) {
+		const core::String outputPattern = getArgVal("--output");
+		const app::AppState batchState = convertBatch(outputPattern);
+		if (batchState != app::AppState::Running) {
+			return batchState;
+		}
+		return state;
 	}
 
-	const io::FilePtr outputFile = filesystem()->open(outfile, io::FileMode::SysWrite);
-	if (!outputFile->validHandle()) {
-		Log::error("Could not open target file: %s", outfile.c_str());
-		return app::AppState::InitFailure;
-	}
-	if (outputFile->length() > 0) {
-		if (!hasArg("--force") && !hasArg("-f")) {
-			Log::error("Given output file '%s' already exists", outfile.c_str());
-			return app::AppState::InitFailure;
-		}
+	const core::String infile = _argv[_argc - 2];
+	const core::String outfile = _argv[_argc - 1];
+	const app::AppState convertState = convertSingle(infile, outfile);
+	if (convertState != app::AppState::Running) {
+		return convertState;
 	}
+	return state;
+}
 
+bool VoxConvert::convertFile(const io::FilePtr& inputFile, const io::FilePtr& outputFile) const {
 	voxel::VoxelVolumes volumes;
 	if (!voxelformat::loadVolumeFormat(inputFile, volumes)) {
-		Log::error("Failed to load given input file");
-		return app::AppState::InitFailure;
+		Log::error("Failed to load given input file '%s'", inputFile->name().c_str());
+		return false;
 	}
 
-	if (hasArg("--merge") || hasArg("-m")) {
+	if (_mergeVolumes) {
 		voxel::RawVolume* merged = volumes.merge();
 		if (merged == nullptr) {
 			Log::error("Failed to merge volumes");
-			return app::AppState::InitFailure;
+			voxelformat::clearVolumes(volumes);
+			return false;
 		}
 		voxelformat::clearVolumes(volumes);
 		volumes.push_back(voxel::VoxelVolume(merged));
 	}
 
-	if (hasArg("--scale") || hasArg("-s")) {
+	if (_scaleVolumes) {
 		for (auto& v : volumes) {
 			const voxel::Region srcRegion = v.volume->region();
 			const glm::ivec3& targetDimensionsHalf = (srcRegion.getDimensionsInVoxels() / 2) - 1;
@@ -117,14 +125,212 @@ app::AppState VoxConvert::onInit() {
 
 	if (!voxelformat::saveVolumeFormat(outputFile, volumes)) {
 		voxelformat::clearVolumes(volumes);
-		Log::error("Failed to write to output file '%s'", outfile.c_str());
-		return app::AppState::InitFailure;
+		Log::error("Failed to write to output file '%s'", outputFile->name().c_str());
+		return false;
 	}
 	Log::info("Wrote output file %s", outputFile->name().c_str());
 
 	voxelformat::clearVolumes(volumes);
+	return true;
+}
 
-	return state;
+app::AppState VoxConvert::convertSingle(const core::String& infile, const core::String& outfile) {
+	Log::debug("infile: %s", infile.c_str());
+	Log::debug("outfile: %s", outfile.c_str());
+
+	const io::FilePtr inputFile = filesystem()->open(infile, io::FileMode::SysRead);
+	if (!inputFile->exists()) {
+		Log::error("Given input file '%s' does not exist", infile.c_str());
+		_exitCode = 127;
+		return app::AppState::InitFailure;
+	}
+
+	const io::FilePtr outputFile = filesystem()->open(outfile, io::FileMode::SysWrite);
+	if (!outputFile->validHandle()) {
+		Log::error("Could not open target file: %s", outfile.c_str());
+		return app::AppState::InitFailure;
+	}
+	if (outputFile->length() > 0) {
+		if (!_force) {
+			Log::error("Given output file '%s' already exists", outfile.c_str());
+			return app::AppState::InitFailure;
+		}
+	}
+
+	if (!convertFile(inputFile, outputFile)) {
+		return app::AppState::InitFailure;
+	}
+	return app::AppState::Running;
+}
+
+bool VoxConvert::collectInputFiles(const core::String& input, core::DynamicArray<core::String>& files) const {
+	core::String directory = input;
+	core::String filter;
+	if (!io::Filesystem::isReadableDir(input)) {
+		if (!core::string::contains(input, "*") && !core::string::contains(input, "?")) {
+			files.push_back(input);
+			return true;
+		}
+		directory = core::string::extractPath(input);
+		filter = core::string::extractFilenameWithExtension(input);
+	}
+	if (directory.empty()) {
+		directory = ".";
+	}
+	const core::String& absDirectory = io::Filesystem::absolutePath(directory);
+	if (absDirectory.empty()) {
+		Log::error("Could not resolve the input directory '%s'", directory.c_str());
+		return false;
+	}
+	core::DynamicArray<io::Filesystem::DirEntry> entities;
+	filesystem()->list(absDirectory, entities, filter);
+	const core::String supported = core::String(",") + voxelformat::SUPPORTED_VOXEL_FORMATS_LOAD + ",";
+	for (const io::Filesystem::DirEntry& entry : entities) {
+		if (entry.type != io::Filesystem::DirEntry::Type::file) {
+			continue;
+		}
+		// a plain directory only contributes the files that we can load
+		if (filter.empty()) {
+			const size_t extPos = entry.name.rfind(".");
+			if (extPos == core::String::npos) {
+				continue;
+			}
+			const core::String& ext = core::String(",") + entry.name.substr(extPos + 1).toLower() + ",";
+			if (!core::string::contains(supported, ext)) {
+				continue;
+			}
+		}
+		files.push_back(absDirectory + "/" + entry.name);
+	}
+	return true;
+}
+
+bool VoxConvert::isUpToDate(const core::String& infile, const core::String& outfile) const {
+	const uint64_t outputTime = io::Filesystem::modificationTime(outfile);
+	if (outputTime == 0u) {
+		return false;
+	}
+	return outputTime >= io::Filesystem::modificationTime(infile);
+}
+
+app::AppState VoxConvert::convertBatch(const core::String& outputPattern) {
+	// the throughput summary should be visible - unless a log level was given explicitly
+	if (!hasArg("--warn") && !hasArg("--error") && _logLevelVar->intVal() > SDL_LOG_PRIORITY_INFO) {
+		_logLevelVar->setVal(SDL_LOG_PRIORITY_INFO);
+		Log::init();
+	}
+
+	if (!core::string::contains(outputPattern, "{name}")) {
+		Log::error("The output pattern '%s' must contain {name} - e.g. out/{name}.qb", outputPattern.c_str());
+		return app::AppState::InitFailure;
+	}
+
+	core::DynamicArray<core::String> inputFiles;
+	for (int i = 1; i < _argc - 1; ++i) {
+		if (SDL_strcmp(_argv[i], "--input") != 0 && SDL_strcmp(_argv[i], "-i") != 0) {
+			continue;
+		}
+		if (!collectInputFiles(_argv[++i], inputFiles)) {
+			return app::AppState::InitFailure;
+		}
+	}
+	if (inputFiles.empty()) {
+		Log::error("No input files given - use --input");
+		return app::AppState::InitFailure;
+	}
+
+	// the files are only opened by the conversion tasks - opening a file for writing truncates it
+	// and we don't want to keep thousands of handles open
+	core::StringMap<core::String> outputs;
+	core::DynamicArray<Conversion> conversions;
+	int upToDate = 0;
+	int failed = 0;
+	for (const core::String& infile : inputFiles) {
+		const core::String& outfile = core::string::replaceAll(outputPattern, "{name}", core::string::extractFilename(infile));
+		// the parallel conversions must not write to the same file
+		core::String otherInput;
+		if (outputs.get(outfile, otherInput)) {
+			Log::error("Both '%s' and '%s' would be converted to '%s'", otherInput.c_str(), infile.c_str(), outfile.c_str());
+			++failed;
+			continue;
+		}
+		outputs.put(outfile, infile);
+		if (!_force && isUpToDate(infile, outfile)) {
+			Log::debug("Skip up to date file '%s'", outfile.c_str());
+			++upToDate;
+			continue;
+		}
+		const core::String& outputDir = core::string::extractPath(outfile);
+		if (!outputDir.empty()) {
+			filesystem()->createDir(outputDir);
+		}
+		conversions.push_back(Conversion{infile, outfile});
+	}
+
+	int threads = core::string::toInt(getArgVal("--threads"));
+	if (threads <= 0) {
+		threads = SDL_GetCPUCount();
+	}
+	threads = core_max(1, core_min(threads, (int)conversions.size()));
+
+	struct Result {
+		bool success = false;
+		long bytes = 0;
+		double millis = 0.0;
+	};
+	const double millisPerTick = 1000.0 / (double)core::TimeProvider::highResTimeResolution();
+	const uint64_t batchStart = core::TimeProvider::highResTime();
+	int converted = 0;
+	uint64_t totalBytes = 0u;
+	{
+		core::ThreadPool threadPool(threads, "VoxConvert");
+		threadPool.init();
+		std::vector<std::future<Result> > results;
+		results.reserve(conversions.size());
+		for (const Conversion& conversion : conversions) {
+			results.emplace_back(threadPool.enqueue([this, &conversion, millisPerTick] () {
+				Result result;
+				const uint64_t start = core::TimeProvider::highResTime();
+				const io::FilePtr& inputFile = filesystem()->open(conversion.infile, io::FileMode::SysRead);
+				if (!inputFile->exists()) {
+					Log::error("Given input file '%s' does not exist", conversion.infile.c_str());
+					return result;
+				}
+				const io::FilePtr& outputFile = filesystem()->open(conversion.outfile, io::FileMode::SysWrite);
+				if (!outputFile->validHandle()) {
+					Log::error("Could not open target file: %s", conversion.outfile.c_str());
+					return result;
+				}
+				result.bytes = inputFile->length();
+				result.success = convertFile(inputFile, outputFile);
+				result.millis = (double)(core::TimeProvider::highResTime() - start) * millisPerTick;
+				return result;
+			}));
+		}
+
+		for (size_t i = 0; i < results.size(); ++i) {
+			const Result& result = results[i].get();
+			if (!result.success) {
+				++failed;
+				continue;
+			}
+			++converted;
+			totalBytes += (uint64_t)result.bytes;
+			const double mbPerSecond = result.millis > 0.0 ? (double)result.bytes / 1024.0 / 1024.0 / (result.millis / 1000.0) : 0.0;
+			Log::info("%s -> %s: %.2f ms (%.2f MB/s)", conversions[i].infile.c_str(), conversions[i].outfile.c_str(),
+					result.millis, mbPerSecond);
+		}
+		threadPool.shutdown(true);
+	}
+	const double seconds = (double)(core::TimeProvider::highResTime() - batchStart) * millisPerTick / 1000.0;
+
+	Log::info("Converted %i files with %i threads in %.2f s (%.2f files/s, %.2f MB/s) - %i up to date, %i failed",
+			converted, threads, seconds, seconds > 0.0 ? (double)converted / seconds : 0.0,
+			seconds > 0.0 ? (double)totalBytes / 1024.0 / 1024.0 / seconds : 0.0, upToDate, failed);
+	if (failed > 0) {
+		_exitCode = 1;
+	}
+	return app::AppState::Running;
 }
 
 int main(int argc, char *argv[]) {
@@ -5,16 +5,45 @@
 #pragma once
 
 #include "app/CommandlineApp.h"
+#include "core/collection/DynamicArray.h"
+#include "io/File.h"
 
 /**
  * @brief This tool is able to convert voxel volumes between different formats
  *
+ * In batch mode (@c --input and @c --output) the given files, directories or wildcard patterns are
+ * converted in parallel - the palette and the filesystem are only initialized once for all of them.
+ *
  * @ingroup Tools
  */
 class VoxConvert: public app::CommandlineApp {
 private:
 	using Super = app::CommandlineApp;
 	core::VarPtr _palette;
+	bool _mergeVolumes = false;
+	bool _scaleVolumes = false;
+	bool _force = false;
+
+	struct Conversion {
+		core::String infile;
+		core::String outfile;
+	};
+
+	/**
+	 * @brief Loads the input file, applies the merge and scale options and saves the result to the output file
+	 * @note This is executed in parallel in batch mode - so don't touch any other state than the given files here
+	 */
+	bool convertFile(const io::FilePtr& inputFile, const io::FilePtr& outputFile) const;
+	/**
+	 * @brief Resolves the given file, directory or wildcard pattern to the voxel files to convert
+	 */
+	bool collectInputFiles(const core::String& input, core::DynamicArray<core::String>& files) const;
+	/**
+	 * @return @c true if the output file is newer than the input file
+	 */
+	bool isUpToDate(const core::String& infile, const core::String& outfile) const;
+	app::AppState convertSingle(const core::String& infile, const core::String& outfile);
+	app::AppState convertBatch(const core::String& outputPattern);
 public:
 	VoxConvert(const metric::MetricPtr& metric, const io::FilesystemPtr& filesystem, const core::EventBusPtr& eventBus, const core::TimeProviderPtr& timeProvider);
 
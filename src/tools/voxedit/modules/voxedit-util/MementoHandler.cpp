@@ -12,6 +12,7 @@
 #include "core/StandardLib.h"
 #include "core/Log.h"
 #include "core/Zip.h"
+#include <utility>
 
 namespace voxedit {
 
@@ -30,10 +31,17 @@ MementoData::MementoData(const uint8_t* buf, size_t bufSize,
 	}
 }
 
+MementoData::MementoData(uint8_t* buf, size_t bufSize, const voxel::Region& region, bool compressed, bool delta) :
+		_compressedSize(bufSize), _buffer(buf), _region(region), _compressed(compressed), _delta(delta) {
+}
+
 MementoData::MementoData(MementoData&& o) noexcept :
 		_compressedSize(std::exchange(o._compressedSize, 0)),
 		_buffer(std::exchange(o._buffer, nullptr)),
-		_region(o._region) {
+		_region(o._region),
+		_compressed(o._compressed),
+		_delta(o._delta),
+		_compressionId(std::exchange(o._compressionId, 0u)) {
 }
 
 MementoData::~MementoData() {
@@ -45,7 +53,10 @@ MementoData::~MementoData() {
 
 MementoData::MementoData(const MementoData& o) :
 		_compressedSize(o._compressedSize),
-		_region(o._region) {
+		_region(o._region),
+		_compressed(o._compressed),
+		_delta(o._delta),
+		_compressionId(o._compressionId) {
 	if (o._buffer != nullptr) {
 		core_assert(_compressedSize > 0);
 		_buffer = (uint8_t*)core_malloc(_compressedSize);
@@ -63,6 +74,9 @@ MementoData& MementoData::operator=(MementoData &&o) noexcept {
 		}
 		_buffer = std::exchange(o._buffer, nullptr);
 		_region = o._region;
+		_compressed = o._compressed;
+		_delta = o._delta;
+		_compressionId = std::exchange(o._compressionId, 0u);
 	}
 	return *this;
 }
@@ -87,16 +101,84 @@ MementoData MementoData::fromVolume(const voxel::RawVolume* volume) {
 	return data;
 }
 
-voxel::RawVolume* MementoData::toVolume(const MementoData& mementoData) {
-	if (mementoData._buffer == nullptr) {
+MementoData MementoData::fromRegion(const voxel::RawVolume* volume, const voxel::Region& region) {
+	if (volume == nullptr) {
+		return MementoData();
+	}
+	voxel::Region cropped = region;
+	cropped.cropTo(volume->region());
+	if (!cropped.isValid()) {
+		return MementoData();
+	}
+	const voxel::Region& volumeRegion = volume->region();
+	const glm::ivec3& offset = cropped.getLowerCorner() - volumeRegion.getLowerCorner();
+	const int width = cropped.getWidthInVoxels();
+	const int height = cropped.getHeightInVoxels();
+	const int depth = cropped.getDepthInVoxels();
+	const size_t bufferSize = cropped.voxels() * sizeof(voxel::Voxel);
+	voxel::Voxel* buffer = (voxel::Voxel*)core_malloc(bufferSize);
+	const voxel::Voxel* src = (const voxel::Voxel*)volume->data();
+	// copy the rows along x - they are contiguous in both buffers
+	const size_t rowSize = width * sizeof(voxel::Voxel);
+	for (int z = 0; z < depth; ++z) {
+		for (int y = 0; y < height; ++y) {
+			const voxel::Voxel* srcRow = src + offset.x + (offset.y + y) * volume->width() + (offset.z + z) * volume->width() * volume->height();
+			core_memcpy((void*)(buffer + y * width + z * width * height), (const void*)srcRow, rowSize);
+		}
+	}
+	return MementoData((uint8_t*)buffer, bufferSize, cropped, false, true);
+}
+
+voxel::Voxel* MementoData::voxels() const {
+	if (_buffer == nullptr) {
 		return nullptr;
 	}
-	const size_t uncompressedBufferSize = mementoData._region.voxels() * sizeof(voxel::Voxel);
+	const size_t uncompressedBufferSize = _region.voxels() * sizeof(voxel::Voxel);
 	uint8_t *uncompressedBuf = (uint8_t*)core_malloc(uncompressedBufferSize);
-	if (!core::zip::uncompress(mementoData._buffer, mementoData._compressedSize, uncompressedBuf, uncompressedBufferSize)) {
+	if (!_compressed) {
+		core_assert(_compressedSize == uncompressedBufferSize);
+		core_memcpy(uncompressedBuf, _buffer, uncompressedBufferSize);
+		return (voxel::Voxel*)uncompressedBuf;
+	}
+	if (!core::zip::uncompress(_buffer, _compressedSize, uncompressedBuf, uncompressedBufferSize)) {
+		core_free(uncompressedBuf);
+		return nullptr;
+	}
+	return (voxel::Voxel*)uncompressedBuf;
+}
+
+voxel::RawVolume* MementoData::toVolume(const MementoData& mementoData) {
+	voxel::Voxel* voxels = mementoData.voxels();
+	if (voxels == nullptr) {
 		return nullptr;
 	}
-	return voxel::RawVolume::createRaw((voxel::Voxel*)uncompressedBuf, mementoData._region);
+	return voxel::RawVolume::createRaw(voxels, mementoData._region);
+}
+
+bool MementoData::applyToVolume(const MementoData& mementoData, voxel::RawVolume* volume) {
+	if (volume == nullptr) {
+		return false;
+	}
+	voxel::Voxel* voxels = mementoData.voxels();
+	if (voxels == nullptr) {
+		return false;
+	}
+	const voxel::Region& region = mementoData._region;
+	const glm::ivec3& mins = region.getLowerCorner();
+	const int width = region.getWidthInVoxels();
+	const int height = region.getHeightInVoxels();
+	voxel::Region target = region;
+	target.cropTo(volume->region());
+	for (int z = target.getLowerZ(); z <= target.getUpperZ(); ++z) {
+		for (int y = target.getLowerY(); y <= target.getUpperY(); ++y) {
+			for (int x = target.getLowerX(); x <= target.getUpperX(); ++x) {
+				const int index = (x - mins.x) + (y - mins.y) * width + (z - mins.z) * width * height;
+				volume->setVoxel(x, y, z, voxels[index]);
+			}
+		}
+	}
+	core_free(voxels);
+	return true;
 }
 
 MementoHandler::MementoHandler() {
@@ -108,13 +190,185 @@ MementoHandler::~MementoHandler() {
 
 bool MementoHandler::init() {
 	_states.reserve(MaxStates);
+	_compressionPool.init();
+	_backgroundCompression = true;
 	return true;
 }
 
 void MementoHandler::shutdown() {
+	if (_backgroundCompression) {
+		_compressionPool.shutdown(true);
+		_backgroundCompression = false;
+	}
+	collectCompressed();
 	clearStates();
 }
 
+void MementoHandler::compressInBackground(MementoData& data) {
+	if (data._buffer == nullptr || data._compressed) {
+		return;
+	}
+	if (!_backgroundCompression) {
+		const uint32_t compressedBufferSize = core::zip::compressBound(data._compressedSize);
+		uint8_t* compressedBuf = (uint8_t*)core_malloc(compressedBufferSize);
+		size_t finalBufSize = 0u;
+		if (!core::zip::compress(data._buffer, data._compressedSize, compressedBuf, compressedBufferSize, &finalBufSize)
+				|| finalBufSize >= data._compressedSize) {
+			core_free(compressedBuf);
+			return;
+		}
+		core_free(data._buffer);
+		data._buffer = compressedBuf;
+		data._compressedSize = finalBufSize;
+		data._compressed = true;
+		return;
+	}
+	if (++_compressionId == 0u) {
+		++_compressionId;
+	}
+	data._compressionId = _compressionId;
+	// the state might get removed while the compression is running - so the task works on its own copy
+	const size_t size = data._compressedSize;
+	uint8_t* raw = (uint8_t*)core_malloc(size);
+	core_memcpy(raw, data._buffer, size);
+	const uint32_t id = data._compressionId;
+	{
+		core::ScopedLock lock(_compressionLock);
+		++_pendingCompressions;
+	}
+	_compressionPool.enqueue([this, raw, size, id] () {
+		const uint32_t compressedBufferSize = core::zip::compressBound(size);
+		uint8_t* compressedBuf = (uint8_t*)core_malloc(compressedBufferSize);
+		size_t finalBufSize = 0u;
+		if (!core::zip::compress(raw, size, compressedBuf, compressedBufferSize, &finalBufSize)) {
+			core_free(compressedBuf);
+			compressedBuf = nullptr;
+			finalBufSize = 0u;
+		}
+		core_free(raw);
+		CompressionResult result;
+		result.id = id;
+		result.buffer = compressedBuf;
+		result.size = finalBufSize;
+		_compressed.push(core::move(result));
+		core::ScopedLock lock(_compressionLock);
+		--_pendingCompressions;
+		_compressionCondition.notify_all();
+	});
+}
+
+void MementoHandler::collectCompressed() {
+	CompressionResult result;
+	while (_compressed.pop(result)) {
+		MementoData* target = nullptr;
+		for (MementoState& state : _states) {
+			if (state.data._compressionId == result.id) {
+				target = &state.data;
+				break;
+			}
+			if (state.undoData._compressionId == result.id) {
+				target = &state.undoData;
+				break;
+			}
+		}
+		if (target == nullptr) {
+			// the state was already removed
+			core_free(result.buffer);
+			continue;
+		}
+		target->_compressionId = 0u;
+		if (result.buffer == nullptr || result.size >= target->_compressedSize) {
+			core_free(result.buffer);
+			continue;
+		}
+		core_free(target->_buffer);
+		target->_buffer = result.buffer;
+		target->_compressedSize = result.size;
+		target->_compressed = true;
+	}
+}
+
+void MementoHandler::waitForCompression() {
+	{
+		core::ScopedLock lock(_compressionLock);
+		_compressionCondition.wait(_compressionLock, [this] () {
+			return _pendingCompressions <= 0;
+		});
+	}
+	collectCompressed();
+}
+
+voxel::RawVolume* MementoHandler::shadow(int layer) const {
+	voxel::RawVolume* volume = nullptr;
+	_shadows.get(layer, volume);
+	return volume;
+}
+
+void MementoHandler::setShadow(int layer, const voxel::RawVolume* volume) {
+	removeShadow(layer);
+	if (volume == nullptr) {
+		return;
+	}
+	_shadows.put(layer, new voxel::RawVolume(volume));
+}
+
+void MementoHandler::removeShadow(int layer) {
+	voxel::RawVolume* volume = shadow(layer);
+	if (volume == nullptr) {
+		return;
+	}
+	delete volume;
+	_shadows.remove(layer);
+}
+
+void MementoHandler::swapLayers(int layer1, int layer2) {
+	voxel::RawVolume* volume1 = shadow(layer1);
+	voxel::RawVolume* volume2 = shadow(layer2);
+	_shadows.remove(layer1);
+	_shadows.remove(layer2);
+	if (volume1 != nullptr) {
+		_shadows.put(layer2, volume1);
+	}
+	if (volume2 != nullptr) {
+		_shadows.put(layer1, volume2);
+	}
+}
+
+void MementoHandler::updateShadow(const MementoState& state) {
+	if (state.layer < 0 || state.type == MementoType::LayerRenamed) {
+		return;
+	}
+	if (state.data._buffer == nullptr) {
+		removeShadow(state.layer);
+		return;
+	}
+	if (state.isRegionDelta()) {
+		MementoData::applyToVolume(state.data, shadow(state.layer));
+		return;
+	}
+	voxel::RawVolume* volume = MementoData::toVolume(state.data);
+	removeShadow(state.layer);
+	if (volume != nullptr) {
+		_shadows.put(state.layer, volume);
+	}
+}
+
+void MementoHandler::materialize(MementoState& state) {
+	if (!state.data._delta) {
+		return;
+	}
+	// the shadow volume is the state of the layer at the current state position
+	const voxel::RawVolume* volume = shadow(state.layer);
+	if (volume == nullptr) {
+		Log::warn("No state for layer %i to create the snapshot from", state.layer);
+		return;
+	}
+	MementoData data = MementoData::fromRegion(volume, volume->region());
+	data._delta = false;
+	compressInBackground(data);
+	state.data = core::move(data);
+}
+
 void MementoHandler::lock() {
 	++_locked;
 }
@@ -141,6 +395,10 @@ void MementoHandler::construct() {
 void MementoHandler::clearStates() {
 	_states.clear();
 	_statePosition = 0u;
+	for (auto iter = _shadows.begin(); iter != _shadows.end(); ++iter) {
+		delete iter->value;
+	}
+	_shadows.clear();
 }
 
 MementoState MementoHandler::undo() {
@@ -148,6 +406,17 @@ MementoState MementoHandler::undo() {
 		return InvalidMementoState;
 	}
 	core_assert(_statePosition >= 1);
+	collectCompressed();
+	const MementoState& current = _states[_statePosition];
+	if (current.undoData._buffer != nullptr) {
+		// region delta - restore the voxels of the modified region
+		--_statePosition;
+		Log::debug("Available states: %i, current index: %i", (int)_states.size(), _statePosition);
+		voxel::logRegion("Undo", current.region);
+		const MementoState undoState{current.type, current.undoData, current.layer, current.name, current.region};
+		updateShadow(undoState);
+		return undoState;
+	}
 	--_statePosition;
 	if (_states[_statePosition].data._buffer != nullptr
 			&& _states[_statePosition].type == MementoType::LayerAdded
@@ -158,7 +427,9 @@ MementoState MementoHandler::undo() {
 	const MementoState& s = state();
 	const voxel::Region region = _states[_statePosition + 1].region;
 	voxel::logRegion("Undo", region);
-	return MementoState{_states[_statePosition + 1].type, s.data, s.layer, s.name, region};
+	const MementoState undoState{_states[_statePosition + 1].type, s.data, s.layer, s.name, region};
+	updateShadow(undoState);
+	return undoState;
 }
 
 MementoState MementoHandler::redo() {
@@ -166,6 +437,7 @@ MementoState MementoHandler::redo() {
 		return InvalidMementoState;
 	}
 	Log::debug("Available states: %i, current index: %i", (int)_states.size(), _statePosition);
+	collectCompressed();
 	++_statePosition;
 	if (_states[_statePosition].data._buffer == nullptr && _states[_statePosition].type == MementoType::LayerAdded) {
 		++_statePosition;
@@ -175,7 +447,9 @@ MementoState MementoHandler::redo() {
 	}
 	const MementoState& s = state();
 	voxel::logRegion("Redo", s.region);
-	return MementoState{s.type, s.data, s.layer, s.name, s.region};
+	const MementoState redoState{s.type, s.data, s.layer, s.name, s.region};
+	updateShadow(redoState);
+	return redoState;
 }
 
 void MementoHandler::markLayerDeleted(int layer, const core::String& name, const voxel::RawVolume* volume) {
@@ -194,11 +468,34 @@ void MementoHandler::markLayerAdded(int layer, const core::String& name, const v
 	markUndo(layer, name, volume, MementoType::LayerAdded);
 }
 
+bool MementoHandler::markUndoRegion(int layer, const core::String& name, const voxel::RawVolume* volume, const voxel::Region& region) {
+	if (volume == nullptr || !region.isValid() || _states.empty()) {
+		return false;
+	}
+	voxel::RawVolume* shadowVolume = shadow(layer);
+	if (shadowVolume == nullptr || shadowVolume->region() != volume->region()) {
+		// no previous state or the volume was resized
+		return false;
+	}
+	MementoData undoData = MementoData::fromRegion(shadowVolume, region);
+	if (undoData._buffer == nullptr) {
+		return false;
+	}
+	MementoData data = MementoData::fromRegion(volume, region);
+	MementoData::applyToVolume(data, shadowVolume);
+	compressInBackground(undoData);
+	compressInBackground(data);
+	Log::debug("Region delta memento state. Volume: %i, region: %i", volume->region().voxels(), data._region.voxels());
+	_states.emplace_back(MementoType::Modification, core::move(data), core::move(undoData), layer, name, region);
+	return true;
+}
+
 void MementoHandler::markUndo(int layer, const core::String& name, const voxel::RawVolume* volume, MementoType type, const voxel::Region& region) {
 	if (_locked > 0) {
 		Log::debug("Don't add undo state - we are currently in locked mode");
 		return;
 	}
+	collectCompressed();
 	if (!_states.empty()) {
 		// if we mark something as new undo state, we can throw away
 		// every other state that follows the new one (everything after
@@ -207,8 +504,22 @@ void MementoHandler::markUndo(int layer, const core::String& name, const voxel::
 	}
 	Log::debug("New undo state for layer %i with name %s (memento state index: %i)", layer, name.c_str(), (int)_states.size());
 	voxel::logRegion("MarkUndo", region);
-	const MementoData& data = MementoData::fromVolume(volume);
-	_states.emplace_back(type, data, layer, name, region);
+	if (type != MementoType::Modification || !markUndoRegion(layer, name, volume, region)) {
+		if (!_states.empty()) {
+			// undoing a full snapshot state restores the previous state as a whole
+			materialize(_states.back());
+		}
+		MementoData data;
+		if (volume != nullptr) {
+			data = MementoData::fromRegion(volume, volume->region());
+			data._delta = false;
+			compressInBackground(data);
+		}
+		_states.emplace_back(type, core::move(data), layer, core::String(name), voxel::Region(region));
+		if (type != MementoType::LayerRenamed) {
+			setShadow(layer, volume);
+		}
+	}
 	while (_states.size() > MaxStates) {
 		_states.erase(0);
 	}
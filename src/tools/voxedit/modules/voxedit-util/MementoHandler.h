@@ -8,6 +8,12 @@
 #include "voxel/Region.h"
 #include "voxel/Voxel.h"
 #include "core/collection/DynamicArray.h"
+#include "core/collection/ConcurrentQueue.h"
+#include "core/collection/Map.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/concurrent/Lock.h"
+#include "core/Trace.h"
+#include "core/concurrent/ThreadPool.h"
 #include "core/String.h"
 #include <stdint.h>
 #include <stddef.h>
@@ -28,14 +34,15 @@ enum class MementoType {
 /**
  * @brief Holds the data of a memento state
  *
- * The given buffer is owned by this class and represents a compressed volume
+ * The given buffer is owned by this class and represents a compressed volume. Region deltas
+ * are kept uncompressed until the @c MementoHandler compressed them in the background.
  */
 class MementoData {
 	friend struct MementoState;
 	friend class MementoHandler;
 private:
 	/**
-	 * @brief How big is the buffer with the compressed volume data
+	 * @brief How big is the buffer with the (compressed) volume data
 	 */
 	size_t _compressedSize = 0;
 	/**
@@ -46,8 +53,28 @@ private:
 	 * The region the given volume data is for
 	 */
 	voxel::Region _region {};
+	/**
+	 * @brief @c false if the buffer still contains the raw voxels
+	 */
+	bool _compressed = true;
+	/**
+	 * @brief The data only covers the modified region and must be applied to the existing volume
+	 */
+	bool _delta = false;
+	/**
+	 * @brief Identifies the data for the background compression - @c 0 if there is none pending
+	 */
+	uint32_t _compressionId = 0u;
 
 	MementoData(const uint8_t* buf, size_t bufSize, const voxel::Region& _region);
+	/**
+	 * @brief Takes the ownership of the given buffer
+	 */
+	MementoData(uint8_t* buf, size_t bufSize, const voxel::Region& _region, bool compressed, bool delta);
+	/**
+	 * @return The uncompressed voxels - you own the returned memory
+	 */
+	voxel::Voxel* voxels() const;
 public:
 	constexpr MementoData() {}
 	MementoData(MementoData&& o) noexcept;
@@ -56,6 +83,10 @@ public:
 
 	MementoData& operator=(MementoData &&o) noexcept;
 
+	inline bool isDelta() const {
+		return _delta;
+	}
+
 	/**
 	 * @brief Converts the given @c mementoData into a volume
 	 * @note Keep in mind that you own the returned memory
@@ -68,11 +99,27 @@ public:
 	 * @param[in] volume The volume to create the memento state for. This might be @c null.
 	 */
 	static MementoData fromVolume(const voxel::RawVolume* volume);
+	/**
+	 * @brief Copies the voxels of the given region - the data is not compressed
+	 * @param[in] volume The volume to copy the region from
+	 * @param[in] region The region to copy. It is cropped to the region of the volume.
+	 */
+	static MementoData fromRegion(const voxel::RawVolume* volume, const voxel::Region& region);
+	/**
+	 * @brief Writes the voxels of the given memento data back into the given volume
+	 * @note This is used for region deltas - see @c isDelta()
+	 */
+	static bool applyToVolume(const MementoData& mementoData, voxel::RawVolume* volume);
 };
 
 struct MementoState {
 	MementoType type;
 	MementoData data;
+	/**
+	 * @brief The voxels of the modified region before the modification was done. Only
+	 * available for states that were recorded as region delta.
+	 */
+	MementoData undoData;
 	int layer;
 	core::String name;
 	/**
@@ -90,7 +137,11 @@ struct MementoState {
 	}
 
 	MementoState(MementoType _type, MementoData&& _data, int _layer, core::String&& _name, voxel::Region&& _region) :
-			type(_type), data(_data), layer(_layer), name(_name), region(_region) {
+			type(_type), data(core::move(_data)), layer(_layer), name(_name), region(_region) {
+	}
+
+	MementoState(MementoType _type, MementoData&& _data, MementoData&& _undoData, int _layer, const core::String& _name, const voxel::Region& _region) :
+			type(_type), data(core::move(_data)), undoData(core::move(_undoData)), layer(_layer), name(_name), region(_region) {
 	}
 
 	/**
@@ -103,6 +154,14 @@ struct MementoState {
 	inline const voxel::Region& dataRegion() const {
 		return data._region;
 	}
+
+	/**
+	 * @brief The data only contains the voxels of the modified region and must be applied to the
+	 * existing volume of the layer with @c MementoData::applyToVolume()
+	 */
+	inline bool isRegionDelta() const {
+		return data._delta;
+	}
 };
 
 /**
@@ -113,6 +172,55 @@ private:
 	core::DynamicArray<MementoState> _states;
 	uint8_t _statePosition = 0u;
 	int _locked = 0;
+
+	/**
+	 * @brief The state of each layer at the current state position. This allows to record only the
+	 * modified region of a layer - the voxels before the modification are taken from here.
+	 */
+	typedef core::Map<int, voxel::RawVolume*, 64> Shadows;
+	Shadows _shadows;
+
+	struct CompressionResult {
+		uint32_t id = 0u;
+		uint8_t* buffer = nullptr;
+		size_t size = 0u;
+
+		inline bool operator<(const CompressionResult& rhs) const {
+			return id < rhs.id;
+		}
+	};
+	core::ThreadPool _compressionPool { 1, "Memento" };
+	core::ConcurrentQueue<CompressionResult> _compressed;
+	core_trace_mutex(core::Lock, _compressionLock, "MementoCompression");
+	// signaled when a compression task finished - see waitForCompression()
+	core::ConditionVariable _compressionCondition;
+	int _pendingCompressions = 0;
+	uint32_t _compressionId = 0u;
+	bool _backgroundCompression = false;
+
+	void compressInBackground(MementoData& data);
+	/**
+	 * @brief Put the results of the background compression into the states
+	 */
+	void collectCompressed();
+
+	void setShadow(int layer, const voxel::RawVolume* volume);
+	void removeShadow(int layer);
+	voxel::RawVolume* shadow(int layer) const;
+	/**
+	 * @brief Update the shadow volume of the layer to the state that is returned by undo() or redo()
+	 */
+	void updateShadow(const MementoState& state);
+	/**
+	 * @brief Replaces the region data of the state at the current position with a full snapshot.
+	 *
+	 * Undoing a full snapshot state returns the data of the previous state - which must be a full snapshot, too.
+	 */
+	void materialize(MementoState& state);
+	/**
+	 * @return @c true if a region delta for the given modification could be recorded
+	 */
+	bool markUndoRegion(int layer, const core::String& name, const voxel::RawVolume* volume, const voxel::Region& region);
 public:
 	static const int MaxStates;
 
@@ -144,19 +252,32 @@ public:
 	 * @param[in] name The name of the layer
 	 * @param[in] volume The state of the volume
 	 * @param[in] type The @c MementoType - has influence on undo() and redo() state position changes.
+	 * @param[in] region The modified region. For modifications only the voxels of this region are recorded
+	 * if the volume didn't change its size. Otherwise the whole volume is recorded.
 	 */
 	void markUndo(int layer, const core::String& name, const voxel::RawVolume* volume, MementoType type = MementoType::Modification, const voxel::Region& region = voxel::Region::InvalidRegion);
 	void markLayerDeleted(int layer, const core::String& name, const voxel::RawVolume* volume);
 	void markLayerAdded(int layer, const core::String& name, const voxel::RawVolume* volume);
+	/**
+	 * @brief The volumes of the given layers were swapped - the region deltas of the following
+	 * modifications must be recorded against the swapped volumes.
+	 */
+	void swapLayers(int layer1, int layer2);
 
 	/**
 	 * @note Keep in mind that the returned state contains memory for the voxel::RawVolume that you take ownership for
+	 * @note If the returned state is a region delta (@c MementoState::isRegionDelta()) the data must be applied to
+	 * the existing volume of the layer
 	 */
 	MementoState undo();
 	/**
 	 * @note Keep in mind that the returned state contains memory for the voxel::RawVolume that you take ownership for
 	 */
 	MementoState redo();
+	/**
+	 * @brief Blocks until all region deltas are compressed
+	 */
+	void waitForCompression();
 	bool canUndo() const;
 	bool canRedo() const;
 
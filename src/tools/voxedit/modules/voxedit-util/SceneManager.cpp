@@ -438,6 +438,13 @@ void SceneManager::undo() {
 		_layerMgr.rename(s.layer, s.name);
 		return;
 	}
+	if (s.isRegionDelta()) {
+		// only the voxels of the modified region were recorded
+		if (MementoData::applyToVolume(s.data, volume(s.layer))) {
+			modified(s.layer, s.dataRegion(), false);
+		}
+		return;
+	}
 	voxel::RawVolume* v = MementoData::toVolume(s.data);
 	if (v == nullptr) {
 		_layerMgr.deleteLayer(s.layer, false);
@@ -503,6 +510,13 @@ void SceneManager::redo() {
 		_layerMgr.rename(s.layer, s.name);
 		return;
 	}
+	if (s.isRegionDelta()) {
+		// only the voxels of the modified region were recorded
+		if (MementoData::applyToVolume(s.data, volume(s.layer))) {
+			modified(s.layer, s.dataRegion(), false);
+		}
+		return;
+	}
 	voxel::RawVolume* v = MementoData::toVolume(s.data);
 	if (v == nullptr) {
 		_layerMgr.deleteLayer(s.layer, false);
@@ -1946,7 +1960,9 @@ void SceneManager::onLayerSwapped(int layerId1, int layerId2) {
 	// TODO: mementohandler
 	if (!_volumeRenderer.swap(layerId1, layerId2)) {
 		Log::error("Failed to swap volumes for layer %i and layer %i", layerId1, layerId2);
+		return;
 	}
+	_mementoHandler.swapLayers(layerId1, layerId2);
 }
 
 void SceneManager::onLayerHide(int layerId) {
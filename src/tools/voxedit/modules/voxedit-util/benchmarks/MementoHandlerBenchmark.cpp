@@ -0,0 +1,116 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "../MementoHandler.h"
+#include "voxel/RawVolume.h"
+
+class MementoHandlerBenchmark : public app::AbstractBenchmark {
+protected:
+	/**
+	 * @brief A brush stroke of the given size in the center of the volume
+	 */
+	static voxel::Region stroke(const voxel::RawVolume& volume, int size) {
+		const glm::ivec3& center = volume.region().getCenter();
+		return voxel::Region(center, center + size - 1);
+	}
+
+	static void modify(voxel::RawVolume& volume, const voxel::Region& region, int i) {
+		const voxel::Voxel voxel = (i & 1) ? voxel::createVoxel(voxel::VoxelType::Generic, (uint8_t)i) : voxel::Voxel();
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					volume.setVoxel(x, y, z, voxel);
+				}
+			}
+		}
+	}
+
+	static voxel::Region sceneRegion(int size) {
+		return voxel::Region(glm::ivec3(0), glm::ivec3(size - 1));
+	}
+};
+
+/**
+ * @brief The latency of a brush stroke if the whole volume is recorded
+ */
+BENCHMARK_DEFINE_F(MementoHandlerBenchmark, MarkUndoFullSnapshot)(benchmark::State &state) {
+	voxedit::MementoHandler handler;
+	handler.init();
+	voxel::RawVolume volume(sceneRegion((int)state.range(0)));
+	const voxel::Region& region = stroke(volume, 8);
+	handler.markUndo(0, "", &volume);
+	int i = 0;
+	for (auto _ : state) {
+		modify(volume, region, ++i);
+		handler.markUndo(0, "", &volume);
+	}
+	handler.shutdown();
+}
+
+/**
+ * @brief The latency of a brush stroke if only the modified region is recorded
+ */
+BENCHMARK_DEFINE_F(MementoHandlerBenchmark, MarkUndoRegionDelta)(benchmark::State &state) {
+	voxedit::MementoHandler handler;
+	handler.init();
+	voxel::RawVolume volume(sceneRegion((int)state.range(0)));
+	const voxel::Region& region = stroke(volume, 8);
+	handler.markUndo(0, "", &volume);
+	int i = 0;
+	for (auto _ : state) {
+		modify(volume, region, ++i);
+		handler.markUndo(0, "", &volume, voxedit::MementoType::Modification, region);
+	}
+	handler.shutdown();
+}
+
+/**
+ * @brief The latency of undo and redo of full snapshots - including the decompression of the volume
+ */
+BENCHMARK_DEFINE_F(MementoHandlerBenchmark, UndoRedoFullSnapshot)(benchmark::State &state) {
+	voxedit::MementoHandler handler;
+	handler.init();
+	voxel::RawVolume volume(sceneRegion((int)state.range(0)));
+	const voxel::Region& region = stroke(volume, 8);
+	handler.markUndo(0, "", &volume);
+	modify(volume, region, 1);
+	handler.markUndo(0, "", &volume);
+	handler.waitForCompression();
+	for (auto _ : state) {
+		const voxedit::MementoState& undo = handler.undo();
+		delete voxedit::MementoData::toVolume(undo.data);
+		const voxedit::MementoState& redo = handler.redo();
+		delete voxedit::MementoData::toVolume(redo.data);
+	}
+	handler.shutdown();
+}
+
+/**
+ * @brief The latency of undo and redo of region deltas - including writing the voxels back into the volume
+ */
+BENCHMARK_DEFINE_F(MementoHandlerBenchmark, UndoRedoRegionDelta)(benchmark::State &state) {
+	voxedit::MementoHandler handler;
+	handler.init();
+	voxel::RawVolume volume(sceneRegion((int)state.range(0)));
+	const voxel::Region& region = stroke(volume, 8);
+	handler.markUndo(0, "", &volume);
+	modify(volume, region, 1);
+	handler.markUndo(0, "", &volume, voxedit::MementoType::Modification, region);
+	handler.waitForCompression();
+	for (auto _ : state) {
+		const voxedit::MementoState& undo = handler.undo();
+		voxedit::MementoData::applyToVolume(undo.data, &volume);
+		const voxedit::MementoState& redo = handler.redo();
+		voxedit::MementoData::applyToVolume(redo.data, &volume);
+	}
+	handler.shutdown();
+}
+
+BENCHMARK_REGISTER_F(MementoHandlerBenchmark, MarkUndoFullSnapshot)->Arg(64)->Arg(128)->Unit(benchmark::kMicrosecond);
+BENCHMARK_REGISTER_F(MementoHandlerBenchmark, MarkUndoRegionDelta)->Arg(64)->Arg(128)->Unit(benchmark::kMicrosecond);
+BENCHMARK_REGISTER_F(MementoHandlerBenchmark, UndoRedoFullSnapshot)->Arg(64)->Arg(128)->Unit(benchmark::kMicrosecond);
+BENCHMARK_REGISTER_F(MementoHandlerBenchmark, UndoRedoRegionDelta)->Arg(64)->Arg(128)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
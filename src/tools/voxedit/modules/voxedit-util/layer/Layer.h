@@ -26,7 +26,7 @@ struct Layer {
 		if (i == metadata.end()) {
 			return EMPTY;
 		}
-		return i->second;
+		return i->value;
 	}
 
 	void reset() {
@@ -24,6 +24,10 @@ protected:
 	void TearDown() override {
 		mementoHandler.shutdown();
 	}
+
+	static voxel::Voxel solid() {
+		return voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	}
 };
 
 TEST_F(MementoHandlerTest, testMarkUndo) {
@@ -661,4 +665,115 @@ TEST_F(MementoHandlerTest, testAddNewLayerEdit) {
 	EXPECT_FALSE(mementoHandler.canRedo());
 }
 
+TEST_F(MementoHandlerTest, testRegionDelta) {
+	std::shared_ptr<voxel::RawVolume> volume = create(16);
+	mementoHandler.markUndo(0, "Layer 1", volume.get());
+	EXPECT_FALSE(mementoHandler.state().isRegionDelta());
+
+	const glm::ivec3 pos(2, 3, 4);
+	volume->setVoxel(pos, solid());
+	mementoHandler.markUndo(0, "Layer 1", volume.get(), MementoType::Modification, voxel::Region(pos, pos));
+	ASSERT_TRUE(mementoHandler.state().isRegionDelta());
+	EXPECT_EQ(1, mementoHandler.state().dataRegion().voxels());
+
+	MementoState state = mementoHandler.undo();
+	ASSERT_TRUE(state.isRegionDelta());
+	EXPECT_EQ(0, state.layer);
+	EXPECT_EQ(voxel::Region(pos, pos), state.region);
+	ASSERT_TRUE(MementoData::applyToVolume(state.data, volume.get()));
+	EXPECT_TRUE(voxel::isAir(volume->voxel(pos).getMaterial()));
+
+	state = mementoHandler.redo();
+	ASSERT_TRUE(state.isRegionDelta());
+	ASSERT_TRUE(MementoData::applyToVolume(state.data, volume.get()));
+	EXPECT_EQ(solid(), volume->voxel(pos));
+}
+
+TEST_F(MementoHandlerTest, testRegionDeltaMultipleSteps) {
+	std::shared_ptr<voxel::RawVolume> volume = create(16);
+	mementoHandler.markUndo(0, "Layer 1", volume.get());
+	for (int i = 0; i < 4; ++i) {
+		const glm::ivec3 pos(i);
+		volume->setVoxel(pos, solid());
+		mementoHandler.markUndo(0, "Layer 1", volume.get(), MementoType::Modification, voxel::Region(glm::ivec3(0), pos));
+	}
+	mementoHandler.waitForCompression();
+	EXPECT_EQ(5, (int)mementoHandler.stateSize());
+
+	// undo the last two steps
+	for (int i = 0; i < 2; ++i) {
+		const MementoState& state = mementoHandler.undo();
+		ASSERT_TRUE(state.isRegionDelta());
+		ASSERT_TRUE(MementoData::applyToVolume(state.data, volume.get()));
+	}
+	EXPECT_EQ(solid(), volume->voxel(glm::ivec3(1)));
+	EXPECT_TRUE(voxel::isAir(volume->voxel(glm::ivec3(2)).getMaterial()));
+	EXPECT_TRUE(voxel::isAir(volume->voxel(glm::ivec3(3)).getMaterial()));
+
+	// a new modification throws away the redo states and is recorded against the restored state
+	const glm::ivec3 pos(10);
+	volume->setVoxel(pos, solid());
+	mementoHandler.markUndo(0, "Layer 1", volume.get(), MementoType::Modification, voxel::Region(pos, pos));
+	EXPECT_EQ(4, (int)mementoHandler.stateSize());
+	const MementoState& state = mementoHandler.undo();
+	ASSERT_TRUE(state.isRegionDelta());
+	ASSERT_TRUE(MementoData::applyToVolume(state.data, volume.get()));
+	EXPECT_TRUE(voxel::isAir(volume->voxel(pos).getMaterial()));
+	EXPECT_EQ(solid(), volume->voxel(glm::ivec3(1)));
+}
+
+TEST_F(MementoHandlerTest, testRegionDeltaFullSnapshotFallback) {
+	std::shared_ptr<voxel::RawVolume> volume = create(16);
+	mementoHandler.markUndo(0, "Layer 1", volume.get());
+	const glm::ivec3 pos(1);
+	volume->setVoxel(pos, solid());
+	mementoHandler.markUndo(0, "Layer 1", volume.get(), MementoType::Modification, voxel::Region(pos, pos));
+	ASSERT_TRUE(mementoHandler.state().isRegionDelta());
+
+	// the volume was resized - the region delta can't be applied
+	std::shared_ptr<voxel::RawVolume> resized = create(8);
+	mementoHandler.markUndo(0, "Layer 1", resized.get(), MementoType::Modification, resized->region());
+	EXPECT_FALSE(mementoHandler.state().isRegionDelta());
+	EXPECT_EQ(8, mementoHandler.state().dataRegion().getWidthInVoxels());
+
+	// undo restores the whole volume of the previous state - including the recorded modification
+	MementoState state = mementoHandler.undo();
+	ASSERT_FALSE(state.isRegionDelta());
+	ASSERT_TRUE(state.hasVolumeData());
+	std::unique_ptr<voxel::RawVolume> restored(MementoData::toVolume(state.data));
+	ASSERT_NE(nullptr, restored.get());
+	EXPECT_EQ(volume->region(), restored->region());
+	EXPECT_EQ(solid(), restored->voxel(pos));
+
+	// the previous step is still a region delta
+	state = mementoHandler.undo();
+	ASSERT_TRUE(state.isRegionDelta());
+	ASSERT_TRUE(MementoData::applyToVolume(state.data, restored.get()));
+	EXPECT_TRUE(voxel::isAir(restored->voxel(pos).getMaterial()));
+}
+
+TEST_F(MementoHandlerTest, testRegionDeltaLayerAdded) {
+	std::shared_ptr<voxel::RawVolume> first = create(4);
+	std::shared_ptr<voxel::RawVolume> second = create(4);
+	mementoHandler.markUndo(0, "Layer 1", first.get());
+	mementoHandler.markLayerAdded(1, "Layer 2", second.get());
+	EXPECT_FALSE(mementoHandler.state().isRegionDelta());
+
+	const glm::ivec3 pos(1);
+	second->setVoxel(pos, solid());
+	mementoHandler.markUndo(1, "Layer 2", second.get(), MementoType::Modification, voxel::Region(pos, pos));
+	ASSERT_TRUE(mementoHandler.state().isRegionDelta());
+	mementoHandler.waitForCompression();
+
+	MementoState state = mementoHandler.undo();
+	ASSERT_TRUE(state.isRegionDelta());
+	EXPECT_EQ(1, state.layer);
+
+	// undo the layer add - this is still a full snapshot state
+	state = mementoHandler.undo();
+	EXPECT_EQ(1, state.layer);
+	EXPECT_FALSE(state.isRegionDelta());
+	EXPECT_FALSE(state.hasVolumeData());
+}
+
 }